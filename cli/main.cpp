@@ -19,10 +19,14 @@
 
 #include "core/log/streamlogger.h"
 #include "core/log/logmanager.h"
+#include "core/log/metrics.h"
 #include "core/interpreter/fromfilemodule.h"
 #include "core/moduleloader.h"
 #include "core/object.h"
 #include "core/interpreter/programloader.h"
+#include "core/interpreter/query.h"
+#include "core/interpreter/bytecode.h"
+#include "core/interpreter/scriptprofiler.h"
 #include "core/modules/default/defaultmodule.h"
 #include "core/modulesetup.h"
 #include "core/util/fileutil.h"
@@ -45,21 +49,30 @@ enum DisplayType {
     value,
     numberOfChildren,
     size,
-    binary
+    binary,
+    errors
 };
 #define DISPLAY_TYPE_DEFAULT DisplayType::subtree
 
 struct CLIOptions {
     std::string filePath;
     std::vector<std::string> leafs;
+    std::string query;
+    std::string profilePath;
+    std::string statsFormat;
     DisplayType displayType;
     int maxDepth;
     bool verbose;
+    bool skeleton;
     CLIOptions() : filePath(),
                    leafs(),
+                   query(),
+                   profilePath(),
+                   statsFormat(),
                    displayType(DISPLAY_TYPE_DEFAULT),
                    maxDepth(-1),
-                   verbose(false)
+                   verbose(false),
+                   skeleton(false)
     {
 
     }
@@ -90,9 +103,28 @@ are ignored),\n\
      * numberOfChildren : number of children of the last leaf reached,\n\
      * size : size of the last leaf reached (in bits) \n\
      * binary : raw data of the last leaf reached (use with caution) \n\
+     * errors : parsing errors found in the last leaf reached \n\
   -d, --max-depth : how deep in the subtree should we go,\n\
                     ignored if type is not subtree\n\
-                    -1 (default) will go as deep as it gets" << std::endl;
+                    -1 (default) will go as deep as it gets\n\
+  -s, --skeleton : only parse the offsets, sizes and types of the elements,\n\
+                   their bodies are parsed when reached\n\
+  -q, --query : select the objects matching a path below the last leaf reached\n\
+                and display each of them as soon as it is found. The steps\n\
+                of the path are separated by '/', each one is either a name,\n\
+                '#' followed by an index, '*' for every child or '**' for\n\
+                every descendant, optionally followed by ':' and a type name\n\
+                and by an HMDL expression between brackets.\n\
+                Example: hexamonkey-cli test.ts -t size -q '*:transport_packet[PID == 256]'\n\
+  -p, --profile-script : measure the time spent in each line and type of the\n\
+                         scripts and write the report to the file given,\n\
+                         with the folded stacks for flame graphs written next\n\
+                         to it with the '.folded' extension added. The scripts\n\
+                         are run by the AST interpreter, which is slower than\n\
+                         the bytecode but knows the lines\n\
+  --stats : write to the error output what the parsing did once done, objects\n\
+            created, file reads, parser calls, collections... It can be\n\
+            followed by the format, text (default) or json" << std::endl;
 }
 
 
@@ -140,6 +172,8 @@ bool parseArgs(const int argc, const char* const argv[], CLIOptions& options)
                 options.displayType = DisplayType::size;
             else if(typeStr == "binary")
                 options.displayType = DisplayType::binary;
+            else if(typeStr == "errors")
+                options.displayType = DisplayType::errors;
             else
                 return false;
         } else if(flag == "--max-depth" || flag == "-d")
@@ -151,6 +185,35 @@ bool parseArgs(const int argc, const char* const argv[], CLIOptions& options)
             std::stringstream mdStream(optStr.front());
             mdStream >> options.maxDepth;
             optStr.pop_front();
+        } else if(flag == "--skeleton" || flag == "-s")
+        {
+            optStr.pop_front();
+            options.skeleton = true;
+        } else if(flag == "--query" || flag == "-q")
+        {
+            optStr.pop_front();
+            if(optStr.empty())
+                return false;
+
+            options.query = optStr.front();
+            optStr.pop_front();
+        } else if(flag == "--profile-script" || flag == "-p")
+        {
+            optStr.pop_front();
+            if(optStr.empty())
+                return false;
+
+            options.profilePath = optStr.front();
+            optStr.pop_front();
+        } else if(flag == "--stats")
+        {
+            optStr.pop_front();
+            options.statsFormat = "text";
+            if(!optStr.empty() && (optStr.front() == "text" || optStr.front() == "json"))
+            {
+                options.statsFormat = optStr.front();
+                optStr.pop_front();
+            }
         } else
         { moreOptions = false; }
     }
@@ -161,6 +224,52 @@ bool parseArgs(const int argc, const char* const argv[], CLIOptions& options)
     return true;
 }
 
+void display(Object& object, const CLIOptions& options, File& file)
+{
+    object.explore(options.maxDepth);
+    switch(options.displayType)
+    {
+        case value:
+            std::cout << object.value() << std::endl;
+            break;
+
+        case subtree:
+            object.displayTree(std::cout);
+            break;
+
+        case info:
+            object.display(std::cout) << std::endl;
+            break;
+
+        case numberOfChildren:
+            std::cout << object.numberOfChildren() << std::endl;
+            break;
+
+        case size:
+            std::cout << object.size() << std::endl;
+            break;
+
+        case binary:
+            object.dump(std::cout);
+            break;
+
+        case errors:
+        {
+            const ParsingErrorIndex& index = object.errors();
+            std::streamoff begin = object.beginningPos();
+            std::streamoff end = object.size() != -1 ? begin + object.size() : file.size();
+            for (const ParsingError* error : index.between(begin, end)) {
+                std::cout << error->position() << " " << ParsingError::reasonName(error->reason())
+                          << " " << error->object() << std::endl;
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
 int main(int argc, char *argv[])
 {
     CLIOptions options;
@@ -175,6 +284,11 @@ int main(int argc, char *argv[])
     if (options.verbose) {
         logger.reset(new StreamLogger(std::cerr));
     }
+    if (!options.profilePath.empty()) {
+        Bytecode::setEnabled(false);
+        ScriptProfiler::setEnabled(true);
+    }
+
     ModuleSetup moduleSetup;
     moduleSetup.setup();
 
@@ -193,7 +307,8 @@ int main(int argc, char *argv[])
         const Module& module = moduleLoader.getModule(file);
 
         std::vector<Object*> objs;
-        objs.push_back(module.handleFile(module.getType("File"), file, collector));
+        objs.push_back(module.handleFile(module.getType("File"), file, collector,
+                                         options.skeleton ? Object::skeletonParsing : Object::fullParsing));
 
 
         Object*child = nullptr;
@@ -216,36 +331,49 @@ int main(int argc, char *argv[])
                 return 1;
             }
         }
-        objs[0]->explore(options.maxDepth);
-        switch(options.displayType)
+        if(options.displayType == fileType)
         {
-            case fileType:
-                std::cout << objs[objs.size()-1]->type() << std::endl;
-                break;
-
-            case value:
-                std::cout << objs[0]->value() << std::endl;
-                break;
-
-            case subtree:
-                objs[0]->displayTree(std::cout);
-                break;
-
-            case numberOfChildren:
-                std::cout << objs[0]->numberOfChildren() << std::endl;
-                break;
-
-            case size:
-                std::cout << objs[0]->size() << std::endl;
-                break;
+            std::cout << objs[objs.size()-1]->type() << std::endl;
+        }
+        else if(!options.query.empty())
+        {
+            Query query(moduleSetup.programLoader());
+            if(!query.setExpression(options.query))
+            {
+                std::cerr << "Invalid query" << std::endl;
+                return 1;
+            }
 
-            case binary:
-                objs[0]->dump(std::cout);
-                break;
+            // Each object is displayed as soon as it is found, the rest of the file being parsed afterwards
+            query.run(*objs[0], [&options, &file](Object& object) {
+                display(object, options, file);
+                std::cout.flush();
+                return true;
+            });
+        }
+        else
+        {
+            display(*objs[0], options, file);
+        }
 
-            default:
-                break;
+        if(!options.profilePath.empty() && !ScriptProfiler::write(options.profilePath))
+        {
+            std::cerr << "Profile could not be written" << std::endl;
+            return 1;
         }
     }
+
+    if(!options.statsFormat.empty())
+    {
+#ifdef HM_METRICS
+        if(options.statsFormat == "json")
+            Metrics::writeJson(std::cerr);
+        else
+            Metrics::writeText(std::cerr);
+#else
+        std::cerr << "The metrics are not compiled in" << std::endl;
+        return 1;
+#endif
+    }
     return 0;
 }
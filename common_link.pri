@@ -1,6 +1,9 @@
 
 SRCDIR = $$PWD
 
+# Same as in core.pri, for the programs reading the metrics of the library
+!nometrics: DEFINES += HM_METRICS
+
 unix: LIBS += -L$$SRCDIR/core -lhexamonkey
 win32 {
     CONFIG( debug, debug|release ) {
@@ -33,7 +33,7 @@
 #define VERBOSE
 #endif
 
-ast* last_sibling(ast* node)
+static ast* last_sibling(ast* node)
 {
 	if(node->next_sibling == NULL)
 		return node;
@@ -41,7 +41,7 @@ ast* last_sibling(ast* node)
 		return last_sibling((ast*)node->next_sibling);
 }
 
-ast* new_node(ast* parent, uint32_t id)
+static ast* new_node(ast* parent, uint32_t id)
 {
 	ast* node = malloc(sizeof(ast));
 	
@@ -55,7 +55,7 @@ ast* new_node(ast* parent, uint32_t id)
 	return node;
 }
 
-ast* append_node(ast* parent, uint32_t id)
+static ast* append_node(ast* parent, uint32_t id)
 {
 	ast* node = new_node(parent, id);
 	
@@ -67,7 +67,7 @@ ast* append_node(ast* parent, uint32_t id)
 	return node;
 }
 
-ast* prepend_node(ast* parent, uint32_t id)
+static ast* prepend_node(ast* parent, uint32_t id)
 {
 	ast* node = new_node(parent, id);
 	
@@ -77,9 +77,95 @@ ast* prepend_node(ast* parent, uint32_t id)
 	return node;
 }
 
-ast root = {HMC_ROOT_ID, 0, -1, NULL, NULL, NULL};
-ast* current_node = &root;
-int line_number=1;
+static void init_root(compiler_state* state, uint32_t id)
+{
+	state->root.id = id;
+	state->root.size = 0;
+	state->root.line_number = -1;
+	state->root.parent = NULL;
+	state->root.first_child.node = NULL;
+	state->root.next_sibling = NULL;
+	state->current_node = &state->root;
+}
+
+static void init_state(compiler_state* state, int start_token)
+{
+	init_root(state, HMC_ROOT_ID);
+	state->line_number = 1;
+	state->start_token = start_token;
+	state->current_stack = NULL;
+	state->current_stashes[0] = NULL;
+	state->current_stashes[1] = NULL;
+	state->stashes_counts[0] = NULL;
+	state->stashes_counts[1] = NULL;
+	state->infos = 0;
+	state->is_virtual = 0;
+	state->error = NULL;
+	state->error_size = 0;
+}
+
+static void free_content(int32_t id, content* content)
+{
+	if(id != -1 && hmcElemTypes[id] == HMC_STRING)
+		free(content->s);
+}
+
+static void free_children(ast* node)
+{
+	if(hmcElemTypes[node->id] == HMC_MASTER)
+	{
+		ast* child = node->first_child.node;
+		while(child != NULL)
+		{
+			ast* next = child->next_sibling;
+			free_children(child);
+			free(child);
+			child = next;
+		}
+	}
+	else if(hmcElemTypes[node->id] == HMC_STRING)
+	{
+		free(node->first_child.s);
+	}
+	node->first_child.node = NULL;
+}
+
+static void free_stack(stack* st)
+{
+	while(st != NULL)
+	{
+		stack* next = st->st;
+		free_content(st->id, &st->content);
+		free(st);
+		st = next;
+	}
+}
+
+static void free_int_stack(int_stack* st)
+{
+	while(st != NULL)
+	{
+		int_stack* next = st->st;
+		free(st);
+		st = next;
+	}
+}
+
+/* Release whatever is left, which is only the case when the parsing failed */
+static void free_state(compiler_state* state)
+{
+	int i;
+	free_children(&state->root);
+	free_stack(state->current_stack);
+	state->current_stack = NULL;
+	for(i = 0; i < 2; ++i)
+	{
+		free_stack(state->current_stashes[i]);
+		state->current_stashes[i] = NULL;
+		free_int_stack(state->stashes_counts[i]);
+		state->stashes_counts[i] = NULL;
+	}
+}
 
 #ifdef VERBOSE
 int indentation = 0;
@@ -93,9 +179,9 @@ void print_indentation()
 }
 #endif
 
-ast* insert_first_node(uint32_t id)
+static void insert_first_node(compiler_state* state, uint32_t id)
 {
-	current_node = prepend_node(current_node, id);	
+	state->current_node = prepend_node(state->current_node, id);	
 #ifdef POP_DEBUG	
 	print_indentation();
 	printf("<%s>\n",hmcElemNames[id]);
@@ -103,14 +189,15 @@ ast* insert_first_node(uint32_t id)
 #endif
 }
 
-ast* close_node()
+static void close_node(compiler_state* state)
 {
 #ifdef POP_DEBUG
 	--indentation;	
 	print_indentation();
-	printf("</%s>\n",hmcElemNames[current_node->id]);
+	printf("</%s>\n",hmcElemNames[state->current_node->id]);
 #endif
 	
+	ast* current_node = state->current_node;
 	ast* parent = current_node->parent;
 	
 	if(parent != NULL) 
@@ -128,63 +215,63 @@ ast* close_node()
 		}
 	}
 	
-	current_node = parent;	
+	state->current_node = parent;	
 }
 
-void set_integer(int64_t i)
+static void set_integer(compiler_state* state, int64_t i)
 {
 #ifdef POP_DEBUG
 	print_indentation();
 	printf("%d\n",i);
 #endif
-	current_node->size = int_size(i);
-	current_node->first_child.i = i;
+	state->current_node->size = int_size(i);
+	state->current_node->first_child.i = i;
 }
 
-void set_uinteger(uint64_t u)
+static void set_uinteger(compiler_state* state, uint64_t u)
 {
 #ifdef POP_DEBUG	
 	print_indentation();
 	printf("%u\n",u);
 #endif
-	current_node->size = uint_size(u);
-	current_node->first_child.u = u;
+	state->current_node->size = uint_size(u);
+	state->current_node->first_child.u = u;
 }
 
-void set_string(char* s)
+static void set_string(compiler_state* state, char* s)
 {
 #ifdef POP_DEBUG	
 	print_indentation();
 	printf("%s\n",s);
 #endif
-	current_node->size = strlen(s);
-	current_node->first_child.s = s;
+	state->current_node->size = strlen(s);
+	state->current_node->first_child.s = s;
 }
 
-void set_float(double f)
+static void set_float(compiler_state* state, double f)
 {
 #ifdef POP_DEBUG	
 	print_indentation();
 	printf("%f\n",f);
 #endif
-	current_node->size = 8;
-	current_node->first_child.f = f;
+	state->current_node->size = 8;
+	state->current_node->first_child.f = f;
 }
 
-void push_master(int32_t id, int32_t count);
-void push_integer(int32_t id, int64_t i);
-void push_uinteger(int32_t id, uint64_t u);
-void push_float(int32_t id, double f);
-void push_string(int32_t id, char* s);
+static void push_master(compiler_state* state, int32_t id, int32_t count);
+static void push_integer(compiler_state* state, int32_t id, int64_t i);
+static void push_uinteger(compiler_state* state, int32_t id, uint64_t u);
+static void push_float(compiler_state* state, int32_t id, double f);
+static void push_string(compiler_state* state, int32_t id, char* s);
 
-void write_node(FILE* file, ast* node)
+static void write_node(compiler_state* state, hmc_buffer* output, ast* node)
 {
-	push_integer(HMC_LINE_NUMBER, node->line_number);
-	push_integer(HMC_FILE_OFFSET, ftell(file));
-	push_master(HMC_CODE_INFO, 2);
+	push_integer(state, HMC_LINE_NUMBER, node->line_number);
+	push_integer(state, HMC_FILE_OFFSET, output->size);
+	push_master(state, HMC_CODE_INFO, 2);
 	
-	write_ebml_int(file, node->id);
-	write_ebml_int(file, node->size);
+	write_ebml_int(output, node->id);
+	write_ebml_int(output, node->size);
 	ast* child;
 #ifdef WRITE_DEBUG
 	print_indentation();
@@ -199,7 +286,7 @@ void write_node(FILE* file, ast* node)
 #endif
 			for(child = node->first_child.node; child != NULL; child = child->next_sibling)
 			{
-				write_node(file, child);
+				write_node(state, output, child);
 			}
 #ifdef WRITE_DEBUG
 			--indentation;
@@ -211,28 +298,28 @@ void write_node(FILE* file, ast* node)
 #ifdef WRITE_DEBUG
 			printf("%d", node->first_child.i);
 #endif
-			write_int(file, node->first_child.i, node->size);
+			write_int(output, node->first_child.i, node->size);
 			break;
 			
 		case HMC_UINTEGER:
 #ifdef WRITE_DEBUG
 			printf("%d", node->first_child.u);
 #endif
-			write_uint(file, node->first_child.u, node->size);
+			write_uint(output, node->first_child.u, node->size);
 			break;
 			
 		case HMC_STRING:
 #ifdef WRITE_DEBUG
 			printf("%s", node->first_child.s);
 #endif
-			write_string(file, node->first_child.s, node->size);
+			write_string(output, node->first_child.s, node->size);
 			break;
 			
 		case HMC_FLOAT:
 #ifdef WRITE_DEBUG
 			printf("%f", node->first_child.f);
 #endif
-			write_float(file, node->first_child.f);
+			write_float(output, node->first_child.f);
 			break;
 	}
 #ifdef WRITE_DEBUG
@@ -240,93 +327,94 @@ void write_node(FILE* file, ast* node)
 #endif
 }
 
-stack* current_stack = NULL;
-
-void push_line()
+static void push_line(compiler_state* state)
 {
 	stack* s = malloc(sizeof(stack));
 	s->id = -1;
 	s->count = 0;
-	s->content.u = line_number;
-	s->st = current_stack;
+	s->content.u = state->line_number;
+	s->st = state->current_stack;
 	
-	current_stack = s;
+	state->current_stack = s;
 }
 
-void new_stack(int32_t id, int32_t count)
+static void new_stack(compiler_state* state, int32_t id, int32_t count)
 {
 	if(count == 0) 
 	{
-		push_line();
+		push_line(state);
 		count = 1;
 	}
 
 	stack* s = malloc(sizeof(stack));
 	s->id = id;
 	s->count = count;
-	s->st = current_stack;
-	current_stack = s;
+	s->content.u = 0;
+	s->st = state->current_stack;
+	state->current_stack = s;
 }
 
-void push_master(int32_t id, int32_t count)
+static void push_master(compiler_state* state, int32_t id, int32_t count)
 {
-	new_stack(id, count);
+	new_stack(state, id, count);
 }
 
-void push_integer(int32_t id, int64_t i)
+static void push_integer(compiler_state* state, int32_t id, int64_t i)
 {
-	new_stack(id, 0);
-	current_stack->content.i = i;
+	new_stack(state, id, 0);
+	state->current_stack->content.i = i;
 }
 
-void push_uinteger(int32_t id, uint64_t u)
+static void push_uinteger(compiler_state* state, int32_t id, uint64_t u)
 {
-	new_stack(id, 0);
-	current_stack->content.u = u;
+	new_stack(state, id, 0);
+	state->current_stack->content.u = u;
 }
 
-void push_float(int32_t id, double f)
+static void push_float(compiler_state* state, int32_t id, double f)
 {
-	new_stack(id, 0);
-	current_stack->content.f = f;
+	new_stack(state, id, 0);
+	state->current_stack->content.f = f;
 }
 
-void push_string(int32_t id, char* s)
+/* The string is released along with the node, it must have been allocated by malloc */
+static void push_string(compiler_state* state, int32_t id, char* s)
 {
-	new_stack(id, 0);
-	current_stack->content.s = s;
+	new_stack(state, id, 0);
+	state->current_stack->content.s = s;
 }
 
-void ignore()
+static void ignore(compiler_state* state)
 {
-	stack* popped = current_stack;
-	current_stack = popped->st;
+	stack* popped = state->current_stack;
+	state->current_stack = popped->st;
 	
 	int i;
 	for(i=0; i<popped->count;++i)
-		ignore();
+		ignore(state);
 
+	free_content(popped->id, &popped->content);
 	free(popped);
 }
 
-void pop()
+static void pop(compiler_state* state)
 {
-	stack* popped = current_stack;
-	current_stack = popped->st;
+	stack* popped = state->current_stack;
+	state->current_stack = popped->st;
 
 	int should_insert =  (popped->id != -1) //not line
-				   && !(hmcElemTypes[popped->id] == HMC_MASTER && hmcElemAssoc[popped->id] && current_node->id == popped->id);//not associative
+				   && !(hmcElemTypes[popped->id] == HMC_MASTER && hmcElemAssoc[popped->id] && state->current_node->id == popped->id);//not associative
 
 	if(should_insert) 
 	{
-		insert_first_node(popped->id);
+		insert_first_node(state, popped->id);
 	}
 
 	if(popped->id == -1) 
 	{
-		if(current_node != NULL && (current_node->line_number == -1 || current_node->line_number > popped->content.u))
+		if(state->current_node != NULL && (state->current_node->line_number == -1 || state->current_node->line_number > popped->content.u))
 		{
-			current_node->line_number = popped->content.u;
+			state->current_node->line_number = popped->content.u;
 		}
 	}
 	else
@@ -334,137 +422,137 @@ void pop()
 		switch(hmcElemTypes[popped->id])
 		{
 			case HMC_INTEGER:
-				set_integer(popped->content.i);
+				set_integer(state, popped->content.i);
 				break;
 
 			case HMC_UINTEGER:
-				set_uinteger(popped->content.u);
+				set_uinteger(state, popped->content.u);
 				break;
 
 			case HMC_STRING:
-				set_string(popped->content.s);
+				set_string(state, popped->content.s);
 				break;
 
 			case HMC_FLOAT:
-				set_float(popped->content.f);
+				set_float(state, popped->content.f);
 				break;
 		}
 	}
 
 	int i;
 	for(i=0; i<popped->count;++i)
-		pop();
+		pop(state);
 
 
 	if(should_insert) 
 	{
-		close_node();
+		close_node(state);
 	}
 
 	free(popped);
 }
 
-int empty()
+static int empty(compiler_state* state)
 {
-	return current_stack == NULL;
+	return state->current_stack == NULL;
 }
 
-
-stack* current_stashes[] = {NULL, NULL}; 
-int_stack* stashes_counts[] = {NULL, NULL};
-
-int _stash(int number)
+static int _stash(compiler_state* state, int number)
 {
-	stack* s = current_stack;
-	current_stack = s->st;
-	s->st = current_stashes[number];
-	current_stashes[number] = s;
+	stack* s = state->current_stack;
+	state->current_stack = s->st;
+	s->st = state->current_stashes[number];
+	state->current_stashes[number] = s;
 
 	int result = 1;
 	int i;
 	for(i = 0; i < s->count; ++i)
 	{
-		result += _stash(number);
+		result += _stash(state, number);
 	}
 
 	return result; 
 }
 
-void stash(int number)
+static void stash(compiler_state* state, int number)
 {
 	int_stack* s = malloc(sizeof(int_stack));
-	s->i = _stash(number);
-	s->st = stashes_counts[number];
-	stashes_counts[number] = s;
+	s->i = _stash(state, number);
+	s->st = state->stashes_counts[number];
+	state->stashes_counts[number] = s;
 }
 
-void unstash(int number)
+static void unstash(compiler_state* state, int number)
 {
 	int i;
-	for(i = 0; i < stashes_counts[number]->i; ++i)
+	for(i = 0; i < state->stashes_counts[number]->i; ++i)
 	{
-		stack* s = current_stashes[number];
-		current_stashes[number] = s->st;
-		s->st = current_stack;
-		current_stack = s;
+		stack* s = state->current_stashes[number];
+		state->current_stashes[number] = s->st;
+		s->st = state->current_stack;
+		state->current_stack = s;
 	}
-	int_stack* old = stashes_counts[number];
-	stashes_counts[number] = old->st;
+	int_stack* old = state->stashes_counts[number];
+	state->stashes_counts[number] = old->st;
 	free(old);
 }
 
-void copy_stashed(int number)
+static void copy_stashed(compiler_state* state, int number)
 {
 	int i = 0;
-	stack* current_stash = current_stashes[number];
-	int_stack* current_count = stashes_counts[number];
+	stack* current_stash = state->current_stashes[number];
+	int_stack* current_count = state->stashes_counts[number];
 	for(i = 0; i < current_count->i; ++i)
 	{
-		new_stack(current_stash->id, current_stash->count);
-		current_stack->content = current_stash->content;
+		new_stack(state, current_stash->id, current_stash->count);
+		state->current_stack->content = current_stash->content;
+		// Each copy owns its string so that they can all be released
+		if(current_stash->id != -1 && hmcElemTypes[current_stash->id] == HMC_STRING)
+			state->current_stack->content.s = strdup(current_stash->content.s);
 
 		current_stash = current_stash->st;
 	}
 }
 
-void del_stashed(int number)
+static void del_stashed(compiler_state* state, int number)
 {
 	int i;
-	for(i = 0; i < stashes_counts[number]->i; ++i)
+	for(i = 0; i < state->stashes_counts[number]->i; ++i)
 	{
-		stack* popped = current_stashes[number];
-		current_stashes[number] = popped->st;
+		stack* popped = state->current_stashes[number];
+		state->current_stashes[number] = popped->st;
+		free_content(popped->id, &popped->content);
 		free(popped);
 	}
-	int_stack* old = stashes_counts[number];
-	stashes_counts[number] = old->st;
+	int_stack* old = state->stashes_counts[number];
+	state->stashes_counts[number] = old->st;
 	free(old);
 }
 
-void handle_op(int id)
+static void handle_op(compiler_state* state, int id)
 {
 	int parameterCount = operatorParameterCount[id];
 	
 	int i;
 	for(i = 0; i < parameterCount; ++i)
 	{
-		stash(0);
+		stash(state, 0);
 	}
 	
-	push_integer(HMC_OPERATOR, id);
+	push_integer(state, HMC_OPERATOR, id);
 	
 	for(i = 0; i < parameterCount; ++i)
 	{
-		unstash(0);
+		unstash(state, 0);
 	}
 	
-	push_master(HMC_RIGHT_VALUE, parameterCount+1);
+	push_master(state, HMC_RIGHT_VALUE, parameterCount+1);
 }
 
 #ifdef STACK_DEBUG
-void dump_stack()
+void dump_stack(compiler_state* state)
 {
-	stack* st = current_stack;
+	stack* st = state->current_stack;
 	while(st) {
 		if(st->id == -1) 
 		{
@@ -0,0 +1,67 @@
+//This file is part of the HexaMonkey project, a multimedia analyser
+//Copyright (C) 2013  Sevan Drapeau-Martin, Nicolas Fleury
+
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The source is a whole HMDL file */
+#define HMC_FILE_MODE       0
+/* The source is a single right value, as used by filters */
+#define HMC_EXPRESSION_MODE 1
+
+/*
+ * Version of the output of the compiler, to be incremented whenever the same
+ * source may compile differently : change to the grammar, the scanner, the
+ * encoding of the nodes (ast.h, write.h) or the model.
+ */
+#define HMC_OUTPUT_VERSION  1
+
+typedef struct _hmc_buffer
+{
+	char*  data;
+	size_t size;
+	size_t capacity;
+} hmc_buffer;
+
+/*
+ * Compile HMDL source code into the content of a compiled HMDL file.
+ *
+ * The compilation only works on its own state, so that this function can be
+ * called from several threads at the same time. Returns 0 on success, in which
+ * case output must be released with hmc_free_buffer. Otherwise a message
+ * describing the first error is written into error when it is not NULL.
+ */
+int hmc_compile(const char* source, size_t size, int mode, hmc_buffer* output, char* error, size_t error_size);
+
+void hmc_free_buffer(hmc_buffer* buffer);
+
+/*
+ * Version of the output of the compiler linked, see HMC_OUTPUT_VERSION.
+ */
+int hmc_output_version(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
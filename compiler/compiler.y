@@ -17,17 +17,30 @@
 
 %error-verbose
 
+%define api.pure full
+%lex-param {yyscan_t scanner}
+%parse-param {yyscan_t scanner} {compiler_state* state}
+
+%code requires {
+    #include "struct.h"
+    #ifndef YY_TYPEDEF_YY_SCANNER_T
+    #define YY_TYPEDEF_YY_SCANNER_T
+    typedef void* yyscan_t;
+    #endif
+}
+
 %{ 
     #include "ast.h"  
     #include "header.h"
-    extern FILE *yyin;   
-    void yyerror (char const *);
     int yydebug=1;                                                                    
-    int indent=0; 
-    int infos=0;
-	int isVirtual = 0;
 %}    
 
+%code {
+    int yylex(YYSTYPE* lvalp, yyscan_t scanner);
+    void yyerror(yyscan_t scanner, compiler_state* state, char const *);
+    int hmc_parse(compiler_state* state, const char* source, size_t size);
+}
+
 %union {
     long long          i;
     unsigned long long u;
@@ -42,6 +55,8 @@
 
 %token STRUCT_TOKEN ENUM_TOKEN
 
+%token FILE_START_TOKEN EXPRESSION_START_TOKEN
+
 %token ASSOC_TOKEN
 
 %left ',' 
@@ -78,252 +93,256 @@
 %token <i> INT_VALUE 
 %token <u> UINT_VALUE  
 %token <f> FLOAT_VALUE
+
+%destructor { free($$); } <s>
  
 %% /* Grammar rules and actions follow */
-main:file
+main:
+    FILE_START_TOKEN file
+   |EXPRESSION_START_TOKEN right_value
   
 file: format_detection_additions imports class_declarations
 
 format_detection_additions:
-    /*empty*/ {push_master(HMC_FORMAT_DETECTION_ADDITIONS,0);}
-   |format_detection_additions format_detection_addition {push_master(HMC_FORMAT_DETECTION_ADDITIONS,2);}
+    /*empty*/ {push_master(state, HMC_FORMAT_DETECTION_ADDITIONS,0);}
+   |format_detection_additions format_detection_addition {push_master(state, HMC_FORMAT_DETECTION_ADDITIONS,2);}
 ;
 
 imports:
-    /*empty*/ {push_master(HMC_IMPORTS,0);}
-    |imports import_token import_list {push_master(HMC_IMPORTS, 3);}
+    /*empty*/ {push_master(state, HMC_IMPORTS,0);}
+    |imports import_token import_list {push_master(state, HMC_IMPORTS, 3);}
 ;
 
 import_token:
-	IMPORT_TOKEN {push_line();}
+	IMPORT_TOKEN {push_line(state);}
 
 import_list:
-    identifier {push_master(HMC_IMPORTS,1);}
-   |import_list identifier {push_master(HMC_IMPORTS,2);}
+    identifier {push_master(state, HMC_IMPORTS,1);}
+   |import_list identifier {push_master(state, HMC_IMPORTS,2);}
 
 class_declarations:
-    /*empty*/ {push_master(HMC_CLASS_DECLARATIONS,0);}
-   |class_declarations class_declaration {push_master(HMC_CLASS_DECLARATIONS,2);}
-   |class_declarations forward {push_master(HMC_CLASS_DECLARATIONS,2);}
-   |class_declarations function_declaration {push_master(HMC_CLASS_DECLARATIONS,2);}
+    /*empty*/ {push_master(state, HMC_CLASS_DECLARATIONS,0);}
+   |class_declarations class_declaration {push_master(state, HMC_CLASS_DECLARATIONS,2);}
+   |class_declarations forward {push_master(state, HMC_CLASS_DECLARATIONS,2);}
+   |class_declarations function_declaration {push_master(state, HMC_CLASS_DECLARATIONS,2);}
 ;
    
 format_detection_addition:
-    ADD_MAGIC_NUMBER_TOKEN {push_integer(HMC_OPERATOR, HMC_ADD_MAGIC_NUMBER_OP);}  magic_number {push_master(HMC_FORMAT_DETECTION_ADDITION,2);}
-   |ADD_EXTENSION_TOKEN {push_integer(HMC_OPERATOR, HMC_ADD_EXTENSION_OP);}  identifier {push_master(HMC_FORMAT_DETECTION_ADDITION,2);}
-   |ADD_SYNCBYTE_TOKEN {push_integer(HMC_OPERATOR, HMC_ADD_SYNCBYTE_OP);}  uint_constant uint_constant {push_master(HMC_FORMAT_DETECTION_ADDITION,3);}
+    ADD_MAGIC_NUMBER_TOKEN {push_integer(state, HMC_OPERATOR, HMC_ADD_MAGIC_NUMBER_OP);}  magic_number {push_master(state, HMC_FORMAT_DETECTION_ADDITION,2);}
+   |ADD_EXTENSION_TOKEN {push_integer(state, HMC_OPERATOR, HMC_ADD_EXTENSION_OP);}  identifier {push_master(state, HMC_FORMAT_DETECTION_ADDITION,2);}
+   |ADD_SYNCBYTE_TOKEN {push_integer(state, HMC_OPERATOR, HMC_ADD_SYNCBYTE_OP);}  uint_constant uint_constant {push_master(state, HMC_FORMAT_DETECTION_ADDITION,3);}
 ;
 
 magic_number:
-    MAGIC_NUMBER {push_string(HMC_STRING_CONSTANT, $1);}
+    MAGIC_NUMBER {push_string(state, HMC_STRING_CONSTANT, $1);}
 ;
 
 class_declaration:    
-    class_token class_info class_definition {push_master(HMC_CLASS_DECLARATION, 3);}
+    class_token class_info class_definition {push_master(state, HMC_CLASS_DECLARATION, 3);}
    |class_token class_infos class_definition 
     {
-        stash(1);
+        stash(state, 1);
 		
-	    copy_stashed(1);
-		push_master(HMC_CLASS_DECLARATION, 3);
-		push_master(HMC_CLASS_DECLARATIONS, 2);
-		unstash(0);
-		--infos;
-        while(infos>0)
+	    copy_stashed(state, 1);
+		push_master(state, HMC_CLASS_DECLARATION, 3);
+		push_master(state, HMC_CLASS_DECLARATIONS, 2);
+		unstash(state, 0);
+		--state->infos;
+        while(state->infos>0)
         {
-            copy_stashed(1);
-            push_master(HMC_CLASS_DECLARATION, 2);
-            push_master(HMC_CLASS_DECLARATIONS, 2);
-            unstash(0);
-            --infos;
+            copy_stashed(state, 1);
+            push_master(state, HMC_CLASS_DECLARATION, 2);
+            push_master(state, HMC_CLASS_DECLARATIONS, 2);
+            unstash(state, 0);
+            --state->infos;
         }
-        unstash(1);
-        push_master(HMC_CLASS_DECLARATION, 2);
+        unstash(state, 1);
+        push_master(state, HMC_CLASS_DECLARATION, 2);
     }
 ;
 
 class_token:
-	CLASS_TOKEN {isVirtual = 0; push_line();}
-   |VIRTUAL_TOKEN CLASS_TOKEN {isVirtual = 1; push_line();}
+	CLASS_TOKEN {state->is_virtual = 0; push_line(state);}
+   |VIRTUAL_TOKEN CLASS_TOKEN {state->is_virtual = 1; push_line(state);}
 
 class_info:
-    type_template extension specification type_attributes {push_integer(HMC_VIRTUAL, isVirtual); 
-	                                                       push_master(HMC_CLASS_INFO, 5);}
+    type_template extension specification type_attributes {push_integer(state, HMC_VIRTUAL, state->is_virtual); 
+	                                                       push_master(state, HMC_CLASS_INFO, 5);}
 
 class_infos:
-    class_info',' class_info {stash(0);++infos;} 
-   |class_infos ',' class_info {stash(0);++infos;}
+    class_info',' class_info {stash(state, 0);++state->infos;} 
+   |class_infos ',' class_info {stash(state, 0);++state->infos;}
  
 forward:
-    forward_token type to_token type {push_master(HMC_FORWARD, 4);}
+    forward_token type to_token type {push_master(state, HMC_FORWARD, 4);}
 
 forward_token:
-	FORWARD_TOKEN {push_line();}
+	FORWARD_TOKEN {push_line(state);}
 
 to_token:
-	TO_TOKEN {push_line();}
+	TO_TOKEN {push_line(state);}
 	
 type_template:
-     identifier type_template_argument_list {push_master(HMC_TYPE_TEMPLATE, 2);}
+     identifier type_template_argument_list {push_master(state, HMC_TYPE_TEMPLATE, 2);}
 ;
 
 type_template_argument_list:
-    /*empty*/ {push_master(HMC_ARGUMENT_DECLARATIONS, 0);}
-    |'(' ')' {push_master(HMC_ARGUMENT_DECLARATIONS, 0);}
+    /*empty*/ {push_master(state, HMC_ARGUMENT_DECLARATIONS, 0);}
+    |'(' ')' {push_master(state, HMC_ARGUMENT_DECLARATIONS, 0);}
     |'(' type_template_arguments ')'
 ;
 
 type_template_arguments:
-      identifier {push_master(HMC_ARGUMENT_DECLARATIONS, 1);}
-    | type_template_arguments ',' identifier {push_master(HMC_ARGUMENT_DECLARATIONS, 2);}
+      identifier {push_master(state, HMC_ARGUMENT_DECLARATIONS, 1);}
+    | type_template_arguments ',' identifier {push_master(state, HMC_ARGUMENT_DECLARATIONS, 2);}
 ;
 
 function_declaration:
-    function_token identifier function_arguments execution_block {push_master(HMC_FUNCTION_DECLARATION, 4);}
+    function_token identifier function_arguments execution_block {push_master(state, HMC_FUNCTION_DECLARATION, 4);}
 ;
 
 function_token:
-	FUNCTION_TOKEN {push_line();}
+	FUNCTION_TOKEN {push_line(state);}
 
 function_arguments:
     '(' function_argument_list ')'
-   |'(' ')' {push_master(HMC_FUNCTION_ARGUMENTS, 0);}
+   |'(' ')' {push_master(state, HMC_FUNCTION_ARGUMENTS, 0);}
 ;
 
 function_argument_list:
-    function_argument {push_master(HMC_FUNCTION_ARGUMENTS, 1);}
-   |function_argument_list ',' function_argument {push_master(HMC_FUNCTION_ARGUMENTS, 2);}   
+    function_argument {push_master(state, HMC_FUNCTION_ARGUMENTS, 1);}
+   |function_argument_list ',' function_argument {push_master(state, HMC_FUNCTION_ARGUMENTS, 2);}   
 ;
 
 function_argument:
-    modifiable identifier default_value {push_master(HMC_FUNCTION_ARGUMENT, 3);}
+    modifiable identifier default_value {push_master(state, HMC_FUNCTION_ARGUMENT, 3);}
     
 modifiable:
-    /*empty*/ {push_integer(HMC_MODIFIABLE, 1);}
-   |CONST_TOKEN {push_integer(HMC_MODIFIABLE, 0);}
+    /*empty*/ {push_integer(state, HMC_MODIFIABLE, 1);}
+   |CONST_TOKEN {push_integer(state, HMC_MODIFIABLE, 0);}
    
 default_value:
-    /*empty*/ {push_integer(HMC_NULL_CONSTANT, 0); push_master(HMC_RIGHT_VALUE, 1);}
+    /*empty*/ {push_integer(state, HMC_NULL_CONSTANT, 0); push_master(state, HMC_RIGHT_VALUE, 1);}
    |'=' right_value
 
 type_access:
-    type {push_master(HMC_RIGHT_VALUE,1);}
+    type {push_master(state, HMC_RIGHT_VALUE,1);}
    |'(' right_value ')'
 ;
 
 type:
-    identifier {push_master(HMC_ARGUMENTS,0); push_master(HMC_TYPE, 2);} 
+    identifier {push_master(state, HMC_ARGUMENTS,0); push_master(state, HMC_TYPE, 2);} 
    |explicit_type
    
 explicit_type:
-    identifier right_value_arguments {push_master(HMC_TYPE, 2);}
-   |struct_header '{' struct_arguments '}' {push_master(HMC_TYPE, 2);}
-   |enum_header '{' enum_arguments '}' {push_master(HMC_ARGUMENTS,2);push_master(HMC_TYPE, 2);}
+    identifier right_value_arguments {push_master(state, HMC_TYPE, 2);}
+   |struct_header '{' struct_arguments '}' {push_master(state, HMC_TYPE, 2);}
+   |enum_header '{' enum_arguments '}' {push_master(state, HMC_ARGUMENTS,2);push_master(state, HMC_TYPE, 2);}
 ;
 
 right_value_arguments:
-    '(' ')' {push_master(HMC_ARGUMENTS,0);}
+    '(' ')' {push_master(state, HMC_ARGUMENTS,0);}
    |'(' right_value_argument_list ')'
 ;
     
 right_value_argument_list:
-      right_value {push_master(HMC_ARGUMENTS,1);}
-    | right_value_argument_list ',' right_value {push_master(HMC_ARGUMENTS,2);}
+      right_value {push_master(state, HMC_ARGUMENTS,1);}
+    | right_value_argument_list ',' right_value {push_master(state, HMC_ARGUMENTS,2);}
 ;
 
 struct_header:
-	struct_type struct_name {push_master(HMC_ARGUMENTS, 1);}
-   |struct_type {push_integer(HMC_NULL_CONSTANT, 0); push_master(HMC_RIGHT_VALUE, 1); push_master(HMC_ARGUMENTS, 1);}
+	struct_type struct_name {push_master(state, HMC_ARGUMENTS, 1);}
+   |struct_type {push_integer(state, HMC_NULL_CONSTANT, 0); push_master(state, HMC_RIGHT_VALUE, 1); push_master(state, HMC_ARGUMENTS, 1);}
 ;
 
 struct_name:
-	IDENT {push_string(HMC_STRING_CONSTANT, $1); push_master(HMC_RIGHT_VALUE, 1);}
-   |'#'   {push_string(HMC_STRING_CONSTANT, "#"); push_master(HMC_RIGHT_VALUE, 1);}
+	IDENT {push_string(state, HMC_STRING_CONSTANT, $1); push_master(state, HMC_RIGHT_VALUE, 1);}
+   |'#'   {push_string(state, HMC_STRING_CONSTANT, strdup("#")); push_master(state, HMC_RIGHT_VALUE, 1);}
    
 struct_type:
-	STRUCT_TOKEN {push_string(HMC_IDENTIFIER, "Struct");}
+	STRUCT_TOKEN {push_string(state, HMC_IDENTIFIER, strdup("Struct"));}
 
 struct_declaration:
 	type_access struct_name
    |struct_declaration '['']' {
-                                stash(0);
-                                stash(0);
-                                push_string(HMC_IDENTIFIER, "Array");
-                                unstash(0);
-                                push_master(HMC_ARGUMENTS,1);
-                                push_master(HMC_TYPE,2);
-                                push_master(HMC_RIGHT_VALUE,1);
-                                unstash(0);
+                                stash(state, 0);
+                                stash(state, 0);
+                                push_string(state, HMC_IDENTIFIER, strdup("Array"));
+                                unstash(state, 0);
+                                push_master(state, HMC_ARGUMENTS,1);
+                                push_master(state, HMC_TYPE,2);
+                                push_master(state, HMC_RIGHT_VALUE,1);
+                                unstash(state, 0);
 						    }
     
    |struct_declaration '['right_value']' {
-                                stash(1);
-                                stash(0);
-                                stash(0);
-                                push_string(HMC_IDENTIFIER, "Tuple");
-                                unstash(0);
-                                unstash(1);
-                                push_master(HMC_ARGUMENTS,2);
-                                push_master(HMC_TYPE,2);
-                                push_master(HMC_RIGHT_VALUE,1);
-                                unstash(0);
+                                stash(state, 1);
+                                stash(state, 0);
+                                stash(state, 0);
+                                push_string(state, HMC_IDENTIFIER, strdup("Tuple"));
+                                unstash(state, 0);
+                                unstash(state, 1);
+                                push_master(state, HMC_ARGUMENTS,2);
+                                push_master(state, HMC_TYPE,2);
+                                push_master(state, HMC_RIGHT_VALUE,1);
+                                unstash(state, 0);
 								}
 					
 struct_arguments:
 	/*empty*/
-   |struct_arguments struct_declaration ';' {push_master(HMC_ARGUMENTS,3);}
+   |struct_arguments struct_declaration ';' {push_master(state, HMC_ARGUMENTS,3);}
 
 enum_header:
-    enum_type type_access {push_master(HMC_ARGUMENTS,1);}
+    enum_type type_access {push_master(state, HMC_ARGUMENTS,1);}
     
 enum_type:
-	ENUM_TOKEN {push_string(HMC_IDENTIFIER, "Enum");}
+	ENUM_TOKEN {push_string(state, HMC_IDENTIFIER, strdup("Enum"));}
     
 enum_arguments:
 	/*empty*/
-    right_value ':' right_value {push_master(HMC_ARGUMENTS,2);}
-   |enum_arguments ',' right_value ':' right_value  {push_master(HMC_ARGUMENTS,3);}
+    right_value ':' right_value {push_master(state, HMC_ARGUMENTS,2);}
+   |enum_arguments ',' right_value ':' right_value  {push_master(state, HMC_ARGUMENTS,3);}
 	
 extension:
-    /*empty*/ {push_master(HMC_EXTENSION,0);}
-   | extends_token type {push_master(HMC_EXTENSION,2);}
+    /*empty*/ {push_master(state, HMC_EXTENSION,0);}
+   | extends_token type {push_master(state, HMC_EXTENSION,2);}
 
 extends_token:
-	EXTENDS_TOKEN {push_line();}
+	EXTENDS_TOKEN {push_line(state);}
    
 specification:
-    /*empty*/ {push_master(HMC_SPECIFICATION,0);}
-   | as_token type {push_master(HMC_SPECIFICATION,2);}
+    /*empty*/ {push_master(state, HMC_SPECIFICATION,0);}
+   | as_token type {push_master(state, HMC_SPECIFICATION,2);}
    
 as_token:
-	AS_TOKEN {push_line();}
+	AS_TOKEN {push_line(state);}
 
 type_attributes:
-	/*empty*/ {push_master(HMC_TYPE_ATTRIBUTES,0);}
+	/*empty*/ {push_master(state, HMC_TYPE_ATTRIBUTES,0);}
    |WITH_TOKEN '{'type_attribute_items'}' 
    
 type_attribute_items:
-	/*empty*/ {push_master(HMC_TYPE_ATTRIBUTES,0);}
-   |type_attribute_item {push_master(HMC_TYPE_ATTRIBUTES,1);}
-   |type_attribute_items ',' type_attribute_item {push_master(HMC_TYPE_ATTRIBUTES,2);}
+	/*empty*/ {push_master(state, HMC_TYPE_ATTRIBUTES,0);}
+   |type_attribute_item {push_master(state, HMC_TYPE_ATTRIBUTES,1);}
+   |type_attribute_items ',' type_attribute_item {push_master(state, HMC_TYPE_ATTRIBUTES,2);}
 
 type_attribute_item:
-	identifier ':' right_value {push_master(HMC_TYPE_ATTRIBUTE_ITEM, 2);}
+	identifier ':' right_value {push_master(state, HMC_TYPE_ATTRIBUTE_ITEM, 2);}
 
 class_definition:
-    /*empty*/ {push_master(HMC_EXECUTION_BLOCK, 0);push_master(HMC_EXECUTION_BLOCK, 0); push_master(HMC_CLASS_DEFINITION, 2);}
-   |execution_block {push_master(HMC_EXECUTION_BLOCK, 0); push_master(HMC_CLASS_DEFINITION, 2);}
-   |'{' statements ELLIPSIS_TOKEN statements '}' {push_master(HMC_CLASS_DEFINITION, 2);}
+    /*empty*/ {push_master(state, HMC_EXECUTION_BLOCK, 0);push_master(state, HMC_EXECUTION_BLOCK, 0); push_master(state, HMC_CLASS_DEFINITION, 2);}
+   |execution_block {push_master(state, HMC_EXECUTION_BLOCK, 0); push_master(state, HMC_CLASS_DEFINITION, 2);}
+   |'{' statements ELLIPSIS_TOKEN statements '}' {push_master(state, HMC_CLASS_DEFINITION, 2);}
    
 execution_block:
-     ';' {push_master(HMC_EXECUTION_BLOCK, 0);}
-    | statement {push_master(HMC_EXECUTION_BLOCK, 1);}
-    |'{' statements '}' {push_master(HMC_EXECUTION_BLOCK, 1);}
+     ';' {push_master(state, HMC_EXECUTION_BLOCK, 0);}
+    | statement {push_master(state, HMC_EXECUTION_BLOCK, 1);}
+    |'{' statements '}' {push_master(state, HMC_EXECUTION_BLOCK, 1);}
 ;
         
 statements:
-    /*empty*/ {push_master(HMC_EXECUTION_BLOCK, 0);}
-  | statements statement  {push_master(HMC_EXECUTION_BLOCK, 2);}
+    /*empty*/ {push_master(state, HMC_EXECUTION_BLOCK, 0);}
+  | statements statement  {push_master(state, HMC_EXECUTION_BLOCK, 2);}
   
 statement:
     simple_statement ';'
@@ -331,7 +350,7 @@ statement:
    |loop
    |for_loop
    |do_loop
-   |HEADER_TOKEN {push_line();push_master(HMC_HEADER_MARK, 1);}
+   |HEADER_TOKEN {push_line(state);push_master(state, HMC_HEADER_MARK, 1);}
 ;
 
 simple_statement:
@@ -346,46 +365,46 @@ simple_statement:
 ;   
 
 break:
-    BREAK_TOKEN {push_line(); push_master(HMC_BREAK, 1);}
+    BREAK_TOKEN {push_line(state); push_master(state, HMC_BREAK, 1);}
     
 continue:
-    CONTINUE_TOKEN {push_line(); push_master(HMC_CONTINUE, 1);}
+    CONTINUE_TOKEN {push_line(state); push_master(state, HMC_CONTINUE, 1);}
     
 return:
-    return_token {push_integer(HMC_NULL_CONSTANT, 0); push_master(HMC_RIGHT_VALUE, 1); push_master(HMC_RETURN, 2);}
-   |return_token right_value {push_master(HMC_RETURN, 2);}
+    return_token {push_integer(state, HMC_NULL_CONSTANT, 0); push_master(state, HMC_RIGHT_VALUE, 1); push_master(state, HMC_RETURN, 2);}
+   |return_token right_value {push_master(state, HMC_RETURN, 2);}
 
 return_token:
-	RETURN_TOKEN {push_line();}
+	RETURN_TOKEN {push_line(state);}
 
 declaration:
-    _declaration {push_integer(HMC_SHOWCASED, 0); push_master(HMC_DECLARATION, 3);}
-   |_declaration SHOWCASED_TOKEN {push_integer(HMC_SHOWCASED, 1); push_master(HMC_DECLARATION, 3);}
+    _declaration {push_integer(state, HMC_SHOWCASED, 0); push_master(state, HMC_DECLARATION, 3);}
+   |_declaration SHOWCASED_TOKEN {push_integer(state, HMC_SHOWCASED, 1); push_master(state, HMC_DECLARATION, 3);}
     
 
 _declaration:   
     type_access name_identifier 
    |_declaration '['']' {
-                                stash(0);
-                                stash(0);
-                                push_string(HMC_IDENTIFIER, "Array");
-                                unstash(0);
-                                push_master(HMC_ARGUMENTS,1);
-                                push_master(HMC_TYPE,2);
-                                push_master(HMC_RIGHT_VALUE,1);
-                                unstash(0);
+                                stash(state, 0);
+                                stash(state, 0);
+                                push_string(state, HMC_IDENTIFIER, strdup("Array"));
+                                unstash(state, 0);
+                                push_master(state, HMC_ARGUMENTS,1);
+                                push_master(state, HMC_TYPE,2);
+                                push_master(state, HMC_RIGHT_VALUE,1);
+                                unstash(state, 0);
     }
    |_declaration '['right_value']' {
-                                stash(1);
-                                stash(0);
-                                stash(0);
-                                push_string(HMC_IDENTIFIER, "Tuple");
-                                unstash(0);
-                                unstash(1);
-                                push_master(HMC_ARGUMENTS,2);
-                                push_master(HMC_TYPE,2);
-                                push_master(HMC_RIGHT_VALUE,1);
-                                unstash(0);
+                                stash(state, 1);
+                                stash(state, 0);
+                                stash(state, 0);
+                                push_string(state, HMC_IDENTIFIER, strdup("Tuple"));
+                                unstash(state, 0);
+                                unstash(state, 1);
+                                push_master(state, HMC_ARGUMENTS,2);
+                                push_master(state, HMC_TYPE,2);
+                                push_master(state, HMC_RIGHT_VALUE,1);
+                                unstash(state, 0);
     }
 ;
 
@@ -394,103 +413,103 @@ local_declarations:
 ;
        
 _local_declarations:
-	local_declaration {push_master(HMC_LOCAL_DECLARATIONS, 1);}
-   |_local_declarations ',' local_declaration {push_master(HMC_LOCAL_DECLARATIONS, 2);}
+	local_declaration {push_master(state, HMC_LOCAL_DECLARATIONS, 1);}
+   |_local_declarations ',' local_declaration {push_master(state, HMC_LOCAL_DECLARATIONS, 2);}
 ;
 	   
 local_declaration:   
-    identifier {push_master(HMC_LOCAL_DECLARATION, 1);}  
-   |identifier '=' right_value{push_master(HMC_LOCAL_DECLARATION, 2);}  
+    identifier {push_master(state, HMC_LOCAL_DECLARATION, 1);}  
+   |identifier '=' right_value{push_master(state, HMC_LOCAL_DECLARATION, 2);}  
 ;
 
 identifier:
-    IDENT {push_string(HMC_IDENTIFIER, $1);}
+    IDENT {push_string(state, HMC_IDENTIFIER, $1);}
 ;
 
 extended_identifier:
-    IDENT {push_string(HMC_IDENTIFIER, $1);}
-   |A_IDENT {push_string(HMC_IDENTIFIER, $1);}
+    IDENT {push_string(state, HMC_IDENTIFIER, $1);}
+   |A_IDENT {push_string(state, HMC_IDENTIFIER, $1);}
 ;
 
 name_identifier:
-    IDENT {push_string(HMC_IDENTIFIER, $1);}
-   |'#'   {push_string(HMC_IDENTIFIER, "#");}
+    IDENT {push_string(state, HMC_IDENTIFIER, $1);}
+   |'#'   {push_string(state, HMC_IDENTIFIER, strdup("#"));}
    |'(' right_value ')' 
 
 v_right_value:
-	|variable                                    {push_master(HMC_RIGHT_VALUE, 1);}
+	|variable                                    {push_master(state, HMC_RIGHT_VALUE, 1);}
    
 right_value:
-     variable '=' right_value                    {handle_op(HMC_ASSIGN_OP);}
-    |variable RIGHT_ASSIGN_TOKEN right_value     {handle_op(HMC_RIGHT_ASSIGN_OP);}
-    |variable LEFT_ASSIGN_TOKEN right_value      {handle_op(HMC_LEFT_ASSIGN_OP);}
-    |variable ADD_ASSIGN_TOKEN right_value       {handle_op(HMC_ADD_ASSIGN_OP);}
-    |variable SUB_ASSIGN_TOKEN right_value       {handle_op(HMC_SUB_ASSIGN_OP);}
-    |variable MUL_ASSIGN_TOKEN right_value       {handle_op(HMC_MUL_ASSIGN_OP);}
-    |variable DIV_ASSIGN_TOKEN right_value       {handle_op(HMC_DIV_ASSIGN_OP);}
-    |variable MOD_ASSIGN_TOKEN right_value       {handle_op(HMC_MOD_ASSIGN_OP);}
-    |variable AND_ASSIGN_TOKEN right_value       {handle_op(HMC_AND_ASSIGN_OP);}
-    |variable XOR_ASSIGN_TOKEN right_value       {handle_op(HMC_XOR_ASSIGN_OP);}
-    |variable OR_ASSIGN_TOKEN right_value        {handle_op(HMC_OR_ASSIGN_OP);}
-	|INC_TOKEN variable                          {handle_op(HMC_PRE_INC_OP);}
-    |DEC_TOKEN variable                          {handle_op(HMC_PRE_DEC_OP);}
-    |variable INC_TOKEN %prec SUF_INC            {handle_op(HMC_SUF_INC_OP);}
-    |variable DEC_TOKEN %prec SUF_DEC            {handle_op(HMC_SUF_DEC_OP);}
-    |right_value '?' right_value ':' right_value {handle_op(HMC_TERNARY_OP);}
-    |right_value OR_TOKEN right_value            {handle_op(HMC_OR_OP);}
-    |right_value AND_TOKEN right_value           {handle_op(HMC_AND_OP);}
-    |right_value '|' right_value                 {handle_op(HMC_BITWISE_OR_OP);}
-    |right_value '^' right_value                 {handle_op(HMC_BITWISE_XOR_OP);}
-    |right_value '&' right_value                 {handle_op(HMC_BITWISE_AND_OP);}
-    |right_value EQ_TOKEN right_value            {handle_op(HMC_EQ_OP);}
-    |right_value NE_TOKEN right_value            {handle_op(HMC_NE_OP);}
-    |right_value GE_TOKEN right_value            {handle_op(HMC_GE_OP);}
-    |right_value '>' right_value                 {handle_op(HMC_GT_OP);}
-    |right_value LE_TOKEN right_value            {handle_op(HMC_LE_OP);}
-    |right_value '<' right_value                 {handle_op(HMC_LT_OP);}
-    |right_value RIGHT_TOKEN right_value         {handle_op(HMC_RIGHT_OP);}
-    |right_value LEFT_TOKEN right_value          {handle_op(HMC_LEFT_OP);}
-    |right_value '+' right_value                 {handle_op(HMC_ADD_OP);}
-    |right_value '-' right_value                 {handle_op(HMC_SUB_OP);}
-    |right_value '*' right_value                 {handle_op(HMC_MUL_OP);}
-    |right_value '/' right_value                 {handle_op(HMC_DIV_OP);}
-    |right_value '%' right_value                 {handle_op(HMC_MOD_OP);}  
-    |NOT_TOKEN right_value                       {handle_op(HMC_NOT_OP);}
-    |BITWISE_NOT_TOKEN  right_value              {handle_op(HMC_BITWISE_NOT_OP);}
-    |'-' %prec OPP right_value                   {handle_op(HMC_OPP_OP);}
-    |constant_value                              {push_master(HMC_RIGHT_VALUE, 1);}
-    |variable                                    {push_master(HMC_RIGHT_VALUE, 1);}
-    |explicit_type                               {push_master(HMC_RIGHT_VALUE, 1);}
-	|v_right_value ':' %prec MET right_value     {push_master(HMC_ARGUMENTS, 1);
-                                                  push_integer(HMC_UNDEFINED_CONSTANT, 0); push_master(HMC_RIGHT_VALUE, 1);
-                                                  push_master(HMC_KEYWORD_ARGUMENTS, 0);
-                                                  push_integer(HMC_UNDEFINED_CONSTANT, 0); push_master(HMC_RIGHT_VALUE, 1);
-												  push_master(HMC_METHOD_EVALUATION, 5);push_master(HMC_RIGHT_VALUE, 1);}
-    |v_right_value ':' %prec MET method_arguments{push_master(HMC_METHOD_EVALUATION, 5);push_master(HMC_RIGHT_VALUE, 1);}
-	|'(' right_value ')' ':' %prec MET right_value     {push_master(HMC_ARGUMENTS, 1);
-                                                  push_integer(HMC_UNDEFINED_CONSTANT, 0); push_master(HMC_RIGHT_VALUE, 1);
-                                                  push_master(HMC_KEYWORD_ARGUMENTS, 0);
-                                                  push_integer(HMC_UNDEFINED_CONSTANT, 0); push_master(HMC_RIGHT_VALUE, 1);
-												  push_master(HMC_METHOD_EVALUATION, 5);push_master(HMC_RIGHT_VALUE, 1);}
-    |'(' right_value ')'  ':' %prec MET method_arguments{push_master(HMC_METHOD_EVALUATION, 5);push_master(HMC_RIGHT_VALUE, 1);}
-	|variable SUBSCOPE_ASSIGN_TOKEN right_value  {push_master(HMC_FIELD_ASSIGN, 2);push_master(HMC_RIGHT_VALUE, 1);}
-	|'[' array_items ']'                         {push_master(HMC_RIGHT_VALUE, 1);}
-	|'{' map_items '}'                           {push_master(HMC_RIGHT_VALUE, 1);}
+     variable '=' right_value                    {handle_op(state, HMC_ASSIGN_OP);}
+    |variable RIGHT_ASSIGN_TOKEN right_value     {handle_op(state, HMC_RIGHT_ASSIGN_OP);}
+    |variable LEFT_ASSIGN_TOKEN right_value      {handle_op(state, HMC_LEFT_ASSIGN_OP);}
+    |variable ADD_ASSIGN_TOKEN right_value       {handle_op(state, HMC_ADD_ASSIGN_OP);}
+    |variable SUB_ASSIGN_TOKEN right_value       {handle_op(state, HMC_SUB_ASSIGN_OP);}
+    |variable MUL_ASSIGN_TOKEN right_value       {handle_op(state, HMC_MUL_ASSIGN_OP);}
+    |variable DIV_ASSIGN_TOKEN right_value       {handle_op(state, HMC_DIV_ASSIGN_OP);}
+    |variable MOD_ASSIGN_TOKEN right_value       {handle_op(state, HMC_MOD_ASSIGN_OP);}
+    |variable AND_ASSIGN_TOKEN right_value       {handle_op(state, HMC_AND_ASSIGN_OP);}
+    |variable XOR_ASSIGN_TOKEN right_value       {handle_op(state, HMC_XOR_ASSIGN_OP);}
+    |variable OR_ASSIGN_TOKEN right_value        {handle_op(state, HMC_OR_ASSIGN_OP);}
+	|INC_TOKEN variable                          {handle_op(state, HMC_PRE_INC_OP);}
+    |DEC_TOKEN variable                          {handle_op(state, HMC_PRE_DEC_OP);}
+    |variable INC_TOKEN %prec SUF_INC            {handle_op(state, HMC_SUF_INC_OP);}
+    |variable DEC_TOKEN %prec SUF_DEC            {handle_op(state, HMC_SUF_DEC_OP);}
+    |right_value '?' right_value ':' right_value {handle_op(state, HMC_TERNARY_OP);}
+    |right_value OR_TOKEN right_value            {handle_op(state, HMC_OR_OP);}
+    |right_value AND_TOKEN right_value           {handle_op(state, HMC_AND_OP);}
+    |right_value '|' right_value                 {handle_op(state, HMC_BITWISE_OR_OP);}
+    |right_value '^' right_value                 {handle_op(state, HMC_BITWISE_XOR_OP);}
+    |right_value '&' right_value                 {handle_op(state, HMC_BITWISE_AND_OP);}
+    |right_value EQ_TOKEN right_value            {handle_op(state, HMC_EQ_OP);}
+    |right_value NE_TOKEN right_value            {handle_op(state, HMC_NE_OP);}
+    |right_value GE_TOKEN right_value            {handle_op(state, HMC_GE_OP);}
+    |right_value '>' right_value                 {handle_op(state, HMC_GT_OP);}
+    |right_value LE_TOKEN right_value            {handle_op(state, HMC_LE_OP);}
+    |right_value '<' right_value                 {handle_op(state, HMC_LT_OP);}
+    |right_value RIGHT_TOKEN right_value         {handle_op(state, HMC_RIGHT_OP);}
+    |right_value LEFT_TOKEN right_value          {handle_op(state, HMC_LEFT_OP);}
+    |right_value '+' right_value                 {handle_op(state, HMC_ADD_OP);}
+    |right_value '-' right_value                 {handle_op(state, HMC_SUB_OP);}
+    |right_value '*' right_value                 {handle_op(state, HMC_MUL_OP);}
+    |right_value '/' right_value                 {handle_op(state, HMC_DIV_OP);}
+    |right_value '%' right_value                 {handle_op(state, HMC_MOD_OP);}  
+    |NOT_TOKEN right_value                       {handle_op(state, HMC_NOT_OP);}
+    |BITWISE_NOT_TOKEN  right_value              {handle_op(state, HMC_BITWISE_NOT_OP);}
+    |'-' %prec OPP right_value                   {handle_op(state, HMC_OPP_OP);}
+    |constant_value                              {push_master(state, HMC_RIGHT_VALUE, 1);}
+    |variable                                    {push_master(state, HMC_RIGHT_VALUE, 1);}
+    |explicit_type                               {push_master(state, HMC_RIGHT_VALUE, 1);}
+	|v_right_value ':' %prec MET right_value     {push_master(state, HMC_ARGUMENTS, 1);
+                                                  push_integer(state, HMC_UNDEFINED_CONSTANT, 0); push_master(state, HMC_RIGHT_VALUE, 1);
+                                                  push_master(state, HMC_KEYWORD_ARGUMENTS, 0);
+                                                  push_integer(state, HMC_UNDEFINED_CONSTANT, 0); push_master(state, HMC_RIGHT_VALUE, 1);
+												  push_master(state, HMC_METHOD_EVALUATION, 5);push_master(state, HMC_RIGHT_VALUE, 1);}
+    |v_right_value ':' %prec MET method_arguments{push_master(state, HMC_METHOD_EVALUATION, 5);push_master(state, HMC_RIGHT_VALUE, 1);}
+	|'(' right_value ')' ':' %prec MET right_value     {push_master(state, HMC_ARGUMENTS, 1);
+                                                  push_integer(state, HMC_UNDEFINED_CONSTANT, 0); push_master(state, HMC_RIGHT_VALUE, 1);
+                                                  push_master(state, HMC_KEYWORD_ARGUMENTS, 0);
+                                                  push_integer(state, HMC_UNDEFINED_CONSTANT, 0); push_master(state, HMC_RIGHT_VALUE, 1);
+												  push_master(state, HMC_METHOD_EVALUATION, 5);push_master(state, HMC_RIGHT_VALUE, 1);}
+    |'(' right_value ')'  ':' %prec MET method_arguments{push_master(state, HMC_METHOD_EVALUATION, 5);push_master(state, HMC_RIGHT_VALUE, 1);}
+	|variable SUBSCOPE_ASSIGN_TOKEN right_value  {push_master(state, HMC_FIELD_ASSIGN, 2);push_master(state, HMC_RIGHT_VALUE, 1);}
+	|'[' array_items ']'                         {push_master(state, HMC_RIGHT_VALUE, 1);}
+	|'{' map_items '}'                           {push_master(state, HMC_RIGHT_VALUE, 1);}
     |'('right_value')'                          
 ;
 
 array_items:
-	/* empty */                 {push_master(HMC_ARRAY_SCOPE, 0);}
-   |right_value                 {push_master(HMC_ARRAY_SCOPE, 1);}
-   |right_value ',' array_items {push_master(HMC_ARRAY_SCOPE, 2);}
+	/* empty */                 {push_master(state, HMC_ARRAY_SCOPE, 0);}
+   |right_value                 {push_master(state, HMC_ARRAY_SCOPE, 1);}
+   |right_value ',' array_items {push_master(state, HMC_ARRAY_SCOPE, 2);}
 	
 map_item:
-	constant_value ':' right_value {push_master(HMC_MAP_ITEM, 2);}
+	constant_value ':' right_value {push_master(state, HMC_MAP_ITEM, 2);}
 	
 map_items:
-	/* empty */            {push_master(HMC_MAP_SCOPE, 0);}
-   |map_item               {push_master(HMC_MAP_SCOPE, 1);}
-   |map_item ',' map_items {push_master(HMC_MAP_SCOPE, 2);}
+	/* empty */            {push_master(state, HMC_MAP_SCOPE, 0);}
+   |map_item               {push_master(state, HMC_MAP_SCOPE, 1);}
+   |map_item ',' map_items {push_master(state, HMC_MAP_SCOPE, 2);}
 
 constant_value:
     int_constant 
@@ -503,183 +522,170 @@ constant_value:
 ;
 
 int_constant : 
-    INT_VALUE {push_integer(HMC_INT_CONSTANT, $1);};
+    INT_VALUE {push_integer(state, HMC_INT_CONSTANT, $1);};
 
 uint_constant : 
-    UINT_VALUE {push_uinteger(HMC_UINT_CONSTANT, $1);};
+    UINT_VALUE {push_uinteger(state, HMC_UINT_CONSTANT, $1);};
 
 string_constant : 
-    STRING_VALUE {push_string(HMC_STRING_CONSTANT, $1);};
+    STRING_VALUE {push_string(state, HMC_STRING_CONSTANT, $1);};
     
 float_constant :
-    FLOAT_VALUE {push_float(HMC_FLOAT_CONSTANT, $1);}
+    FLOAT_VALUE {push_float(state, HMC_FLOAT_CONSTANT, $1);}
     
 null_constant:
-    NULL_TOKEN {push_integer(HMC_NULL_CONSTANT, 0);}
+    NULL_TOKEN {push_integer(state, HMC_NULL_CONSTANT, 0);}
 	
 undefined_constant:
-    UNDEFINED_TOKEN {push_integer(HMC_UNDEFINED_CONSTANT, 0);}
+    UNDEFINED_TOKEN {push_integer(state, HMC_UNDEFINED_CONSTANT, 0);}
     
 empty_string_constant:
-    EMPTY_STRING_TOKEN {push_integer(HMC_EMPTY_STRING_CONSTANT, 0);}
+    EMPTY_STRING_TOKEN {push_integer(state, HMC_EMPTY_STRING_CONSTANT, 0);}
 
 variable:
-    extended_identifier {push_master(HMC_VARIABLE, 1);}
-   |SELF_TOKEN '['  ']' {push_integer(HMC_NULL_CONSTANT, 0); push_master(HMC_RIGHT_VALUE, 1); push_master(HMC_VARIABLE, 1);}
-   |SELF_TOKEN '[' right_value ']' {push_master(HMC_VARIABLE, 1);}
-   |variable '.' extended_identifier {push_master(HMC_VARIABLE, 2);}
-   |variable '[' right_value ']' {push_master(HMC_VARIABLE, 2);}
-   |variable '[' ']' {push_integer(HMC_NULL_CONSTANT, 0); push_master(HMC_RIGHT_VALUE, 1); push_master(HMC_VARIABLE, 2);}
+    extended_identifier {push_master(state, HMC_VARIABLE, 1);}
+   |SELF_TOKEN '['  ']' {push_integer(state, HMC_NULL_CONSTANT, 0); push_master(state, HMC_RIGHT_VALUE, 1); push_master(state, HMC_VARIABLE, 1);}
+   |SELF_TOKEN '[' right_value ']' {push_master(state, HMC_VARIABLE, 1);}
+   |variable '.' extended_identifier {push_master(state, HMC_VARIABLE, 2);}
+   |variable '[' right_value ']' {push_master(state, HMC_VARIABLE, 2);}
+   |variable '[' ']' {push_integer(state, HMC_NULL_CONSTANT, 0); push_master(state, HMC_RIGHT_VALUE, 1); push_master(state, HMC_VARIABLE, 2);}
 
 field_assignment:
 	
-   |variable SUBSCOPE_ASSIGN_TOKEN field_assignment {push_master(HMC_FIELD_ASSIGN, 2);}
+   |variable SUBSCOPE_ASSIGN_TOKEN field_assignment {push_master(state, HMC_FIELD_ASSIGN, 2);}
 
 remove:
-	REMOVE_TOKEN variable {push_master(HMC_REMOVE, 1);}
+	REMOVE_TOKEN variable {push_master(state, HMC_REMOVE, 1);}
 
 method_arguments:
-   |'('')'                                          {push_master(HMC_ARGUMENTS, 0);
-                                                     push_integer(HMC_UNDEFINED_CONSTANT, 0); push_master(HMC_RIGHT_VALUE, 1);
-                                                     push_master(HMC_KEYWORD_ARGUMENTS, 0);
-                                                     push_integer(HMC_UNDEFINED_CONSTANT, 0); push_master(HMC_RIGHT_VALUE, 1);}
+   |'('')'                                          {push_master(state, HMC_ARGUMENTS, 0);
+                                                     push_integer(state, HMC_UNDEFINED_CONSTANT, 0); push_master(state, HMC_RIGHT_VALUE, 1);
+                                                     push_master(state, HMC_KEYWORD_ARGUMENTS, 0);
+                                                     push_integer(state, HMC_UNDEFINED_CONSTANT, 0); push_master(state, HMC_RIGHT_VALUE, 1);}
    |'('method_arguments1')'                         {}
 
 method_arguments1:
-     right_value_argument_list                      {push_integer(HMC_UNDEFINED_CONSTANT, 0); push_master(HMC_RIGHT_VALUE, 1);
-                                                     push_master(HMC_KEYWORD_ARGUMENTS, 0);
-                                                     push_integer(HMC_UNDEFINED_CONSTANT, 0); push_master(HMC_RIGHT_VALUE, 1);}
-    |method_arguments2                              {stash(0);stash(0);stash(0);
-                                                     push_master(HMC_ARGUMENTS, 0);
-                                                     unstash(0);unstash(0);unstash(0);}
+     right_value_argument_list                      {push_integer(state, HMC_UNDEFINED_CONSTANT, 0); push_master(state, HMC_RIGHT_VALUE, 1);
+                                                     push_master(state, HMC_KEYWORD_ARGUMENTS, 0);
+                                                     push_integer(state, HMC_UNDEFINED_CONSTANT, 0); push_master(state, HMC_RIGHT_VALUE, 1);}
+    |method_arguments2                              {stash(state, 0);stash(state, 0);stash(state, 0);
+                                                     push_master(state, HMC_ARGUMENTS, 0);
+                                                     unstash(state, 0);unstash(state, 0);unstash(state, 0);}
     |right_value_argument_list','method_arguments2  {}
          
 method_arguments2:
-     '*' right_value                                {push_master(HMC_KEYWORD_ARGUMENTS, 0);
-                                                     push_integer(HMC_UNDEFINED_CONSTANT, 0); push_master(HMC_RIGHT_VALUE, 1);}
-    |method_arguments3                              {stash(0);stash(0);
-                                                     push_integer(HMC_UNDEFINED_CONSTANT, 0); push_master(HMC_RIGHT_VALUE, 1);
-                                                     unstash(0);unstash(0);}
+     '*' right_value                                {push_master(state, HMC_KEYWORD_ARGUMENTS, 0);
+                                                     push_integer(state, HMC_UNDEFINED_CONSTANT, 0); push_master(state, HMC_RIGHT_VALUE, 1);}
+    |method_arguments3                              {stash(state, 0);stash(state, 0);
+                                                     push_integer(state, HMC_UNDEFINED_CONSTANT, 0); push_master(state, HMC_RIGHT_VALUE, 1);
+                                                     unstash(state, 0);unstash(state, 0);}
     |'*' right_value','method_arguments3            {}
 
 method_arguments3:
-     keyword_argument_list                          {push_integer(HMC_UNDEFINED_CONSTANT, 0); push_master(HMC_RIGHT_VALUE, 1);}
-    |'*' '*' right_value                            {stash(0);
-                                                     push_master(HMC_KEYWORD_ARGUMENTS, 0);
-                                                     unstash(0);}
+     keyword_argument_list                          {push_integer(state, HMC_UNDEFINED_CONSTANT, 0); push_master(state, HMC_RIGHT_VALUE, 1);}
+    |'*' '*' right_value                            {stash(state, 0);
+                                                     push_master(state, HMC_KEYWORD_ARGUMENTS, 0);
+                                                     unstash(state, 0);}
     |keyword_argument_list',' '*' '*' right_value   {}
     
 keyword_argument:
-    identifier ASSOC_TOKEN right_value              {push_master(HMC_KEYWORD_ARGUMENT, 2);}
+    identifier ASSOC_TOKEN right_value              {push_master(state, HMC_KEYWORD_ARGUMENT, 2);}
          
 keyword_argument_list:
-    keyword_argument                                {push_master(HMC_KEYWORD_ARGUMENTS, 1);}
-   |keyword_argument_list',' keyword_argument       {push_master(HMC_KEYWORD_ARGUMENTS, 2);}
+    keyword_argument                                {push_master(state, HMC_KEYWORD_ARGUMENTS, 1);}
+   |keyword_argument_list',' keyword_argument       {push_master(state, HMC_KEYWORD_ARGUMENTS, 2);}
          
 conditional_statement:
-    if_token '(' right_value ')' execution_block {push_master(HMC_EXECUTION_BLOCK,0); push_master(HMC_CONDITIONAL_STATEMENT,4);}
-   |if_token '(' right_value ')' execution_block ELSE_TOKEN execution_block{push_master(HMC_CONDITIONAL_STATEMENT,4);}
+    if_token '(' right_value ')' execution_block {push_master(state, HMC_EXECUTION_BLOCK,0); push_master(state, HMC_CONDITIONAL_STATEMENT,4);}
+   |if_token '(' right_value ')' execution_block ELSE_TOKEN execution_block{push_master(state, HMC_CONDITIONAL_STATEMENT,4);}
 
 if_token:
-	IF_TOKEN {push_line();}
+	IF_TOKEN {push_line(state);}
    
 loop:
-    while_token '(' right_value ')' execution_block {push_master(HMC_LOOP,3);}
+    while_token '(' right_value ')' execution_block {push_master(state, HMC_LOOP,3);}
 
 while_token:
-	WHILE_TOKEN {push_line();}
+	WHILE_TOKEN {push_line(state);}
 	
 for_loop:
-	for_token '(' ';' right_value ';'  ')' execution_block {push_master(HMC_LOOP,2); push_master(HMC_EXECUTION_BLOCK,2);}
-   |for_token '(' simple_statement ';' right_value ';'  ')' execution_block {push_master(HMC_LOOP,2); push_master(HMC_EXECUTION_BLOCK,3);}
-   |for_token '(' ';' right_value ';' simple_statement ')'{stash(0);} execution_block {unstash(0); push_master(HMC_EXECUTION_BLOCK,2); push_master(HMC_LOOP,2); push_master(HMC_EXECUTION_BLOCK,2);}
-   |for_token '(' simple_statement ';' right_value ';' simple_statement ')'{stash(0);} execution_block {unstash(0); push_master(HMC_EXECUTION_BLOCK,2); push_master(HMC_LOOP,2); push_master(HMC_EXECUTION_BLOCK,3);}
+	for_token '(' ';' right_value ';'  ')' execution_block {push_master(state, HMC_LOOP,2); push_master(state, HMC_EXECUTION_BLOCK,2);}
+   |for_token '(' simple_statement ';' right_value ';'  ')' execution_block {push_master(state, HMC_LOOP,2); push_master(state, HMC_EXECUTION_BLOCK,3);}
+   |for_token '(' ';' right_value ';' simple_statement ')'{stash(state, 0);} execution_block {unstash(state, 0); push_master(state, HMC_EXECUTION_BLOCK,2); push_master(state, HMC_LOOP,2); push_master(state, HMC_EXECUTION_BLOCK,2);}
+   |for_token '(' simple_statement ';' right_value ';' simple_statement ')'{stash(state, 0);} execution_block {unstash(state, 0); push_master(state, HMC_EXECUTION_BLOCK,2); push_master(state, HMC_LOOP,2); push_master(state, HMC_EXECUTION_BLOCK,3);}
 
 for_token:
-	FOR_TOKEN {push_line();}
+	FOR_TOKEN {push_line(state);}
 	
 do_loop:
-    do_token execution_block {stash(0);} WHILE_TOKEN '(' right_value ')' {unstash(0); push_master(HMC_DO_LOOP, 3);}
+    do_token execution_block {stash(state, 0);} WHILE_TOKEN '(' right_value ')' {unstash(state, 0); push_master(state, HMC_DO_LOOP, 3);}
 	
 do_token:
-	DO_TOKEN {push_line();}
+	DO_TOKEN {push_line(state);}
 %%
 
-void yyerror(char const *s)
+void yyerror(yyscan_t scanner, compiler_state* state, char const *s)
 {
-    fprintf(stderr, "%s on line %d\n", s, line_number);
+    if(state->error != NULL && state->error_size > 0)
+    {
+        snprintf(state->error, state->error_size, "%s on line %d", s, state->line_number);
+    }
 }
 
-
-int main(int argc, char *argv[])                                                                             
-{    
-    if(argc > 1)
+int hmc_compile(const char* source, size_t size, int mode, hmc_buffer* output, char* error, size_t error_size)
+{
+    compiler_state state;
+    init_state(&state, mode == HMC_EXPRESSION_MODE ? EXPRESSION_START_TOKEN : FILE_START_TOKEN);
+    state.error = error;
+    state.error_size = error_size;
+    if(error != NULL && error_size > 0)
     {
-        // open a file handle to a particular file:
-        FILE *file = fopen(argv[1], "r");
-        // make sure it is valid:
-        if (!file) 
-        {
-            fprintf(stderr,"Can't open file %s\n",argv[1]);
-            return EXIT_FAILURE;
-        }
-        // set flex to read from it instead of defaulting to STDIN:
-        yyin = file;
-        
-        // parse through the input until there is no more:
-        do 
-        {
-            yyparse();
-        } while (!feof(yyin));
-        
-        FILE *output;
-        
-        if(argc > 2)
-        {
-            output = fopen(argv[2], "wb");
-        }
-        else
-        {
-            output = fopen("output.hmc", "wb");
-        }
-        
-        if (!output)
-        {
-            fprintf(stderr,"Can't open output file\n");
-            return EXIT_FAILURE;
-        }
-
-        int i;
-        for(i = 0; i < headerSize; ++i)
-            fputc(header[i], output);
-        
-#ifdef STACK_DEBUG
-		dump_stack();
-#endif
-		
-        while(!empty()) 
-            pop();
-        
-        write_node(output, &root);
-		root.id = HMC_DEBUG;
-		root.size = 0;
-		root.line_number = -1;
-		root.parent = NULL;
-		root.first_child.node = NULL;
-		root.next_sibling = NULL;
-		
-		while(!empty()) 
-            pop();
-        
-        write_node(output, &root);
-		
-        return EXIT_SUCCESS;
-        
+        error[0] = '\0';
     }
-    else
+
+    output->data = NULL;
+    output->size = 0;
+    output->capacity = 0;
+
+    if(hmc_parse(&state, source, size) != 0)
     {
-        fprintf(stderr,"No input specified\n");
+        free_state(&state);
         return EXIT_FAILURE;
     }
+
+    int i;
+    for(i = 0; i < headerSize; ++i)
+        put_byte(output, header[i]);
+
+#ifdef STACK_DEBUG
+    dump_stack(&state);
+#endif
+
+    while(!empty(&state)) 
+        pop(&state);
+
+    write_node(&state, output, &state.root);
+    free_children(&state.root);
+    init_root(&state, HMC_DEBUG);
+
+    while(!empty(&state)) 
+        pop(&state);
+
+    write_node(&state, output, &state.root);
+
+    free_state(&state);
+    return EXIT_SUCCESS;
+}
+
+void hmc_free_buffer(hmc_buffer* buffer)
+{
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->size = 0;
+    buffer->capacity = 0;
 }
 
+int hmc_output_version(void)
+{
+    return HMC_OUTPUT_VERSION;
+}
@@ -1,2 +1,2 @@
-const int headerSize = 42;
-const unsigned char header[] = {0x1a, 0x45, 0xdf, 0xa3, 0xa5, 0x42, 0x86, 0x81, 0x1, 0x42, 0xf7, 0x81, 0x1, 0x42, 0xf2, 0x81, 0x4, 0x42, 0xf3, 0x81, 0x8, 0x42, 0x82, 0x8a, 0x68, 0x65, 0x78, 0x61, 0x6d, 0x6f, 0x6e, 0x6b, 0x65, 0x79, 0x42, 0x87, 0x81, 0x2, 0x42, 0x85, 0x81, 0x2};
+static const int headerSize = 42;
+static const unsigned char header[] = {0x1a, 0x45, 0xdf, 0xa3, 0xa5, 0x42, 0x86, 0x81, 0x1, 0x42, 0xf7, 0x81, 0x1, 0x42, 0xf2, 0x81, 0x4, 0x42, 0xf3, 0x81, 0x8, 0x42, 0x82, 0x8a, 0x68, 0x65, 0x78, 0x61, 0x6d, 0x6f, 0x6e, 0x6b, 0x65, 0x79, 0x42, 0x87, 0x81, 0x2, 0x42, 0x85, 0x81, 0x2};
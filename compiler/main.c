@@ -0,0 +1,85 @@
+/*This file is part of the HexaMonkey project, a multimedia analyser
+ *Copyright (C) 2013  Sevan Drapeau-Martin, Nicolas Fleury
+
+ *This program is free software; you can redistribute it and/or
+ *modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation; either version 2
+ *of the License, or (at your option) any later version.
+
+ *This program is distributed in the hope that it will be useful,
+ *but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *GNU General Public License for more details.
+
+ *You should have received a copy of the GNU General Public License
+ *along with this program; if not, write to the Free Software
+ *Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.*/
+
+/* Command line front end of the compiler library, built as hexacompiler and as
+ * expcompiler when EXPRESSION_COMPILER is defined */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "compiler.h"
+
+#ifdef EXPRESSION_COMPILER
+#define MODE HMC_EXPRESSION_MODE
+#else
+#define MODE HMC_FILE_MODE
+#endif
+
+int main(int argc, char *argv[])
+{
+    if(argc <= 1)
+    {
+        fprintf(stderr,"No input specified\n");
+        return EXIT_FAILURE;
+    }
+
+    FILE *file = fopen(argv[1], "rb");
+    if (!file)
+    {
+        fprintf(stderr,"Can't open file %s\n",argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    size_t size = 0;
+    size_t capacity = 4096;
+    char* source = malloc(capacity);
+    size_t count;
+    while((count = fread(source + size, 1, capacity - size, file)) > 0)
+    {
+        size += count;
+        if(size == capacity)
+        {
+            capacity *= 2;
+            source = realloc(source, capacity);
+        }
+    }
+    fclose(file);
+
+    hmc_buffer output;
+    char error[256];
+    if(hmc_compile(source, size, MODE, &output, error, sizeof(error)) != 0)
+    {
+        fprintf(stderr, "%s\n", error);
+        free(source);
+        return EXIT_FAILURE;
+    }
+    free(source);
+
+    FILE *outputFile = fopen(argc > 2 ? argv[2] : "output.hmc", "wb");
+    if (!outputFile)
+    {
+        fprintf(stderr,"Can't open output file\n");
+        hmc_free_buffer(&output);
+        return EXIT_FAILURE;
+    }
+
+    fwrite(output.data, 1, output.size, outputFile);
+    fclose(outputFile);
+    hmc_free_buffer(&output);
+
+    return EXIT_SUCCESS;
+}
@@ -19,6 +19,7 @@
 #define STRUCT_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 typedef union _elem
 {
@@ -61,4 +62,20 @@ typedef struct _int_stack
 	void* st;
 } int_stack;
 
+/* Everything a compilation works on, so that several can run at the same time */
+typedef struct _compiler_state
+{
+	ast root;
+	ast* current_node;
+	int line_number;
+	int start_token;
+	stack* current_stack;
+	stack* current_stashes[2];
+	int_stack* stashes_counts[2];
+	int infos;
+	int is_virtual;
+	char* error;
+	size_t error_size;
+} compiler_state;
+
 #endif
@@ -24,7 +24,19 @@
 #include <stdarg.h> 
 #include <stdint.h> 
 
-int ebml_int_size(uint64_t value)
+#include "compiler.h"
+
+static void put_byte(hmc_buffer* output, unsigned char c)
+{
+	if(output->size == output->capacity)
+	{
+		output->capacity = output->capacity ? 2 * output->capacity : 4096;
+		output->data = realloc(output->data, output->capacity);
+	}
+	output->data[output->size++] = c;
+}
+
+static int ebml_int_size(uint64_t value)
 {
     value++;
     int size = 1;
@@ -38,7 +50,7 @@ int ebml_int_size(uint64_t value)
     return size;
 }
 
-int int_size(int64_t value)
+static int int_size(int64_t value)
 {
 	int size = 1;
 	int64_t max_value = 1<<7;
@@ -51,7 +63,7 @@ int int_size(int64_t value)
     return size;
 }
 
-int uint_size(uint64_t value)
+static int uint_size(uint64_t value)
 {
 	int size = 1;
 	uint64_t max_value = 1<<8;
@@ -64,52 +76,52 @@ int uint_size(uint64_t value)
     return size;
 }
 
-void write_ebml_int(FILE* file, uint64_t i)
+static void write_ebml_int(hmc_buffer* output, uint64_t i)
 {
 	int size = ebml_int_size(i);
 	unsigned char* p_first = (char*)&i;
 	unsigned char* p_current  = p_first + (size - 1);
-	fputc(*p_current | 1<<(8-size), file);
+	put_byte(output, *p_current | 1<<(8-size));
 	for(p_current--; p_current>=p_first; p_current--)
 	{
-		fputc(*p_current, file);
+		put_byte(output, *p_current);
 	}
 }
 
-void write_int(FILE* file, int64_t i, int size)
+static void write_int(hmc_buffer* output, int64_t i, int size)
 {
 	unsigned char* p_first = (char*)&i;
 	unsigned char* p_current;
 	for(p_current = p_first + (size - 1); p_current>=p_first; p_current--)
 	{
-		fputc(*p_current, file);
+		put_byte(output, *p_current);
 	}
 }
 
-void write_uint(FILE* file, uint64_t u, int size)
+static void write_uint(hmc_buffer* output, uint64_t u, int size)
 {
 	unsigned char* p_first = (char*)&u;
 	unsigned char* p_current;
 	for(p_current = p_first + (size - 1); p_current>=p_first; p_current--)
 	{
-		fputc(*p_current, file);
+		put_byte(output, *p_current);
 	}
 }
 
-void write_string(FILE* file, char* s, int size)
+static void write_string(hmc_buffer* output, char* s, int size)
 {
 	int count;
 	for(count = 0; count < size; count ++)
-		fputc(s[count],file);
+		put_byte(output, s[count]);
 }
 
-void write_float(FILE* file, double f)
+static void write_float(hmc_buffer* output, double f)
 {
 	unsigned char* p_first = (char*)&f;
 	unsigned char* p_current;
 	for(p_current = p_first + 7; p_current>=p_first; p_current--)
 	{
-		fputc(*p_current, file);
+		put_byte(output, *p_current);
 	}
 }
 
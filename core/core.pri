@@ -1,5 +1,8 @@
 INCLUDEPATH += ..
 
+# The runtime metrics are compiled out by running qmake with CONFIG+=nometrics
+!nometrics: DEFINES += HM_METRICS
+
 SOURCES += \
     ../core/variant.cpp \
     ../core/parser.cpp \
@@ -19,15 +22,22 @@ SOURCES += \
     ../core/formatdetector/formatdetector.cpp \
     ../core/formatdetector/extensionformatdetector.cpp \
     ../core/formatdetector/compositeformatdetector.cpp \
+    ../core/formatdetector/detectionmanifest.cpp \
     ../core/interpreter/program.cpp \
     ../core/interpreter/programloader.cpp \
+    ../core/interpreter/hmcreader.cpp \
     ../core/interpreter/fromfileparser.cpp \
     ../core/interpreter/fromfilemodule.cpp \
     ../core/interpreter/filter.cpp \
+    ../core/interpreter/query.cpp \
     ../core/interpreter/evaluator.cpp \
     ../core/interpreter/blockexecution.cpp \
+    ../core/interpreter/bytecode.cpp \
+    ../core/interpreter/virtualmachine.cpp \
+    ../core/interpreter/scriptprofiler.cpp \
     ../core/log/logger.cpp \
     ../core/log/logmanager.cpp \
+    ../core/log/metrics.cpp \
     ../core/log/streamlogger.cpp \
     ../core/modules/default/elementarycontainerparser.cpp \
     ../core/modules/default/tupleparser.cpp \
@@ -58,7 +68,7 @@ SOURCES += \
     ../core/variable/mapscope.cpp \
     ../core/variable/variablepath.cpp \
     ../core/modulesetup.cpp \
-    ../core/parsingexception.cpp \
+    ../core/parsingerror.cpp \
     ../core/modules/default/integertypetemplate.cpp \
     ../core/modules/default/filetypetemplate.cpp \
     ../core/modules/default/arraytypetemplate.cpp \
@@ -102,15 +112,22 @@ HEADERS  += \
     ../core/formatdetector/formatdetector.h \
     ../core/formatdetector/extensionformatdetector.h \
     ../core/formatdetector/compositeformatdetector.h \
+    ../core/formatdetector/detectionmanifest.h \
     ../core/interpreter/program.h \
     ../core/interpreter/programloader.h \
+    ../core/interpreter/hmcreader.h \
     ../core/interpreter/fromfileparser.h \
     ../core/interpreter/fromfilemodule.h \
     ../core/interpreter/filter.h \
+    ../core/interpreter/query.h \
     ../core/interpreter/evaluator.h \
     ../core/interpreter/blockexecution.h \
+    ../core/interpreter/bytecode.h \
+    ../core/interpreter/virtualmachine.h \
+    ../core/interpreter/scriptprofiler.h \
     ../core/log/logger.h \
     ../core/log/logmanager.h \
+    ../core/log/metrics.h \
     ../core/log/streamlogger.h \
     ../core/modules/default/elementarycontainerparser.h \
     ../core/modules/default/tupleparser.h \
@@ -129,12 +146,15 @@ HEADERS  += \
     ../core/util/csvreader.h \
     ../core/util/bitutil.h \
     ../core/util/ptrutil.h \
+    ../core/util/appendonlyvector.h \
+    ../core/util/appendonlymap.h \
     ../core/util/osutil.h \
     ../core/util/rapidxml/rapidxml_utils.hpp \
     ../core/util/rapidxml/rapidxml_print.hpp \
     ../core/util/rapidxml/rapidxml_iterators.hpp \
     ../core/util/rapidxml/rapidxml.hpp \
     ../compiler/model.h \
+    ../compiler/compiler.h \
     ../core/variable/variable.h \
     ../core/variable/variablepath.h \
     ../core/variable/variablecollector.h \
@@ -149,7 +169,7 @@ HEADERS  += \
     ../core/variable/parserscope.h \
     ../core/varianthash.h \
     ../core/modulesetup.h \
-    ../core/parsingexception.h \
+    ../core/parsingerror.h \
     ../core/modules/default/integertypetemplate.h \
     ../core/modules/default/filetypetemplate.h \
     ../core/modules/default/arraytypetemplate.h \
@@ -174,4 +194,6 @@ HEADERS  += \
     $$PWD/util/formatutil.h \
     $$PWD/modules/default/defaultmethods.h
 
-
+# Scripts are compiled in process by the library built in the compiler directory
+LIBS += -L$$PWD/../compiler -lhmcompiler
+PRE_TARGETDEPS += $$PWD/../compiler/libhmcompiler.a
@@ -20,6 +20,7 @@
 #include "core/util/strutil.h"
 #include "core/util/bitutil.h"
 #include "core/log/logmanager.h"
+#include "core/log/metrics.h"
 
 RealFile::RealFile() : File()
 {
@@ -62,6 +63,9 @@ void RealFile::read(char* s, int64_t count )
 {
     if(count == 0)
         return;
+    HM_METRICS_ADD(fileReads, 1);
+    HM_METRICS_ADD(fileBytesRead, (count + 7) / 8);
+    HM_METRICS_RECORD(readSize, (count + 7) / 8);
     if (_bitPosition == 0 && count % 8 == 0)
         _file.read(s,count/8);
     else
@@ -104,6 +108,7 @@ void RealFile::read(char* s, int64_t count )
 
 
 void RealFile::seekg(int64_t off, std::ios_base::seekdir dir) {
+    HM_METRICS_ADD(fileSeeks, 1);
     switch (dir)
     {
         case std::ios_base::beg :
@@ -0,0 +1,160 @@
+//This file is part of the HexaMonkey project, a multimedia analyser
+//Copyright (C) 2013  Sevan Drapeau-Martin, Nicolas Fleury
+
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "core/formatdetector/detectionmanifest.h"
+#include "core/util/fileutil.h"
+#include "core/util/strutil.h"
+
+void FormatDetections::addTo(StandardFormatDetector::Adder &formatAdder) const
+{
+    for(const std::string& magicNumber : magicNumbers)
+    {
+        formatAdder.addMagicNumber(magicNumber);
+    }
+    for(const std::string& extension : extensions)
+    {
+        formatAdder.addExtension(extension);
+    }
+    for(const auto& syncbyte : syncbytes)
+    {
+        formatAdder.addSyncbyte(syncbyte.first, syncbyte.second);
+    }
+}
+
+// One "script <hash> <path>" line per script followed by a line per detection method,
+// the values are the rest of the line since magic numbers contain spaces
+DetectionManifest::DetectionManifest(const std::string &path)
+    : _path(path),
+      _modified(false)
+{
+    std::ifstream file(path);
+    Entry* entry = nullptr;
+    std::string line;
+    while(std::getline(file, line))
+    {
+        const size_t separator = line.find(' ');
+        if(separator == std::string::npos)
+            continue;
+
+        const std::string kind = line.substr(0, separator);
+        const std::string value = line.substr(separator + 1);
+        if(kind == "script")
+        {
+            const size_t pathSeparator = value.find(' ');
+            if(pathSeparator == std::string::npos)
+            {
+                entry = nullptr;
+                continue;
+            }
+            entry = &_read[value.substr(pathSeparator + 1)];
+            entry->hash = fromHex(value.substr(0, pathSeparator));
+        }
+        else if(entry == nullptr)
+        {
+            continue;
+        }
+        else if(kind == "magic")
+        {
+            entry->detections.magicNumbers.push_back(value);
+        }
+        else if(kind == "extension")
+        {
+            entry->detections.extensions.push_back(value);
+        }
+        else if(kind == "syncbyte")
+        {
+            std::stringstream stream(value);
+            int syncbyte, packetLength;
+            if(stream >> syncbyte >> packetLength)
+            {
+                entry->detections.syncbytes.push_back(std::make_pair(syncbyte, packetLength));
+            }
+        }
+    }
+}
+
+const FormatDetections *DetectionManifest::find(const std::string &scriptPath, uint64_t hash)
+{
+    auto it = _entries.find(scriptPath);
+    if(it == _entries.end())
+    {
+        auto read = _read.find(scriptPath);
+        if(read == _read.end() || read->second.hash != hash)
+            return nullptr;
+
+        it = _entries.insert(*read).first;
+        _read.erase(read);
+    }
+    else if(it->second.hash != hash)
+    {
+        return nullptr;
+    }
+    return &it->second.detections;
+}
+
+void DetectionManifest::set(const std::string &scriptPath, uint64_t hash, const FormatDetections &detections)
+{
+    _read.erase(scriptPath);
+    _entries[scriptPath] = Entry{hash, detections};
+    _modified = true;
+}
+
+bool DetectionManifest::save() const
+{
+    // What remains of the entries read belongs to scripts that were removed or replaced
+    if(!_modified && _read.empty())
+        return true;
+
+    // Renamed once complete, so that a manifest is never read truncated
+    const std::string tempPath = uniqueTempPath(_path);
+    {
+        std::ofstream file(tempPath);
+        for(const auto& entry : _entries)
+        {
+            const FormatDetections& detections = entry.second.detections;
+            file << "script " << toHex(entry.second.hash, 16) << " " << entry.first << "\n";
+            for(const std::string& magicNumber : detections.magicNumbers)
+            {
+                file << "magic " << magicNumber << "\n";
+            }
+            for(const std::string& extension : detections.extensions)
+            {
+                file << "extension " << extension << "\n";
+            }
+            for(const auto& syncbyte : detections.syncbytes)
+            {
+                file << "syncbyte " << syncbyte.first << " " << syncbyte.second << "\n";
+            }
+        }
+        if(!file.flush())
+        {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+
+    if(!replaceFile(tempPath, _path))
+    {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,87 @@
+//This file is part of the HexaMonkey project, a multimedia analyser
+//Copyright (C) 2013  Sevan Drapeau-Martin, Nicolas Fleury
+
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef DETECTIONMANIFEST_H
+#define DETECTIONMANIFEST_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <stdint.h>
+
+#include "core/formatdetector/standardformatdetector.h"
+
+/**
+ * @brief Format detection methods of a \link Module module\endlink, kept apart from the module
+ * so that they can be registered without loading it
+ */
+struct FormatDetections
+{
+    std::vector<std::string> magicNumbers;
+    std::vector<std::string> extensions;
+    std::vector<std::pair<int, int> > syncbytes;
+
+    /**
+     * @brief Register the detection methods with the \link StandardFormatDetector::Adder format adder\endlink
+     */
+    void addTo(StandardFormatDetector::Adder& formatAdder) const;
+};
+
+/**
+ * @brief File persisting the \link FormatDetections format detections\endlink of the HMDL scripts
+ *
+ * Each entry is identified by the path of the script and a hash of its content, so that an entry
+ * is only used as long as the script is unchanged. The entries neither found nor set since the
+ * manifest was read are dropped when it is saved, and the file is only written again when it
+ * has changed.
+ */
+class DetectionManifest
+{
+public:
+    /**
+     * @brief Read the manifest at the given path, which is empty if the file doesn't exist
+     */
+    DetectionManifest(const std::string& path);
+
+    /**
+     * @brief Get the detections recorded for the script, or nullptr if there is none
+     * for this version of the script
+     */
+    const FormatDetections* find(const std::string& scriptPath, uint64_t hash);
+
+    void set(const std::string& scriptPath, uint64_t hash, const FormatDetections& detections);
+
+    /**
+     * @brief Write the manifest if it has changed, returns false if it cannot be written
+     */
+    bool save() const;
+
+private:
+    struct Entry
+    {
+        uint64_t hash;
+        FormatDetections detections;
+    };
+
+    const std::string _path;
+    std::map<std::string, Entry> _read;
+    std::map<std::string, Entry> _entries;
+    bool _modified;
+};
+
+#endif // DETECTIONMANIFEST_H
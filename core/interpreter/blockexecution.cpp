@@ -6,6 +6,7 @@
 #include "core/interpreter/blockexecution.h"
 #include "core/interpreter/evaluator.h"
 #include "core/interpreter/programloader.h"
+#include "core/interpreter/scriptprofiler.h"
 #include "core/util/unused.h"
 
 //#define EXECUTION_TRACE 1
@@ -51,6 +52,10 @@ BlockExecution::ExitCode BlockExecution::execute(Program::const_iterator breakpo
 
     while(current != end && current != breakpoint && parseQuota > 0)
     {
+        if(_object != nullptr && !_object->isValid()) {
+            return ExitCode::Aborted;
+        }
+
         if(current!=last) {
             lineRepeatCount = 0;
         }
@@ -99,12 +104,14 @@ BlockExecution::ExitCode BlockExecution::execute(Program::const_iterator breakpo
             }
             else
             {
+                ScriptProfiler::Scope scope(line, ScriptProfiler::resumedStatement);
                 _subBlockExitCode = subBlock->execute(parseQuota);
             }
         }
         else
         {
             ++lineRepeatCount;
+            ScriptProfiler::Scope scope(line, ScriptProfiler::statement);
             switch(line.tag())
             {
                 case HMC_DECLARATION:
@@ -194,7 +201,7 @@ void BlockExecution::handleDeclaration(const Program &declaration, size_t &parse
 {
     if(_object != nullptr)
     {
-        const Variant typeValue = eval.rightValue(declaration.node(0)).value();
+        const Variant typeValue = eval.value(declaration.node(0));
 
         if (!typeValue.isValueless()) {
             const ObjectType type = typeValue.toObjectType();
@@ -203,7 +210,7 @@ void BlockExecution::handleDeclaration(const Program &declaration, size_t &parse
 
             std::string name = nameProgram.tag() == HMC_IDENTIFIER ?
                                    nameProgram.payload().toString()
-                                 : eval.rightValue(nameProgram).value().toString();
+                                 : eval.value(nameProgram).toString();
 #ifdef EXECUTION_TRACE
             std::stringstream S;
             S<<"Declaration "<<type<<" "<<name;
@@ -223,7 +230,7 @@ void BlockExecution::handleLocalDeclarations(const Program &declarations)
 
         Variable value;
         if (declaration.size() >= 2) {
-            value = collector().copy(eval.rightValue(declaration.node(1)).value());
+            value = collector().copy(eval.value(declaration.node(1)));
         } else {
             value = collector().null();
         }
@@ -249,7 +256,7 @@ void BlockExecution::handleRemove(const Program &remove)
 void BlockExecution::handleRightValue(const Program &rightValue)
 {
 #ifdef EXECUTION_TRACE
-    Variant value = eval.rightValue(rightValue).value();
+    Variant value = eval.value(rightValue);
 #else
     eval.rightValue(rightValue);
 #endif
@@ -266,7 +273,7 @@ void BlockExecution::handleCondition(const Program &condition)
 #ifdef EXECUTION_TRACE
     std::cerr<<"Condition"<<std::endl;
 #endif
-    if(eval.rightValue(condition.node(0)).value().toBool())
+    if(eval.value(condition.node(0)).toBool())
     {
 #ifdef EXECUTION_TRACE
         std::cerr<<" then"<<std::endl;
@@ -374,38 +381,8 @@ void BlockExecution::handleReturn(const Program &line)
 
 bool BlockExecution::loopCondition(const Program &loop)
 {
-    Variable variable = eval.rightValue(loop.node(0));
-    bool check = variable.value().toBool();
+    bool check = eval.value(loop.node(0)).toBool();
     return check
-            && ((!hasDeclaration(loop.node(1)) || (_object != nullptr && _object->availableSize()!= 0)));
-}
-
-bool BlockExecution::hasDeclaration(const Program &instructions)
-{
-    for(Program program: instructions)
-    {
-        switch(program.tag())
-        {
-            case HMC_DECLARATION:
-                return true;
-
-            case HMC_CONDITIONAL_STATEMENT:
-                if(hasDeclaration(program.node(1)))
-                    return true;
-                if(hasDeclaration(program.node(2)))
-                    return true;
-                break;
-
-            case HMC_LOOP:
-            case HMC_DO_LOOP:
-                if(hasDeclaration(program.node(1)))
-                    return true;
-                break;
-
-            default:
-                break;
-        }
-    }
-    return false;
+            && ((!loop.node(1).hasDeclaration() || (_object != nullptr && _object->availableSize()!= 0)));
 }
 
@@ -48,7 +48,9 @@ public:
         /// Has exited when a continue statement has been reached
         Continued,
         /// Has exited when a return statement has been reached
-        Returned
+        Returned,
+        /// Has exited because the object parsed has been invalidated
+        Aborted
     };
 
     /**
@@ -103,7 +105,6 @@ private:
     void handleReturn(const Program& line);
 
     bool loopCondition(const Program& loop);
-    static bool hasDeclaration(const Program& instructions);
 
     Program program;
     const Program::const_iterator begin;
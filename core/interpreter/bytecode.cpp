@@ -0,0 +1,1726 @@
+//This file is part of the HexaMonkey project, a multimedia analyser
+//Copyright (C) 2013  Sevan Drapeau-Martin, Nicolas Fleury
+
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+
+#include <algorithm>
+#include <atomic>
+#include <set>
+
+#include "compiler/model.h"
+#include "core/interpreter/bytecode.h"
+#include "core/interpreter/fromfilemethod.h"
+#include "core/interpreter/program.h"
+#include "core/interpreter/virtualmachine.h"
+#include "core/module.h"
+#include "core/modulemethod.h"
+#include "core/objecttypetemplate.h"
+#include "core/util/unused.h"
+#include "core/variable/objectscope.h"
+
+namespace {
+std::atomic<bool> bytecodeEnabled(true);
+std::atomic<bool> bytecodeOptimized(true);
+}
+
+/**
+ * @brief Lowers an execution block into \link Bytecode bytecode\endlink
+ *
+ * Registers are allocated per statement : nothing computed by a statement
+ * is used by the next one, so every statement starts again with the first
+ * registers of each kind.
+ *
+ * Names are resolved at load time when possible : local variables to their
+ * slot, reserved fields of the object and type parameters to their index,
+ * methods to the native method of the module if any.
+ * Only the paths with several elements or computed keys are kept as strings.
+ *
+ * The optimisations are made on the fly : right values made of constants are
+ * evaluated, conditions and loops whose condition is constant only keep the
+ * branch taken, and the statements following a jump out of a block are dropped.
+ * In a loop that declares nothing, modifies no path with several elements and
+ * only calls native or inlined methods, a path read whose leading elements
+ * neither depend on nor name a variable modified by the loop has this prefix
+ * resolved the first time it is needed in each execution of the loop, and kept
+ * in a register reserved until the end of the loop.
+ */
+class BytecodeCompiler
+{
+public:
+    BytecodeCompiler(Bytecode& code, bool hasObject, const LocalScope::Slots& localSlots, const Module* module);
+
+    bool compile(const Program& block);
+
+private:
+    typedef Bytecode::OpCode OpCode;
+
+    /**
+     * @brief Prefix of the paths, shared by structurally identical paths, resolved once
+     * in the variable register while the value register flag holds true
+     */
+    struct HoistedPath
+    {
+        Program path;
+        int length;
+        int variable;
+        int flag;
+    };
+
+    struct Loop
+    {
+        std::vector<size_t> breaks;
+        std::vector<size_t> continues;
+        std::vector<HoistedPath> hoistedPaths;
+    };
+
+    void block(const Program& block);
+    void statement(const Program& line);
+    void declaration(const Program& declaration);
+    void localDeclarations(const Program& declarations);
+    void condition(const Program& condition);
+    void loop(const Program& loop);
+    void doLoop(const Program& loop);
+    void jumpOut(bool isBreak);
+
+    int value(const Program& rightValue);
+    int variable(const Program& rightValue, bool modifiable, bool createIfNeeded);
+    void discard(const Program& rightValue);
+    int field(const Program& variable, bool modifiable, bool createIfNeeded);
+    int fieldValue(const Program& variable);
+    int path(const Program& variable);
+    int path(const Program& variable, int begin, int end);
+    int localSlot(const Program& variable) const;
+    int reservedIndex(const Program& variable) const;
+    const ModuleMethod* boundMethod(const Program& call) const;
+    const NativeMethod* nativeMethod(const Program& call) const;
+    int nativeCall(const Program& call, const NativeMethod& method);
+    const FromFileMethod* inlinedMethod(const Program& call) const;
+    bool isInlinable(const FromFileMethod& method, std::vector<const FromFileMethod*>& methods, size_t& size) const;
+    bool isInlinableBlock(const Program& block, std::vector<const FromFileMethod*>& methods, size_t& size) const;
+    bool isInlinableValue(const Program& rightValue, std::vector<const FromFileMethod*>& methods, size_t& size) const;
+    int inlineCall(const Program& call, const FromFileMethod& method);
+    void inlineBlock(const Program& block, int result, std::vector<size_t>& exits);
+    int inlinedArgument(const Program& variable) const;
+    bool isShadowed(const Program& callee) const;
+    int parameterIndex(const Program& variable) const;
+    int type(const Program& type);
+    int list(const Program& program, uint32_t tag);
+
+    bool fold(const Program& rightValue, Variant& result) const;
+    void hoistPaths(const Program& loop, std::vector<HoistedPath>& hoistedPaths);
+    void collectWrites(const Program& program, std::set<std::string>& written, bool& hoistable) const;
+    void collectPaths(const Program& program, const std::set<std::string>& written, std::vector<HoistedPath>& hoistedPaths);
+    int invariantLength(const Program& variable, const std::set<std::string>& written) const;
+    const HoistedPath* hoistedPath(const Program& variable) const;
+    void hoistedField(const Program& variable, const HoistedPath& hoisted, int result);
+
+    bool isJumpOut(const Program& line) const;
+
+    static bool isVariableExpression(const Program& rightValue);
+    static bool isSamePrefix(const Program& a, const Program& b, int length);
+    static bool isSameTree(const Program& a, const Program& b);
+    static const std::string* singleName(const Program& variable);
+    static int parameterNumber(const FromFileMethod& method, const std::string& name);
+
+    size_t emit(OpCode op, int32_t a = 0, int32_t b = 0, int32_t c = 0);
+    size_t pc() const;
+    void patch(size_t at, size_t target);
+
+    int constant(const Variant& value);
+    int name(const std::string& name);
+
+    int newValue();
+    int newVariable();
+    int newType();
+    void resetRegisters();
+
+    Bytecode& _code;
+    const bool _hasObject;
+    const LocalScope::Slots& _slots;
+    const Module* _module;
+    const bool _optimized;
+    bool _failed;
+
+    std::vector<Loop> _loops;
+
+    /**
+     * @brief Script method whose body is being inlined, its arguments being held
+     * by consecutive value registers
+     */
+    struct Inlining
+    {
+        const FromFileMethod* method;
+        int firstArgument;
+    };
+    std::vector<Inlining> _inlinings;
+
+    int _valueCount;
+    int _variableCount;
+    int _typeCount;
+
+    /// Registers below these ones are held by the hoisted paths of the loops being compiled
+    int _reservedValues;
+    int _reservedVariables;
+};
+
+BytecodeCompiler::BytecodeCompiler(Bytecode &code, bool hasObject, const LocalScope::Slots &localSlots, const Module* module)
+    : _code(code),
+      _hasObject(hasObject),
+      _slots(localSlots),
+      _module(module),
+      _optimized(Bytecode::optimized()),
+      _failed(false),
+      _valueCount(0),
+      _variableCount(0),
+      _typeCount(0),
+      _reservedValues(0),
+      _reservedVariables(0)
+{
+    UNUSED(hmcElemNames);
+}
+
+bool BytecodeCompiler::compile(const Program &block)
+{
+    for (const Program& line : block) {
+        _code._statementPcs.push_back(pc());
+        statement(line);
+    }
+    _code._statementPcs.push_back(pc());
+
+    return !_failed;
+}
+
+void BytecodeCompiler::block(const Program &block)
+{
+    for (const Program& line : block) {
+        statement(line);
+        //The rest of the block is never reached
+        if (_optimized && isJumpOut(line)) {
+            break;
+        }
+    }
+}
+
+void BytecodeCompiler::statement(const Program &line)
+{
+    resetRegisters();
+
+    switch (line.tag())
+    {
+        case HMC_DECLARATION:
+            declaration(line);
+            break;
+
+        case HMC_LOCAL_DECLARATIONS:
+            localDeclarations(line);
+            break;
+
+        case HMC_REMOVE:
+        {
+            const int slot = localSlot(line.node(0));
+            if (slot != -1) {
+                emit(OpCode::RemoveLocal, slot);
+            } else {
+                emit(OpCode::Remove, path(line.node(0)));
+            }
+            break;
+        }
+
+        case HMC_RIGHT_VALUE:
+            discard(line);
+            break;
+
+        case HMC_CONDITIONAL_STATEMENT:
+            condition(line);
+            break;
+
+        case HMC_LOOP:
+            loop(line);
+            break;
+
+        case HMC_DO_LOOP:
+            doLoop(line);
+            break;
+
+        case HMC_BREAK:
+            jumpOut(true);
+            break;
+
+        case HMC_CONTINUE:
+            jumpOut(false);
+            break;
+
+        case HMC_RETURN:
+            emit(OpCode::Return, variable(line.node(0), false, false));
+            break;
+
+        default:
+            break;
+    }
+}
+
+void BytecodeCompiler::declaration(const Program &declaration)
+{
+    //Member declarations only make sense in a class definition
+    if (!_hasObject) {
+        return;
+    }
+
+    const int typeValue = value(declaration.node(0));
+
+    const Program& nameProgram = declaration.node(1);
+    if (nameProgram.tag() == HMC_IDENTIFIER) {
+        emit(OpCode::Declare, typeValue, constant(nameProgram.payload()), true);
+    } else {
+        //The name is only evaluated if there is a type
+        const size_t skip = emit(OpCode::JumpIfValueless, -1, typeValue);
+        emit(OpCode::Declare, typeValue, value(nameProgram), false);
+        patch(skip, pc());
+    }
+}
+
+void BytecodeCompiler::localDeclarations(const Program &declarations)
+{
+    for (const Program& declaration : declarations) {
+        const int slot = _slots.find(declaration.node(0).payload().toString());
+        if (slot == -1) {
+            //The slots given don't cover the block
+            _failed = true;
+            return;
+        }
+        if (declaration.size() >= 2) {
+            const int copy = newVariable();
+            emit(OpCode::Box, copy, value(declaration.node(1)));
+            emit(OpCode::LocalDeclare, slot, copy);
+        } else {
+            emit(OpCode::LocalDeclare, slot, -1);
+        }
+    }
+}
+
+void BytecodeCompiler::condition(const Program &condition)
+{
+    Variant constantCondition;
+    if (fold(condition.node(0), constantCondition)) {
+        block(condition.node(constantCondition.toBool() ? 1 : 2));
+        return;
+    }
+
+    const size_t elseJump = emit(OpCode::JumpIfFalse, -1, value(condition.node(0)));
+    block(condition.node(1));
+
+    const Program& elseBlock = condition.node(2);
+    if (elseBlock.size() > 0) {
+        const size_t endJump = emit(OpCode::Jump, -1);
+        patch(elseJump, pc());
+        block(elseBlock);
+        patch(endJump, pc());
+    } else {
+        patch(elseJump, pc());
+    }
+}
+
+void BytecodeCompiler::loop(const Program &loop)
+{
+    Variant constantCondition;
+    const bool isConstant = fold(loop.node(0), constantCondition);
+    if (isConstant && !constantCondition.toBool()) {
+        return;
+    }
+
+    const int reservedValues = _reservedValues;
+    const int reservedVariables = _reservedVariables;
+    std::vector<HoistedPath> hoistedPaths;
+    hoistPaths(loop, hoistedPaths);
+
+    const size_t begin = pc();
+
+    std::vector<size_t> exits;
+    if (!isConstant) {
+        exits.push_back(emit(OpCode::JumpIfFalse, -1, value(loop.node(0))));
+    }
+    if (loop.node(1).hasDeclaration()) {
+        exits.push_back(emit(OpCode::JumpIfNoSpace, -1));
+    }
+
+    _loops.emplace_back();
+    _loops.back().hoistedPaths = std::move(hoistedPaths);
+    block(loop.node(1));
+    emit(OpCode::Jump, begin);
+
+    for (size_t jump : _loops.back().continues) {
+        patch(jump, begin);
+    }
+    for (size_t jump : _loops.back().breaks) {
+        exits.push_back(jump);
+    }
+    _loops.pop_back();
+
+    for (size_t jump : exits) {
+        patch(jump, pc());
+    }
+
+    _reservedValues = reservedValues;
+    _reservedVariables = reservedVariables;
+}
+
+void BytecodeCompiler::doLoop(const Program &loop)
+{
+    const int reservedValues = _reservedValues;
+    const int reservedVariables = _reservedVariables;
+    std::vector<HoistedPath> hoistedPaths;
+    hoistPaths(loop, hoistedPaths);
+
+    const size_t begin = pc();
+
+    _loops.emplace_back();
+    _loops.back().hoistedPaths = std::move(hoistedPaths);
+    block(loop.node(1));
+
+    for (size_t jump : _loops.back().continues) {
+        patch(jump, pc());
+    }
+    std::vector<size_t> exits = std::move(_loops.back().breaks);
+    _loops.pop_back();
+
+    resetRegisters();
+    Variant constantCondition;
+    const bool isConstant = fold(loop.node(0), constantCondition);
+    if (!isConstant || constantCondition.toBool()) {
+        if (!isConstant) {
+            exits.push_back(emit(OpCode::JumpIfFalse, -1, value(loop.node(0))));
+        }
+        if (loop.node(1).hasDeclaration()) {
+            exits.push_back(emit(OpCode::JumpIfNoSpace, -1));
+        }
+        emit(OpCode::Jump, begin);
+    }
+
+    for (size_t jump : exits) {
+        patch(jump, pc());
+    }
+
+    _reservedValues = reservedValues;
+    _reservedVariables = reservedVariables;
+}
+
+void BytecodeCompiler::jumpOut(bool isBreak)
+{
+    if (_loops.empty()) {
+        return;
+    }
+
+    const size_t jump = emit(OpCode::Jump, -1);
+    if (isBreak) {
+        _loops.back().breaks.push_back(jump);
+    } else {
+        _loops.back().continues.push_back(jump);
+    }
+}
+
+int BytecodeCompiler::value(const Program &rightValue)
+{
+    if (isVariableExpression(rightValue)) {
+        if (rightValue.node(0).tag() == HMC_VARIABLE) {
+            return fieldValue(rightValue.node(0));
+        }
+        if (rightValue.node(0).tag() == HMC_METHOD_EVALUATION) {
+            const NativeMethod* method = nativeMethod(rightValue.node(0));
+            if (method != nullptr) {
+                return nativeCall(rightValue.node(0), *method);
+            }
+            const FromFileMethod* script = inlinedMethod(rightValue.node(0));
+            if (script != nullptr) {
+                return inlineCall(rightValue.node(0), *script);
+            }
+        }
+        const int result = newValue();
+        emit(OpCode::ValueOf, result, variable(rightValue, false, false));
+        return result;
+    }
+
+    const Program& first = rightValue.node(0);
+    Variant folded;
+    if (first.tag() == HMC_OPERATOR && fold(rightValue, folded)) {
+        const int result = newValue();
+        emit(OpCode::LoadConstant, result, constant(folded));
+        return result;
+    }
+
+    switch (first.tag())
+    {
+        case HMC_OPERATOR:
+        {
+            const int op = first.payload().toInteger();
+            switch (op)
+            {
+                case HMC_SUF_INC_OP:
+                case HMC_SUF_DEC_OP:
+                {
+                    const int a = field(rightValue.node(1), true, true);
+                    const int result = newValue();
+                    emit(OpCode::PostIncrement, result, a, op == HMC_SUF_INC_OP ? 1 : -1);
+                    return result;
+                }
+
+                case HMC_NOT_OP:
+                case HMC_BITWISE_NOT_OP:
+                case HMC_OPP_OP:
+                {
+                    const int a = value(rightValue.node(1));
+                    emit(op == HMC_NOT_OP ? OpCode::Not : op == HMC_BITWISE_NOT_OP ? OpCode::BitwiseNot : OpCode::Opposite, a, a);
+                    return a;
+                }
+
+                case HMC_TERNARY_OP:
+                {
+                    Variant constantCondition;
+                    if (fold(rightValue.node(1), constantCondition)) {
+                        return value(rightValue.node(constantCondition.toBool() ? 2 : 3));
+                    }
+
+                    const int result = newValue();
+                    const size_t elseJump = emit(OpCode::JumpIfFalse, -1, value(rightValue.node(1)));
+                    emit(OpCode::Move, result, value(rightValue.node(2)));
+                    const size_t endJump = emit(OpCode::Jump, -1);
+                    patch(elseJump, pc());
+                    emit(OpCode::Move, result, value(rightValue.node(3)));
+                    patch(endJump, pc());
+                    return result;
+                }
+
+                default:
+                {
+                    OpCode opCode = OpCode::Add;
+                    if (!Bytecode::binaryOpCode(op, opCode)) {
+                        _failed = true;
+                        return newValue();
+                    }
+                    const int a = value(rightValue.node(1));
+                    const int b = value(rightValue.node(2));
+                    emit(opCode, a, a, b);
+                    return a;
+                }
+            }
+        }
+
+        case HMC_INT_CONSTANT:
+        case HMC_UINT_CONSTANT:
+        case HMC_STRING_CONSTANT:
+        case HMC_FLOAT_CONSTANT:
+        {
+            const int result = newValue();
+            emit(OpCode::LoadConstant, result, constant(first.payload()));
+            return result;
+        }
+
+        case HMC_EMPTY_STRING_CONSTANT:
+        {
+            const int result = newValue();
+            emit(OpCode::LoadConstant, result, constant(Variant("")));
+            return result;
+        }
+
+        case HMC_TYPE:
+        {
+            const int t = type(first);
+            const int result = newValue();
+            emit(OpCode::TypeValue, result, t);
+            return result;
+        }
+
+        default:
+            _failed = true;
+            return newValue();
+    }
+}
+
+int BytecodeCompiler::variable(const Program &rightValue, bool modifiable, bool createIfNeeded)
+{
+    if (!isVariableExpression(rightValue)) {
+        const int result = newVariable();
+        emit(OpCode::Box, result, value(rightValue));
+        return result;
+    }
+
+    const Program& first = rightValue.node(0);
+    switch (first.tag())
+    {
+        case HMC_OPERATOR:
+        {
+            const int op = first.payload().toInteger();
+            const int a = field(rightValue.node(1), true, true);
+            if (op == HMC_PRE_INC_OP || op == HMC_PRE_DEC_OP) {
+                emit(OpCode::Increment, a, op == HMC_PRE_INC_OP ? 1 : -1);
+            } else if (op == HMC_ASSIGN_OP) {
+                emit(OpCode::Assign, a, value(rightValue.node(2)), -1);
+            } else {
+                OpCode opCode = OpCode::Add;
+                if (!Bytecode::binaryOpCode(op, opCode)) {
+                    _failed = true;
+                }
+                emit(OpCode::Assign, a, value(rightValue.node(2)), static_cast<int32_t>(opCode));
+            }
+            return a;
+        }
+
+        case HMC_FIELD_ASSIGN:
+        {
+            const int result = variable(first.node(1), true, false);
+            const int slot = localSlot(first.node(0));
+            if (slot != -1) {
+                emit(OpCode::AssignLocal, result, slot);
+            } else {
+                emit(OpCode::AssignField, result, path(first.node(0)));
+            }
+            return result;
+        }
+
+        case HMC_NULL_CONSTANT:
+        {
+            const int result = newVariable();
+            emit(OpCode::LoadNull, result);
+            return result;
+        }
+
+        case HMC_UNDEFINED_CONSTANT:
+        {
+            const int result = newVariable();
+            emit(OpCode::LoadUndefined, result);
+            return result;
+        }
+
+        case HMC_VARIABLE:
+            return field(first, modifiable, createIfNeeded);
+
+        case HMC_ARRAY_SCOPE:
+        {
+            const int items = list(first, HMC_ARRAY_SCOPE);
+            const int result = newVariable();
+            emit(OpCode::MakeArray, result, items);
+            return result;
+        }
+
+        case HMC_MAP_SCOPE:
+        {
+            const int items = list(first, HMC_MAP_SCOPE);
+            const int result = newVariable();
+            emit(OpCode::MakeMap, result, items);
+            return result;
+        }
+
+        case HMC_METHOD_EVALUATION:
+        {
+            const NativeMethod* method = nativeMethod(first);
+            if (method != nullptr) {
+                const int value = nativeCall(first, *method);
+                const int result = newVariable();
+                emit(OpCode::BoxResult, result, value);
+                return result;
+            }
+
+            const FromFileMethod* script = inlinedMethod(first);
+            if (script != nullptr) {
+                const int value = inlineCall(first, *script);
+                const int result = newVariable();
+                emit(OpCode::BoxResult, result, value);
+                return result;
+            }
+
+            const int call = list(first, HMC_METHOD_EVALUATION);
+            const int result = newVariable();
+            emit(OpCode::Call, result, call);
+            return result;
+        }
+
+        default:
+            _failed = true;
+            return newVariable();
+    }
+}
+
+void BytecodeCompiler::discard(const Program &rightValue)
+{
+    if (isVariableExpression(rightValue)) {
+        variable(rightValue, false, false);
+    } else {
+        value(rightValue);
+    }
+}
+
+int BytecodeCompiler::field(const Program &variable, bool modifiable, bool createIfNeeded)
+{
+    const int access = (modifiable ? 1 : 0) | (createIfNeeded ? 2 : 0);
+    const int result = newVariable();
+
+    const int argument = inlinedArgument(variable);
+    if (argument != -1) {
+        emit(OpCode::Box, result, argument);
+        return result;
+    }
+
+    const int slot = localSlot(variable);
+    if (slot != -1) {
+        emit(OpCode::LocalField, result, slot, access);
+        return result;
+    }
+
+    const HoistedPath* hoisted = access == 0 ? hoistedPath(variable) : nullptr;
+    if (hoisted != nullptr) {
+        hoistedField(variable, *hoisted, result);
+        return result;
+    }
+
+    const int reserved = reservedIndex(variable);
+    const int fieldPath = path(variable);
+    if (reserved != -1) {
+        _code._paths[fieldPath].binding = reserved;
+        emit(OpCode::ReservedField, result, fieldPath, access);
+    } else {
+        emit(OpCode::Field, result, fieldPath, access);
+    }
+    return result;
+}
+
+int BytecodeCompiler::fieldValue(const Program &variable)
+{
+    const int argument = inlinedArgument(variable);
+    if (argument != -1) {
+        //Copied since the operations work in place on their first operand
+        const int result = newValue();
+        emit(OpCode::Move, result, argument);
+        return result;
+    }
+
+    if (localSlot(variable) == -1) {
+        const int reserved = reservedIndex(variable);
+        const int parameter = parameterIndex(variable);
+        if (reserved != -1 || parameter != -1) {
+            const int fieldPath = path(variable);
+            const int result = newValue();
+            if (reserved != -1) {
+                _code._paths[fieldPath].binding = reserved;
+                emit(OpCode::ReservedValue, result, fieldPath);
+            } else {
+                _code._paths[fieldPath].binding = parameter;
+                emit(OpCode::ParameterValue, result, fieldPath);
+            }
+            return result;
+        }
+    }
+
+    const int result = newValue();
+    emit(OpCode::ValueOf, result, field(variable, false, false));
+    return result;
+}
+
+int BytecodeCompiler::path(const Program &variable)
+{
+    return path(variable, 0, variable.size());
+}
+
+int BytecodeCompiler::path(const Program &variable, int begin, int end)
+{
+    Bytecode::Path path;
+    path.isStatic = true;
+    path.binding = -1;
+
+    for (int i = begin; i < end; ++i) {
+        const Program elem = variable.node(i);
+        switch (elem.tag())
+        {
+            case HMC_IDENTIFIER:
+                path.elements.push_back({true, constant(elem.payload())});
+                path.staticPath.push_back(elem.payload());
+                break;
+
+            case HMC_RIGHT_VALUE:
+                path.elements.push_back({false, value(elem)});
+                path.isStatic = false;
+                break;
+
+            case HMC_TYPE:
+            {
+                const int t = type(elem);
+                const int result = newValue();
+                emit(OpCode::TypeValue, result, t);
+                path.elements.push_back({false, result});
+                path.isStatic = false;
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    if (!path.isStatic) {
+        path.staticPath.clear();
+    }
+
+    _code._paths.push_back(std::move(path));
+    return _code._paths.size() - 1;
+}
+
+int BytecodeCompiler::localSlot(const Program &variable) const
+{
+    const std::string* name = singleName(variable);
+    if (name == nullptr) {
+        return -1;
+    }
+    return _slots.find(*name);
+}
+
+int BytecodeCompiler::reservedIndex(const Program &variable) const
+{
+    //The reserved fields are those of the object scope
+    const std::string* name = singleName(variable);
+    if (!_hasObject || name == nullptr || (*name)[0] != '@') {
+        return -1;
+    }
+    return ObjectScope::reservedIndex(*name);
+}
+
+int BytecodeCompiler::parameterIndex(const Program &variable) const
+{
+    const std::string* name = singleName(variable);
+    if (!_hasObject || _code._typeTemplate == nullptr || name == nullptr || (*name)[0] == '@') {
+        return -1;
+    }
+    return _code._typeTemplate->parameterNumber(*name);
+}
+
+int BytecodeCompiler::type(const Program &type)
+{
+    const int result = newType();
+    const size_t load = emit(OpCode::LoadType, result, name(type.node(0).payload().toString()), -1);
+
+    Program arguments = type.node(1);
+    for (int i = 0; i < arguments.size(); ++i) {
+        if (arguments.node(i).tag() == HMC_RIGHT_VALUE) {
+            const int parameter = value(arguments.node(i));
+            emit(OpCode::SetTypeParameter, result, i, parameter);
+        }
+    }
+
+    _code._instructions[load].c = pc();
+    return result;
+}
+
+int BytecodeCompiler::list(const Program &program, uint32_t tag)
+{
+    Bytecode::List list;
+    list.target = -1;
+
+    switch (tag)
+    {
+        case HMC_ARRAY_SCOPE:
+            for (const Program& item : program) {
+                list.items.push_back(variable(item, false, false));
+            }
+            break;
+
+        case HMC_MAP_SCOPE:
+            for (const Program& item : program) {
+                list.keywords.push_back(constant(item.node(0).payload()));
+                list.keywordItems.push_back(variable(item.node(1), true, false));
+            }
+            break;
+
+        case HMC_METHOD_EVALUATION:
+            for (const Program& argument : program.node(1)) {
+                list.items.push_back(variable(argument, false, false));
+            }
+            for (const Program& entry : program.node(3)) {
+                list.keywords.push_back(constant(entry.node(0).payload()));
+                list.keywordItems.push_back(variable(entry.node(1), false, false));
+            }
+            list.target = variable(program.node(0), false, false);
+            break;
+
+        default:
+            break;
+    }
+
+    _code._lists.push_back(std::move(list));
+    return _code._lists.size() - 1;
+}
+
+bool BytecodeCompiler::fold(const Program &rightValue, Variant &result) const
+{
+    if (!_optimized || rightValue.tag() != HMC_RIGHT_VALUE || isVariableExpression(rightValue) || !rightValue.isConstant()) {
+        return false;
+    }
+
+    const Program& first = rightValue.node(0);
+    switch (first.tag())
+    {
+        case HMC_INT_CONSTANT:
+        case HMC_UINT_CONSTANT:
+        case HMC_STRING_CONSTANT:
+        case HMC_FLOAT_CONSTANT:
+            result = first.payload();
+            return true;
+
+        case HMC_EMPTY_STRING_CONSTANT:
+            result = Variant("");
+            return true;
+
+        case HMC_OPERATOR:
+        {
+            const int op = first.payload().toInteger();
+            switch (op)
+            {
+                case HMC_NOT_OP:
+                case HMC_BITWISE_NOT_OP:
+                case HMC_OPP_OP:
+                {
+                    Variant a;
+                    if (!fold(rightValue.node(1), a)) {
+                        return false;
+                    }
+                    if (op == HMC_NOT_OP) {
+                        result = !a;
+                    } else if (op == HMC_BITWISE_NOT_OP) {
+                        result = ~a;
+                    } else {
+                        result = -a;
+                    }
+                    return true;
+                }
+
+                case HMC_TERNARY_OP:
+                {
+                    Variant condition;
+                    return fold(rightValue.node(1), condition)
+                        && fold(rightValue.node(condition.toBool() ? 2 : 3), result);
+                }
+
+                default:
+                {
+                    OpCode opCode = OpCode::Add;
+                    Variant a;
+                    Variant b;
+                    if (!Bytecode::binaryOpCode(op, opCode) || !fold(rightValue.node(1), a) || !fold(rightValue.node(2), b)) {
+                        return false;
+                    }
+                    //Left to the execution, which reports the division by zero
+                    if ((opCode == OpCode::Divide || opCode == OpCode::Modulo) && b.toDouble() == 0) {
+                        return false;
+                    }
+                    result = VirtualMachine::binary(opCode, a, b);
+                    return true;
+                }
+            }
+        }
+
+        //Types are looked up in the module at run time
+        default:
+            return false;
+    }
+}
+
+void BytecodeCompiler::hoistPaths(const Program &loop, std::vector<HoistedPath> &hoistedPaths)
+{
+    //Declaring members parses data, which can run any script
+    if (!_optimized || loop.node(1).hasDeclaration()) {
+        return;
+    }
+
+    std::set<std::string> written;
+    bool hoistable = true;
+    collectWrites(loop, written, hoistable);
+    if (!hoistable) {
+        return;
+    }
+    collectPaths(loop.node(1), written, hoistedPaths);
+
+    //The prefixes are resolved again in each execution of the loop
+    for (const HoistedPath& hoisted : hoistedPaths) {
+        emit(OpCode::LoadConstant, hoisted.flag, constant(Variant(true)));
+    }
+    _reservedValues = _valueCount;
+    _reservedVariables = _variableCount;
+}
+
+void BytecodeCompiler::collectWrites(const Program &program, std::set<std::string> &written, bool &hoistable) const
+{
+    for (const Program& node : program) {
+        Program target;
+        switch (node.tag())
+        {
+            case HMC_RIGHT_VALUE:
+                if (node.node(0).tag() == HMC_OPERATOR) {
+                    const int op = node.node(0).payload().toInteger();
+                    if (isVariableExpression(node) || op == HMC_SUF_INC_OP || op == HMC_SUF_DEC_OP) {
+                        target = node.node(1);
+                    }
+                }
+                break;
+
+            case HMC_FIELD_ASSIGN:
+            case HMC_REMOVE:
+                target = node.node(0);
+                break;
+
+            case HMC_LOCAL_DECLARATION:
+                written.insert(node.node(0).payload().toString());
+                break;
+
+            case HMC_METHOD_EVALUATION:
+                //The other methods could modify anything
+                if (nativeMethod(node) == nullptr && inlinedMethod(node) == nullptr) {
+                    hoistable = false;
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        if (target.isValid()) {
+            //Writing through a path could modify what another path goes through
+            const std::string* name = singleName(target);
+            if (name == nullptr) {
+                hoistable = false;
+            } else {
+                written.insert(*name);
+            }
+        }
+
+        if (!hoistable) {
+            return;
+        }
+
+        if (hmcElemTypes[node.tag()] == HMC_MASTER) {
+            collectWrites(node, written, hoistable);
+        }
+    }
+}
+
+void BytecodeCompiler::collectPaths(const Program &program, const std::set<std::string> &written, std::vector<HoistedPath> &hoistedPaths)
+{
+    for (const Program& node : program) {
+        if (node.tag() == HMC_VARIABLE) {
+            const int length = invariantLength(node, written);
+            if (length >= 2 && hoistedPath(node) == nullptr
+             && std::none_of(hoistedPaths.begin(), hoistedPaths.end(), [&](const HoistedPath& hoisted) {
+                    return hoisted.length == length && isSamePrefix(hoisted.path, node, length);
+                })) {
+                hoistedPaths.push_back({node, length, newVariable(), newValue()});
+            }
+        }
+
+        if (hmcElemTypes[node.tag()] == HMC_MASTER) {
+            collectPaths(node, written, hoistedPaths);
+        }
+    }
+}
+
+int BytecodeCompiler::invariantLength(const Program &variable, const std::set<std::string> &written) const
+{
+    const Program first = variable.node(0);
+    if (first.tag() != HMC_IDENTIFIER || written.count(first.payload().toString())) {
+        return 0;
+    }
+
+    //The last element is always resolved by the read itself
+    int length = 1;
+    for (; length < variable.size() - 1; ++length) {
+        const Program elem = variable.node(length);
+        if (elem.tag() == HMC_IDENTIFIER) {
+            continue;
+        }
+
+        //Types are looked up at run time
+        if (elem.tag() != HMC_RIGHT_VALUE) {
+            break;
+        }
+
+        Variant key;
+        if (fold(elem, key)) {
+            continue;
+        }
+
+        //A key read from a variable that isn't a reserved field, which the parsing modifies
+        const std::string* name = elem.node(0).tag() == HMC_VARIABLE ? singleName(elem.node(0)) : nullptr;
+        if (name == nullptr || (*name)[0] == '@' || written.count(*name)) {
+            break;
+        }
+    }
+    return length;
+}
+
+const BytecodeCompiler::HoistedPath *BytecodeCompiler::hoistedPath(const Program &variable) const
+{
+    //The outermost loops first, their prefixes being resolved less often
+    for (const Loop& loop : _loops) {
+        for (const HoistedPath& hoisted : loop.hoistedPaths) {
+            if (hoisted.length < variable.size() && isSamePrefix(hoisted.path, variable, hoisted.length)) {
+                return &hoisted;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void BytecodeCompiler::hoistedField(const Program &variable, const HoistedPath &hoisted, int result)
+{
+    const size_t resolved = emit(OpCode::JumpIfFalse, -1, hoisted.flag);
+    emit(OpCode::Field, hoisted.variable, path(variable, 0, hoisted.length), 0);
+    emit(OpCode::LoadConstant, hoisted.flag, constant(Variant(false)));
+    patch(resolved, pc());
+
+    emit(OpCode::SubField, result, hoisted.variable, path(variable, hoisted.length, variable.size()));
+}
+
+const ModuleMethod *BytecodeCompiler::boundMethod(const Program &call) const
+{
+    //Only the calls by name with positional arguments are bound
+    if (_module == nullptr || call.node(3).size() != 0) {
+        return nullptr;
+    }
+
+    const Program callee = call.node(0).node(0);
+    if (callee.tag() != HMC_VARIABLE || isShadowed(callee)) {
+        return nullptr;
+    }
+
+    const std::string* name = singleName(callee);
+    if (name == nullptr) {
+        return nullptr;
+    }
+
+    return _module->getMethod(*name);
+}
+
+const NativeMethod *BytecodeCompiler::nativeMethod(const Program &call) const
+{
+    const ModuleMethod* method = boundMethod(call);
+    if (method == nullptr || method->native() == nullptr) {
+        return nullptr;
+    }
+
+    const size_t count = std::max<size_t>(call.node(1).size(), method->signature().size());
+    if (count > NativeMethod::maxArguments) {
+        return nullptr;
+    }
+    return method->native();
+}
+
+int BytecodeCompiler::nativeCall(const Program &call, const NativeMethod &method)
+{
+    const std::vector<MethodArgument>& signature = method.signature();
+    const Program arguments = call.node(1);
+    const size_t count = std::max<size_t>(arguments.size(), signature.size());
+
+    //The values are gathered in consecutive registers, the first one receiving the result
+    const int first = newValue();
+    for (size_t i = 1; i < count; ++i) {
+        newValue();
+    }
+
+    size_t i = 0;
+    for (const Program& argument : arguments) {
+        emit(OpCode::Move, first + i, value(argument));
+        ++i;
+    }
+    for (; i < count; ++i) {
+        emit(OpCode::LoadConstant, first + i, constant(signature[i].defaultValue()));
+    }
+
+    _code._nativeCalls.push_back({&method, static_cast<int32_t>(count)});
+    emit(OpCode::CallNative, first, _code._nativeCalls.size() - 1, first);
+    return first;
+}
+
+const FromFileMethod *BytecodeCompiler::inlinedMethod(const Program &call) const
+{
+    const ModuleMethod* method = boundMethod(call);
+    if (method == nullptr || method->script() == nullptr) {
+        return nullptr;
+    }
+
+    std::vector<const FromFileMethod*> methods;
+    for (const Inlining& inlining : _inlinings) {
+        methods.push_back(inlining.method);
+    }
+    size_t size = 0;
+    if (!isInlinable(*method->script(), methods, size)) {
+        return nullptr;
+    }
+    return method->script();
+}
+
+bool BytecodeCompiler::isInlinable(const FromFileMethod &method, std::vector<const FromFileMethod *> &methods, size_t &size) const
+{
+    //The names used by the body must resolve the same way as in the block compiled
+    if (&method.module() != _module) {
+        return false;
+    }
+
+    //Recursive methods are never inlined
+    if (std::find(methods.begin(), methods.end(), &method) != methods.end()) {
+        return false;
+    }
+
+    methods.push_back(&method);
+    const bool inlinable = isInlinableBlock(method.definition(), methods, size);
+    methods.pop_back();
+    return inlinable;
+}
+
+bool BytecodeCompiler::isInlinableBlock(const Program &block, std::vector<const FromFileMethod *> &methods, size_t &size) const
+{
+    //Only conditions and returns, which leave nothing behind them but the value returned
+    for (const Program& line : block) {
+        if (++size > Bytecode::maxInlinedSize) {
+            return false;
+        }
+
+        switch (line.tag())
+        {
+            case HMC_RETURN:
+                if (line.node(0).tag() != HMC_RIGHT_VALUE || !isInlinableValue(line.node(0), methods, size)) {
+                    return false;
+                }
+                break;
+
+            case HMC_CONDITIONAL_STATEMENT:
+                if (!isInlinableValue(line.node(0), methods, size)
+                 || !isInlinableBlock(line.node(1), methods, size)
+                 || !isInlinableBlock(line.node(2), methods, size)) {
+                    return false;
+                }
+                break;
+
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+bool BytecodeCompiler::isInlinableValue(const Program &rightValue, std::vector<const FromFileMethod *> &methods, size_t &size) const
+{
+    if (++size > Bytecode::maxInlinedSize) {
+        return false;
+    }
+
+    const Program& first = rightValue.node(0);
+    switch (first.tag())
+    {
+        case HMC_OPERATOR:
+        {
+            //Side effects excluded
+            const int op = first.payload().toInteger();
+            OpCode opCode = OpCode::Add;
+            if (isVariableExpression(rightValue) || op == HMC_SUF_INC_OP || op == HMC_SUF_DEC_OP) {
+                return false;
+            }
+            if (op != HMC_NOT_OP && op != HMC_BITWISE_NOT_OP && op != HMC_OPP_OP && op != HMC_TERNARY_OP && !Bytecode::binaryOpCode(op, opCode)) {
+                return false;
+            }
+            for (int i = 1; i < rightValue.size(); ++i) {
+                if (!isInlinableValue(rightValue.node(i), methods, size)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        case HMC_INT_CONSTANT:
+        case HMC_UINT_CONSTANT:
+        case HMC_STRING_CONSTANT:
+        case HMC_FLOAT_CONSTANT:
+        case HMC_EMPTY_STRING_CONSTANT:
+        case HMC_NULL_CONSTANT:
+        case HMC_UNDEFINED_CONSTANT:
+            return true;
+
+        case HMC_VARIABLE:
+        {
+            //Only the parameters, everything else would be looked up in another scope
+            const std::string* name = singleName(first);
+            return name != nullptr && parameterNumber(*methods.back(), *name) != -1;
+        }
+
+        case HMC_TYPE:
+            for (const Program& argument : first.node(1)) {
+                if (argument.tag() == HMC_RIGHT_VALUE && !isInlinableValue(argument, methods, size)) {
+                    return false;
+                }
+            }
+            return true;
+
+        case HMC_METHOD_EVALUATION:
+        {
+            //The calls must be bound or inlined as well, the same way boundMethod does
+            const Program callee = first.node(0).node(0);
+            const std::string* name = callee.tag() == HMC_VARIABLE ? singleName(callee) : nullptr;
+            if (first.node(3).size() != 0 || name == nullptr || parameterNumber(*methods.back(), *name) != -1) {
+                return false;
+            }
+
+            const ModuleMethod* method = _module->getMethod(*name);
+            if (method == nullptr) {
+                return false;
+            }
+
+            for (const Program& argument : first.node(1)) {
+                if (!isInlinableValue(argument, methods, size)) {
+                    return false;
+                }
+            }
+
+            if (method->native() != nullptr) {
+                return std::max<size_t>(first.node(1).size(), method->signature().size()) <= NativeMethod::maxArguments;
+            }
+            return method->script() != nullptr && isInlinable(*method->script(), methods, size);
+        }
+
+        default:
+            return false;
+    }
+}
+
+int BytecodeCompiler::inlineCall(const Program &call, const FromFileMethod &method)
+{
+    const std::vector<MethodArgument>& signature = method.signature();
+    const Program arguments = call.node(1);
+    const size_t count = std::max<size_t>(arguments.size(), signature.size());
+
+    //The arguments are gathered in the registers following the one receiving the result
+    const int result = newValue();
+    const int first = result + 1;
+    for (size_t i = 0; i < count; ++i) {
+        newValue();
+    }
+
+    size_t i = 0;
+    for (const Program& argument : arguments) {
+        emit(OpCode::Move, first + i, value(argument));
+        ++i;
+    }
+    for (; i < count; ++i) {
+        emit(OpCode::LoadConstant, first + i, constant(signature[i].defaultValue()));
+    }
+
+    _inlinings.push_back({&method, first});
+    std::vector<size_t> exits;
+    inlineBlock(method.definition(), result, exits);
+
+    //Reaching the end of the method without returning gives undefined
+    emit(OpCode::LoadConstant, result, constant(Variant()));
+    for (size_t exit : exits) {
+        patch(exit, pc());
+    }
+    _inlinings.pop_back();
+
+    return result;
+}
+
+void BytecodeCompiler::inlineBlock(const Program &block, int result, std::vector<size_t> &exits)
+{
+    for (const Program& line : block) {
+        if (line.tag() == HMC_RETURN) {
+            emit(OpCode::Move, result, value(line.node(0)));
+            exits.push_back(emit(OpCode::Jump, -1));
+            continue;
+        }
+
+        //Otherwise a condition, as checked by isInlinableBlock
+        const size_t elseJump = emit(OpCode::JumpIfFalse, -1, value(line.node(0)));
+        inlineBlock(line.node(1), result, exits);
+
+        const Program& elseBlock = line.node(2);
+        if (elseBlock.size() > 0) {
+            const size_t endJump = emit(OpCode::Jump, -1);
+            patch(elseJump, pc());
+            inlineBlock(elseBlock, result, exits);
+            patch(endJump, pc());
+        } else {
+            patch(elseJump, pc());
+        }
+    }
+}
+
+int BytecodeCompiler::inlinedArgument(const Program &variable) const
+{
+    if (_inlinings.empty()) {
+        return -1;
+    }
+
+    const std::string* name = singleName(variable);
+    if (name == nullptr) {
+        return -1;
+    }
+
+    const Inlining& inlining = _inlinings.back();
+    const int number = parameterNumber(*inlining.method, *name);
+    return number != -1 ? inlining.firstArgument + number : -1;
+}
+
+bool BytecodeCompiler::isShadowed(const Program &callee) const
+{
+    //Within an inlined body, the names are those of the scope of the method
+    if (!_inlinings.empty()) {
+        const std::string* name = singleName(callee);
+        return name == nullptr || parameterNumber(*_inlinings.back().method, *name) != -1;
+    }
+    return localSlot(callee) != -1;
+}
+
+bool BytecodeCompiler::isJumpOut(const Program &line) const
+{
+    switch (line.tag())
+    {
+        case HMC_RETURN:
+            return true;
+
+        case HMC_BREAK:
+        case HMC_CONTINUE:
+            //Ignored outside of loops
+            return !_loops.empty();
+
+        default:
+            return false;
+    }
+}
+
+bool BytecodeCompiler::isVariableExpression(const Program &rightValue)
+{
+    const Program& first = rightValue.node(0);
+    switch (first.tag())
+    {
+        case HMC_OPERATOR:
+        {
+            const int op = first.payload().toInteger();
+            return op == HMC_PRE_INC_OP
+                || op == HMC_PRE_DEC_OP
+                || (op >= HMC_ASSIGN_OP && op <= HMC_OR_ASSIGN_OP);
+        }
+
+        case HMC_FIELD_ASSIGN:
+        case HMC_NULL_CONSTANT:
+        case HMC_UNDEFINED_CONSTANT:
+        case HMC_VARIABLE:
+        case HMC_ARRAY_SCOPE:
+        case HMC_MAP_SCOPE:
+        case HMC_METHOD_EVALUATION:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+bool BytecodeCompiler::isSamePrefix(const Program &a, const Program &b, int length)
+{
+    for (int i = 0; i < length; ++i) {
+        if (!isSameTree(a.node(i), b.node(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BytecodeCompiler::isSameTree(const Program &a, const Program &b)
+{
+    if (a.tag() != b.tag() || a.size() != b.size()) {
+        return false;
+    }
+
+    if (hmcElemTypes[a.tag()] != HMC_MASTER) {
+        return a.payload() == b.payload();
+    }
+
+    for (int i = 0; i < a.size(); ++i) {
+        if (!isSameTree(a.node(i), b.node(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const std::string *BytecodeCompiler::singleName(const Program &variable)
+{
+    if (variable.size() != 1) {
+        return nullptr;
+    }
+
+    const Program elem = variable.node(0);
+    if (elem.tag() != HMC_IDENTIFIER) {
+        return nullptr;
+    }
+    return &elem.payload().toString();
+}
+
+int BytecodeCompiler::parameterNumber(const FromFileMethod &method, const std::string &name)
+{
+    const std::vector<MethodArgument>& signature = method.signature();
+    for (size_t i = 0; i < signature.size(); ++i) {
+        if (signature[i].name() == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+size_t BytecodeCompiler::emit(OpCode op, int32_t a, int32_t b, int32_t c)
+{
+    _code._instructions.push_back({op, a, b, c});
+    return _code._instructions.size() - 1;
+}
+
+size_t BytecodeCompiler::pc() const
+{
+    return _code._instructions.size();
+}
+
+void BytecodeCompiler::patch(size_t at, size_t target)
+{
+    _code._instructions[at].a = target;
+}
+
+int BytecodeCompiler::constant(const Variant &value)
+{
+    _code._constants.push_back(value);
+    return _code._constants.size() - 1;
+}
+
+int BytecodeCompiler::name(const std::string &name)
+{
+    _code._names.push_back(name);
+    return _code._names.size() - 1;
+}
+
+int BytecodeCompiler::newValue()
+{
+    const int index = _valueCount++;
+    _code._valueCount = std::max(_code._valueCount, _valueCount);
+    return index;
+}
+
+int BytecodeCompiler::newVariable()
+{
+    const int index = _variableCount++;
+    _code._variableCount = std::max(_code._variableCount, _variableCount);
+    return index;
+}
+
+int BytecodeCompiler::newType()
+{
+    const int index = _typeCount++;
+    _code._typeCount = std::max(_code._typeCount, _typeCount);
+    return index;
+}
+
+void BytecodeCompiler::resetRegisters()
+{
+    _valueCount = _reservedValues;
+    _variableCount = _reservedVariables;
+    _typeCount = 0;
+}
+
+Bytecode::Bytecode()
+    : _typeTemplate(nullptr),
+      _valueCount(0),
+      _variableCount(0),
+      _typeCount(0)
+{
+}
+
+std::shared_ptr<const Bytecode> Bytecode::compile(const Program &block, bool hasObject, const Module *module)
+{
+    std::shared_ptr<LocalScope::Slots> localSlots = std::make_shared<LocalScope::Slots>();
+    bindLocals(block, *localSlots);
+    return compile(block, hasObject, localSlots, nullptr, module);
+}
+
+std::shared_ptr<const Bytecode> Bytecode::compile(const Program &block,
+                                                  bool hasObject,
+                                                  std::shared_ptr<const LocalScope::Slots> localSlots,
+                                                  const ObjectTypeTemplate *typeTemplate,
+                                                  const Module *module)
+{
+    std::shared_ptr<Bytecode> code(new Bytecode);
+    code->_slots = localSlots;
+    code->_typeTemplate = typeTemplate;
+
+    BytecodeCompiler compiler(*code, hasObject, *localSlots, module);
+    if (!compiler.compile(block)) {
+        return nullptr;
+    }
+    return code;
+}
+
+void Bytecode::bindLocals(const Program &block, LocalScope::Slots &localSlots)
+{
+    for (const Program& node : block) {
+        switch (node.tag())
+        {
+            case HMC_LOCAL_DECLARATIONS:
+                for (const Program& declaration : node) {
+                    localSlots.add(declaration.node(0).payload().toString());
+                }
+                break;
+
+            case HMC_FIELD_ASSIGN:
+            case HMC_REMOVE:
+            {
+                const Program variable = node.node(0);
+                if (variable.size() == 1 && variable.node(0).tag() == HMC_IDENTIFIER) {
+                    localSlots.add(variable.node(0).payload().toString());
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        if (hmcElemTypes[node.tag()] == HMC_MASTER) {
+            bindLocals(node, localSlots);
+        }
+    }
+}
+
+bool Bytecode::enabled()
+{
+    return bytecodeEnabled.load(std::memory_order_relaxed);
+}
+
+void Bytecode::setEnabled(bool enabled)
+{
+    bytecodeEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool Bytecode::optimized()
+{
+    return bytecodeOptimized.load(std::memory_order_relaxed);
+}
+
+void Bytecode::setOptimized(bool optimized)
+{
+    bytecodeOptimized.store(optimized, std::memory_order_relaxed);
+}
+
+bool Bytecode::binaryOpCode(int op, OpCode &opCode)
+{
+    switch (op)
+    {
+        case HMC_RIGHT_ASSIGN_OP:
+        case HMC_RIGHT_OP:        opCode = OpCode::RightShift; break;
+        case HMC_LEFT_ASSIGN_OP:
+        case HMC_LEFT_OP:         opCode = OpCode::LeftShift; break;
+        case HMC_ADD_ASSIGN_OP:
+        case HMC_ADD_OP:          opCode = OpCode::Add; break;
+        case HMC_SUB_ASSIGN_OP:
+        case HMC_SUB_OP:          opCode = OpCode::Substract; break;
+        case HMC_MUL_ASSIGN_OP:
+        case HMC_MUL_OP:          opCode = OpCode::Multiply; break;
+        case HMC_DIV_ASSIGN_OP:
+        case HMC_DIV_OP:          opCode = OpCode::Divide; break;
+        case HMC_MOD_ASSIGN_OP:
+        case HMC_MOD_OP:          opCode = OpCode::Modulo; break;
+        case HMC_AND_ASSIGN_OP:
+        case HMC_BITWISE_AND_OP:  opCode = OpCode::BitwiseAnd; break;
+        case HMC_XOR_ASSIGN_OP:
+        case HMC_BITWISE_XOR_OP:  opCode = OpCode::BitwiseXor; break;
+        case HMC_OR_ASSIGN_OP:
+        case HMC_BITWISE_OR_OP:   opCode = OpCode::BitwiseOr; break;
+        case HMC_OR_OP:           opCode = OpCode::Or; break;
+        case HMC_AND_OP:          opCode = OpCode::And; break;
+        case HMC_EQ_OP:           opCode = OpCode::Equal; break;
+        case HMC_NE_OP:           opCode = OpCode::NotEqual; break;
+        case HMC_GE_OP:           opCode = OpCode::GreaterEqual; break;
+        case HMC_GT_OP:           opCode = OpCode::Greater; break;
+        case HMC_LE_OP:           opCode = OpCode::LessEqual; break;
+        case HMC_LT_OP:           opCode = OpCode::Less; break;
+        //Not a binary operator
+        default:                  return false;
+    }
+    return true;
+}
+
+size_t Bytecode::statementPc(size_t statementIndex) const
+{
+    if (statementIndex < _statementPcs.size()) {
+        return _statementPcs[statementIndex];
+    }
+    return _instructions.size();
+}
+
+size_t Bytecode::size() const
+{
+    return _instructions.size();
+}
+
+const std::vector<Bytecode::Instruction> &Bytecode::instructions() const
+{
+    return _instructions;
+}
+
+const std::vector<Variant> &Bytecode::constants() const
+{
+    return _constants;
+}
+
+const std::vector<std::string> &Bytecode::names() const
+{
+    return _names;
+}
+
+const std::vector<Bytecode::Path> &Bytecode::paths() const
+{
+    return _paths;
+}
+
+const std::vector<Bytecode::List> &Bytecode::lists() const
+{
+    return _lists;
+}
+
+const std::vector<Bytecode::NativeCall> &Bytecode::nativeCalls() const
+{
+    return _nativeCalls;
+}
+
+const std::shared_ptr<const LocalScope::Slots> &Bytecode::localSlots() const
+{
+    return _slots;
+}
+
+const ObjectTypeTemplate *Bytecode::typeTemplate() const
+{
+    return _typeTemplate;
+}
+
+int Bytecode::valueCount() const
+{
+    return _valueCount;
+}
+
+int Bytecode::variableCount() const
+{
+    return _variableCount;
+}
+
+int Bytecode::typeCount() const
+{
+    return _typeCount;
+}
@@ -0,0 +1,301 @@
+//This file is part of the HexaMonkey project, a multimedia analyser
+//Copyright (C) 2013  Sevan Drapeau-Martin, Nicolas Fleury
+
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "core/variant.h"
+#include "core/variable/localscope.h"
+#include "core/variable/variablepath.h"
+
+class FromFileMethod;
+class Module;
+class NativeMethod;
+class ObjectTypeTemplate;
+class Program;
+
+/**
+ * @brief Compact form of an HMDL execution block run by the \link VirtualMachine virtual machine\endlink
+ *
+ * The block is lowered once at load time into a flat list of instructions
+ * working on typed registers : value registers holding \link Variant variants\endlink
+ * for the temporaries, variable registers holding \link Variable variables\endlink
+ * for left values and shared objects and type registers holding the
+ * \link ObjectType types\endlink being built.
+ *
+ * Blocks using constructs the compiler doesn't handle are not compiled, in which
+ * case the \link BlockExecution AST interpreter\endlink is used instead.
+ *
+ * Unless \link Bytecode::setOptimized disabled\endlink, the block is optimised while lowered :
+ * the constant right values are folded, the branches of conditions and loops that
+ * are never taken are removed, and the paths read in a loop have their longest
+ * prefix that the loop doesn't modify resolved once per execution of the loop.
+ */
+class Bytecode
+{
+public:
+    enum class OpCode : uint8_t
+    {
+        /// values[a] = constants[b]
+        LoadConstant,
+        /// values[a] = values[b]
+        Move,
+        /// values[a] = variables[b].value()
+        ValueOf,
+        /// variables[a] = copy of values[b]
+        Box,
+        /// variables[a] = null variable
+        LoadNull,
+        /// variables[a] = undefined variable
+        LoadUndefined,
+        /// variables[a] = scope field at paths[b], c holds the access flags
+        Field,
+        /// variables[a] = field of variables[b] at paths[c], read only
+        SubField,
+        /// variables[a] = local variable in slot b, c holds the access flags
+        LocalField,
+        /// variables[a] = reserved field of the object bound to paths[b], c holds the access flags
+        ReservedField,
+        /// values[a] = value of the reserved field of the object bound to paths[b]
+        ReservedValue,
+        /// values[a] = value of the type parameter bound to paths[b]
+        ParameterValue,
+        /// variables[a] set to the result of binary operation c between itself and values[b]
+        /// or to values[b] if c is Assign
+        Assign,
+        /// variables[a] incremented by b (1 or -1)
+        Increment,
+        /// values[a] = variables[b].value() then variables[b] incremented by c (1 or -1)
+        PostIncrement,
+        /// values[a] = !values[b]
+        Not,
+        /// values[a] = ~values[b]
+        BitwiseNot,
+        /// values[a] = -values[b]
+        Opposite,
+        /// values[a] = values[b] op values[c]
+        Or, And, BitwiseOr, BitwiseXor, BitwiseAnd,
+        Equal, NotEqual, GreaterEqual, Greater, LessEqual, Less,
+        RightShift, LeftShift, Add, Substract, Multiply, Divide, Modulo,
+        /// types[a] = type named names[b], jumps to c if not found
+        LoadType,
+        /// parameter b of types[a] = values[c]
+        SetTypeParameter,
+        /// values[a] = types[b]
+        TypeValue,
+        /// variables[a] = array built from the item list lists[b]
+        MakeArray,
+        /// variables[a] = map built from the item list lists[b]
+        MakeMap,
+        /// variables[a] = result of the call calls[b]
+        Call,
+        /// values[a] = result of the native call nativeCalls[b] on the values from register c on
+        CallNative,
+        /// variables[a] = copy of values[b], or an undefined variable if values[b] is undefined
+        BoxResult,
+        /// variables[a] set constant and assigned to the scope field at paths[b]
+        AssignField,
+        /// declare a member of type values[a] named values[b] or constants[b] if c
+        Declare,
+        /// variables[a] set constant and assigned to the local variable in slot b
+        AssignLocal,
+        /// declare the local variable in slot a initialized with variables[b] or null if b < 0
+        LocalDeclare,
+        /// remove the scope field at paths[a]
+        Remove,
+        /// remove the local variable in slot a
+        RemoveLocal,
+        /// jump to a
+        Jump,
+        /// jump to a if values[b] is false
+        JumpIfFalse,
+        /// jump to a if values[b] is valueless
+        JumpIfValueless,
+        /// jump to a if no more data is available for the object parsed
+        JumpIfNoSpace,
+        /// return variables[a]
+        Return
+    };
+
+    struct Instruction
+    {
+        OpCode op;
+        int32_t a;
+        int32_t b;
+        int32_t c;
+    };
+
+    /**
+     * @brief Element of a path, either constant or computed in a value register
+     */
+    struct PathElement
+    {
+        bool isConstant;
+        int32_t index;
+    };
+
+    /**
+     * @brief Path to a scope field, already built when all its elements are constant
+     *
+     * A path made of a single name can be bound at load time to a reserved field
+     * of the object or to a type parameter, in which case binding holds its index.
+     * The path is still used when the binding cannot be used at run time.
+     */
+    struct Path
+    {
+        std::vector<PathElement> elements;
+        bool isStatic;
+        VariablePath staticPath;
+        int32_t binding;
+    };
+
+    /**
+     * @brief Variable registers given to a call, arrays and maps, with the keywords
+     * (constant indices) for keyword arguments and map items
+     */
+    struct List
+    {
+        int32_t target;
+        std::vector<int32_t> items;
+        std::vector<int32_t> keywords;
+        std::vector<int32_t> keywordItems;
+    };
+
+    /**
+     * @brief Call bound at load time to a \link NativeMethod native method\endlink, the values
+     * being held by consecutive value registers, default values included
+     */
+    struct NativeCall
+    {
+        const NativeMethod* method;
+        int32_t count;
+    };
+
+    /**
+     * @brief Number of program nodes beyond which a script method isn't inlined, the
+     * methods it calls being inlined included
+     */
+    static const size_t maxInlinedSize = 64;
+
+    /**
+     * @brief Compile an execution block
+     * @param block Execution block tagged program
+     * @param hasObject True if the block is part of a class definition, in which case
+     * member declarations are compiled, otherwise they are ignored
+     * @param module If given, the calls naming its \link NativeMethod native methods\endlink
+     * with positional arguments only are bound to them, and the calls naming its small
+     * script methods made of conditions and returns are inlined
+     * @return nullptr if the block uses constructs not handled by the compiler
+     */
+    static std::shared_ptr<const Bytecode> compile(const Program& block, bool hasObject, const Module* module = nullptr);
+
+    /**
+     * @brief Compile an execution block sharing its local scope with other blocks
+     *
+     * The local variables are accessed through the slots given, which must hold all
+     * the names bound by \link Bytecode::bindLocals bindLocals\endlink for the block.
+     * The names of the reserved fields of the object (@size, @pos...) and, if a
+     * template is given, the names of its parameters are bound at load time as well.
+     */
+    static std::shared_ptr<const Bytecode> compile(const Program& block,
+                                                   bool hasObject,
+                                                   std::shared_ptr<const LocalScope::Slots> localSlots,
+                                                   const ObjectTypeTemplate* typeTemplate = nullptr,
+                                                   const Module* module = nullptr);
+
+    /**
+     * @brief Bind to slots the local variables declared or assigned by name in the block
+     */
+    static void bindLocals(const Program& block, LocalScope::Slots& localSlots);
+
+    /**
+     * @brief Check if the blocks compiled are executed by the virtual machine, which
+     * is the default, or by the AST interpreter.
+     */
+    static bool enabled();
+    static void setEnabled(bool enabled);
+
+    /**
+     * @brief Check if the blocks are optimised when compiled, which is the default
+     */
+    static bool optimized();
+    static void setOptimized(bool optimized);
+
+    /**
+     * @brief Get the operation of a binary operator of the model, compound assignments included
+     * @return false if the operator is not binary
+     */
+    static bool binaryOpCode(int op, OpCode& opCode);
+
+    /**
+     * @brief Get the index of the first instruction of a top level statement of the block
+     *
+     * The index of the end of the block is given for the statement count.
+     */
+    size_t statementPc(size_t statementIndex) const;
+
+    size_t size() const;
+
+    const std::vector<Instruction>& instructions() const;
+    const std::vector<Variant>& constants() const;
+    const std::vector<std::string>& names() const;
+    const std::vector<Path>& paths() const;
+    const std::vector<List>& lists() const;
+    const std::vector<NativeCall>& nativeCalls() const;
+
+    /**
+     * @brief Get the slots of the local variables, to be given to the
+     * \link LocalScope local scope\endlink the block is run in
+     */
+    const std::shared_ptr<const LocalScope::Slots>& localSlots() const;
+
+    /**
+     * @brief Get the template the type parameters are bound to, nullptr if none
+     */
+    const ObjectTypeTemplate* typeTemplate() const;
+
+    int valueCount() const;
+    int variableCount() const;
+    int typeCount() const;
+
+private:
+    friend class BytecodeCompiler;
+
+    Bytecode();
+
+    std::vector<Instruction> _instructions;
+    std::vector<size_t> _statementPcs;
+    std::vector<Variant> _constants;
+    std::vector<std::string> _names;
+    std::vector<Path> _paths;
+    std::vector<List> _lists;
+    std::vector<NativeCall> _nativeCalls;
+    std::shared_ptr<const LocalScope::Slots> _slots;
+    const ObjectTypeTemplate* _typeTemplate;
+
+    int _valueCount;
+    int _variableCount;
+    int _typeCount;
+};
+
+#endif // BYTECODE_H
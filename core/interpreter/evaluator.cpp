@@ -1,380 +1,529 @@
-#include "evaluator.h"
-
-#include "compiler/model.h"
-#include "core/log/logmanager.h"
-#include "core/interpreter/evaluator.h"
-#include "core/interpreter/program.h"
-#include "core/util/unused.h"
-#include "core/variable/arrayscope.h"
-#include "core/variable/mapscope.h"
-
-const Variant emptyString("");
-const Module emptyModule;
-
-
-Evaluator::Evaluator(const Variable &scope)
-    : scope(scope),
-      module(emptyModule)
-{
-    UNUSED(hmcElemNames);
-}
-
-Evaluator::Evaluator(const Variable& scope, const Module &module)
-    : scope(scope),
-      module(module)
-{
-}
-
-Variable Evaluator::rightValue(const Program &program, int modifiable, int createIfNeeded) const
-{
-    Program first = program.node(0);
-    switch(first.tag())
-    {
-        case HMC_OPERATOR:
-        {
-            const int op = first.payload().toInteger();
-
-            switch(op) {
-                case HMC_PRE_INC_OP:
-                {
-                    Variable a = variable(program[1], true, true);
-                    a.setValue(a.value()+1);
-                    return a;
-                }
-
-                case HMC_PRE_DEC_OP:
-                {
-                    Variable a = variable(program[1], true, true);
-                    a.setValue(a.value()-1);
-                    return a;
-                }
-
-                case HMC_SUF_INC_OP:
-                {
-                    Variable a = variable(program[1], true, true);
-                    const Variant& value = a.value();
-                    Variable aCopy = collector().copy(value);
-                    a.setValue(value + 1);
-                    return aCopy;
-                }
-
-                case HMC_SUF_DEC_OP:
-                {
-                    Variable a = variable(program[1], true, true);
-                    const Variant& value = a.value();
-                    Variable aCopy = collector().copy(value);
-                    a.setValue(value - 1);
-                    return aCopy;
-                }
-
-                case HMC_ASSIGN_OP:
-                {
-                    Variable a = variable(program[1], true, true);
-                    a.setValue(rightValue(program[2]).value());
-                    return a;
-                }
-
-                case HMC_RIGHT_ASSIGN_OP:
-                {
-                    Variable a = variable(program[1], true, true);
-                    a.setValue(a.value() >> rightValue(program[2]).value());
-                    return a;
-                }
-
-                case HMC_LEFT_ASSIGN_OP:
-                {
-                    Variable a = variable(program[1], true, true);
-                    a.setValue(a.value() << rightValue(program[2]).value());
-                    return a;
-                }
-
-                case HMC_ADD_ASSIGN_OP:
-                {
-                    Variable a = variable(program[1], true, true);
-                    a.setValue(a.value() + rightValue(program[2]).value());
-                    return a;
-                }
-
-                case HMC_SUB_ASSIGN_OP:
-                {
-                    Variable a = variable(program[1], true, true);
-                    a.setValue(a.value() - rightValue(program[2]).value());
-                    return a;
-                }
-
-                case HMC_MUL_ASSIGN_OP:
-                {
-                    Variable a = variable(program[1], true, true);
-                    a.setValue(a.value() * rightValue(program[2]).value());
-                    return a;
-                }
-
-                case HMC_DIV_ASSIGN_OP:
-                {
-                    Variable a = variable(program[1], true, true);
-                    a.setValue(a.value() / rightValue(program[2]).value());
-                    return a;
-                }
-
-                case HMC_MOD_ASSIGN_OP:
-                {
-                    Variable a = variable(program[1], true, true);
-                    a.setValue(a.value() % rightValue(program[2]).value());
-                    return a;
-                }
-
-                case HMC_AND_ASSIGN_OP:
-                {
-                    Variable a = variable(program[1], true, true);
-                    a.setValue(a.value() & rightValue(program[2]).value());
-                    return a;
-                }
-
-                case HMC_XOR_ASSIGN_OP:
-                {
-                    Variable a = variable(program[1], true, true);
-                    a.setValue(a.value() ^ rightValue(program[2]).value());
-                    return a;
-                }
-
-                case HMC_OR_ASSIGN_OP:
-                {
-                    Variable a = variable(program[1], true, true);
-                    a.setValue(a.value() | rightValue(program[2]).value());
-                    return a;
-                }
-
-                case HMC_NOT_OP:
-                    return collector().copy(!rightValue(program[1]).value());
-
-                case HMC_BITWISE_NOT_OP:
-                    return collector().copy(~rightValue(program[1]).value());
-
-                case HMC_OPP_OP:
-                    return collector().copy(-rightValue(program[1]).value());
-
-                case HMC_OR_OP:
-                    return collector().copy(rightValue(program[1]).value() || rightValue(program[2]).value());
-
-                case HMC_AND_OP:
-                    return collector().copy(rightValue(program[1]).value() && rightValue(program[2]).value());
-
-                case HMC_BITWISE_OR_OP:
-                    return collector().copy(rightValue(program[1]).value() | rightValue(program[2]).value());
-
-                case HMC_BITWISE_XOR_OP:
-                    return collector().copy(rightValue(program[1]).value() ^ rightValue(program[2]).value());
-
-                case HMC_BITWISE_AND_OP:
-                    return collector().copy(rightValue(program[1]).value() & rightValue(program[2]).value());
-
-                case HMC_EQ_OP:
-                    return collector().copy(rightValue(program[1]).value() == rightValue(program[2]).value());
-
-                case HMC_NE_OP:
-                    return collector().copy(rightValue(program[1]).value() != rightValue(program[2]).value());
-
-                case HMC_GE_OP:
-                    return collector().copy(rightValue(program[1]).value() >= rightValue(program[2]).value());
-
-                case HMC_GT_OP:
-                    return collector().copy(rightValue(program[1]).value() > rightValue(program[2]).value());
-
-                case HMC_LE_OP:
-                    return collector().copy(rightValue(program[1]).value() <= rightValue(program[2]).value());
-
-                case HMC_LT_OP:
-                    return collector().copy(rightValue(program[1]).value() < rightValue(program[2]).value());
-
-                case HMC_RIGHT_OP:
-                    return collector().copy(rightValue(program[1]).value() >> rightValue(program[2]).value());
-
-                case HMC_LEFT_OP:
-                    return collector().copy(rightValue(program[1]).value() << rightValue(program[2]).value());
-
-                case HMC_ADD_OP:
-                    return collector().copy(rightValue(program[1]).value() + rightValue(program[2]).value());
-
-                case HMC_SUB_OP:
-                    return collector().copy(rightValue(program[1]).value() - rightValue(program[2]).value());
-
-                case HMC_MUL_OP:
-                    return collector().copy(rightValue(program[1]).value() * rightValue(program[2]).value());
-
-                case HMC_DIV_OP:
-                    return collector().copy(rightValue(program[1]).value() / rightValue(program[2]).value());
-
-                case HMC_MOD_OP:
-                    return collector().copy(rightValue(program[1]).value() % rightValue(program[2]).value());
-
-                case HMC_TERNARY_OP:
-                {
-                    const int index = rightValue(program[1]).value().toBool() ? 2 : 3;
-                    return collector().copy(rightValue(program[index]).value());
-                }
-
-                default:
-                    return Variable();
-            }
-        }
-
-        case HMC_FIELD_ASSIGN:
-            return assignField(first[0], first[1]);
-
-        case HMC_INT_CONSTANT:
-        case HMC_UINT_CONSTANT:
-        case HMC_STRING_CONSTANT:
-        case HMC_FLOAT_CONSTANT:
-            return collector().copy(first.payload());
-
-        case HMC_NULL_CONSTANT:
-            return collector().null();
-
-        case HMC_UNDEFINED_CONSTANT:
-            return Variable();
-
-        case HMC_EMPTY_STRING_CONSTANT:
-            return collector().copy(emptyString);
-
-        case HMC_VARIABLE:
-            return variable(first, modifiable, createIfNeeded);
-
-        case HMC_TYPE:
-            return collector().copy(type(first));
-
-        case HMC_ARRAY_SCOPE:
-            return arrayScope(first);
-
-        case HMC_MAP_SCOPE:
-            return mapScope(first);
-
-        case HMC_METHOD_EVALUATION:
-            return methodEvaluation(first);
-
-    }
-    return Variable();
-}
-
-VariablePath Evaluator::variablePath(const Program &program) const
-{
-    VariablePath path;
-    for(Program elem : program)
-    {
-        switch(elem.tag())
-        {
-            case HMC_IDENTIFIER:
-                path.push_back(elem.payload());
-                break;
-
-            case HMC_RIGHT_VALUE:
-                path.push_back(rightValue(elem).value());
-                break;
-
-            case HMC_TYPE:
-                path.push_back(type(elem));
-                break;
-
-            default:
-                break;
-        }
-    }
-    return path;
-}
-
-ObjectType Evaluator::type(const Program &program) const
-{
-    const std::string& name = program.node(0).payload().toString();
-    ObjectType type = module.getType(name);
-    if(type.isNull())
-    {
-        Log::error("Type not found ", name);
-        return type;
-    }
-
-    Program arguments = program.node(1);
-    for(int i = 0; i < arguments.size(); ++i)
-    {
-        if(arguments.node(i).tag() == HMC_RIGHT_VALUE)
-        {
-            type.setParameter(i, rightValue(arguments.node(i)).value());
-        }
-    }
-    return type;
-}
-
-std::shared_ptr<ObjectType> Evaluator::sharedType(const Program &program) const
-{
-    const std::string& name = program.node(0).payload().toString();
-    auto type = module.getSharedType(name);
-    if(type->isNull())
-    {
-        Log::error("Type not found ", name);
-        return type;
-    }
-
-    Program arguments = program.node(1);
-    for(int i = 0; i < arguments.size(); ++i)
-    {
-        if(arguments.node(i).tag() == HMC_RIGHT_VALUE)
-        {
-            type->setParameter(i, rightValue(arguments.node(i)).value());
-        }
-    }
-    return type;
-}
-
-VariableCollector &Evaluator::collector() const
-{
-    return scope.collector();
-}
-
-Variable Evaluator::variable(const Program &program, bool modifiable, bool createIfNeeded) const
-{
-    return scope.field(variablePath(program), modifiable, createIfNeeded);
-}
-
-Variable Evaluator::assignField(const Program &pathProgram, const Program &rightValueProgram) const
-{
-    Variable value = rightValue(rightValueProgram, true);
-
-    value.setConstant();
-
-    scope.setField(variablePath(pathProgram), value);
-
-    return value;
-}
-
-Variable Evaluator::arrayScope(const Program &program) const
-{
-    ArrayScope* arrayScope = new ArrayScope(collector());
-    for (const Program& item : program) {
-        arrayScope->addField(rightValue(item));
-    }
-
-    return Variable(arrayScope, true);
-}
-
-Variable Evaluator::mapScope(const Program &program) const
-{
-    MapScope* mapScope = new MapScope(collector());
-    for (const Program& item : program) {
-        mapScope->setField(item[0].payload(), rightValue(item[1], true));
-    }
-
-    return Variable(mapScope, true);
-}
-
-Variable Evaluator::methodEvaluation(const Program &program) const
-{
-    VariableArgs args;
-    for (const auto& arg : program.node(1)) {
-        args.emplace_back(rightValue(arg));
-    }
-
-    VariableKeywordArgs kwargs;
-    for (const auto& entry : program.node(3)) {
-        kwargs[entry.node(0).payload().toString()] = rightValue(entry.node(1));
-    }
-
-    return rightValue(program.node(0)).call(args, kwargs);
-}
+#include "evaluator.h"
+
+#include "compiler/model.h"
+#include "core/log/logmanager.h"
+#include "core/interpreter/evaluator.h"
+#include "core/interpreter/program.h"
+#include "core/interpreter/scriptprofiler.h"
+#include "core/util/unused.h"
+#include "core/variable/arrayscope.h"
+#include "core/variable/mapscope.h"
+
+const Variant emptyString("");
+const Module emptyModule;
+
+
+Evaluator::Evaluator(const Variable &scope)
+    : scope(scope),
+      module(emptyModule)
+{
+    UNUSED(hmcElemNames);
+}
+
+Evaluator::Evaluator(const Variable& scope, const Module &module)
+    : scope(scope),
+      module(module)
+{
+}
+
+Variable Evaluator::rightValue(const Program &program, int modifiable, int createIfNeeded) const
+{
+    Program first = program.node(0);
+    switch(first.tag())
+    {
+        case HMC_OPERATOR:
+        {
+            const int op = first.payload().toInteger();
+
+            switch(op) {
+                case HMC_PRE_INC_OP:
+                {
+                    Variable a = variable(program[1], true, true);
+                    a.setValue(a.value()+1);
+                    return a;
+                }
+
+                case HMC_PRE_DEC_OP:
+                {
+                    Variable a = variable(program[1], true, true);
+                    a.setValue(a.value()-1);
+                    return a;
+                }
+
+                case HMC_ASSIGN_OP:
+                {
+                    Variable a = variable(program[1], true, true);
+                    a.setValue(value(program[2]));
+                    return a;
+                }
+
+                case HMC_RIGHT_ASSIGN_OP:
+                {
+                    Variable a = variable(program[1], true, true);
+                    a.setValue(a.value() >> value(program[2]));
+                    return a;
+                }
+
+                case HMC_LEFT_ASSIGN_OP:
+                {
+                    Variable a = variable(program[1], true, true);
+                    a.setValue(a.value() << value(program[2]));
+                    return a;
+                }
+
+                case HMC_ADD_ASSIGN_OP:
+                {
+                    Variable a = variable(program[1], true, true);
+                    a.setValue(a.value() + value(program[2]));
+                    return a;
+                }
+
+                case HMC_SUB_ASSIGN_OP:
+                {
+                    Variable a = variable(program[1], true, true);
+                    a.setValue(a.value() - value(program[2]));
+                    return a;
+                }
+
+                case HMC_MUL_ASSIGN_OP:
+                {
+                    Variable a = variable(program[1], true, true);
+                    a.setValue(a.value() * value(program[2]));
+                    return a;
+                }
+
+                case HMC_DIV_ASSIGN_OP:
+                {
+                    Variable a = variable(program[1], true, true);
+                    a.setValue(a.value() / value(program[2]));
+                    return a;
+                }
+
+                case HMC_MOD_ASSIGN_OP:
+                {
+                    Variable a = variable(program[1], true, true);
+                    a.setValue(a.value() % value(program[2]));
+                    return a;
+                }
+
+                case HMC_AND_ASSIGN_OP:
+                {
+                    Variable a = variable(program[1], true, true);
+                    a.setValue(a.value() & value(program[2]));
+                    return a;
+                }
+
+                case HMC_XOR_ASSIGN_OP:
+                {
+                    Variable a = variable(program[1], true, true);
+                    a.setValue(a.value() ^ value(program[2]));
+                    return a;
+                }
+
+                case HMC_OR_ASSIGN_OP:
+                {
+                    Variable a = variable(program[1], true, true);
+                    a.setValue(a.value() | value(program[2]));
+                    return a;
+                }
+
+                case HMC_SUF_INC_OP:
+                case HMC_SUF_DEC_OP:
+                case HMC_NOT_OP:
+                case HMC_BITWISE_NOT_OP:
+                case HMC_OPP_OP:
+                case HMC_OR_OP:
+                case HMC_AND_OP:
+                case HMC_BITWISE_OR_OP:
+                case HMC_BITWISE_XOR_OP:
+                case HMC_BITWISE_AND_OP:
+                case HMC_EQ_OP:
+                case HMC_NE_OP:
+                case HMC_GE_OP:
+                case HMC_GT_OP:
+                case HMC_LE_OP:
+                case HMC_LT_OP:
+                case HMC_RIGHT_OP:
+                case HMC_LEFT_OP:
+                case HMC_ADD_OP:
+                case HMC_SUB_OP:
+                case HMC_MUL_OP:
+                case HMC_DIV_OP:
+                case HMC_MOD_OP:
+                case HMC_TERNARY_OP:
+                    //The result is a new value, only boxed here because it escapes
+                    return collector().copy(value(program));
+
+                default:
+                    return Variable();
+            }
+        }
+
+        case HMC_FIELD_ASSIGN:
+            return assignField(first[0], first[1]);
+
+        case HMC_INT_CONSTANT:
+        case HMC_UINT_CONSTANT:
+        case HMC_STRING_CONSTANT:
+        case HMC_FLOAT_CONSTANT:
+            return collector().copy(first.payload());
+
+        case HMC_NULL_CONSTANT:
+            return collector().null();
+
+        case HMC_UNDEFINED_CONSTANT:
+            return Variable();
+
+        case HMC_EMPTY_STRING_CONSTANT:
+            return collector().copy(emptyString);
+
+        case HMC_VARIABLE:
+            return variable(first, modifiable, createIfNeeded);
+
+        case HMC_TYPE:
+            return collector().copy(type(first));
+
+        case HMC_ARRAY_SCOPE:
+            return arrayScope(first);
+
+        case HMC_MAP_SCOPE:
+            return mapScope(first);
+
+        case HMC_METHOD_EVALUATION:
+            return methodEvaluation(first);
+
+    }
+    return Variable();
+}
+
+Variant Evaluator::value(const Program &program) const
+{
+    Program first = program.node(0);
+    switch(first.tag())
+    {
+        case HMC_OPERATOR:
+        {
+            const int op = first.payload().toInteger();
+
+            switch(op) {
+                case HMC_SUF_INC_OP:
+                {
+                    Variable a = variable(program[1], true, true);
+                    const Variant value = a.value();
+                    a.setValue(value + 1);
+                    return value;
+                }
+
+                case HMC_SUF_DEC_OP:
+                {
+                    Variable a = variable(program[1], true, true);
+                    const Variant value = a.value();
+                    a.setValue(value - 1);
+                    return value;
+                }
+
+                case HMC_NOT_OP:
+                    return !value(program[1]);
+
+                case HMC_BITWISE_NOT_OP:
+                    return ~value(program[1]);
+
+                case HMC_OPP_OP:
+                    return -value(program[1]);
+
+                case HMC_OR_OP:
+                    return value(program[1]) || value(program[2]);
+
+                case HMC_AND_OP:
+                    return value(program[1]) && value(program[2]);
+
+                case HMC_BITWISE_OR_OP:
+                    return value(program[1]) | value(program[2]);
+
+                case HMC_BITWISE_XOR_OP:
+                    return value(program[1]) ^ value(program[2]);
+
+                case HMC_BITWISE_AND_OP:
+                    return value(program[1]) & value(program[2]);
+
+                case HMC_EQ_OP:
+                    return value(program[1]) == value(program[2]);
+
+                case HMC_NE_OP:
+                    return value(program[1]) != value(program[2]);
+
+                case HMC_GE_OP:
+                    return value(program[1]) >= value(program[2]);
+
+                case HMC_GT_OP:
+                    return value(program[1]) > value(program[2]);
+
+                case HMC_LE_OP:
+                    return value(program[1]) <= value(program[2]);
+
+                case HMC_LT_OP:
+                    return value(program[1]) < value(program[2]);
+
+                case HMC_RIGHT_OP:
+                    return value(program[1]) >> value(program[2]);
+
+                case HMC_LEFT_OP:
+                    return value(program[1]) << value(program[2]);
+
+                case HMC_ADD_OP:
+                    return value(program[1]) + value(program[2]);
+
+                case HMC_SUB_OP:
+                    return value(program[1]) - value(program[2]);
+
+                case HMC_MUL_OP:
+                    return value(program[1]) * value(program[2]);
+
+                case HMC_DIV_OP:
+                    return value(program[1]) / value(program[2]);
+
+                case HMC_MOD_OP:
+                    return value(program[1]) % value(program[2]);
+
+                case HMC_TERNARY_OP:
+                {
+                    const int index = value(program[1]).toBool() ? 2 : 3;
+                    return value(program[index]);
+                }
+
+                default:
+                    //Assignments evaluate to the variable assigned
+                    return rightValue(program).value();
+            }
+        }
+
+        case HMC_INT_CONSTANT:
+        case HMC_UINT_CONSTANT:
+        case HMC_STRING_CONSTANT:
+        case HMC_FLOAT_CONSTANT:
+            return first.payload();
+
+        case HMC_NULL_CONSTANT:
+            return Variant::null();
+
+        case HMC_UNDEFINED_CONSTANT:
+            return Variant();
+
+        case HMC_EMPTY_STRING_CONSTANT:
+            return emptyString;
+
+        case HMC_TYPE:
+            return type(first);
+
+        default:
+            return rightValue(program).value();
+    }
+}
+
+VariablePath Evaluator::variablePath(const Program &program) const
+{
+    VariablePath path;
+    for(Program elem : program)
+    {
+        switch(elem.tag())
+        {
+            case HMC_IDENTIFIER:
+                path.push_back(elem.payload());
+                break;
+
+            case HMC_RIGHT_VALUE:
+                path.push_back(value(elem));
+                break;
+
+            case HMC_TYPE:
+                path.push_back(type(elem));
+                break;
+
+            default:
+                break;
+        }
+    }
+    return path;
+}
+
+ObjectType Evaluator::type(const Program &program) const
+{
+    const std::string& name = program.node(0).payload().toString();
+    ObjectType type = module.getType(name);
+    if(type.isNull())
+    {
+        Log::error("Type not found ", name);
+        return type;
+    }
+
+    Program arguments = program.node(1);
+    for(int i = 0; i < arguments.size(); ++i)
+    {
+        if(arguments.node(i).tag() == HMC_RIGHT_VALUE)
+        {
+            type.setParameter(i, value(arguments.node(i)));
+        }
+    }
+    return type;
+}
+
+std::shared_ptr<ObjectType> Evaluator::sharedType(const Program &program) const
+{
+    const std::string& name = program.node(0).payload().toString();
+    auto type = module.getSharedType(name);
+    if(type->isNull())
+    {
+        Log::error("Type not found ", name);
+        return type;
+    }
+
+    Program arguments = program.node(1);
+    for(int i = 0; i < arguments.size(); ++i)
+    {
+        if(arguments.node(i).tag() == HMC_RIGHT_VALUE)
+        {
+            type->setParameter(i, value(arguments.node(i)));
+        }
+    }
+    return type;
+}
+
+bool Evaluator::isPure(const Program &program, const Module &module, bool localAssignments)
+{
+    Program::Analysis& analysis = program.analysis();
+    if (analysis.purityModule != &module) {
+        analysis.purityModule = &module;
+        analysis.isPure[0] = analysis.isPure[1] = Program::Analysis::State::unknown;
+    }
+
+    Program::Analysis::State& state = analysis.isPure[localAssignments];
+    if (state == Program::Analysis::State::unknown) {
+        state = computeIsPure(program, module, localAssignments) ? Program::Analysis::State::yes : Program::Analysis::State::no;
+    }
+    return state == Program::Analysis::State::yes;
+}
+
+bool Evaluator::computeIsPure(const Program &program, const Module &module, bool localAssignments)
+{
+    switch (program.tag()) {
+        case HMC_OPERATOR:
+            switch (program.payload().toInteger()) {
+                case HMC_ASSIGN_OP:
+                case HMC_RIGHT_ASSIGN_OP:
+                case HMC_LEFT_ASSIGN_OP:
+                case HMC_ADD_ASSIGN_OP:
+                case HMC_SUB_ASSIGN_OP:
+                case HMC_MUL_ASSIGN_OP:
+                case HMC_DIV_ASSIGN_OP:
+                case HMC_MOD_ASSIGN_OP:
+                case HMC_AND_ASSIGN_OP:
+                case HMC_XOR_ASSIGN_OP:
+                case HMC_OR_ASSIGN_OP:
+                case HMC_PRE_INC_OP:
+                case HMC_PRE_DEC_OP:
+                case HMC_SUF_INC_OP:
+                case HMC_SUF_DEC_OP:
+                    return localAssignments;
+
+                case HMC_ADD_MAGIC_NUMBER_OP:
+                case HMC_ADD_EXTENSION_OP:
+                case HMC_ADD_SYNCBYTE_OP:
+                    return false;
+
+                default:
+                    return true;
+            }
+
+        case HMC_FIELD_ASSIGN:
+        case HMC_REMOVE:
+            if (!localAssignments) {
+                return false;
+            }
+            break;
+
+        case HMC_DECLARATION:
+        case HMC_FORWARD:
+            return false;
+
+        case HMC_METHOD_EVALUATION:
+        {
+            //Only methods called by their name can be resolved statically
+            const Program callee = program.node(0).node(0);
+            if (callee.tag() != HMC_VARIABLE || callee.size() != 1 || callee.node(0).tag() != HMC_IDENTIFIER) {
+                return false;
+            }
+
+            const ModuleMethod* method = module.getMethod(callee.node(0).payload().toString());
+            if (method == nullptr || !method->isPure()) {
+                return false;
+            }
+            break;
+        }
+    }
+
+    if (hmcElemTypes[program.tag()] == HMC_MASTER) {
+        for (const Program& child : program) {
+            if (!computeIsPure(child, module, localAssignments)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+VariableCollector &Evaluator::collector() const
+{
+    return scope.collector();
+}
+
+Variable Evaluator::variable(const Program &program, bool modifiable, bool createIfNeeded) const
+{
+    return scope.field(variablePath(program), modifiable, createIfNeeded);
+}
+
+Variable Evaluator::assignField(const Program &pathProgram, const Program &rightValueProgram) const
+{
+    Variable value = rightValue(rightValueProgram, true);
+
+    value.setConstant();
+
+    scope.setField(variablePath(pathProgram), value);
+
+    return value;
+}
+
+Variable Evaluator::arrayScope(const Program &program) const
+{
+    ArrayScope* arrayScope = new ArrayScope(collector());
+    for (const Program& item : program) {
+        arrayScope->addField(rightValue(item));
+    }
+
+    return Variable(arrayScope, true);
+}
+
+Variable Evaluator::mapScope(const Program &program) const
+{
+    MapScope* mapScope = new MapScope(collector());
+    for (const Program& item : program) {
+        mapScope->setField(item[0].payload(), rightValue(item[1], true));
+    }
+
+    return Variable(mapScope, true);
+}
+
+Variable Evaluator::methodEvaluation(const Program &program) const
+{
+    ScriptProfiler::Scope scope(program, ScriptProfiler::call);
+    VariableArgs args;
+    for (const auto& arg : program.node(1)) {
+        args.emplace_back(rightValue(arg));
+    }
+
+    VariableKeywordArgs kwargs;
+    for (const auto& entry : program.node(3)) {
+        kwargs[entry.node(0).payload().toString()] = rightValue(entry.node(1));
+    }
+
+    return rightValue(program.node(0)).call(args, kwargs);
+}
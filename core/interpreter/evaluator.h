@@ -21,6 +21,15 @@ public:
      */
     Variable rightValue(const Program& program, int modifiable = false, int createIfNeeded = false ) const;
 
+    /**
+     * @brief Evaluate the value of a right value tagged \link Program program node\endlink
+     *
+     * Same as the value of \link Evaluator::rightValue rightValue\endlink, but the
+     * intermediate results and the constants are kept as plain \link Variant variants\endlink
+     * instead of being copied into \link Variable variables\endlink.
+     */
+    Variant value(const Program& program) const;
+
     /**
      * @brief Get the \link VariablePath variable path\endlink of a variable
      * tagged \link Program program node\endlink.
@@ -32,7 +41,19 @@ public:
      */
     ObjectType type(const Program& program) const;
     std::shared_ptr<ObjectType> sharedType(const Program& program) const;
+
+    /**
+     * @brief Check statically that evaluating the \link Program program node\endlink has no side effect
+     *
+     * Every method called must be known by the \link Module module\endlink and pure. If localAssignments
+     * is false, assignments are forbidden as well, otherwise they are assumed to modify local variables only.
+     * The result is stored in the \link Program::Analysis analysis\endlink of the node.
+     */
+    static bool isPure(const Program& program, const Module& module, bool localAssignments = false);
+
 private:
+    static bool computeIsPure(const Program& program, const Module& module, bool localAssignments);
+
     VariableCollector& collector() const;
 
     Variable variable(const Program& program, bool modifiable, bool createIfNeeded) const;
@@ -15,17 +15,24 @@
 //along with this program; if not, write to the Free Software
 //Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
+#include "compiler/model.h"
 #include "core/object.h"
 #include "core/parser.h"
 #include "core/objecttypetemplate.h"
+#include "core/interpreter/bytecode.h"
 #include "core/interpreter/filter.h"
 #include "core/interpreter/programloader.h"
+#include "core/interpreter/virtualmachine.h"
 #include "core/variable/variable.h"
 #include "core/variable/objectscope.h"
 #include "core/variable/variablecollector.h"
+#include "core/util/unused.h"
 
-Filter::Filter(const ProgramLoader& programLoader): _programLoader(programLoader)
+Filter::Filter(const ProgramLoader& programLoader)
+    : _programLoader(programLoader),
+      _pushedDown(false)
 {
+    UNUSED(hmcElemNames);
 }
 
 bool Filter::setExpression(const std::string &expression)
@@ -40,12 +47,9 @@ bool Filter::setExpression(const std::string &expression)
 
     if(_program.isValid() && _program.size() > 0)
     {
-        _program = _program.node(0);
-        if(_program.isValid())
-        {
-            _expression = expression;
-            return true;
-        }
+        _expression = expression;
+        _pushedDown = isPushable(_program.node(0));
+        return true;
     }
 
     _expression = "";
@@ -57,17 +61,179 @@ const std::string &Filter::expression()
     return _expression;
 }
 
+bool Filter::pushedDown() const
+{
+    return _pushedDown;
+}
+
 bool Filter::operator()(Object& object)
 {
     if(_expression != "") {
-        Variable objectVariable = object.variable();
-        VariableCollectionGuard collectionGuard(objectVariable.collector());
-
-        objectVariable.setConstant();
-        const bool result = Evaluator(objectVariable).rightValue(_program).value().toBool();
-        return result;
+        VariableCollectionGuard collectionGuard(object.collector());
+        return matches(object);
     } else {
         return true;
     }
 }
 
+void Filter::select(Object &object, int64_t begin, int64_t end, std::vector<Object *> &matches)
+{
+    VariableCollectionGuard collectionGuard(object.collector());
+    for(int64_t i = begin; i < end; ++i)
+    {
+        Object* child = object.access(i);
+        if(child != nullptr && (_expression == "" || this->matches(*child)))
+        {
+            matches.push_back(child);
+        }
+    }
+}
+
+bool Filter::matches(Object &object)
+{
+    if(_pushedDown) {
+        return value(_program.node(0), object).toBool();
+    }
+
+    Variable objectVariable = object.variable();
+    objectVariable.setConstant();
+    return Evaluator(objectVariable).value(_program.node(0)).toBool();
+}
+
+bool Filter::isPushable(const Program &rightValue)
+{
+    const Program first = rightValue.node(0);
+    switch(first.tag())
+    {
+        case HMC_OPERATOR:
+        {
+            const int op = first.payload().toInteger();
+            if(op < HMC_OR_OP || op > HMC_TERNARY_OP
+            || (op >= HMC_PRE_INC_OP && op <= HMC_ADD_SYNCBYTE_OP)) {
+                return false;
+            }
+            for(int i = 1; i < rightValue.size(); ++i) {
+                if(!isPushable(rightValue.node(i))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        case HMC_INT_CONSTANT:
+        case HMC_UINT_CONSTANT:
+        case HMC_STRING_CONSTANT:
+        case HMC_FLOAT_CONSTANT:
+        case HMC_NULL_CONSTANT:
+        case HMC_UNDEFINED_CONSTANT:
+        case HMC_EMPTY_STRING_CONSTANT:
+            return true;
+
+        case HMC_VARIABLE:
+            return isPushableField(first);
+
+        default:
+            return false;
+    }
+}
+
+bool Filter::isPushableField(const Program &variable)
+{
+    //Names of children, the last one may be a reserved field with a plain value
+    for(int i = 0; i < variable.size(); ++i) {
+        const Program elem = variable.node(i);
+        if(elem.tag() != HMC_IDENTIFIER) {
+            return false;
+        }
+
+        const std::string& name = elem.payload().toString();
+        if(name[0] == '@'
+        && (i != variable.size() - 1
+            || (name != "@value" && name != "@size" && name != "@pos" && name != "@rank" && name != "@beginningPos"))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Variant Filter::value(const Program &rightValue, Object &object)
+{
+    const Program first = rightValue.node(0);
+    switch(first.tag())
+    {
+        case HMC_OPERATOR:
+        {
+            const int op = first.payload().toInteger();
+            switch(op) {
+                case HMC_NOT_OP:
+                    return !value(rightValue[1], object);
+
+                case HMC_BITWISE_NOT_OP:
+                    return ~value(rightValue[1], object);
+
+                case HMC_OPP_OP:
+                    return -value(rightValue[1], object);
+
+                //Only the operands deciding of the result are read, the others may need parsing
+                case HMC_OR_OP:
+                    return value(rightValue[1], object).toBool() || value(rightValue[2], object).toBool();
+
+                case HMC_AND_OP:
+                    return value(rightValue[1], object).toBool() && value(rightValue[2], object).toBool();
+
+                case HMC_TERNARY_OP:
+                    return value(rightValue[value(rightValue[1], object).toBool() ? 2 : 3], object);
+
+                default:
+                {
+                    //Same operations as the virtual machine and the constant folding
+                    Bytecode::OpCode opCode;
+                    if(!Bytecode::binaryOpCode(op, opCode)) {
+                        return Variant();
+                    }
+                    return VirtualMachine::binary(opCode, value(rightValue[1], object), value(rightValue[2], object));
+                }
+            }
+        }
+
+        case HMC_NULL_CONSTANT:
+            return Variant::null();
+
+        case HMC_UNDEFINED_CONSTANT:
+            return Variant();
+
+        case HMC_EMPTY_STRING_CONSTANT:
+            return Variant("");
+
+        case HMC_VARIABLE:
+            return fieldValue(first, object);
+
+        default:
+            return first.payload();
+    }
+}
+
+Variant Filter::fieldValue(const Program &variable, Object &object)
+{
+    //Same look up as the scope of the object, parsing the children until found
+    Object* current = &object;
+    for(int i = 0; i < variable.size(); ++i) {
+        const std::string& name = variable.node(i).payload().toString();
+        if(name == "@size") {
+            return Variant((long long) current->size());
+        } else if(name == "@pos") {
+            return Variant((long long) current->pos());
+        } else if(name == "@rank") {
+            return Variant(current->rank());
+        } else if(name == "@beginningPos") {
+            return Variant((long long) current->beginningPos());
+        } else if(name != "@value") {
+            current = current->lookUp(name, true);
+            if(current == nullptr) {
+                return Variant();
+            }
+        }
+    }
+    return current->value();
+}
+
@@ -20,6 +20,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "core/parser.h"
 #include "core/interpreter/programloader.h"
@@ -30,6 +31,12 @@ class Object;
 
 /**
  * @brief Evaluate an HMDL statement on an object
+ *
+ * When the expression only combines constants with fields of the object looked up
+ * by name (e.g. "PID == 256" or "header.type != 0 && @size > 64"), it is pushed down :
+ * only the fields referenced are read, as plain \link Variant values\endlink, without
+ * building any \link Variable variable\endlink. Other expressions are evaluated by an
+ * \link Evaluator evaluator\endlink on the scope of the object.
  */
 class Filter
 {
@@ -39,12 +46,33 @@ public:
     bool setExpression(const std::string& expression);
     const std::string& expression();
 
+    /**
+     * @brief Check if the expression is evaluated on the fields read only
+     */
+    bool pushedDown() const;
+
     bool operator()(Object &object);
 
+    /**
+     * @brief Append the children of the object in [begin, end) matching the expression
+     *
+     * The whole batch shares a single collection of the variables, instead of one per child.
+     */
+    void select(Object& object, int64_t begin, int64_t end, std::vector<Object*>& matches);
+
 private:
+    bool matches(Object& object);
+
+    static bool isPushable(const Program& rightValue);
+    static bool isPushableField(const Program& variable);
+    static Variant value(const Program& rightValue, Object& object);
+    static Variant fieldValue(const Program& variable, Object& object);
+
     const ProgramLoader& _programLoader;
+    /// Root of the compiled expression, which owns the right value evaluated
     Program _program;
     std::string _expression;
+    bool _pushedDown;
 };
 
 #endif // FILTER_H
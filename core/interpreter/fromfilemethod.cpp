@@ -2,15 +2,52 @@
 
 #include "core/interpreter/blockexecution.h"
 #include "core/interpreter/evaluator.h"
+#include "core/interpreter/virtualmachine.h"
 
 #include "core/variable/localscope.h"
 #include "core/variable/methodscope.h"
 
 Variable FromFileMethod::call(VariableArgs &args, VariableKeywordArgs &kwargs, VariableCollector &collector) const
+{
+    const std::shared_ptr<const Bytecode>& bytecode = code();
+    if (!bytecode || !Bytecode::enabled()) {
+        return interpret(args, kwargs, collector);
+    }
+
+    fillNumberedArgs(args, kwargs, collector);
+
+    Frame frame = acquireFrame();
+
+    MethodScope arguments(args, kwargs, collector);
+    arguments.setExternal();
+    LocalScope locals(Variable(&arguments, true), _module, bytecode->localSlots(), std::move(frame.slots));
+    locals.setExternal();
+
+    //In reverse so that the first of parameters sharing a name wins, as with keyword arguments
+    for (size_t i = _parameterSlots.size(); i-- > 0;) {
+        locals.setSlot(_parameterSlots[i], args[i]);
+    }
+
+    Variable returnValue;
+    {
+        Variable scope(&locals, true);
+        VirtualMachine machine(bytecode, scope, locals, _module, std::move(frame.registers));
+        machine.execute();
+        returnValue = machine.returnValue();
+        frame.registers = machine.releaseRegisters();
+    }
+
+    frame.slots = locals.releaseSlots();
+    releaseFrame(std::move(frame));
+    return returnValue;
+}
+
+Variable FromFileMethod::interpret(VariableArgs &args, VariableKeywordArgs &kwargs, VariableCollector &collector) const
 {
     fillArgs(args, kwargs, collector);
 
-    Variable scope(new LocalScope(Variable(new MethodScope(args, kwargs, collector), true), _module), true);
+    LocalScope* locals = new LocalScope(Variable(new MethodScope(args, kwargs, collector), true), _module);
+    Variable scope(locals, true);
 
     Evaluator eval(scope, _module);
     BlockExecution blockExecution(_definition, eval, scope, nullptr);
@@ -19,3 +56,78 @@ Variable FromFileMethod::call(VariableArgs &args, VariableKeywordArgs &kwargs, V
 
     return blockExecution.returnValue();
 }
+
+const std::shared_ptr<const Bytecode> &FromFileMethod::code() const
+{
+    std::call_once(_compiled, [this] {
+        std::shared_ptr<LocalScope::Slots> localSlots = std::make_shared<LocalScope::Slots>();
+        for (const MethodArgument& argument : signature()) {
+            _parameterSlots.push_back(localSlots->add(argument.name()));
+        }
+        Bytecode::bindLocals(_definition, *localSlots);
+
+        _code = Bytecode::compile(_definition, false, localSlots, nullptr, &_module);
+    });
+    return _code;
+}
+
+std::vector<FromFileMethod::Frame> &FromFileMethod::threadFrames()
+{
+    static thread_local std::vector<Frame> frames;
+    return frames;
+}
+
+FromFileMethod::Frame FromFileMethod::acquireFrame()
+{
+    std::vector<Frame>& frames = threadFrames();
+    if (frames.empty()) {
+        return Frame();
+    }
+
+    Frame frame = std::move(frames.back());
+    frames.pop_back();
+    return frame;
+}
+
+void FromFileMethod::releaseFrame(Frame &&frame)
+{
+    threadFrames().push_back(std::move(frame));
+}
+
+bool FromFileMethod::isPure() const
+{
+    switch (_purity) {
+        case Purity::pure:
+            return true;
+
+        case Purity::impure:
+            return false;
+
+        case Purity::computing:
+            //Recursive methods are conservatively considered impure
+            return false;
+
+        case Purity::unknown:
+            break;
+    }
+
+    _purity = Purity::computing;
+    const Purity purity = Evaluator::isPure(_definition, _module, true) ? Purity::pure : Purity::impure;
+    _purity = purity;
+    return purity == Purity::pure;
+}
+
+const FromFileMethod *FromFileMethod::script() const
+{
+    return this;
+}
+
+const Program &FromFileMethod::definition() const
+{
+    return _definition;
+}
+
+const Module &FromFileMethod::module() const
+{
+    return _module;
+}
@@ -1,9 +1,15 @@
 #ifndef FROMFILEMETHOD_H
 #define FROMFILEMETHOD_H
 
+#include <atomic>
+#include <mutex>
+
 #include "core/modulemethod.h"
 
 #include "core/interpreter/program.h"
+#include "core/interpreter/bytecode.h"
+#include "core/interpreter/virtualmachine.h"
+#include "core/variable/localscope.h"
 
 class FromFileMethod : public ModuleMethod
 {
@@ -12,15 +18,67 @@ public:
     FromFileMethod(Program definition, TSignature&& signature, const Module& module)
         : ModuleMethod(signature),
           _definition(definition),
-          _module(module)
+          _module(module),
+          _purity(Purity::unknown)
     {
     }
 
+    /**
+     * @brief Execute the definition in a frame taken from the pool of the thread
+     *
+     * The scopes of the frame live on the stack and the storage of their slots and of the
+     * registers is reused from a call to the next, so that a call doesn't allocate. The storage
+     * fits any method, the pool is shared by the methods called from the same thread.
+     */
     virtual Variable call(VariableArgs& args, VariableKeywordArgs& kwargs, VariableCollector& collector) const override;
 
+    /**
+     * @brief The method is pure if it only calls pure methods, its assignments are local
+     *
+     * Computed on first use, once all the methods of the module are known.
+     */
+    virtual bool isPure() const override;
+
+    virtual const FromFileMethod* script() const override;
+
+    const Program& definition() const;
+    const Module& module() const;
+
 private:
+    /**
+     * @brief Storage released by a call, kept for the next ones
+     */
+    struct Frame
+    {
+        std::vector<LocalScope::Slot> slots;
+        VirtualMachine::Registers registers;
+    };
+
+    Variable interpret(VariableArgs& args, VariableKeywordArgs& kwargs, VariableCollector& collector) const;
+    /// One frame per call in progress at most in the thread, recursive calls included
+    static std::vector<Frame>& threadFrames();
+    static Frame acquireFrame();
+    static void releaseFrame(Frame&& frame);
+
+    /**
+     * @brief Compiled on first call, once all the methods of the module are known, by a single thread
+     */
+    const std::shared_ptr<const Bytecode>& code() const;
+
+    enum class Purity {
+        unknown,
+        computing,
+        pure,
+        impure
+    };
+
     Program _definition;
     const Module& _module;
+    mutable std::shared_ptr<const Bytecode> _code;
+    /// The parameters are bound to the first local slots, set from the arguments on call
+    mutable std::vector<int> _parameterSlots;
+    mutable std::once_flag _compiled;
+    mutable std::atomic<Purity> _purity;
 };
 
 #endif // FROMFILEMETHOD_H
@@ -49,23 +49,41 @@ const std::vector<Variant> emptyParameterDefaults;
 
 FromFileModule::FromFileModule(Program program)
     : _program(program),
+      _programLoader(nullptr),
+      _scope(_collector.null()),
+      _evaluator(_scope, *this)
+{
+    UNUSED(hmcElemNames);
+    if(program.isValid())
+    {
+        Program formatDetections = program.node(0);
+        loadFormatDetections(formatDetections);
+    }
+}
+
+FromFileModule::FromFileModule(const ProgramLoader &programLoader, const std::string &basePath, const FormatDetections &formatDetections)
+    : _programLoader(&programLoader),
+      _basePath(basePath),
+      _formatDetections(formatDetections),
       _scope(_collector.null()),
       _evaluator(_scope, *this)
 {
     UNUSED(hmcElemNames);
 }
 
+const FormatDetections &FromFileModule::formatDetections() const
+{
+    return _formatDetections;
+}
+
 void FromFileModule::addFormatDetection(StandardFormatDetector::Adder &formatAdder)
 {
-    if(program().isValid())
-    {
-        Program formatDetections = program().node(0);
-        loadFormatDetections(formatDetections, formatAdder);
-    }
+    _formatDetections.addTo(formatAdder);
 }
 
 void FromFileModule::requestImportations(std::vector<std::string> &formatRequested)
 {
+    loadProgram();
     if(program().isValid())
     {
         Program imports = program().node(1);
@@ -75,6 +93,7 @@ void FromFileModule::requestImportations(std::vector<std::string> &formatRequest
 
 bool FromFileModule::doLoad()
 {
+    loadProgram();
     if(!program().isValid())
         return false;
 
@@ -84,22 +103,31 @@ bool FromFileModule::doLoad()
     return true;
 }
 
-void FromFileModule::loadFormatDetections(Program &formatDetections, StandardFormatDetector::Adder &formatAdder)
+void FromFileModule::loadProgram()
+{
+    if(_programLoader != nullptr)
+    {
+        _program = _programLoader->fromFile(_basePath);
+        _programLoader = nullptr;
+    }
+}
+
+void FromFileModule::loadFormatDetections(Program &formatDetections)
 {
     for(Program formatDetection: formatDetections)
     {
         switch(formatDetection.node(0).payload().toInteger())
         {
             case HMC_ADD_MAGIC_NUMBER_OP:
-                formatAdder.addMagicNumber(formatDetection.node(1).payload().toString());
+                _formatDetections.magicNumbers.push_back(formatDetection.node(1).payload().toString());
                 break;
 
             case HMC_ADD_EXTENSION_OP:
-                formatAdder.addExtension(formatDetection.node(1).payload().toString());
+                _formatDetections.extensions.push_back(formatDetection.node(1).payload().toString());
                 break;
 
             case HMC_ADD_SYNCBYTE_OP:
-                formatAdder.addSyncbyte(formatDetection.node(1).payload().toInteger(), formatDetection.node(2).payload().toInteger());
+                _formatDetections.syncbytes.push_back(std::make_pair(formatDetection.node(1).payload().toInteger(), formatDetection.node(2).payload().toInteger()));
                 break;
 
             default:
@@ -130,16 +158,11 @@ void FromFileModule::nameScan(Program& declarations)
     std::cerr<<"Load templates :"<<std::endl;
 #endif
 
+    // Functions first: the templates compile their bodies on construction
+    // and bind the native calls they make to the methods known at that time
     for(Program declaration : declarations)
     {
-        if(declaration.tag() == HMC_CLASS_DECLARATION)
-        {
-            ObjectTypeTemplate& objectTypeTemplate = addTemplate(new FromFileTemplate(declaration, *this, _collector, _evaluator));
-#ifdef LOAD_TRACE
-            std::cerr<<"    "<<objectTypeTemplate<<std::endl;
-#endif
-        }
-        else if(declaration.tag() == HMC_FUNCTION_DECLARATION)
+        if(declaration.tag() == HMC_FUNCTION_DECLARATION)
         {
             const std::string& name = declaration.node(0).payload().toString();
             const Program& arguments = declaration.node(1);
@@ -149,11 +172,22 @@ void FromFileModule::nameScan(Program& declarations)
 
             for(const Program& argument: arguments)
             {
-                signature.emplace_back(MethodArgument(argument.node(1).payload().toString(), !argument.node(0).payload().toBool(), _evaluator.rightValue(argument.node(2)).value()));
+                signature.emplace_back(MethodArgument(argument.node(1).payload().toString(), !argument.node(0).payload().toBool(), _evaluator.value(argument.node(2))));
             }
             addMethod(name, new FromFileMethod(definition, signature, *this));
         }
     }
+
+    for(Program declaration : declarations)
+    {
+        if(declaration.tag() == HMC_CLASS_DECLARATION)
+        {
+            ObjectTypeTemplate& objectTypeTemplate = addTemplate(new FromFileTemplate(declaration, *this, _collector, _evaluator));
+#ifdef LOAD_TRACE
+            std::cerr<<"    "<<objectTypeTemplate<<std::endl;
+#endif
+        }
+    }
 #ifdef LOAD_TRACE
     std::cerr<<std::endl;
 #endif
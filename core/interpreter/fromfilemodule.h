@@ -21,13 +21,19 @@
 #include <memory>
 
 #include "core/module.h"
+#include "core/formatdetector/detectionmanifest.h"
 #include "core/interpreter/program.h"
 #include "core/interpreter/evaluator.h"
 
+class ProgramLoader;
+
 /**
  * @brief Module implementation created from an HMDL file
  *
  * The module generates instances of FromFileParser as parsers.
+ *
+ * The \link Program program\endlink can either be given on construction, or only be loaded
+ * when the module is first used if its \link FormatDetections format detections\endlink are known.
  */
 class FromFileModule : public Module
 {
@@ -37,14 +43,23 @@ public:
      */
     FromFileModule(Program program);
 
+    /**
+     * @param programLoader used to load the program from the file when the module is first used.
+     * @param basePath of the HMDL file, as given to ProgramLoader::fromFile.
+     * @param formatDetections of the HMDL file, as found in a \link DetectionManifest manifest\endlink.
+     */
+    FromFileModule(const ProgramLoader& programLoader, const std::string& basePath, const FormatDetections& formatDetections);
+
+    const FormatDetections& formatDetections() const;
+
 private:
     virtual void addFormatDetection(StandardFormatDetector::Adder& formatAdder) final;
     virtual void requestImportations(std::vector<std::string>& formatRequested) final;
     virtual bool doLoad() final;
 
-    bool loadProgram(const std::string path);
+    void loadProgram();
 
-    void loadFormatDetections(Program& formatDetections, StandardFormatDetector::Adder& formatAdder);
+    void loadFormatDetections(Program& formatDetections);
     void loadImports(Program& imports, std::vector<std::string>& formatRequested);
 
     void nameScan(Program &classDeclarations);
@@ -56,6 +71,9 @@ private:
     }
 
     Program _program;
+    const ProgramLoader* _programLoader;
+    std::string _basePath;
+    FormatDetections _formatDetections;
 
     mutable VariableCollector _collector;
     Variable _scope;
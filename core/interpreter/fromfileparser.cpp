@@ -19,19 +19,27 @@
 #include "core/objecttypetemplate.h"
 #include "core/interpreter/fromfileparser.h"
 #include "core/interpreter/programloader.h"
+#include "core/interpreter/scriptprofiler.h"
 #include "core/variable/localscope.h"
 #include "core/variable/typescope.h"
 #include "core/variable/objectscope.h"
 #include "core/util/unused.h"
 
-FromFileParser::FromFileParser(ParsingOption &option, const Module &module, Program classDefinition, Program::const_iterator headerEnd, bool needTailParsing)
+FromFileParser::FromFileParser(ParsingOption &option, const ObjectTypeTemplate &typeTemplate, const Module &module, Program classDefinition, Program::const_iterator headerEnd, Program::const_iterator descriptionEnd, bool needTailParsing)
     : Parser(option),
+      _typeTemplate(typeTemplate),
       _sharedAccess(new Parser*(this)),
-      _scope(new LocalScope(Variable(new ObjectScope(_sharedAccess), true), module), true),
+      _objectScope(new ObjectScope(_sharedAccess)),
+      _locals(new LocalScope(Variable(_objectScope, true), module)),
+      _scope(_locals, true),
       _headerEnd(headerEnd),
+      _headerEndPc(0),
+      _descriptionEnd(descriptionEnd),
+      _descriptionEndPc(0),
+      _descriptionParsed(headerEnd == descriptionEnd),
       _evaluator(_scope, module),
-      _bodyExecution(classDefinition.node(0), _evaluator, _scope, &object()),
-      _tailExecution(classDefinition.node(1), _evaluator, _scope, &object()),
+      _bodyExecution(new BlockExecution(classDefinition.node(0), _evaluator, _scope, &object())),
+      _tailExecution(new BlockExecution(classDefinition.node(1), _evaluator, _scope, &object())),
       _needTailParsing(needTailParsing)
 {
     UNUSED(hmcElemNames);
@@ -40,7 +48,7 @@ FromFileParser::FromFileParser(ParsingOption &option, const Module &module, Prog
 
     if (constType().fixedSize() == -1 && headerEnd == bodyBlock.begin()) {
         setHeadParsed();
-        if(_bodyExecution.done()) {
+        if(bodyDone()) {
             setParsed();
         }
     }
@@ -51,6 +59,33 @@ FromFileParser::FromFileParser(ParsingOption &option, const Module &module, Prog
     }
 }
 
+FromFileParser::FromFileParser(ParsingOption &option, const ObjectTypeTemplate &typeTemplate, const Module &module, std::shared_ptr<const Bytecode> bodyCode, std::shared_ptr<const Bytecode> tailCode, size_t headerEnd, size_t descriptionEnd, bool needTailParsing)
+    : Parser(option),
+      _typeTemplate(typeTemplate),
+      _sharedAccess(new Parser*(this)),
+      _objectScope(new ObjectScope(_sharedAccess)),
+      _locals(new LocalScope(Variable(_objectScope, true), module, bodyCode->localSlots())),
+      _scope(_locals, true),
+      _headerEndPc(headerEnd),
+      _descriptionEndPc(descriptionEnd),
+      _descriptionParsed(headerEnd == descriptionEnd),
+      _evaluator(_scope, module),
+      _bodyMachine(new VirtualMachine(bodyCode, _scope, *_locals, module, &object(), _objectScope)),
+      _tailMachine(new VirtualMachine(tailCode, _scope, *_locals, module, &object(), _objectScope)),
+      _needTailParsing(needTailParsing)
+{
+    if (constType().fixedSize() == -1 && headerEnd == 0) {
+        setHeadParsed();
+        if(bodyDone()) {
+            setParsed();
+        }
+    }
+
+    if (tailCode->size() == 0) {
+        setNoTail();
+    }
+}
+
 FromFileParser::~FromFileParser()
 {
     *_sharedAccess = nullptr;
@@ -58,37 +93,100 @@ FromFileParser::~FromFileParser()
 
 void FromFileParser::doParseHead()
 {
+    ScriptProfiler::Scope scope(_typeTemplate);
     int64_t fixedSize = constType().fixedSize();
     if(fixedSize > 0) {
         object().setSize(fixedSize);
     }
 
-    _bodyExecution.execute(_headerEnd);
-    if(_bodyExecution.done()) {
+    if (_bodyMachine) {
+        _bodyMachine->executeUntil(_headerEndPc);
+    } else {
+        _bodyExecution->execute(_headerEnd);
+    }
+    if(bodyDone()) {
         setParsed();
+        profileObject();
+    }
+}
+
+void FromFileParser::doParseDescription()
+{
+    if (_descriptionParsed) {
+        return;
+    }
+
+    ScriptProfiler::Scope scope(_typeTemplate);
+    if (_bodyMachine) {
+        _bodyMachine->executeUntil(_descriptionEndPc);
+    } else {
+        _bodyExecution->execute(_descriptionEnd);
+    }
+    _descriptionParsed = true;
+    if(bodyDone()) {
+        setParsed();
+        profileObject();
     }
 }
 
 void FromFileParser::doParse()
 {
-    _bodyExecution.execute();
+    // The breakpoint of the description must not be passed without stopping
+    doParseDescription();
+    ScriptProfiler::Scope scope(_typeTemplate);
+    if (_bodyMachine) {
+        _bodyMachine->execute();
+    } else {
+        _bodyExecution->execute();
+    }
+    profileObject();
 }
 
 bool FromFileParser::doParseSome(int hint)
 {
+    doParseDescription();
+    ScriptProfiler::Scope scope(_typeTemplate);
     size_t parseQuota = hint;
-    _bodyExecution.execute(parseQuota);
-    if(_bodyExecution.done())
+    if (_bodyMachine) {
+        _bodyMachine->execute(parseQuota);
+    } else {
+        _bodyExecution->execute(parseQuota);
+    }
+    if(bodyDone()) {
+        profileObject();
         return true;
+    }
     return false;
 }
 
 void FromFileParser::doParseTail()
 {
-    _tailExecution.execute();
+    ScriptProfiler::Scope scope(_typeTemplate);
+    if (_tailMachine) {
+        _tailMachine->execute();
+    } else {
+        _tailExecution->execute();
+    }
 }
 
 bool FromFileParser::doNeedTailParsing()
 {
     return _needTailParsing;
 }
+
+void FromFileParser::profileObject()
+{
+    // An object is counted for each of its classes, by the parser of the class
+    if (ScriptProfiler::enabled()) {
+        ScriptProfiler::addObject(_typeTemplate, object().size());
+    }
+}
+
+bool FromFileParser::bodyDone() const
+{
+    if (_bodyMachine) {
+        return _bodyMachine->done();
+    } else {
+        return _bodyExecution->done();
+    }
+}
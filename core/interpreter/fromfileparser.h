@@ -24,38 +24,64 @@
 #include "core/interpreter/program.h"
 #include "core/interpreter/evaluator.h"
 #include "core/interpreter/blockexecution.h"
+#include "core/interpreter/virtualmachine.h"
 #include "core/variable/variable.h"
 
+class LocalScope;
+class ObjectScope;
+class ObjectTypeTemplate;
+
 /**
  * @brief Parser implementation using an HMDL class definition
  *
- * Uses an instance of BlockExecution to execute the program.
+ * Uses an instance of VirtualMachine to execute the compiled program,
+ * or an instance of BlockExecution when the program could not be compiled.
  * A breakpoint is given to isolate the head, which is computed
- * statically by the module.
+ * statically by the module. In \link Object::skeletonParsing skeleton\endlink
+ * mode a second one isolates the description (value, link and attributes)
+ * which is only parsed when it is accessed.
  */
 class FromFileParser : public Parser
 {
 public:
-    FromFileParser(ParsingOption& option, const Module &module, Program classDefinition, Program::const_iterator headerEnd, bool needTailParsing);
+    FromFileParser(ParsingOption& option, const ObjectTypeTemplate& typeTemplate, const Module &module, Program classDefinition, Program::const_iterator headerEnd, Program::const_iterator descriptionEnd, bool needTailParsing);
+    FromFileParser(ParsingOption& option, const ObjectTypeTemplate& typeTemplate, const Module &module, std::shared_ptr<const Bytecode> bodyCode, std::shared_ptr<const Bytecode> tailCode, size_t headerEnd, size_t descriptionEnd, bool needTailParsing);
     ~FromFileParser();
 
 private:
     virtual void doParseHead() final;
+    virtual void doParseDescription() final;
     virtual void doParse() final;
     virtual bool doParseSome(int hint) final;
     virtual void doParseTail() final;
     virtual bool doNeedTailParsing() final;
 
+    bool bodyDone() const;
+    void profileObject();
+
+    /// Template of the class whose definition is executed, for the profiler
+    const ObjectTypeTemplate& _typeTemplate;
+
     std::shared_ptr<Parser*> _sharedAccess;
 
+    ObjectScope* _objectScope;
+    LocalScope* _locals;
     Variable _scope;
 
     Program::const_iterator _headerEnd;
+    size_t _headerEndPc;
+
+    Program::const_iterator _descriptionEnd;
+    size_t _descriptionEndPc;
+    bool _descriptionParsed;
 
     Evaluator _evaluator;
 
-    BlockExecution _bodyExecution;
-    BlockExecution _tailExecution;
+    std::unique_ptr<BlockExecution> _bodyExecution;
+    std::unique_ptr<BlockExecution> _tailExecution;
+
+    std::unique_ptr<VirtualMachine> _bodyMachine;
+    std::unique_ptr<VirtualMachine> _tailMachine;
 
     bool _needTailParsing;
 };
@@ -7,6 +7,7 @@
 #include "core/variable/variablepath.h"
 #include "core/variable/variable.h"
 #include "core/interpreter/fromfileparser.h"
+#include "core/interpreter/bytecode.h"
 #include "core/interpreter/blockexecution.h"
 #include "core/variable/localscope.h"
 #include "core/variable/typescope.h"
@@ -42,10 +43,25 @@ FromFileTemplate::FromFileTemplate(Program declaration, const Module &module, Va
       _classDefinition(declaration.node(1)),
       _collector(collector),
       _evaluator(evaluator),
-      _flag(0)
+      _flag(0),
+      _headerEndPc(0),
+      _skeletonHeaderEndPc(0)
 {
     UNUSED(hmcElemNames);
 
+    //The body and the tail share the local scope of the parser
+    std::shared_ptr<LocalScope::Slots> localSlots = std::make_shared<LocalScope::Slots>();
+    Bytecode::bindLocals(_classDefinition.node(0), *localSlots);
+    Bytecode::bindLocals(_classDefinition.node(1), *localSlots);
+
+    _bodyCode = Bytecode::compile(_classDefinition.node(0), true, localSlots, this, &_module);
+    _tailCode = Bytecode::compile(_classDefinition.node(1), true, localSlots, this, &_module);
+    if (!_bodyCode || !_tailCode) {
+        Log::info("Class ", name(), " is not compiled to bytecode, the AST interpreter is used");
+        _bodyCode.reset();
+        _tailCode.reset();
+    }
+
     if (_classInfo.node(4).payload().toBool()) {
         setVirtual(true);
     }
@@ -77,7 +93,24 @@ Parser *FromFileTemplate::parseOrGetParser(const ObjectType &, ParsingOption &op
         return nullptr;
     }
 
-    return new FromFileParser(option, _module, _classDefinition, headerEnd(), needTailParsing());
+    const bool skeleton = static_cast<Object&>(option).parsingMode() == Object::skeletonParsing;
+
+    if (_bodyCode && Bytecode::enabled()) {
+        if (skeleton) {
+            skeletonHeaderEnd();
+            headerEnd();
+            return new FromFileParser(option, *this, _module, _bodyCode, _tailCode, _skeletonHeaderEndPc, _headerEndPc, needTailParsing());
+        } else {
+            headerEnd();
+            return new FromFileParser(option, *this, _module, _bodyCode, _tailCode, _headerEndPc, _headerEndPc, needTailParsing());
+        }
+    }
+
+    if (skeleton) {
+        return new FromFileParser(option, *this, _module, _classDefinition, skeletonHeaderEnd(), headerEnd(), needTailParsing());
+    } else {
+        return new FromFileParser(option, *this, _module, _classDefinition, headerEnd(), headerEnd(), needTailParsing());
+    }
 }
 
 const VariablePath sizeDescriptor = {"@size"};
@@ -90,6 +123,12 @@ const std::vector<VariablePath> headerOnlyVars = {
     {"@attr"}
 };
 
+/// Variables needed in skeleton mode to know the size of the object and specify its type
+const std::vector<VariablePath> skeletonHeaderVars = {
+    sizeDescriptor,
+    {"@args"}
+};
+
 
 std::shared_ptr<ObjectType> fromFileNullParent(new ObjectType);
 
@@ -97,7 +136,7 @@ int64_t FromFileTemplate::fixedSize(const ObjectType &type) const
 {
     if (! (_flag & _sizeComputed)) {
         _fixedSize = unknownSize;
-        std::set<VariablePath> dependencies = variableDependencies(_classDefinition, true);
+        const std::set<VariablePath>& dependencies = variableDependencies(_classDefinition, true);
         if (dependencies.find(sizeDescriptor) == dependencies.end())
         {
             if (!isVirtual() && type.parent().isNull()) {
@@ -144,43 +183,97 @@ Variant FromFileTemplate::attributeValue(const ObjectType &type, ObjectTypeTempl
 {
     auto it = _attributeExpressions.find(attribute);
 
-    if (it != _attributeExpressions.end())
+    if (it == _attributeExpressions.end()) {
+        return Variant();
+    }
+
+    //The value of a pure attribute only depends on the type's parameters, purity is
+    //checked on first use, once all the methods of the module are known
+    bool pure;
+    {
+        std::lock_guard<std::mutex> lock(_attributeMutex);
+        pure = Evaluator::isPure(it->second, _module);
+        if (pure) {
+            auto cached = _attributeValues.find(type);
+            if (cached != _attributeValues.end()) {
+                auto value = cached->second.find(attribute);
+                if (value != cached->second.end()) {
+                    return value->second;
+                }
+            }
+        }
+    }
+
+    Variant value;
     {
         VariableCollectionGuard guard(_collector);
-        return Evaluator(Variable(new TypeScope(_collector, type), false), _module).rightValue(it->second).value();
-    } else {
-        return Variant();
+        value = Evaluator(Variable(new TypeScope(_collector, type), false), _module).value(it->second);
     }
+
+    if (pure) {
+        //The values are copied out under the lock, clearing never invalidates one in use
+        std::lock_guard<std::mutex> lock(_attributeMutex);
+        if (_attributeValues.size() >= maxCachedAttributeTypes) {
+            _attributeValues.clear();
+        }
+        _attributeValues[type][attribute] = value;
+    }
+    return value;
 }
 
 Program::const_iterator FromFileTemplate::headerEnd() const
 {
     if (! (_flag & _headerEndComputed))
     {
-        Program bodyBlock = _classDefinition.node(0);
+        _headerEnd = computeHeaderEnd(headerOnlyVars);
+        _headerEndPc = headerEndPc(_headerEnd);
+        _flag |= _headerEndComputed;
+    }
+    return _headerEnd;
+}
 
-        for (Program::const_iterator headerEnd = bodyBlock.begin(); headerEnd != bodyBlock.end(); ++headerEnd) {
-            const Program& line = *headerEnd;
-            //Check header mark
-            if (line.tag() == HMC_HEADER_MARK) {
-                return ++headerEnd;
-            }
-        }
+Program::const_iterator FromFileTemplate::skeletonHeaderEnd() const
+{
+    if (! (_flag & _skeletonHeaderEndComputed))
+    {
+        _skeletonHeaderEnd = computeHeaderEnd(skeletonHeaderVars);
+        _skeletonHeaderEndPc = headerEndPc(_skeletonHeaderEnd);
+        _flag |= _skeletonHeaderEndComputed;
+    }
+    return _skeletonHeaderEnd;
+}
 
-        Program::const_reverse_iterator reverseHeaderEnd = bodyBlock.rbegin();
-        for(;reverseHeaderEnd != bodyBlock.rend(); ++reverseHeaderEnd)
-        {
-            if(checkHeaderOnlyVar(*reverseHeaderEnd)) {
-                break;
-            }
-        }
+size_t FromFileTemplate::headerEndPc(Program::const_iterator headerEnd) const
+{
+    if (!_bodyCode) {
+        return 0;
+    }
+    return _bodyCode->statementPc(std::distance(_classDefinition.node(0).begin(), headerEnd));
+}
 
-        _headerEnd = bodyBlock.begin();
-        std::advance(_headerEnd, std::distance(reverseHeaderEnd, bodyBlock.rend()));
+Program::const_iterator FromFileTemplate::computeHeaderEnd(const std::vector<VariablePath> &headerVars) const
+{
+    Program bodyBlock = _classDefinition.node(0);
 
-        _flag |= _headerEndComputed;
+    for (Program::const_iterator headerEnd = bodyBlock.begin(); headerEnd != bodyBlock.end(); ++headerEnd) {
+        const Program& line = *headerEnd;
+        //Check header mark
+        if (line.tag() == HMC_HEADER_MARK) {
+            return ++headerEnd;
+        }
     }
-    return _headerEnd;
+
+    Program::const_reverse_iterator reverseHeaderEnd = bodyBlock.rbegin();
+    for(;reverseHeaderEnd != bodyBlock.rend(); ++reverseHeaderEnd)
+    {
+        if(checkHeaderOnlyVar(*reverseHeaderEnd, headerVars)) {
+            break;
+        }
+    }
+
+    Program::const_iterator headerEnd = bodyBlock.begin();
+    std::advance(headerEnd, std::distance(reverseHeaderEnd, bodyBlock.rend()));
+    return headerEnd;
 }
 
 bool FromFileTemplate::needTailParsing() const
@@ -192,7 +285,7 @@ bool FromFileTemplate::needTailParsing() const
         _needTailParsing = false;
         for(Program line : tailBlock)
         {
-            if(checkHeaderOnlyVar(line)) {
+            if(checkHeaderOnlyVar(line, headerOnlyVars)) {
                 _needTailParsing = true;
             }
         }
@@ -202,12 +295,12 @@ bool FromFileTemplate::needTailParsing() const
     return _needTailParsing;
 }
 
-bool FromFileTemplate::checkHeaderOnlyVar(const Program &line) const
+bool FromFileTemplate::checkHeaderOnlyVar(const Program &line, const std::vector<VariablePath> &headerVars) const
 {
     //Check dependencies
-    std::set<VariablePath> variableSet = variableDependencies(line, true);
+    const std::set<VariablePath>& variableSet = variableDependencies(line, true);
 
-    return std::any_of(headerOnlyVars.begin(), headerOnlyVars.end(), [&variableSet](const VariablePath& headerOnlyVar)
+    return std::any_of(headerVars.begin(), headerVars.end(), [&variableSet](const VariablePath& headerOnlyVar)
     {
         auto find = variableSet.find(headerOnlyVar);
         if(find != variableSet.end())
@@ -241,7 +334,7 @@ int64_t FromFileTemplate::guessSize(const Program &instructions) const
                 if(!variableDependencies(line.node(0),false).empty())
                     return unknownSize;
 
-                ObjectType type = _evaluator.rightValue(line.node(0)).value().toObjectType();
+                ObjectType type = _evaluator.value(line.node(0)).toObjectType();
                 if(type.isNull())
                     return unknownSize;
 
@@ -338,10 +431,14 @@ void FromFileTemplate::buildDependencies(const Program &instructions, bool modif
     }
 }
 
-std::set<VariablePath> FromFileTemplate::variableDependencies(const Program &instructions, bool modificationOnly) const
+const std::set<VariablePath>& FromFileTemplate::variableDependencies(const Program &instructions, bool modificationOnly) const
 {
-    std::set<VariablePath> dependencies;
-    VariableCollectionGuard guard(_collector);
-    buildDependencies(instructions, modificationOnly, dependencies);
-    return dependencies;
+    std::unique_ptr<const std::set<VariablePath> >& dependencies = instructions.analysis().dependencies[modificationOnly];
+    if (!dependencies) {
+        std::unique_ptr<std::set<VariablePath> > computed(new std::set<VariablePath>);
+        VariableCollectionGuard guard(_collector);
+        buildDependencies(instructions, modificationOnly, *computed);
+        dependencies = std::move(computed);
+    }
+    return *dependencies;
 }
@@ -1,9 +1,13 @@
 #ifndef FROMFILETEMPLATE_H
 #define FROMFILETEMPLATE_H
 
+#include <mutex>
+
 #include "core/objecttypetemplate.h"
+#include "core/varianthash.h"
 
 #include "core/interpreter/program.h"
+#include "core/interpreter/bytecode.h"
 
 #include "core/interpreter/evaluator.h"
 
@@ -31,11 +35,14 @@ private:
 
 
     Program::const_iterator headerEnd() const;
+    Program::const_iterator skeletonHeaderEnd() const;
+    Program::const_iterator computeHeaderEnd(const std::vector<VariablePath>& headerVars) const;
+    size_t headerEndPc(Program::const_iterator headerEnd) const;
     bool needTailParsing() const;
 
-    bool checkHeaderOnlyVar(const Program& line) const;
+    bool checkHeaderOnlyVar(const Program& line, const std::vector<VariablePath>& headerVars) const;
     int64_t guessSize(const Program& instructions) const;
-    std::set<VariablePath> variableDependencies(const Program& instructions, bool modificationOnly) const;
+    const std::set<VariablePath>& variableDependencies(const Program& instructions, bool modificationOnly) const;
     void buildDependencies(const Program& instructions, bool modificationOnly, std::set<VariablePath>& descriptors, bool areVariablesModified = false) const;
 
 
@@ -46,8 +53,16 @@ private:
     Program _classInfo;
     Program _classDefinition;
     Program _parentInfo;
+    std::shared_ptr<const Bytecode> _bodyCode;
+    std::shared_ptr<const Bytecode> _tailCode;
     std::unordered_map<ObjectTypeTemplate::Attribute, Program, EnumClassHash> _attributeExpressions;
 
+    typedef std::unordered_map<ObjectTypeTemplate::Attribute, Variant, EnumClassHash> AttributeValues;
+    /// Guards the cache, the attributes are read from any thread (e.g. the names of the types displayed)
+    mutable std::mutex _attributeMutex;
+    mutable std::unordered_map<ObjectType, AttributeValues, std::hash<ObjectType>, IdenticalType> _attributeValues;
+    static const size_t maxCachedAttributeTypes = 4096;
+
     VariableCollector&  _collector;
     const Evaluator& _evaluator;
 
@@ -57,9 +72,13 @@ private:
     static const unsigned int _isParentSize = 0x2;
     static const unsigned int _headerEndComputed = 0x4;
     static const unsigned int _needTailParsingComputed = 0x8;
+    static const unsigned int _skeletonHeaderEndComputed = 0x10;
 
     mutable int64_t _fixedSize;
     mutable Program::const_iterator _headerEnd;
+    mutable Program::const_iterator _skeletonHeaderEnd;
+    mutable size_t _headerEndPc;
+    mutable size_t _skeletonHeaderEndPc;
     mutable bool _needTailParsing;
 };
 
@@ -0,0 +1,371 @@
+//This file is part of the HexaMonkey project, a multimedia analyser
+//Copyright (C) 2013  Sevan Drapeau-Martin, Nicolas Fleury
+
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifndef PLATFORM_WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "compiler/model.h"
+#include "core/interpreter/hmcreader.h"
+#include "core/interpreter/scriptprofiler.h"
+#include "core/util/unused.h"
+#include "core/log/logmanager.h"
+
+/// Id of the EBML header that precedes the root of the program
+static const uint64_t ebmlHeaderId = 0xa45dfa3;
+
+HmcReader::HmcReader(const std::string &path, const std::string &source)
+    : _path(path),
+      _source(source.empty() ? path : source),
+      _data(nullptr),
+      _size(0),
+      _mapped(true)
+{
+    UNUSED(hmcElemNames);
+}
+
+HmcReader::HmcReader(const char *data, size_t size, const std::string &source)
+    : _path(source),
+      _source(source),
+      _data(reinterpret_cast<const uint8_t*>(data)),
+      _size(size),
+      _mapped(false)
+{
+}
+
+HmcReader::~HmcReader()
+{
+    unmap();
+}
+
+Program HmcReader::read()
+{
+    if (!map()) {
+        Log::error("Script could not be loaded : ", _path);
+        return Program();
+    }
+
+    const uint8_t* pos = _data;
+    const uint8_t* end = _data + _size;
+
+    Element header;
+    Element root;
+    size_t count = 1;
+    if (!readElement(pos, end, header)
+     || header.tag != ebmlHeaderId
+     || !readElement(pos, end, root)
+     || root.tag == ebmlHeaderId
+     || hmcElemTypes[root.tag] != HMC_MASTER
+     || !countNodes(root.begin, root.end, count)
+     || count > UINT32_MAX) {
+        Log::error("Script is malformed : ", _path);
+        return Program();
+    }
+
+    auto memory = std::make_shared<Program::Memory>();
+    memory->_nodes.reserve(count);
+    // Allocated beforehand, the analyses are filled from any thread
+    memory->_analyses.resize(count);
+    memory->_nodes.push_back(Program::Memory::Node{Variant::null(), root.tag, 1, 0});
+    memory->_source = _source;
+    readChildren(*memory, 0, root.begin, root.end);
+
+    // Decoding the debug information takes longer than the program itself, it is only needed by the profiler
+    Element debug;
+    if (ScriptProfiler::enabled() && readElement(pos, end, debug) && debug.tag == HMC_DEBUG) {
+        readLines(*memory, debug.begin, debug.end);
+    }
+
+    return Program(memory);
+}
+
+bool HmcReader::map()
+{
+    if (!_mapped) {
+        return _data != nullptr;
+    }
+
+#ifdef PLATFORM_WIN32
+    std::ifstream file(_path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    _buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    _data = _buffer.data();
+    _size = _buffer.size();
+    return true;
+#else
+    int fd = open(_path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) == -1 || status.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    void* data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    _data = static_cast<const uint8_t*>(data);
+    _size = status.st_size;
+    return true;
+#endif
+}
+
+void HmcReader::unmap()
+{
+    if (!_mapped) {
+        return;
+    }
+
+#ifdef PLATFORM_WIN32
+    _buffer.clear();
+#else
+    if (_data != nullptr) {
+        munmap(const_cast<uint8_t*>(_data), _size);
+    }
+#endif
+    _data = nullptr;
+    _size = 0;
+}
+
+bool HmcReader::readVint(const uint8_t *&pos, const uint8_t *end, uint64_t &value) const
+{
+    if (pos >= end || *pos == 0) {
+        return false;
+    }
+
+    int count;
+    for (count = 1; !(*pos & (1 << (8 - count))); ++count) {
+    }
+
+    if (end - pos < count) {
+        return false;
+    }
+
+    value = *pos & ~(1 << (8 - count));
+    for (int i = 1; i < count; ++i) {
+        value = value << 8 | pos[i];
+    }
+    pos += count;
+    return true;
+}
+
+bool HmcReader::readElement(const uint8_t *&pos, const uint8_t *end, Element &element) const
+{
+    uint64_t id;
+    uint64_t size;
+    if (!readVint(pos, end, id) || !readVint(pos, end, size) || size > static_cast<uint64_t>(end - pos)) {
+        return false;
+    }
+
+    element.tag = id;
+    element.begin = pos;
+    element.end = pos + size;
+    pos = element.end;
+    return id == ebmlHeaderId || id < sizeof(hmcElemTypes) / sizeof(hmcElemTypes[0]);
+}
+
+bool HmcReader::countNodes(const uint8_t *begin, const uint8_t *end, size_t &count) const
+{
+    for (const uint8_t* pos = begin; pos < end;) {
+        Element element;
+        if (!readElement(pos, end, element) || element.tag == ebmlHeaderId) {
+            return false;
+        }
+        ++count;
+
+        const size_t size = element.end - element.begin;
+        switch (hmcElemTypes[element.tag]) {
+            case HMC_MASTER:
+                if (!countNodes(element.begin, element.end, count)) {
+                    return false;
+                }
+                break;
+
+            case HMC_INTEGER:
+            case HMC_UINTEGER:
+                if (size > 8) {
+                    return false;
+                }
+                break;
+
+            case HMC_FLOAT:
+                if (size != 4 && size != 8) {
+                    return false;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+void HmcReader::readChildren(Program::Memory &memory, uint32_t parent, const uint8_t *begin, const uint8_t *end) const
+{
+    std::vector<Program::Memory::Node>& nodes = memory._nodes;
+    const uint32_t first = nodes.size();
+
+    Element element;
+    for (const uint8_t* pos = begin; pos < end;) {
+        readElement(pos, end, element);
+        nodes.push_back(Program::Memory::Node{payload(element), element.tag, 0, 0});
+    }
+
+    nodes[parent].first = first;
+    nodes[parent].size = nodes.size() - first;
+
+    // The grandchildren are only appended once all the children are, so that they stay contiguous
+    uint32_t index = first;
+    for (const uint8_t* pos = begin; pos < end; ++index) {
+        readElement(pos, end, element);
+        if (hmcElemTypes[element.tag] == HMC_MASTER) {
+            readChildren(memory, index, element.begin, element.end);
+        } else {
+            nodes[index].first = nodes.size();
+        }
+    }
+}
+
+void HmcReader::readLines(Program::Memory &memory, const uint8_t *begin, const uint8_t *end) const
+{
+    // The debug information gives the line of each element of the tree, identified by its offset in the file
+    std::vector<std::pair<int64_t, int32_t> > lines;
+    Element codeInfo;
+    for (const uint8_t* pos = begin; pos < end;) {
+        if (!readElement(pos, end, codeInfo) || codeInfo.tag != HMC_CODE_INFO) {
+            return;
+        }
+
+        int64_t line = -1;
+        int64_t offset = -1;
+        Element element;
+        for (const uint8_t* infoPos = codeInfo.begin; infoPos < codeInfo.end;) {
+            if (!readElement(infoPos, codeInfo.end, element) || element.end - element.begin > 8) {
+                return;
+            }
+            if (element.tag == HMC_LINE_NUMBER) {
+                line = payload(element).toInteger();
+            } else if (element.tag == HMC_FILE_OFFSET) {
+                offset = payload(element).toInteger();
+            }
+        }
+        if (offset >= 0) {
+            lines.emplace_back(offset, line);
+        }
+    }
+    if (lines.size() != memory._nodes.size()) {
+        return;
+    }
+
+    // Sorted by offset, the elements are in the order of a depth-first traversal of the tree
+    std::sort(lines.begin(), lines.end());
+    memory._lines.resize(lines.size());
+    size_t next = 0;
+    setLines(memory, 0, lines, next);
+}
+
+void HmcReader::setLines(Program::Memory &memory, uint32_t index, const std::vector<std::pair<int64_t, int32_t> > &lines, size_t &next) const
+{
+    memory._lines[index] = lines[next++].second;
+
+    const Program::Memory::Node& node = memory._nodes[index];
+    for (uint32_t child = node.first; child < node.first + node.size; ++child) {
+        setLines(memory, child, lines, next);
+    }
+}
+
+Variant HmcReader::payload(const Element &element) const
+{
+    const size_t size = element.end - element.begin;
+    switch (hmcElemTypes[element.tag]) {
+        case HMC_INTEGER:
+        case HMC_UINTEGER:
+        {
+            uint64_t value = 0;
+            for (const uint8_t* pos = element.begin; pos < element.end; ++pos) {
+                value = value << 8 | *pos;
+            }
+            if (hmcElemTypes[element.tag] == HMC_UINTEGER) {
+                // The uint type promotes 16 bits values to signed integers, which scripts may rely on
+                if (size == 2) {
+                    return Variant(static_cast<int>(value));
+                }
+                return Variant(static_cast<unsigned long long>(value));
+            }
+            if (size > 0 && size < 8 && (*element.begin & 0x80)) {
+                value |= ~0ULL << (8 * size);
+            }
+            return Variant(static_cast<long long>(value));
+        }
+
+        case HMC_FLOAT:
+        {
+            uint64_t value = 0;
+            for (const uint8_t* pos = element.begin; pos < element.end; ++pos) {
+                value = value << 8 | *pos;
+            }
+            if (size == 8) {
+                double f;
+                std::memcpy(&f, &value, sizeof(f));
+                return Variant(f);
+            } else {
+                const uint32_t value32 = value;
+                float f;
+                std::memcpy(&f, &value32, sizeof(f));
+                return Variant(f);
+            }
+        }
+
+        case HMC_STRING:
+        {
+            // Same decoding as the String type: non ascii characters are replaced by '?'
+            std::stringstream S;
+            for (const uint8_t* pos = element.begin; pos < element.end && *pos != '\0'; ++pos) {
+                if ((*pos & 0x80) == 0) {
+                    S << static_cast<char>(*pos);
+                } else {
+                    S << '?';
+                    const uint8_t leading = *pos;
+                    for (uint8_t mask = 0x40; (leading & mask) && pos + 1 < element.end && pos[1] != '\0'; mask >>= 1) {
+                        ++pos;
+                    }
+                }
+            }
+            return Variant(S.str());
+        }
+
+        default:
+            return Variant::null();
+    }
+}
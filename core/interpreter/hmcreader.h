@@ -0,0 +1,89 @@
+//This file is part of the HexaMonkey project, a multimedia analyser
+//Copyright (C) 2013  Sevan Drapeau-Martin, Nicolas Fleury
+
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef HMC_READER_H
+#define HMC_READER_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "core/interpreter/program.h"
+#include "core/util/osutil.h"
+
+/**
+ * @brief Load \link Program programs\endlink from compiled HMDL files
+ *
+ * A compiled HMDL file is an EBML file whose elements are described by model.h. The
+ * file is mapped in memory, or directly given by the compiler, and its elements are decoded directly into the arena of the
+ * \link Program program\endlink, without building the generic \link Object object\endlink
+ * tree that HmcModule gives for viewing the file.
+ */
+class HmcReader
+{
+public:
+    /**
+     * @brief Load a compiled HMDL file
+     *
+     * The source is the path of the HMDL file it was compiled from, if known, which is given
+     * to the \link Program program\endlink along with the lines of the nodes when the
+     * \link ScriptProfiler profiler\endlink is enabled.
+     */
+    HmcReader(const std::string& path, const std::string& source = std::string());
+    /**
+     * @brief Decode compiled HMDL already in memory, the data must outlive the reader
+     */
+    HmcReader(const char* data, size_t size, const std::string& source = "compiled buffer");
+    ~HmcReader();
+
+    /**
+     * @brief Load the root of the program
+     *
+     * Returns an invalid \link Program program\endlink if the file cannot be read or is malformed
+     */
+    Program read();
+
+private:
+    struct Element
+    {
+        uint32_t tag;
+        const uint8_t* begin;
+        const uint8_t* end;
+    };
+
+    bool map();
+    void unmap();
+
+    bool readVint(const uint8_t*& pos, const uint8_t* end, uint64_t& value) const;
+    bool readElement(const uint8_t*& pos, const uint8_t* end, Element& element) const;
+    bool countNodes(const uint8_t* begin, const uint8_t* end, size_t& count) const;
+    void readChildren(Program::Memory& memory, uint32_t parent, const uint8_t* begin, const uint8_t* end) const;
+    void readLines(Program::Memory& memory, const uint8_t* begin, const uint8_t* end) const;
+    void setLines(Program::Memory& memory, uint32_t index, const std::vector<std::pair<int64_t, int32_t> >& lines, size_t& next) const;
+    Variant payload(const Element& element) const;
+
+    const std::string _path;
+    const std::string _source;
+    const uint8_t* _data;
+    size_t _size;
+    const bool _mapped;
+#ifdef PLATFORM_WIN32
+    std::vector<uint8_t> _buffer;
+#endif
+};
+
+#endif // HMC_READER_H
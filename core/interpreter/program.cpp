@@ -17,52 +17,54 @@
 
 #include "compiler/model.h"
 #include "core/variant.h"
-#include "core/parser.h"
 #include "core/interpreter/program.h"
-#include "core/variable/variable.h"
 #include "core/util/unused.h"
 
 Program::Program()
-    : _object(nullptr)
+    : _memory(nullptr),
+      _index(0)
 {
     UNUSED(hmcElemNames);
 }
 
-Program::Program(Object &object, std::shared_ptr<Memory> memory)
-    : _object(&object),
-      _memory(memory)
+Program::Program(Memory *memory, uint32_t index)
+    : _memory(memory),
+      _index(index)
+{
+}
+
+Program::Program(std::shared_ptr<Memory> memory)
+    : _memory(memory.get()),
+      _index(0),
+      _owner(std::move(memory))
 {
-    _object->explore();
 }
 
 bool Program::isValid() const
 {
-    return _object != nullptr;
+    return _memory != nullptr;
 }
 
 uint32_t Program::tag() const
 {
-    return _object->lookUp("id")->value().toInteger();
+    return data().tag;
 }
 
 const Variant &Program::payload() const
 {
-    Object* object = _object->lookUp("payload", true);
-    if(object == nullptr)
-        object = _object;
-    return object->value();
+    return data().payload;
 }
 
 int Program::size() const
 {   
-    return _object->numberOfChildren() - 2;
+    return data().size;
 }
 
 Program Program::node(int index) const
 {
-    Object* nodeObject = _object->access(index+2, true);
-    if(nodeObject != nullptr)
-        return Program(*nodeObject, _memory);
+    const Memory::Node& node = data();
+    if(index >= 0 && static_cast<uint32_t>(index) < node.size)
+        return Program(_memory, node.first + index);
     else
         return Program();
 }
@@ -75,40 +77,129 @@ Program Program::operator [](int index) const
 
 Program::const_iterator Program::begin() const
 {   
-    Object::iterator it = _object->begin();
-    std::advance(it, 2);
-    return const_iterator(it, _memory);
+    return const_iterator(_memory, data().first);
 }
 
 Program::const_iterator Program::end() const
 {   
-    return const_iterator(_object->end(), _memory);
+    const Memory::Node& node = data();
+    return const_iterator(_memory, node.first + node.size);
 }
 
 Program::const_reverse_iterator Program::rbegin() const
 {   
-    return const_reverse_iterator(_object->rbegin(), _memory);
+    const Memory::Node& node = data();
+    return const_reverse_iterator(_memory, node.first + node.size - 1);
 }
 
 Program::const_reverse_iterator Program::rend() const
 {   
-    Object::reverse_iterator it = _object->rend();
-    std::advance(it, -2);
-    return const_reverse_iterator(it, _memory);
+    return const_reverse_iterator(_memory, data().first - 1);
+}
+
+Program::Analysis &Program::analysis() const
+{
+    return _memory->_analyses[_index];
+}
+
+bool Program::hasDeclaration() const
+{
+    Analysis::State& state = analysis().hasDeclaration;
+    if (state == Analysis::State::unknown) {
+        state = computeHasDeclaration() ? Analysis::State::yes : Analysis::State::no;
+    }
+    return state == Analysis::State::yes;
+}
+
+bool Program::isConstant() const
+{
+    Analysis::State& state = analysis().isConstant;
+    if (state == Analysis::State::unknown) {
+        state = computeIsConstant() ? Analysis::State::yes : Analysis::State::no;
+    }
+    return state == Analysis::State::yes;
+}
+
+int Program::line() const
+{
+    const std::vector<int32_t>& lines = _memory->_lines;
+    return _index < lines.size() ? lines[_index] : -1;
+}
+
+const std::string &Program::source() const
+{
+    return _memory->_source;
 }
 
-Program::Memory &Program::memory() const
+const Program::Memory::Node &Program::data() const
 {
-    return *_memory.get();
+    return _memory->_nodes[_index];
 }
 
-File &Program::Memory::file()
+bool Program::computeHasDeclaration() const
 {
-    return _file;
+    for(Program program: *this)
+    {
+        switch(program.tag())
+        {
+            case HMC_DECLARATION:
+                return true;
+
+            case HMC_CONDITIONAL_STATEMENT:
+                if(program.node(1).hasDeclaration())
+                    return true;
+                if(program.node(2).hasDeclaration())
+                    return true;
+                break;
+
+            case HMC_LOOP:
+            case HMC_DO_LOOP:
+                if(program.node(1).hasDeclaration())
+                    return true;
+                break;
+
+            default:
+                break;
+        }
+    }
+    return false;
 }
 
-Object &Program::Memory::setFileObject(Object *fileObject)
+bool Program::computeIsConstant() const
 {
-    _fileObject.reset(fileObject);
-    return *fileObject;
+    switch (tag()) {
+        case HMC_INT_CONSTANT:
+        case HMC_UINT_CONSTANT:
+        case HMC_FLOAT_CONSTANT:
+        case HMC_STRING_CONSTANT:
+        case HMC_EMPTY_STRING_CONSTANT:
+        case HMC_NULL_CONSTANT:
+        case HMC_UNDEFINED_CONSTANT:
+        case HMC_IDENTIFIER:
+            return true;
+
+        case HMC_OPERATOR:
+            switch (payload().toInteger()) {
+                case HMC_ADD_MAGIC_NUMBER_OP:
+                case HMC_ADD_EXTENSION_OP:
+                case HMC_ADD_SYNCBYTE_OP:
+                    return false;
+
+                default:
+                    return true;
+            }
+
+        case HMC_RIGHT_VALUE:
+        case HMC_TYPE:
+        case HMC_ARGUMENTS:
+            for (const Program& child : *this) {
+                if (!child.computeIsConstant()) {
+                    return false;
+                }
+            }
+            return true;
+
+        default:
+            return false;
+    }
 }
@@ -20,8 +20,11 @@
 
 #include <memory>
 #include <set>
+#include <string>
+#include <vector>
 
 #include "core/object.h"
+#include "core/variant.h"
 #include "core/module.h"
 #include "core/variable/variablepath.h"
 #include "core/variable/variablecollector.h"
@@ -30,49 +33,81 @@
  *
  * The root of a \link Program program\endlink can be loaded by the
  * \link ProgramLoader program loader\endlink. The children nodes can then be generated
- * by iterating over the node or accessing them by their index. Leaf nodes
- * and memory of the whole tree is shared by all the nodes generated.
+ * by iterating over the node or accessing them by their index.
+ *
+ * The whole tree is stored in a single arena where the children of a node are contiguous,
+ * and a node is only an index in that arena. The root returned by the loader owns the arena:
+ * the nodes generated from it stay valid as long as a copy of the root is kept.
  */
 class Program
 {
+public:
+    /**
+     * @brief Results of the static analyses of a node
+     *
+     * Each analysis is computed the first time it is needed, usually while the
+     * \link Module module\endlink is loaded, and then read from a side table indexed by node.
+     */
+    struct Analysis
+    {
+        enum class State : uint8_t {unknown, no, yes};
+
+        State hasDeclaration = State::unknown;
+        State isConstant = State::unknown;
+
+        /// Purity depends on the methods of the module, indexed by localAssignments
+        const Module* purityModule = nullptr;
+        State isPure[2] = {State::unknown, State::unknown};
+
+        /// Variables the node depends on, indexed by modificationOnly
+        std::unique_ptr<const std::set<VariablePath> > dependencies[2];
+    };
+
+private:
     class Memory
     {
-        friend class ProgramLoader;
+        friend class HmcReader;
         friend class Program;
 
-        File& file();
-        Object& setFileObject(Object* fileObject);
-        VariableCollector& collector() {
-            return _collector;
-        }
-
-        RealFile _file;
-        std::unique_ptr<Object> _fileObject;
-        VariableCollector _collector;
+        struct Node
+        {
+            Variant payload;
+            uint32_t tag;
+            /// Index of the first child, the children of a node being contiguous
+            uint32_t first;
+            uint32_t size;
+        };
+
+        std::vector<Node> _nodes;
+        /// Indexed like the nodes, allocated along with them so that it is never resized once shared
+        std::vector<Analysis> _analyses;
+        /// Indexed like the nodes, empty unless the debug information has been read
+        std::vector<int32_t> _lines;
+        std::string _source;
     };
 
-    template<class It>
-    class _const_iterator : public std::iterator<std::input_iterator_tag, Program>
+    template<int step>
+    class _const_iterator : public std::iterator<std::bidirectional_iterator_tag, Program>
     {
         friend class Program;
-        It _it;
-        std::shared_ptr<Memory> _memory;
+        Memory* _memory;
+        uint32_t _index;
 
-        _const_iterator<It>(const It& it, std::shared_ptr<Memory> memory):_it(it), _memory(memory){}
+        _const_iterator<step>(Memory* memory, uint32_t index):_memory(memory), _index(index){}
         public:
-            _const_iterator<It>(){}
-            _const_iterator<It>& operator++() {++_it; return *this;}
-            _const_iterator<It> operator++(int) {const_iterator dup(*this); ++_it; return dup;}
-            _const_iterator<It>& operator--() {--_it; return *this;}
-            _const_iterator<It> operator--(int) {const_iterator dup(*this); --_it; return dup;}
-            Program operator*() const {return Program(**_it, _memory);}
-            bool operator==(const _const_iterator<It>& other) const {return _it==other._it;}
-            bool operator!=(const _const_iterator<It>& other) const {return !(*this==other);}
+            _const_iterator<step>():_memory(nullptr), _index(0){}
+            _const_iterator<step>& operator++() {_index += step; return *this;}
+            _const_iterator<step> operator++(int) {_const_iterator<step> dup(*this); _index += step; return dup;}
+            _const_iterator<step>& operator--() {_index -= step; return *this;}
+            _const_iterator<step> operator--(int) {_const_iterator<step> dup(*this); _index -= step; return dup;}
+            Program operator*() const {return Program(_memory, _index);}
+            bool operator==(const _const_iterator<step>& other) const {return _index==other._index;}
+            bool operator!=(const _const_iterator<step>& other) const {return !(*this==other);}
     };
 
 public:
-    typedef _const_iterator< Object::iterator > const_iterator;
-    typedef _const_iterator< Object::reverse_iterator > const_reverse_iterator;
+    typedef _const_iterator<1> const_iterator;
+    typedef _const_iterator<-1> const_reverse_iterator;
 
     Program();
 
@@ -133,15 +168,49 @@ public:
      */
     const_reverse_iterator rend() const;
 
+    /**
+     * @brief Get the static analyses of the node, shared by all the \link Program programs\endlink
+     * generated for the node
+     */
+    Analysis& analysis() const;
+
+    /**
+     * @brief Check if executing the block can declare a variable, including in its
+     * conditional statements and loops
+     */
+    bool hasDeclaration() const;
+
+    /**
+     * @brief Check if the right value only uses constants, operators and types, so that
+     * it always evaluates to the same value without side effects
+     */
+    bool isConstant() const;
+
+    /**
+     * @brief Get the line of the HMDL source where the node begins, or -1 if unknown
+     */
+    int line() const;
+
+    /**
+     * @brief Get the path of the HMDL source the program was compiled from
+     */
+    const std::string& source() const;
+
 private:
-    friend class ProgramLoader;
+    friend class HmcReader;
+
+    Program(Memory* memory, uint32_t index);
+    Program(std::shared_ptr<Memory> memory);
 
-    Program(Object& object, std::shared_ptr<Memory> memory);
+    const Memory::Node& data() const;
 
-    Program::Memory& memory() const;
+    bool computeHasDeclaration() const;
+    bool computeIsConstant() const;
 
-    Object* _object;
-    std::shared_ptr<Program::Memory> _memory;
+    Memory* _memory;
+    uint32_t _index;
+    /// Only set for the root, so that generating the nodes does not touch any reference count
+    std::shared_ptr<Memory> _owner;
 };
 
 #endif // EBMLOBJECT_H
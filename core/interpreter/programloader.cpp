@@ -15,121 +15,89 @@
 //along with this program; if not, write to the Free Software
 //Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
-#include <sstream>
-#include <cstdlib>
 #include <cstdio>
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_set>
 
+#include "compiler/compiler.h"
 #include "compiler/model.h"
 #include "core/modules/default/defaultmodule.h"
 #include "core/objecttypetemplate.h"
 #include "core/parser.h"
-#include "core/modules/hmc/hmcmodule.h"
+#include "core/interpreter/hmcreader.h"
 #include "core/interpreter/programloader.h"
 #include "core/variable/variable.h"
 #include "core/variable/variablepath.h"
 #include "core/util/unused.h"
 #include "core/util/osutil.h"
 #include "core/util/fileutil.h"
+#include "core/util/strutil.h"
 #include "core/log/logmanager.h"
 
-#include "core/log/logmanager.h"
-
-ProgramLoader::ProgramLoader(const HmcModule &module, const std::vector<std::string> &compilerDirs, const std::string userDir)
-    : _module(module),
-#ifdef PLATFORM_WIN32
-      _fileCompiler(getFile(compilerDirs, "hexacompiler.exe")),
-      _expCompiler (getFile(compilerDirs, "expcompiler.exe")),
-#else
-      _fileCompiler(getFile(compilerDirs, "hexacompiler")),
-      _expCompiler (getFile(compilerDirs, "expcompiler")),
-#endif
-      _userDir(userDir)
+ProgramLoader::ProgramLoader(const std::string cacheDir)
+    : _cacheDir(cacheDir),
+      _compilerHash(fileHashBasis)
 
 {
     UNUSED(hmcElemNames);
+    // A new version of the compiler output invalidates the cache
+    const std::string version = toStr(hmc_output_version());
+    dataHash(version.data(), version.size(), _compilerHash);
 }
 
 Program ProgramLoader::fromString(const std::string &exp) const
 {
-    std::ofstream f("temp.hm");
-    f<<exp<<std::endl;
-    f.close();
-    return fromHM("temp.hm", expression);
+    std::string output;
+    std::string error;
+    if(!compile(exp, expression, output, error))
+    {
+        Log::error("Expression could not be compiled : ", exp, " : ", error);
+        return Program();
+    }
+    return HmcReader(output.data(), output.size()).read();
 }
 
 Program ProgramLoader::fromHM(const std::string &path) const
 {
-    return fromHM(path, file);
-}
-
-Program ProgramLoader::fromHM(const std::string &path, int mode) const
-{
-#if defined(PLATFORM_WIN32)
-    const std::string outputPath = path+"c";
-
-#elif defined(PLATFORM_LINUX) || defined(PLATFORM_APPLE)
-    size_t pos;
-    pos = path.find_last_of('/');
-    if (pos == std::string::npos) {
-        pos = 0;
-    }
-    const std::string outputPath = _userDir + path.substr(pos) + "c";
-
-#else
-    ErrorManager::getInstance()->notify("Error: unsuported operating system");
-    return Program();
-#endif
-
-
-
-    std::string compiler;
-    if(mode == file)
-        compiler = _fileCompiler;
-    else
-        compiler = _expCompiler;
-
-    if(!fileExists(path) || compiler.compare("") == 0)
+    std::string source;
+    if(!readFile(path, source))
     {
-        Log::error("Compiler not found");
+        Log::error("Description file could not be read : ", path);
         return Program();
     }
 
-    const std::vector<std::string> arguments = {path, outputPath};
-
-    Log::info("Executing", compiler, " ", path, " ", outputPath);
-
-    bool success = executeCommand(compiler, arguments);
-
-    if(success)
+    const std::string cachedPath = cachePath(path, source);
+    if(fileExists(cachedPath))
     {
-        return fromHMC(outputPath);
+        Program program = HmcReader(cachedPath, path).read();
+        if(program.isValid())
+        {
+            Log::info("Load cached description file : ", cachedPath);
+            return program;
+        }
     }
-    else
+
+    Log::info("Compile description file : ", path);
+    std::string output;
+    std::string error;
+    if(!compile(source, file, output, error))
     {
+        Log::error("Description file could not be compiled : ", path, " : ", error);
         return Program();
     }
+    if(writeCache(cachedPath, output))
+    {
+        pruneCache(cachedPath);
+    }
+    return HmcReader(output.data(), output.size(), path).read();
 }
 
 Program ProgramLoader::fromHMC(const std::string &path) const
 {
-    auto pmemory = std::make_shared<Program::Memory>();
-    Program::Memory& memory = *pmemory;
-
-    File& file = memory.file();
-    file.setPath(path);
-
-    Object& fileObject = memory.setFileObject(_module.handleFile(_module.getType("File"), file, memory.collector()));
-    fileObject.explore(1);
-
-    if(fileObject.numberOfChildren() >= 2)
-    {
-        return Program(*fileObject.access(1), pmemory);
-    }
-    else
-    {
-        Log::error("Script could not be loaded : ", path);
-        return Program();
-    }
+    return HmcReader(path).read();
 }
 
 Program ProgramLoader::fromFile(const std::string &path) const
@@ -139,22 +107,19 @@ Program ProgramLoader::fromFile(const std::string &path) const
 
     if(fileExists(hmPath))
     {
-        if(fileExists(hmcPath)) {
-            long long hmcLastModified = lastModified(hmcPath);
-            long long hmLastModified  = lastModified(hmPath);
-            if(hmLastModified != -1 && hmLastModified != -1 && hmLastModified < hmcLastModified)
-            {
-                Log::info("Load existing description file : ", hmcPath);
-                return fromHMC(hmcPath);
-            }
-        }
-        Log::info("Compile description file : ", hmPath);
-        return fromHM(hmPath, ProgramLoader::file);
+        return fromHM(hmPath);
     }
     else if(fileExists(hmcPath))
     {
         Log::info("Load existing description file : ", hmcPath);
-        return fromHMC(hmcPath);
+        Program program = fromHMC(hmcPath);
+        if(program.isValid() && !isModule(program))
+        {
+            // For instance an expression compiled by expcompiler
+            Log::error("Compiled file is not a description file : ", hmcPath);
+            return Program();
+        }
+        return program;
     }
     else
     {
@@ -164,46 +129,178 @@ Program ProgramLoader::fromFile(const std::string &path) const
     return Program();
 }
 
-#ifdef PLATFORM_WIN32
-#define __POPEN _popen
-#define __PCLOSE _pclose
-#else
-#define __POPEN popen
-#define __PCLOSE pclose
-#endif
-
-bool ProgramLoader::executeCommand(const std::string &program, const std::vector<std::string> &arguments) const
+std::vector<Program> ProgramLoader::fromFiles(const std::vector<std::string> &basePaths) const
 {
-    std::stringstream commandStream;
+    struct Compilation
+    {
+        std::string path;
+        std::string source;
+        std::string cachedPath;
+        std::string error;
+        bool success;
+    };
+
+    std::vector<Compilation> compilations;
+    for(const std::string& basePath : basePaths)
+    {
+        const std::string hmPath = basePath+".hm";
+        std::string source;
+        if(readFile(hmPath, source))
+        {
+            const std::string cachedPath = cachePath(hmPath, source);
+            if(!fileExists(cachedPath))
+            {
+                Log::info("Compile description file : ", hmPath);
+                compilations.push_back(Compilation{hmPath, source, cachedPath, "", false});
+            }
+        }
+    }
 
-    commandStream<<program;
-    for(const std::string& argument : arguments)
+    // The compiler works on a state of its own for each compilation, the workers only share the index of the next one
+    std::atomic<size_t> next(0);
+    auto work = [this, &compilations, &next]() {
+        for(size_t i = next++; i < compilations.size(); i = next++)
+        {
+            Compilation& compilation = compilations[i];
+            std::string output;
+            compilation.success = compile(compilation.source, file, output, compilation.error)
+                               && writeCache(compilation.cachedPath, output);
+        }
+    };
+
+    const size_t threadCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), compilations.size());
+    std::vector<std::thread> threads;
+    for(size_t i = 1; i < threadCount; ++i)
     {
-        commandStream<<" "<<argument;
+        threads.emplace_back(work);
+    }
+    work();
+    for(std::thread& thread : threads)
+    {
+        thread.join();
     }
 
-    std::string s = commandStream.str();
+    // A script compiled without error but not written to the cache is compiled again by fromFile
+    std::unordered_set<std::string> failures;
+    for(const Compilation& compilation : compilations)
+    {
+        if(compilation.success)
+        {
+            pruneCache(compilation.cachedPath);
+        }
+        else if(!compilation.error.empty())
+        {
+            Log::error("Description file could not be compiled : ", compilation.path, " : ", compilation.error);
+            failures.insert(compilation.path);
+        }
+    }
 
+    std::vector<Program> programs;
+    programs.reserve(basePaths.size());
+    for(const std::string& basePath : basePaths)
+    {
+        if(failures.count(basePath+".hm"))
+        {
+            programs.push_back(Program());
+        }
+        else
+        {
+            programs.push_back(fromFile(basePath));
+        }
+    }
+    return programs;
+}
+
+bool ProgramLoader::scriptHash(const std::string &basePath, uint64_t &hash) const
+{
+    hash = _compilerHash;
+    return fileHash(basePath+".hm", hash) || fileHash(basePath+".hmc", hash);
+}
+
+const std::string &ProgramLoader::cacheDir() const
+{
+    return _cacheDir;
+}
 
-    FILE *f = __POPEN(s.c_str(), "r");
-    if(f == nullptr)
+bool ProgramLoader::compile(const std::string &source, int mode, std::string &output, std::string &error) const
+{
+    hmc_buffer buffer;
+    char message[256];
+    if(hmc_compile(source.data(), source.size(), mode == file ? HMC_FILE_MODE : HMC_EXPRESSION_MODE,
+                   &buffer, message, sizeof(message)) != 0)
     {
+        error = message;
         return false;
     }
 
-    while (!feof(f)) {
-        char buf[512];
-        int r = fread(buf, 1, 512, f);
-        std::cerr.write(buf, r);
+    output.assign(buffer.data, buffer.size);
+    hmc_free_buffer(&buffer);
+    return true;
+}
+
+bool ProgramLoader::writeCache(const std::string &cachedPath, const std::string &output) const
+{
+    // Renamed once complete, so that the cache never holds a truncated file
+    const std::string tempPath = uniqueTempPath(cachedPath);
+    {
+        std::ofstream file(tempPath, std::ios::binary);
+        if(!file.write(output.data(), output.size()))
+        {
+            std::remove(tempPath.c_str());
+            return false;
+        }
     }
 
-    int status = __PCLOSE(f);
+    if(!replaceFile(tempPath, cachedPath))
+    {
+        // Another instance may have put the same file in the cache in the meantime
+        std::remove(tempPath.c_str());
+        return fileExists(cachedPath);
+    }
+    return true;
+}
 
-    return (status == EXIT_SUCCESS);
+std::string ProgramLoader::cachePath(const std::string &path, const std::string &source) const
+{
+    uint64_t hash = _compilerHash;
+    dataHash(source.data(), source.size(), hash);
+
+    // Scripts sharing a name in different directories must not evict each other
+    uint64_t pathHash = fileHashBasis;
+    dataHash(path.data(), path.size(), pathHash);
+
+    size_t begin = path.find_last_of("/\\");
+    begin = (begin == std::string::npos) ? 0 : begin + 1;
+    const std::string name = path.substr(begin, path.rfind('.') - begin);
+
+    return concat(_cacheDir, name, "-", toHex(pathHash, 16), "-", toHex(hash, 16), ".hmc");
+}
+
+void ProgramLoader::pruneCache(const std::string &cachedPath) const
+{
+    // The files compiled from other versions of the same script only differ by their content hash
+    const std::string cachedName = cachedPath.substr(_cacheDir.size());
+    const std::string prefix = cachedName.substr(0, cachedName.size() - 20);
+
+    std::vector<std::string> content;
+    getDirContent(_cacheDir, content);
+    for(const std::string& entry : content)
+    {
+        if(entry.size() == cachedName.size()
+        && entry.compare(0, prefix.size(), prefix) == 0
+        && extension(entry) == "hmc"
+        && entry != cachedName)
+        {
+            std::remove((_cacheDir+entry).c_str());
+        }
+    }
 }
 
-// TODO
-long long ProgramLoader::lastModified(const std::string &/*file*/) const
+bool ProgramLoader::isModule(const Program &program) const
 {
-    return -1LL;
+    return program.tag() == HMC_ROOT
+        && program.size() == 3
+        && program.node(0).tag() == HMC_FORMAT_DETECTION_ADDITIONS
+        && program.node(1).tag() == HMC_IMPORTS
+        && program.node(2).tag() == HMC_CLASS_DECLARATIONS;
 }
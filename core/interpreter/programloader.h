@@ -20,6 +20,7 @@
 
 #include <set>
 #include <memory>
+#include <vector>
 #include <stdint.h>
 
 #include "core/file/file.h"
@@ -27,8 +28,6 @@
 #include "core/module.h"
 #include "core/interpreter/program.h"
 
-class HmcModule;
-
 /**
  * @brief Compile and load \link Program programs\endlink
  *
@@ -36,19 +35,22 @@ class HmcModule;
  * from a compiled HMDL file to be used as a \link Module module\endlink : FromFileModule. It can also
  * compile a HMDL file in order to load subsequently the compiled version.
  *
- * The program loader can also load a \link Program program\endlink from a string compiled by expcompiler
- * to be used as a right value that can be evaluated. This is for instance used by \link Filter filters\endlink
+ * The compiler is linked in, scripts are compiled in memory without running any process.
+ * Compiled HMDL files are kept in a cache directory, under a name made of the name of the script,
+ * a hash of its path and a hash of its content and of the compiler build, so that a script is only
+ * compiled again when either changes.
+ *
+ * The program loader can also load a \link Program program\endlink from a string compiled
+ * as an expression to be used as a right value that can be evaluated. This is for instance used by \link Filter filters\endlink
  * to evaluate if an \link Object object\endlink should pass filtering test or not.
  */
 class ProgramLoader
 {
 public:
     /**
-     * @param module used to parse compiled HMDL files
-     * @param compilerDirs
-     * @param userDir
+     * @param cacheDir where the compiled HMDL files are written
      */
-    ProgramLoader(const HmcModule &module, const std::vector<std::string> &compilerDirs, const std::string userDir);
+    ProgramLoader(const std::string cacheDir);
 
     /**
      * @brief Load a \link Program program\endlink from a string to be used as a right value.
@@ -58,36 +60,55 @@ public:
     /**
      * @brief Compile and load a \link Program program\endlink from an HMDL file to be
      * used as a \link Module module\endlink.
+     *
+     * The compiled file is taken from the cache when it is there.
      */
     Program fromHM (const std::string& path) const;
 
     /**
-     * @brief Compile \link Program program\endlink from a compiled HMDL file to be
+     * @brief Load a \link Program program\endlink from a compiled HMDL file to be
      * used as a \link Module module\endlink.
+     *
+     * The file is decoded by an HmcReader.
      */
     Program fromHMC(const std::string& path) const;
 
     /**
      * @brief Load a \link Program program\endlink from the appopriate source to be used as a module.
      *
-     * The basePath is the name of the HMDL file stripped of its extension. The function will either
-     * use the HMDL file or the compiled HMDL file, depending on their existences and their last
-     * modification times.
+     * The basePath is the name of the HMDL file stripped of its extension. The function will
+     * use the HMDL file if it exists, and the compiled HMDL file otherwise.
      */
     Program fromFile(const std::string& basePath) const;
 
-protected:
-    virtual bool executeCommand(const std::string& program, const std::vector<std::string>& arguments) const;
-    virtual long long lastModified(const std::string& file) const;
+    /**
+     * @brief Load \link Program programs\endlink as fromFile does, in the same order
+     *
+     * The HMDL files missing from the cache are compiled concurrently beforehand.
+     */
+    std::vector<Program> fromFiles(const std::vector<std::string>& basePaths) const;
+
+    /**
+     * @brief Hash of the file fromFile would use for the basePath and of the compiler build,
+     * returns false if there is no such file
+     */
+    bool scriptHash(const std::string& basePath, uint64_t& hash) const;
+
+    /**
+     * @brief Directory where the compiled HMDL files are written
+     */
+    const std::string& cacheDir() const;
 
 private:
     enum Mode {file, expression};
-    Program fromHM (const std::string& path, int mode) const;
-
-    const HmcModule& _module;
-    const std::string _fileCompiler;
-    const std::string _expCompiler;
-    const std::string _userDir;
+    bool compile(const std::string& source, int mode, std::string& output, std::string& error) const;
+    bool writeCache(const std::string& cachedPath, const std::string& output) const;
+    std::string cachePath(const std::string& path, const std::string& source) const;
+    void pruneCache(const std::string& cachedPath) const;
+    bool isModule(const Program& program) const;
+
+    const std::string _cacheDir;
+    uint64_t _compilerHash;
 
 };
 
@@ -0,0 +1,240 @@
+//This file is part of the HexaMonkey project, a multimedia analyser
+//Copyright (C) 2013  Sevan Drapeau-Martin, Nicolas Fleury
+
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+
+#include <cctype>
+#include <algorithm>
+
+#include "core/module.h"
+#include "core/object.h"
+#include "core/interpreter/query.h"
+#include "core/interpreter/programloader.h"
+#include "core/util/strutil.h"
+#include "core/log/logmanager.h"
+
+namespace {
+
+/// Child of the given index, parsing the object progressively, nullptr after the last one
+Object* nextChild(Object& object, int64_t index)
+{
+    while (index >= object.numberOfChildren()) {
+        if (object.parsed()) {
+            return nullptr;
+        }
+
+        const int count = object.numberOfChildren();
+        const int64_t pos = object.file().tellg();
+        object.exploreSome(128);
+        object.file().seekg(pos, std::ios_base::beg);
+
+        if (count == object.numberOfChildren() && !object.parsed()) {
+            Log::error("Parsing locked for index ", index);
+            return nullptr;
+        }
+    }
+    return object.access(index);
+}
+
+}
+
+Query::Query(const ProgramLoader &programLoader)
+    : _programLoader(programLoader)
+{
+}
+
+bool Query::setExpression(const std::string &expression)
+{
+    _steps.clear();
+    _expression = "";
+
+    //Slashes and brackets inside the predicates do not delimit the steps
+    std::vector<std::string> texts;
+    int depth = 0;
+    char quote = 0;
+    size_t begin = 0;
+    for (size_t i = 0; i < expression.size(); ++i) {
+        const char c = expression[i];
+        if (quote != 0) {
+            if (c == '\\') {
+                ++i;
+            } else if (c == quote) {
+                quote = 0;
+            }
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '[') {
+            ++depth;
+        } else if (c == ']') {
+            --depth;
+        } else if (c == '/' && depth == 0) {
+            texts.push_back(expression.substr(begin, i - begin));
+            begin = i + 1;
+        }
+    }
+    texts.push_back(expression.substr(begin));
+
+    if (depth != 0 || quote != 0) {
+        Log::error("Invalid query, unbalanced brackets or quotes : ", expression);
+        return false;
+    }
+
+    std::vector<Step> steps;
+    for (const std::string& text : texts) {
+        Step step;
+        if (!parseStep(text, step)) {
+            Log::error("Invalid query step \"", text, "\" in ", expression);
+            return false;
+        }
+        steps.push_back(step);
+    }
+
+    _steps = std::move(steps);
+    _expression = expression;
+    return true;
+}
+
+const std::string &Query::expression() const
+{
+    return _expression;
+}
+
+bool Query::run(Object &object, const std::function<bool (Object &)> &callback) const
+{
+    if (_steps.empty()) {
+        return true;
+    }
+    return run(object, 0, callback);
+}
+
+std::vector<Object *> Query::select(Object &object) const
+{
+    std::vector<Object*> result;
+    run(object, [&result](Object& match) {
+        result.push_back(&match);
+        return true;
+    });
+    return result;
+}
+
+bool Query::parseStep(const std::string &text, Step &step) const
+{
+    std::string selector = text;
+
+    const size_t bracket = text.find('[');
+    if (bracket != std::string::npos) {
+        if (text.back() != ']') {
+            return false;
+        }
+        step.predicate = std::make_shared<Filter>(_programLoader);
+        if (!step.predicate->setExpression(text.substr(bracket + 1, text.size() - bracket - 2))) {
+            return false;
+        }
+        selector = text.substr(0, bracket);
+    }
+
+    const size_t colon = selector.find(':');
+    if (colon != std::string::npos) {
+        step.typeName = selector.substr(colon + 1);
+        selector = selector.substr(0, colon);
+        if (step.typeName.empty()) {
+            return false;
+        }
+    }
+
+    if (selector.empty()) {
+        step.kind = Step::children;
+        return !step.typeName.empty() || step.predicate;
+    } else if (selector == "*") {
+        step.kind = Step::children;
+    } else if (selector == "**") {
+        step.kind = Step::descendants;
+    } else if (selector[0] == '#') {
+        if (selector.size() == 1
+         || !std::all_of(selector.begin() + 1, selector.end(), [](char c) { return std::isdigit(c); })) {
+            return false;
+        }
+        step.kind = Step::byIndex;
+        step.index = strTo<int64_t>(selector.substr(1));
+    } else {
+        step.kind = Step::byName;
+        step.name = selector;
+    }
+    return true;
+}
+
+bool Query::run(Object &object, size_t step, const std::function<bool (Object &)> &callback) const
+{
+    if (step == _steps.size()) {
+        return callback(object);
+    }
+
+    const Step& current = _steps[step];
+    switch (current.kind) {
+        case Step::byName:
+        {
+            //Same look up as the scripts, through the index of the names
+            Object* child = object.lookUp(current.name, true);
+            return child == nullptr || runChild(*child, step, callback);
+        }
+
+        case Step::byIndex:
+        {
+            Object* child = nextChild(object, current.index);
+            return child == nullptr || runChild(*child, step, callback);
+        }
+
+        case Step::children:
+        case Step::descendants:
+            for (int64_t i = 0; Object* child = nextChild(object, i); ++i) {
+                if (!runChild(*child, step, callback)) {
+                    return false;
+                }
+                if (current.kind == Step::descendants && !run(*child, step, callback)) {
+                    return false;
+                }
+            }
+            return true;
+    }
+    return true;
+}
+
+bool Query::runChild(Object &child, size_t step, const std::function<bool (Object &)> &callback) const
+{
+    return !accepts(_steps[step], child) || run(child, step + 1, callback);
+}
+
+bool Query::accepts(const Step &step, Object &object) const
+{
+    if (!step.typeName.empty() && !extendsType(object, step.typeName)) {
+        return false;
+    }
+    return !step.predicate || (*step.predicate)(object);
+}
+
+bool Query::extendsType(const Object &object, const std::string &typeName) const
+{
+    const ObjectType target = object.module().getType(typeName);
+    if (target.isNull()) {
+        return false;
+    }
+    for (ObjectType type = object.type(); !type.isNull(); type = type.parent()) {
+        if (type.extendsDirectly(target)) {
+            return true;
+        }
+    }
+    return false;
+}
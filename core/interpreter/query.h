@@ -0,0 +1,102 @@
+//This file is part of the HexaMonkey project, a multimedia analyser
+//Copyright (C) 2013  Sevan Drapeau-Martin, Nicolas Fleury
+
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+
+#ifndef QUERY_H
+#define QUERY_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/interpreter/filter.h"
+
+class Object;
+class ProgramLoader;
+
+/**
+ * @brief Select the \link Object objects\endlink of a subtree matching a path
+ *
+ * The path is a list of steps separated by '/', each step selecting objects among
+ * the ones selected by the previous step :
+ *  - "name" : the child with this name, found as a script would (e.g. "header")
+ *  - "#n" : the child with this index (e.g. "#0")
+ *  - "*" : every child
+ *  - "**" : every descendant, at any depth
+ *
+ * The selector may be followed by a type test ":Type", which keeps the objects whose type
+ * extends this template, and by an HMDL expression between brackets, which keeps
+ * the objects for which the expression is true as for a \link Filter filter\endlink. The
+ * selector can be omitted before a type test, in which case every child is tested.
+ *
+ * For instance "**:TrackBox/:MediaBox" or "*:transport_packet[PID == 0x100 && payload_unit_start_indicator]".
+ *
+ * The objects are parsed only as far as the query needs : names and indices are looked up
+ * directly and the children are otherwise parsed progressively while they are tested, so
+ * that the objects matching are given as soon as they are found.
+ */
+class Query
+{
+public:
+    Query(const ProgramLoader& programLoader);
+
+    bool setExpression(const std::string& expression);
+    const std::string& expression() const;
+
+    /**
+     * @brief Call the callback on each object matching, in the order of the file
+     *
+     * The query stops as soon as the callback returns false.
+     * @return false if the query has been stopped by the callback
+     */
+    bool run(Object& object, const std::function<bool (Object&)>& callback) const;
+
+    /**
+     * @brief Every object matching
+     */
+    std::vector<Object*> select(Object& object) const;
+
+private:
+    struct Step
+    {
+        enum Kind {
+            byName,
+            byIndex,
+            children,
+            descendants
+        };
+
+        Kind kind;
+        std::string name;
+        int64_t index;
+        std::string typeName;
+        std::shared_ptr<Filter> predicate;
+    };
+
+    bool parseStep(const std::string& text, Step& step) const;
+    bool run(Object& object, size_t step, const std::function<bool (Object&)>& callback) const;
+    bool runChild(Object& child, size_t step, const std::function<bool (Object&)>& callback) const;
+    bool accepts(const Step& step, Object& object) const;
+    bool extendsType(const Object& object, const std::string& typeName) const;
+
+    const ProgramLoader& _programLoader;
+    std::vector<Step> _steps;
+    std::string _expression;
+};
+
+#endif // QUERY_H
@@ -0,0 +1,394 @@
+//This file is part of the HexaMonkey project, a multimedia analyser
+//Copyright (C) 2013  Sevan Drapeau-Martin, Nicolas Fleury
+
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+#include "compiler/model.h"
+#include "core/objecttypetemplate.h"
+#include "core/interpreter/program.h"
+#include "core/interpreter/scriptprofiler.h"
+#include "core/util/fileutil.h"
+#include "core/util/strutil.h"
+#include "core/util/unused.h"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+std::atomic<bool> profilerEnabled(false);
+
+struct Frame
+{
+    enum Kind {lineFrame, callFrame, typeFrame};
+
+    Kind kind;
+    std::string source;
+    int line;
+    std::string name;
+
+    uint64_t count;
+    /// Nanoseconds spent in the frame, without and with its nested frames
+    uint64_t selfTime;
+    uint64_t totalTime;
+    uint64_t objects;
+    uint64_t size;
+
+    std::string label() const
+    {
+        if (kind == typeFrame) {
+            return name;
+        }
+
+        const size_t begin = source.find_last_of("/\\");
+        std::string location = concat(begin == std::string::npos ? source : source.substr(begin + 1),
+                                      ":", line >= 0 ? toStr(line) : std::string("?"));
+        return name.empty() ? location : concat(location, " ", name);
+    }
+};
+
+/// Path of frames, each node of the tree being a frame executed from the frame of its parent
+struct StackNode
+{
+    uint32_t parent;
+    uint32_t frame;
+    uint64_t selfTime;
+};
+
+struct LineKey
+{
+    const std::string* source;
+    int line;
+    Frame::Kind kind;
+
+    bool operator==(const LineKey& other) const
+    {
+        return source == other.source && line == other.line && kind == other.kind;
+    }
+};
+
+struct LineKeyHash
+{
+    size_t operator()(const LineKey& key) const
+    {
+        return std::hash<const void*>()(key.source) ^ (static_cast<size_t>(key.line) << 2 | key.kind);
+    }
+};
+
+struct Profile
+{
+    std::mutex mutex;
+    std::vector<Frame> frames;
+    std::vector<StackNode> nodes = {StackNode{0, 0, 0}};
+
+    /// The programs and the templates are only identified by address, their names are checked in case it is reused
+    std::unordered_map<LineKey, uint32_t, LineKeyHash> lineFrames;
+    std::unordered_map<const ObjectTypeTemplate*, uint32_t> typeFrames;
+    std::unordered_map<uint64_t, uint32_t> children;
+
+    uint32_t frame(Frame::Kind kind, const std::string& source, int line, const std::string& name)
+    {
+        frames.push_back(Frame{kind, source, line, name, 0, 0, 0, 0, 0});
+        return frames.size() - 1;
+    }
+
+    uint32_t lineFrame(const Program& program, Frame::Kind kind)
+    {
+        const LineKey key{&program.source(), program.line(), kind};
+        auto it = lineFrames.find(key);
+        if (it != lineFrames.end() && frames[it->second].source == program.source()) {
+            return it->second;
+        }
+
+        std::string name;
+        if (kind == Frame::callFrame) {
+            name = callName(program);
+        }
+        const uint32_t id = frame(kind, program.source(), key.line, name);
+        lineFrames[key] = id;
+        return id;
+    }
+
+    uint32_t typeFrame(const ObjectTypeTemplate& typeTemplate)
+    {
+        auto it = typeFrames.find(&typeTemplate);
+        if (it != typeFrames.end() && frames[it->second].name == typeTemplate.name()) {
+            return it->second;
+        }
+
+        const uint32_t id = frame(Frame::typeFrame, std::string(), -1, typeTemplate.name());
+        typeFrames[&typeTemplate] = id;
+        return id;
+    }
+
+    uint32_t child(uint32_t parent, uint32_t frame)
+    {
+        const uint64_t key = static_cast<uint64_t>(parent) << 32 | frame;
+        auto it = children.find(key);
+        if (it != children.end()) {
+            return it->second;
+        }
+
+        nodes.push_back(StackNode{parent, frame, 0});
+        children[key] = nodes.size() - 1;
+        return nodes.size() - 1;
+    }
+
+    static std::string callName(const Program& program)
+    {
+        // The method is usually named by a path, the computed elements are not shown
+        std::string name;
+        const Program path = program.node(0).node(0);
+        if (path.isValid() && path.tag() == HMC_VARIABLE) {
+            for (const Program& elem : path) {
+                if (!name.empty()) {
+                    name += ".";
+                }
+                name += elem.tag() == HMC_IDENTIFIER ? elem.payload().toString() : std::string("[]");
+            }
+        }
+        return name + "()";
+    }
+};
+
+Profile& profile()
+{
+    static Profile profile;
+    return profile;
+}
+
+struct Entry
+{
+    uint32_t frame;
+    uint32_t node;
+    Clock::time_point start;
+    uint64_t childTime;
+};
+
+/// Frames being executed by the thread, and how many times each frame is in the stack for recursive calls
+thread_local std::vector<Entry> stack;
+thread_local std::vector<uint32_t> activeFrames;
+
+std::string milliseconds(uint64_t nanoseconds)
+{
+    std::stringstream S;
+    S << std::fixed << std::setprecision(3) << nanoseconds / 1e6;
+    return S.str();
+}
+
+}
+
+ScriptProfiler::Scope::Scope(const Program &program, Kind kind)
+    : _active(enabled())
+{
+    UNUSED(hmcElemNames);
+    if (_active) {
+        Profile& p = profile();
+        std::lock_guard<std::mutex> lock(p.mutex);
+        enter(p.lineFrame(program, kind == call ? Frame::callFrame : Frame::lineFrame), kind != resumedStatement);
+    }
+}
+
+ScriptProfiler::Scope::Scope(const ObjectTypeTemplate &typeTemplate)
+    : _active(enabled())
+{
+    if (_active) {
+        Profile& p = profile();
+        std::lock_guard<std::mutex> lock(p.mutex);
+        enter(p.typeFrame(typeTemplate), true);
+    }
+}
+
+void ScriptProfiler::Scope::enter(uint32_t frame, bool counted)
+{
+    Profile& p = profile();
+    p.frames[frame].count += counted;
+
+    if (activeFrames.size() <= frame) {
+        activeFrames.resize(p.frames.size(), 0);
+    }
+    ++activeFrames[frame];
+
+    const uint32_t parent = stack.empty() ? 0 : stack.back().node;
+    stack.push_back(Entry{frame, p.child(parent, frame), Clock::now(), 0});
+}
+
+ScriptProfiler::Scope::~Scope()
+{
+    if (!_active) {
+        return;
+    }
+
+    const Entry entry = stack.back();
+    const uint64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - entry.start).count();
+    const uint64_t selfTime = time > entry.childTime ? time - entry.childTime : 0;
+    stack.pop_back();
+    if (!stack.empty()) {
+        stack.back().childTime += time;
+    }
+    const bool outermost = --activeFrames[entry.frame] == 0;
+
+    Profile& p = profile();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    // The measures may have been cleared in the meantime
+    if (entry.frame < p.frames.size() && entry.node < p.nodes.size()) {
+        Frame& frame = p.frames[entry.frame];
+        frame.selfTime += selfTime;
+        if (outermost) {
+            frame.totalTime += time;
+        }
+        p.nodes[entry.node].selfTime += selfTime;
+    }
+}
+
+bool ScriptProfiler::enabled()
+{
+    return profilerEnabled.load(std::memory_order_relaxed);
+}
+
+void ScriptProfiler::setEnabled(bool enabled)
+{
+    profilerEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void ScriptProfiler::clear()
+{
+    Profile& p = profile();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    p.frames.clear();
+    p.nodes.resize(1);
+    p.nodes[0].selfTime = 0;
+    p.lineFrames.clear();
+    p.typeFrames.clear();
+    p.children.clear();
+}
+
+void ScriptProfiler::addObject(const ObjectTypeTemplate &typeTemplate, int64_t size)
+{
+    if (enabled()) {
+        Profile& p = profile();
+        std::lock_guard<std::mutex> lock(p.mutex);
+        Frame& frame = p.frames[p.typeFrame(typeTemplate)];
+        ++frame.objects;
+        frame.size += std::max<int64_t>(size, 0);
+    }
+}
+
+void ScriptProfiler::writeReport(std::ostream &out)
+{
+    Profile& p = profile();
+    std::lock_guard<std::mutex> lock(p.mutex);
+
+    std::vector<const Frame*> lines;
+    std::vector<const Frame*> types;
+    uint64_t totalTime = 0;
+    for (const Frame& frame : p.frames) {
+        (frame.kind == Frame::typeFrame ? types : lines).push_back(&frame);
+        totalTime += frame.selfTime;
+    }
+    auto bySelfTime = [](const Frame* a, const Frame* b) {
+        return a->selfTime > b->selfTime;
+    };
+    std::stable_sort(lines.begin(), lines.end(), bySelfTime);
+    std::stable_sort(types.begin(), types.end(), bySelfTime);
+
+    out << "Time spent in the scripts : " << milliseconds(totalTime) << " ms\n\n";
+
+    out << "Lines by self time\n";
+    out << std::setw(12) << "self (ms)" << std::setw(12) << "total (ms)" << std::setw(12) << "count" << "  line\n";
+
+    // The text of the lines is read from the sources, if still there
+    std::map<std::string, std::vector<std::string> > sources;
+    for (const Frame* frame : lines) {
+        auto it = sources.find(frame->source);
+        if (it == sources.end()) {
+            std::string content;
+            it = sources.emplace(frame->source, readFile(frame->source, content) && extension(frame->source) == "hm"
+                                                ? splitByChar(content, '\n')
+                                                : std::vector<std::string>()).first;
+        }
+
+        out << std::setw(12) << milliseconds(frame->selfTime)
+            << std::setw(12) << milliseconds(frame->totalTime)
+            << std::setw(12) << frame->count
+            << "  " << frame->label();
+
+        const std::vector<std::string>& sourceLines = it->second;
+        if (frame->kind == Frame::lineFrame && frame->line > 0 && static_cast<size_t>(frame->line) <= sourceLines.size()) {
+            const std::string& text = sourceLines[frame->line - 1];
+            const size_t begin = text.find_first_not_of(" \t");
+            const size_t end = text.find_last_not_of(" \t\r");
+            if (begin != std::string::npos) {
+                out << "  " << text.substr(begin, end + 1 - begin);
+            }
+        }
+        out << "\n";
+    }
+
+    out << "\nTypes by self time\n";
+    out << std::setw(12) << "self (ms)" << std::setw(12) << "total (ms)" << std::setw(12) << "count"
+        << std::setw(12) << "objects" << std::setw(14) << "bytes" << "  type\n";
+    for (const Frame* frame : types) {
+        out << std::setw(12) << milliseconds(frame->selfTime)
+            << std::setw(12) << milliseconds(frame->totalTime)
+            << std::setw(12) << frame->count
+            << std::setw(12) << frame->objects
+            << std::setw(14) << frame->size / 8
+            << "  " << frame->label() << "\n";
+    }
+}
+
+void ScriptProfiler::writeFoldedStacks(std::ostream &out)
+{
+    Profile& p = profile();
+    std::lock_guard<std::mutex> lock(p.mutex);
+
+    // The parents are always created before their children
+    std::vector<std::string> paths(p.nodes.size());
+    for (size_t i = 1; i < p.nodes.size(); ++i) {
+        const StackNode& node = p.nodes[i];
+        std::string label = p.frames[node.frame].label();
+        std::replace(label.begin(), label.end(), ';', ',');
+        paths[i] = node.parent == 0 ? label : concat(paths[node.parent], ";", label);
+
+        const uint64_t microseconds = node.selfTime / 1000;
+        if (microseconds > 0) {
+            out << paths[i] << " " << microseconds << "\n";
+        }
+    }
+}
+
+bool ScriptProfiler::write(const std::string &path)
+{
+    std::ofstream report(path);
+    std::ofstream folded(path + ".folded");
+    if (!report || !folded) {
+        return false;
+    }
+
+    writeReport(report);
+    writeFoldedStacks(folded);
+    return report.good() && folded.good();
+}
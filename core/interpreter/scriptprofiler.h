@@ -0,0 +1,106 @@
+//This file is part of the HexaMonkey project, a multimedia analyser
+//Copyright (C) 2013  Sevan Drapeau-Martin, Nicolas Fleury
+
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef SCRIPTPROFILER_H
+#define SCRIPTPROFILER_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+class ObjectTypeTemplate;
+class Program;
+
+/**
+ * @brief Measure where the time goes when HMDL scripts are executed
+ *
+ * Once enabled, the statements executed by BlockExecution and the method calls evaluated
+ * by the Evaluator are counted and timed by the line of the source they begin on, and the
+ * execution of the blocks of a class by FromFileParser by the class, along with the number
+ * and the size of the objects it parsed.
+ *
+ * The frames are nested as they are executed, a statement declaring a field for instance
+ * containing the class of the field and its statements. The report sorts the lines and the
+ * types by the time spent in them, not counting their nested frames, and the folded stacks
+ * give the same time for each path of frames, as expected by flame graph tools.
+ *
+ * The bytecode has no line information : the lines are only measured when the scripts
+ * are executed by the AST interpreter, which is up to the caller to choose. The lines
+ * are also only known for the scripts loaded once the profiler is enabled.
+ */
+class ScriptProfiler
+{
+public:
+    enum Kind {
+        statement,
+        /// Statement whose sub-block is executed again, which is not counted as a new execution
+        resumedStatement,
+        call
+    };
+
+    /**
+     * @brief Time a frame from its construction to its destruction, if the profiler is enabled
+     */
+    class Scope
+    {
+    public:
+        Scope(const Program& program, Kind kind);
+        Scope(const ObjectTypeTemplate& typeTemplate);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        void enter(uint32_t frame, bool counted);
+
+        bool _active;
+    };
+
+    /**
+     * @brief Check if the profiler is measuring, which is not the default
+     */
+    static bool enabled();
+    static void setEnabled(bool enabled);
+
+    /**
+     * @brief Forget every measure made so far
+     */
+    static void clear();
+
+    /**
+     * @brief Count an object whose body has been parsed by the class, with its size in bits
+     */
+    static void addObject(const ObjectTypeTemplate& typeTemplate, int64_t size);
+
+    /**
+     * @brief Write the lines and the types sorted by decreasing self time
+     */
+    static void writeReport(std::ostream& out);
+
+    /**
+     * @brief Write a line for each path of frames with its self time in microseconds
+     */
+    static void writeFoldedStacks(std::ostream& out);
+
+    /**
+     * @brief Write the report to the path and the folded stacks next to it, with the ".folded" extension added
+     */
+    static bool write(const std::string& path);
+};
+
+#endif // SCRIPTPROFILER_H
@@ -0,0 +1,505 @@
+//This file is part of the HexaMonkey project, a multimedia analyser
+//Copyright (C) 2013  Sevan Drapeau-Martin, Nicolas Fleury
+
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+
+#include <limits>
+
+#include "core/module.h"
+#include "core/modulemethod.h"
+#include "core/object.h"
+#include "core/interpreter/virtualmachine.h"
+#include "core/log/logmanager.h"
+#include "core/log/metrics.h"
+#include "core/variable/arrayscope.h"
+#include "core/variable/localscope.h"
+#include "core/variable/mapscope.h"
+#include "core/variable/objectscope.h"
+#include "core/variable/variablecollector.h"
+
+VirtualMachine::VirtualMachine(std::shared_ptr<const Bytecode> code,
+                               const Variable &scope,
+                               LocalScope &locals,
+                               const Module &module,
+                               Object *object,
+                               ObjectScope *objectScope)
+    : _code(code),
+      _scope(scope),
+      _locals(locals),
+      _module(module),
+      _object(object),
+      _objectScope(objectScope),
+      _pc(0),
+      _values(code->valueCount()),
+      _variables(code->variableCount()),
+      _types(code->typeCount())
+{
+}
+
+VirtualMachine::VirtualMachine(std::shared_ptr<const Bytecode> code,
+                               const Variable &scope,
+                               LocalScope &locals,
+                               const Module &module,
+                               Registers &&registers)
+    : _code(code),
+      _scope(scope),
+      _locals(locals),
+      _module(module),
+      _object(nullptr),
+      _objectScope(nullptr),
+      _pc(0),
+      _values(std::move(registers.values)),
+      _variables(std::move(registers.variables)),
+      _types(std::move(registers.types)),
+      _arguments(std::move(registers.arguments))
+{
+    _values.resize(code->valueCount());
+    _variables.resize(code->variableCount());
+    _types.resize(code->typeCount());
+}
+
+VirtualMachine::ExitCode VirtualMachine::execute()
+{
+    size_t parseQuota = std::numeric_limits<size_t>::max();
+    return execute(_code->size(), parseQuota);
+}
+
+VirtualMachine::ExitCode VirtualMachine::executeUntil(size_t breakpoint)
+{
+    size_t parseQuota = std::numeric_limits<size_t>::max();
+    return execute(breakpoint, parseQuota);
+}
+
+VirtualMachine::ExitCode VirtualMachine::execute(size_t &parseQuota)
+{
+    return execute(_code->size(), parseQuota);
+}
+
+VirtualMachine::ExitCode VirtualMachine::execute(size_t breakpoint, size_t &parseQuota)
+{
+    typedef Bytecode::OpCode OpCode;
+
+    const size_t end = _code->size();
+    const Bytecode::Instruction* const instructions = _code->instructions().data();
+    const Variant* const constants = _code->constants().data();
+
+    if (_pc != end && _pc != breakpoint && parseQuota > 0 && aborted()) {
+        return ExitCode::Aborted;
+    }
+
+#ifdef HM_METRICS
+    // Counted locally and added once whichever way the execution stops
+    struct ExecutedInstructions
+    {
+        uint64_t count = 0;
+        ~ExecutedInstructions() {HM_METRICS_ADD(instructionsExecuted, count);}
+    } executed;
+#endif
+
+    while (_pc != end && _pc != breakpoint && parseQuota > 0)
+    {
+        const Bytecode::Instruction& instruction = instructions[_pc];
+        ++_pc;
+#ifdef HM_METRICS
+        ++executed.count;
+#endif
+
+        const int32_t a = instruction.a;
+        const int32_t b = instruction.b;
+        const int32_t c = instruction.c;
+
+        switch (instruction.op)
+        {
+            case OpCode::LoadConstant:
+                _values[a] = constants[b];
+                break;
+
+            case OpCode::Move:
+                _values[a] = _values[b];
+                break;
+
+            case OpCode::ValueOf:
+                _values[a] = _variables[b].value();
+                break;
+
+            case OpCode::Box:
+                _variables[a] = collector().copy(_values[b]);
+                break;
+
+            case OpCode::LoadNull:
+                _variables[a] = collector().null();
+                break;
+
+            case OpCode::LoadUndefined:
+                _variables[a] = Variable();
+                break;
+
+            case OpCode::Field:
+                _variables[a] = field(b, c);
+                break;
+
+            case OpCode::SubField:
+            {
+                const VariablePath& subPath = path(c);
+                HM_METRICS_ADD(pathElementsResolved, subPath.size());
+                _variables[a] = _variables[b].field(subPath);
+                break;
+            }
+
+            case OpCode::LocalField:
+                _variables[a] = localField(b, c);
+                break;
+
+            case OpCode::ReservedField:
+                if (hasBindings()) {
+                    _variables[a] = _objectScope->reservedField(_code->paths()[b].binding, (c & 1) && (c & 2));
+                    if (!(c & 1)) {
+                        _variables[a].setConstant();
+                    }
+                } else {
+                    _variables[a] = field(b, c);
+                }
+                break;
+
+            case OpCode::ReservedValue:
+                if (hasBindings()) {
+                    _values[a] = _objectScope->reservedValue(_code->paths()[b].binding);
+                } else {
+                    _values[a] = field(b, 0).value();
+                }
+                break;
+
+            case OpCode::ParameterValue:
+            {
+                const Bytecode::Path& parameterPath = _code->paths()[b];
+                if (!hasBindings() || !_objectScope->parameterValue(*_code->typeTemplate(),
+                                                                    parameterPath.binding,
+                                                                    parameterPath.staticPath[0].toString(),
+                                                                    _values[a])) {
+                    _values[a] = field(b, 0).value();
+                }
+                break;
+            }
+
+            case OpCode::Assign:
+                if (c < 0) {
+                    _variables[a].setValue(_values[b]);
+                } else {
+                    _variables[a].setValue(binary(static_cast<OpCode>(c), _variables[a].value(), _values[b]));
+                }
+                break;
+
+            case OpCode::Increment:
+                if (b > 0) {
+                    _variables[a].setValue(_variables[a].value() + 1);
+                } else {
+                    _variables[a].setValue(_variables[a].value() - 1);
+                }
+                break;
+
+            case OpCode::PostIncrement:
+            {
+                const Variant value = _variables[b].value();
+                _values[a] = value;
+                if (c > 0) {
+                    _variables[b].setValue(value + 1);
+                } else {
+                    _variables[b].setValue(value - 1);
+                }
+                break;
+            }
+
+            case OpCode::Not:
+                _values[a] = !_values[b];
+                break;
+
+            case OpCode::BitwiseNot:
+                _values[a] = ~_values[b];
+                break;
+
+            case OpCode::Opposite:
+                _values[a] = -_values[b];
+                break;
+
+            case OpCode::Or:
+            case OpCode::And:
+            case OpCode::BitwiseOr:
+            case OpCode::BitwiseXor:
+            case OpCode::BitwiseAnd:
+            case OpCode::Equal:
+            case OpCode::NotEqual:
+            case OpCode::GreaterEqual:
+            case OpCode::Greater:
+            case OpCode::LessEqual:
+            case OpCode::Less:
+            case OpCode::RightShift:
+            case OpCode::LeftShift:
+            case OpCode::Add:
+            case OpCode::Substract:
+            case OpCode::Multiply:
+            case OpCode::Divide:
+            case OpCode::Modulo:
+                _values[a] = binary(instruction.op, _values[b], _values[c]);
+                break;
+
+            case OpCode::LoadType:
+            {
+                const std::string& name = _code->names()[b];
+                _types[a] = _module.getType(name);
+                if (_types[a].isNull()) {
+                    Log::error("Type not found ", name);
+                    _pc = c;
+                }
+                break;
+            }
+
+            case OpCode::SetTypeParameter:
+                _types[a].setParameter(b, _values[c]);
+                break;
+
+            case OpCode::TypeValue:
+                _values[a] = _types[b];
+                break;
+
+            case OpCode::MakeArray:
+            {
+                const Bytecode::List& list = _code->lists()[b];
+                ArrayScope* arrayScope = new ArrayScope(collector());
+                for (int32_t item : list.items) {
+                    arrayScope->addField(_variables[item]);
+                }
+                _variables[a] = Variable(arrayScope, true);
+                break;
+            }
+
+            case OpCode::MakeMap:
+            {
+                const Bytecode::List& list = _code->lists()[b];
+                MapScope* mapScope = new MapScope(collector());
+                for (size_t i = 0; i < list.keywords.size(); ++i) {
+                    mapScope->setField(constants[list.keywords[i]], _variables[list.keywordItems[i]]);
+                }
+                _variables[a] = Variable(mapScope, true);
+                break;
+            }
+
+            case OpCode::Call:
+            {
+                const Bytecode::List& list = _code->lists()[b];
+                //The argument storage is kept from a call to the next
+                _arguments.clear();
+                for (int32_t item : list.items) {
+                    _arguments.push_back(_variables[item]);
+                }
+
+                VariableKeywordArgs kwargs;
+                for (size_t i = 0; i < list.keywords.size(); ++i) {
+                    kwargs[constants[list.keywords[i]].toString()] = _variables[list.keywordItems[i]];
+                }
+
+                _variables[a] = _variables[list.target].call(_arguments, kwargs);
+                _arguments.clear();
+                break;
+            }
+
+            case OpCode::CallNative:
+            {
+                const Bytecode::NativeCall& call = _code->nativeCalls()[b];
+                _values[a] = call.method->evaluate(&_values[c], call.count);
+                break;
+            }
+
+            case OpCode::BoxResult:
+                if (_values[b].isUndefined()) {
+                    _variables[a] = Variable();
+                } else {
+                    _variables[a] = collector().copy(_values[b]);
+                }
+                break;
+
+            case OpCode::AssignField:
+                _variables[a].setConstant();
+                _scope.setField(path(b), _variables[a]);
+                break;
+
+            case OpCode::AssignLocal:
+                _variables[a].setConstant();
+                _locals.setSlot(b, _variables[a]);
+                break;
+
+            case OpCode::Declare:
+                if (_object != nullptr && !_values[a].isValueless()) {
+                    const ObjectType type = _values[a].toObjectType();
+                    const std::string& name = c ? constants[b].toString() : _values[b].toString();
+                    if (_object->addVariable(type, name) != nullptr) {
+                        --parseQuota;
+                    }
+                    if (_pc != end && _pc != breakpoint && parseQuota > 0 && aborted()) {
+                        return ExitCode::Aborted;
+                    }
+                }
+                break;
+
+            case OpCode::LocalDeclare:
+                if (b >= 0) {
+                    _locals.setSlot(a, _variables[b]);
+                } else {
+                    _locals.setSlot(a, collector().null());
+                }
+                break;
+
+            case OpCode::Remove:
+                _scope.removeField(path(a));
+                break;
+
+            case OpCode::RemoveLocal:
+                _locals.removeSlot(a);
+                break;
+
+            case OpCode::Jump:
+                _pc = a;
+                break;
+
+            case OpCode::JumpIfFalse:
+                if (!_values[b].toBool()) {
+                    _pc = a;
+                }
+                break;
+
+            case OpCode::JumpIfValueless:
+                if (_values[b].isValueless()) {
+                    _pc = a;
+                }
+                break;
+
+            case OpCode::JumpIfNoSpace:
+                if (_object == nullptr || _object->availableSize() == 0) {
+                    _pc = a;
+                }
+                break;
+
+            case OpCode::Return:
+                _returnValue = _variables[a];
+                _pc = end;
+                return ExitCode::Returned;
+        }
+    }
+
+    if (_pc == end)
+        return ExitCode::EndReached;
+
+    if (_pc == breakpoint)
+        return ExitCode::BreakPointReached;
+
+    return ExitCode::QuotaExhausted;
+}
+
+bool VirtualMachine::done() const
+{
+    return _pc == _code->size();
+}
+
+Variable VirtualMachine::returnValue() const
+{
+    return _returnValue;
+}
+
+VirtualMachine::Registers VirtualMachine::releaseRegisters()
+{
+    Registers registers{std::move(_values), std::move(_variables), std::move(_types), std::move(_arguments)};
+    registers.values.clear();
+    registers.variables.clear();
+    registers.types.clear();
+    registers.arguments.clear();
+    return registers;
+}
+
+VariableCollector &VirtualMachine::collector() const
+{
+    return _scope.collector();
+}
+
+const VariablePath &VirtualMachine::path(int index)
+{
+    const Bytecode::Path& path = _code->paths()[index];
+    if (path.isStatic) {
+        return path.staticPath;
+    }
+
+    const Variant* const constants = _code->constants().data();
+    _path.clear();
+    for (const Bytecode::PathElement& element : path.elements) {
+        _path.push_back(element.isConstant ? constants[element.index] : _values[element.index]);
+    }
+    return _path;
+}
+
+Variable VirtualMachine::field(int path, int access)
+{
+    const VariablePath& fieldPath = this->path(path);
+    HM_METRICS_ADD(pathElementsResolved, fieldPath.size());
+    return _scope.field(fieldPath, access & 1, access & 2);
+}
+
+Variable VirtualMachine::localField(int slot, int access)
+{
+    //Same as a field access on the scope with the name of the variable
+    const bool modifiable = access & 1;
+    Variable variable = _locals.slotField(slot, modifiable, modifiable && (access & 2));
+    if (!modifiable) {
+        variable.setConstant();
+    }
+    return variable;
+}
+
+bool VirtualMachine::hasBindings() const
+{
+    //Fields set by name in the local scope could hide the fields of the object
+    return _objectScope != nullptr && !_locals.hasUnboundFields();
+}
+
+bool VirtualMachine::aborted() const
+{
+    return _object != nullptr && !_object->isValid();
+}
+
+Variant VirtualMachine::binary(Bytecode::OpCode op, const Variant &a, const Variant &b)
+{
+    typedef Bytecode::OpCode OpCode;
+
+    switch (op)
+    {
+        case OpCode::Or:           return a || b;
+        case OpCode::And:          return a && b;
+        case OpCode::BitwiseOr:    return a | b;
+        case OpCode::BitwiseXor:   return a ^ b;
+        case OpCode::BitwiseAnd:   return a & b;
+        case OpCode::Equal:        return a == b;
+        case OpCode::NotEqual:     return a != b;
+        case OpCode::GreaterEqual: return a >= b;
+        case OpCode::Greater:      return a > b;
+        case OpCode::LessEqual:    return a <= b;
+        case OpCode::Less:         return a < b;
+        case OpCode::RightShift:   return a >> b;
+        case OpCode::LeftShift:    return a << b;
+        case OpCode::Add:          return a + b;
+        case OpCode::Substract:    return a - b;
+        case OpCode::Multiply:     return a * b;
+        case OpCode::Divide:       return a / b;
+        case OpCode::Modulo:       return a % b;
+        default:                   return Variant();
+    }
+}
@@ -0,0 +1,158 @@
+//This file is part of the HexaMonkey project, a multimedia analyser
+//Copyright (C) 2013  Sevan Drapeau-Martin, Nicolas Fleury
+
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+
+#ifndef VIRTUALMACHINE_H
+#define VIRTUALMACHINE_H
+
+#include <memory>
+#include <vector>
+
+#include "core/objecttype.h"
+#include "core/interpreter/blockexecution.h"
+#include "core/interpreter/bytecode.h"
+#include "core/variable/variable.h"
+
+class LocalScope;
+class Module;
+class Object;
+class ObjectScope;
+
+/**
+ * @brief Executes an execution block compiled into \link Bytecode bytecode\endlink
+ *
+ * Drop-in replacement for \link BlockExecution block execution\endlink : the
+ * execution can be suspended at a breakpoint or when the quota of member
+ * declarations is exhausted, and later resumed where it stopped.
+ *
+ * The breakpoints are given as instruction indices, the index of the first
+ * instruction of a top level statement can be obtained with
+ * \link Bytecode::statementPc statementPc\endlink.
+ */
+class VirtualMachine
+{
+public:
+    typedef BlockExecution::ExitCode ExitCode;
+
+    /**
+     * @brief Storage of the registers, which can be handed from an execution to the next
+     * one to reuse its memory
+     */
+    struct Registers
+    {
+        std::vector<Variant> values;
+        std::vector<Variable> variables;
+        std::vector<ObjectType> types;
+        VariableArgs arguments;
+    };
+
+    /**
+     * @param code Compiled block, shared with the other executions of the block
+     * @param scope Used to access variables, built on the local scope.
+     * @param locals Local scope built with the \link Bytecode::localSlots slots\endlink of the code,
+     * used to access the local variables bound at load time.
+     * @param module Used to get types.
+     * @param object Object parsed in case of a class definition.
+     * @param objectScope Context of the local scope in case of a class definition,
+     * used to access the reserved fields and type parameters bound at load time.
+     */
+    VirtualMachine(std::shared_ptr<const Bytecode> code,
+                   const Variable& scope,
+                   LocalScope& locals,
+                   const Module& module,
+                   Object* object = nullptr,
+                   ObjectScope* objectScope = nullptr);
+
+    /**
+     * @brief Construct the execution on the registers released by a previous one
+     */
+    VirtualMachine(std::shared_ptr<const Bytecode> code,
+                   const Variable& scope,
+                   LocalScope& locals,
+                   const Module& module,
+                   Registers&& registers);
+
+    /**
+     * @brief Execute the block until it is done
+     */
+    ExitCode execute();
+
+    /**
+     * @brief Execute the block until the breakpoint is reached or it is done.
+     */
+    ExitCode executeUntil(size_t breakpoint);
+
+    /**
+     * @brief Execute the block until it is done as long as the number of members
+     * declared doesn't exceed the parseQuota
+     */
+    ExitCode execute(size_t& parseQuota);
+
+    /**
+     * @brief Execute the block until the breakpoint is reached or it is done
+     * as long as the number of members declared doesn't exceed the parseQuota
+     */
+    ExitCode execute(size_t breakpoint, size_t& parseQuota);
+
+    /**
+     * @brief Check if the execution of the block is done
+     */
+    bool done() const;
+
+    /**
+     * @brief Get the value returned by the block in case the execution has exited
+     * with a return statement.
+     */
+    Variable returnValue() const;
+
+    /**
+     * @brief Give back the storage of the registers, emptied, once the execution is over
+     */
+    Registers releaseRegisters();
+
+    /**
+     * @brief Result of a binary operation, also used to fold constants at load time
+     */
+    static Variant binary(Bytecode::OpCode op, const Variant& a, const Variant& b);
+
+private:
+    VariableCollector& collector() const;
+    const VariablePath& path(int index);
+    Variable field(int path, int access);
+    Variable localField(int slot, int access);
+    bool hasBindings() const;
+    bool aborted() const;
+
+    std::shared_ptr<const Bytecode> _code;
+    Variable _scope;
+    LocalScope& _locals;
+    const Module& _module;
+    Object* _object;
+    ObjectScope* _objectScope;
+
+    size_t _pc;
+
+    std::vector<Variant> _values;
+    std::vector<Variable> _variables;
+    std::vector<ObjectType> _types;
+    VariableArgs _arguments;
+    VariablePath _path;
+
+    Variable _returnValue;
+};
+
+#endif // VIRTUALMACHINE_H
@@ -0,0 +1,173 @@
+#include "metrics.h"
+
+#ifdef HM_METRICS
+
+#include <algorithm>
+#include <iomanip>
+
+namespace {
+
+const char* counterNames[] = {
+    "objects.created",
+    "objects.freed",
+    "file.reads",
+    "file.bytes_read",
+    "file.seeks",
+    "parser.head",
+    "parser.body",
+    "parser.some",
+    "parser.tail",
+    "collector.runs",
+    "collector.freed",
+    "exceptions",
+    "format.detections",
+    "bytecode.instructions",
+    "bytecode.path_elements"
+};
+
+const char* histogramNames[] = {
+    "file.read_size_bytes",
+    "collector.pause_us",
+    "format.detection_us"
+};
+
+static_assert(sizeof(counterNames) / sizeof(counterNames[0]) == Metrics::counterCount, "A counter has no name");
+static_assert(sizeof(histogramNames) / sizeof(histogramNames[0]) == Metrics::histogramCount, "A histogram has no name");
+
+int bitLength(uint64_t value)
+{
+    int length = 0;
+    for (; value != 0; value >>= 1) {
+        ++length;
+    }
+    return length;
+}
+
+}
+
+std::atomic<uint64_t> Metrics::_counters[Metrics::counterCount];
+Metrics::HistogramData Metrics::_histograms[Metrics::histogramCount];
+
+uint64_t Metrics::Summary::percentile(double ratio) const
+{
+    const uint64_t rank = static_cast<uint64_t>(ratio * count);
+    uint64_t seen = 0;
+    for (int length = 0; length < 65; ++length) {
+        seen += buckets[length];
+        if (seen > rank) {
+            const uint64_t bound = length == 64 ? UINT64_MAX : (uint64_t(1) << length) - 1;
+            return std::min(bound, max);
+        }
+    }
+    return max;
+}
+
+Metrics::Timer::Timer(Histogram histogram)
+    : _histogram(histogram),
+      _start(std::chrono::steady_clock::now())
+{
+}
+
+Metrics::Timer::~Timer()
+{
+    record(_histogram, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _start).count());
+}
+
+void Metrics::record(Histogram histogram, uint64_t value)
+{
+    HistogramData& data = _histograms[histogram];
+    data.count.fetch_add(1, std::memory_order_relaxed);
+    data.sum.fetch_add(value, std::memory_order_relaxed);
+    data.buckets[bitLength(value)].fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t max = data.max.load(std::memory_order_relaxed);
+    while (value > max && !data.max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t Metrics::value(Counter counter)
+{
+    return _counters[counter].load(std::memory_order_relaxed);
+}
+
+Metrics::Summary Metrics::summary(Histogram histogram)
+{
+    const HistogramData& data = _histograms[histogram];
+    Summary summary;
+    summary.count = data.count.load(std::memory_order_relaxed);
+    summary.sum = data.sum.load(std::memory_order_relaxed);
+    summary.max = data.max.load(std::memory_order_relaxed);
+    for (int length = 0; length < 65; ++length) {
+        summary.buckets[length] = data.buckets[length].load(std::memory_order_relaxed);
+    }
+    return summary;
+}
+
+const char *Metrics::name(Counter counter)
+{
+    return counterNames[counter];
+}
+
+const char *Metrics::name(Histogram histogram)
+{
+    return histogramNames[histogram];
+}
+
+void Metrics::reset()
+{
+    for (auto& counter : _counters) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+    for (auto& data : _histograms) {
+        data.count.store(0, std::memory_order_relaxed);
+        data.sum.store(0, std::memory_order_relaxed);
+        data.max.store(0, std::memory_order_relaxed);
+        for (auto& bucket : data.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void Metrics::writeText(std::ostream &out)
+{
+    for (int counter = 0; counter < counterCount; ++counter) {
+        out << std::left << std::setw(24) << name(static_cast<Counter>(counter))
+            << std::right << std::setw(14) << value(static_cast<Counter>(counter)) << "\n";
+    }
+
+    for (int histogram = 0; histogram < histogramCount; ++histogram) {
+        const Summary s = summary(static_cast<Histogram>(histogram));
+        out << std::left << std::setw(24) << name(static_cast<Histogram>(histogram)) << std::right
+            << " count " << s.count
+            << " sum " << s.sum
+            << " mean " << (s.count ? s.sum / s.count : 0)
+            << " p50 " << s.percentile(0.5)
+            << " p90 " << s.percentile(0.9)
+            << " p99 " << s.percentile(0.99)
+            << " max " << s.max << "\n";
+    }
+}
+
+void Metrics::writeJson(std::ostream &out)
+{
+    out << "{\n  \"counters\": {";
+    for (int counter = 0; counter < counterCount; ++counter) {
+        out << (counter ? "," : "") << "\n    \"" << name(static_cast<Counter>(counter)) << "\": "
+            << value(static_cast<Counter>(counter));
+    }
+
+    out << "\n  },\n  \"histograms\": {";
+    for (int histogram = 0; histogram < histogramCount; ++histogram) {
+        const Summary s = summary(static_cast<Histogram>(histogram));
+        out << (histogram ? "," : "") << "\n    \"" << name(static_cast<Histogram>(histogram)) << "\": {"
+            << "\"count\": " << s.count
+            << ", \"sum\": " << s.sum
+            << ", \"p50\": " << s.percentile(0.5)
+            << ", \"p90\": " << s.percentile(0.9)
+            << ", \"p99\": " << s.percentile(0.99)
+            << ", \"max\": " << s.max << "}";
+    }
+    out << "\n  }\n}\n";
+}
+
+#endif // HM_METRICS
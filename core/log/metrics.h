@@ -0,0 +1,142 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+/**
+ * @file
+ * The metrics are only compiled in when HM_METRICS is defined, which the qmake
+ * files do unless CONFIG+=nometrics is given. They are updated through the macros
+ * below, which expand to nothing otherwise, so that the hot path does not pay for
+ * them when they are disabled.
+ */
+
+#ifdef HM_METRICS
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <stdint.h>
+
+/**
+ * @brief Registry of counters and histograms of what the parsing did
+ *
+ * The metrics are global and shared by every thread, each update being a relaxed atomic
+ * addition. The histograms count the values by power of two, which is enough to give
+ * their percentiles with the order of magnitude.
+ */
+class Metrics
+{
+public:
+    enum Counter {
+        objectsCreated,
+        objectsFreed,
+        /// Calls to read and seekg on the files opened from the disk
+        fileReads,
+        fileBytesRead,
+        fileSeeks,
+        /// Calls to the parsers, by the part of the object parsed
+        headParsings,
+        bodyParsings,
+        partialParsings,
+        tailParsings,
+        collections,
+        collectedVariables,
+        exceptions,
+        formatDetections,
+        /// Instructions run by the bytecode virtual machine
+        instructionsExecuted,
+        /// Elements of the paths the virtual machine resolves to read or write fields
+        pathElementsResolved,
+        counterCount
+    };
+
+    enum Histogram {
+        /// Bytes read by each call
+        readSize,
+        /// Microseconds spent by each collection
+        collectionPause,
+        /// Microseconds spent detecting the format of each file
+        formatDetectionTime,
+        histogramCount
+    };
+
+    struct Summary
+    {
+        uint64_t count;
+        uint64_t sum;
+        uint64_t max;
+        /// Number of values of each bit length, the first bucket holding 0
+        uint64_t buckets[65];
+
+        /**
+         * @brief Value under which the ratio of the values fall, rounded up to the bound of its bucket
+         */
+        uint64_t percentile(double ratio) const;
+    };
+
+    /**
+     * @brief Time the scope and record the duration in microseconds in the histogram
+     */
+    class Timer
+    {
+    public:
+        Timer(Histogram histogram);
+        ~Timer();
+
+    private:
+        Histogram _histogram;
+        std::chrono::steady_clock::time_point _start;
+    };
+
+    static inline void add(Counter counter, uint64_t n)
+    {
+        _counters[counter].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    static void record(Histogram histogram, uint64_t value);
+
+    static uint64_t value(Counter counter);
+    static Summary summary(Histogram histogram);
+    static const char* name(Counter counter);
+    static const char* name(Histogram histogram);
+
+    /**
+     * @brief Set every counter and histogram back to zero
+     */
+    static void reset();
+
+    /**
+     * @brief Write a line for each counter and each histogram
+     */
+    static void writeText(std::ostream& out);
+
+    /**
+     * @brief Write an object with the counters and the summaries of the histograms
+     */
+    static void writeJson(std::ostream& out);
+
+private:
+    struct HistogramData
+    {
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> sum;
+        std::atomic<uint64_t> max;
+        std::atomic<uint64_t> buckets[65];
+    };
+
+    static std::atomic<uint64_t> _counters[counterCount];
+    static HistogramData _histograms[histogramCount];
+};
+
+#define HM_METRICS_ADD(counter, n) Metrics::add(Metrics::counter, (n))
+#define HM_METRICS_RECORD(histogram, value) Metrics::record(Metrics::histogram, (value))
+#define HM_METRICS_TIME(histogram) Metrics::Timer metricsTimer(Metrics::histogram)
+
+#else
+
+#define HM_METRICS_ADD(counter, n) static_cast<void>(0)
+#define HM_METRICS_RECORD(histogram, value) static_cast<void>(0)
+#define HM_METRICS_TIME(histogram) static_cast<void>(0)
+
+#endif // HM_METRICS
+
+#endif // METRICS_H
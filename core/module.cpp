@@ -44,6 +44,7 @@ void Module::import(const Module &module)
         }
         _importedModulesChain.insert(_importedModulesChain.begin(), &module);
         _importedModulesMap[module.name()] = &module;
+        clearResolutions();
     } else {
         Log::error("Module ", module.name(), " has already been imported by ", name());
     }
@@ -60,6 +61,14 @@ ObjectType Module::specify(const ObjectType &parent) const
        return ObjectType();
     }
 
+    {
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        const TypeResolution* cached = resolution(parent);
+        if (cached != nullptr && cached->isSpecified) {
+            return cached->specification;
+        }
+    }
+
     ObjectType child = specifyLocally(parent);
     if(child.isNull())
     {
@@ -70,6 +79,13 @@ ObjectType Module::specify(const ObjectType &parent) const
                 break;
         }
     }
+
+    std::lock_guard<std::mutex> lock(_cacheMutex);
+    TypeResolution* resolved = resolution(parent);
+    if (resolved != nullptr) {
+        resolved->isSpecified = true;
+        resolved->specification = child;
+    }
     return child;
 }
 
@@ -93,20 +109,12 @@ ObjectType Module::specifyLocally(const ObjectType& parent) const
 
 void Module::addParsers(Object &object, const ObjectType &type) const
 {
-    //Building the father list
-
     ObjectType currentType = type;
     ObjectType lastType;
     while (!currentType.isNull()) {
-        std::list<ObjectType> fathers;
-        while(currentType.typeTemplate() != lastType.typeTemplate() && !currentType.isNull())
-        {
-            fathers.push_front(currentType);
-            currentType = currentType.parent();
-        }
-
         //Adding the fathers' parsers
-        for(ObjectType father : fathers)
+        const std::shared_ptr<const FatherChain> fathers = fatherChain(currentType, lastType.typeTemplate());
+        for(const ObjectType& father : *fathers)
         {
             object.setType(father);
             Parser* parser = father.parseOrGetParser(static_cast<ParsingOption&>(object));
@@ -117,6 +125,12 @@ void Module::addParsers(Object &object, const ObjectType &type) const
         currentType = specify(lastType);
     }
 
+    //In skeleton mode the tail is left for later as long as the size is known,
+    //it is run when the description is first accessed (see Object::parseDescription)
+    if (object.parsingMode() == Object::skeletonParsing && object.size() != -1) {
+        return;
+    }
+
     const auto& parsers = object._parsers;
     if (std::any_of(parsers.begin(), parsers.end(), [](const std::unique_ptr<Parser>& parser) {
         if (parser) {
@@ -131,8 +145,84 @@ void Module::addParsers(Object &object, const ObjectType &type) const
 
 
 
+std::shared_ptr<const Module::FatherChain> Module::fatherChain(const ObjectType &type, const ObjectTypeTemplate &stopTemplate) const
+{
+    {
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        const TypeResolution* cached = resolution(type);
+        if (cached != nullptr) {
+            for (const auto& entry : cached->fatherChains) {
+                if (entry.first == &stopTemplate) {
+                    return entry.second;
+                }
+            }
+        }
+    }
+
+    std::shared_ptr<FatherChain> fathers = std::make_shared<FatherChain>();
+    ObjectType currentType = type;
+    while(currentType.typeTemplate() != stopTemplate && !currentType.isNull())
+    {
+        fathers->push_back(currentType);
+        currentType = currentType.parent();
+    }
+    std::reverse(fathers->begin(), fathers->end());
+
+    //The evaluation of the parents may have modified the table
+    std::lock_guard<std::mutex> lock(_cacheMutex);
+    TypeResolution* resolved = resolution(type);
+    if (resolved != nullptr) {
+        resolved->fatherChains.emplace_back(&stopTemplate, fathers);
+    }
+    return fathers;
+}
+
+Module::TypeResolution *Module::resolution(const ObjectType &type) const
+{
+    auto it = _resolutions.find(type);
+    if (it != _resolutions.end()) {
+        return &it->second;
+    }
+
+    size_t& count = _resolutionCounts[&type.typeTemplate()];
+    if (count >= maxResolutionsPerTemplate) {
+        return nullptr;
+    }
+
+    ++count;
+    if (count == maxResolutionsPerTemplate) {
+        //The parameters of the template depend on the data, its types are not worth caching
+        for (auto entry = _resolutions.begin(); entry != _resolutions.end();) {
+            if (&entry->first.typeTemplate() == &type.typeTemplate()) {
+                entry = _resolutions.erase(entry);
+            } else {
+                ++entry;
+            }
+        }
+        return nullptr;
+    }
+
+    return &_resolutions[type];
+}
+
+void Module::clearResolutions()
+{
+    std::lock_guard<std::mutex> lock(_cacheMutex);
+    _resolutions.clear();
+    _resolutionCounts.clear();
+}
+
+void Module::freezeSpecializers()
+{
+    for (auto& item : _specializers) {
+        item.second.freeze();
+    }
+}
+
 void Module::setSpecification(const ObjectType& parent, const ObjectType& child)
 {
+    clearResolutions();
+
     if (!parent.typeTemplate().isVirtual()) {
         Log::error("Cannot forward ",parent," to ",child," because ",parent.typeTemplate().name(), " is not virtual ");
     }
@@ -150,7 +240,7 @@ void Module::setSpecification(const ObjectType& parent, const ObjectType& child)
 
 
 
-Object* Module::handle(const ObjectType& type, File& file, Object* parent, VariableCollector &collector) const
+Object* Module::handle(const ObjectType& type, File& file, Object* parent, VariableCollector &collector, Object::ParsingMode mode) const
 {
     Object* object;
 
@@ -159,6 +249,7 @@ Object* Module::handle(const ObjectType& type, File& file, Object* parent, Varia
         parent->_lastChild = object;
     } else {
         object = new Object(file, 0, nullptr, collector, *this);
+        object->_parsingMode = mode;
     }
 
     addParsers(*object, type);
@@ -167,18 +258,26 @@ Object* Module::handle(const ObjectType& type, File& file, Object* parent, Varia
 
 const ObjectTypeTemplate& Module::getTemplate(const std::string &name) const
 {
-    const auto it = _templates.find(name);
+    {
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        const auto it = _templates.find(name);
 
-    if(it != _templates.end())
-        return *it->second;
+        if(it != _templates.end())
+            return *it->second;
+    }
 
     for(const Module* importedModule : _importedModulesChain)
     {
+        std::unique_lock<std::mutex> importedLock(importedModule->_cacheMutex);
         const auto it = importedModule->_templates.find(name);
 
-        if(it != _templates.end()) {
-            _templates[name] = it->second;
-            return *it->second;
+        if(it != importedModule->_templates.end()) {
+            const ObjectTypeTemplate* typeTemplate = it->second;
+            importedLock.unlock();
+
+            std::lock_guard<std::mutex> lock(_cacheMutex);
+            _templates[name] = typeTemplate;
+            return *typeTemplate;
         }
     }
 
@@ -204,23 +303,54 @@ private:
 
 Variable Module::getVariable(const std::string &name, VariableCollector &collector) const
 {
-    const auto it = _methods.find(name);
+    const ModuleMethod* method = getMethod(name);
+
+    if(method != nullptr) {
+        return Variable(new ModuleMethodVariableImplementation(*method, collector), false);
+    }
+
+    return Variable();
+}
+
+const ModuleMethod *Module::getMethod(const std::string &name) const
+{
+    {
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        const auto it = _methods.find(name);
 
-    if(it != _methods.end()) {
-        return Variable(new ModuleMethodVariableImplementation(*it->second, collector), false);
+        if(it != _methods.end()) {
+            return it->second;
+        }
     }
 
     for(const Module* importedModule : _importedModulesChain)
     {
+        std::unique_lock<std::mutex> importedLock(importedModule->_cacheMutex);
         const auto it = importedModule->_methods.find(name);
 
-        if(it != _methods.end()) {
-            _methods[name] = it->second;
-            return Variable(new ModuleMethodVariableImplementation(*it->second, collector), false);
+        if(it != importedModule->_methods.end()) {
+            const ModuleMethod* method = it->second;
+            importedLock.unlock();
+
+            std::lock_guard<std::mutex> lock(_cacheMutex);
+            _methods[name] = method;
+            return method;
         }
     }
 
-    return Variable();
+    return nullptr;
+}
+
+std::vector<const Module *> Module::parsingModules() const
+{
+    std::vector<const Module*> modules{this};
+    for(const Module* importedModule : _importedModulesChain)
+    {
+        if(importedModule->hasParsingState()) {
+            modules.push_back(importedModule);
+        }
+    }
+    return modules;
 }
 
 void Module::addFormatDetection(StandardFormatDetector::Adder &/*formatAdder*/)
@@ -232,6 +362,11 @@ void Module::requestImportations(std::vector<std::string> &/*formatRequested*/)
 {
 }
 
+bool Module::hasParsingState() const
+{
+    return true;
+}
+
 bool Module::doLoad()
 {
     return true;
@@ -26,10 +26,13 @@
 #include <set>
 #include <algorithm>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 #include "core/objecttype.h"
 #include "core/objecttypetemplate.h"
 #include "core/formatdetector/standardformatdetector.h"
+#include "core/varianthash.h"
 #include "core/variable/variable.h"
 #include "core/specializer.h"
 #include "core/modulemethod.h"
@@ -91,9 +94,16 @@ public:
      */
     void setSpecification(const ObjectType& parent, const ObjectType& child);
 
-    inline Object* handleFile(const ObjectType &type, File& file, VariableCollector& collector) const
+    /**
+     * @brief Create the root \link Object object\endlink of a file
+     *
+     * In \link Object::skeletonParsing skeleton\endlink mode, the elements of the whole tree are only
+     * parsed up to what is needed to know their size and type, the rest is parsed when they are explored
+     * and their value, link and attributes when they are accessed.
+     */
+    inline Object* handleFile(const ObjectType &type, File& file, VariableCollector& collector, Object::ParsingMode mode = Object::fullParsing) const
     {
-        return handle(type, file, nullptr, collector);
+        return handle(type, file, nullptr, collector, mode);
     }
     /**
      * @brief Create an object beginning at the current position of the file and add the appropriate \link Parser
@@ -159,6 +169,13 @@ public:
 
     Variable getVariable(const std::string& name, VariableCollector& collector) const;
 
+    /**
+     * @brief Get the method by this name among the current \link Module module\endlink and the imported ones
+     *
+     * Return nullptr if no method by this name exists
+     */
+    const ModuleMethod* getMethod(const std::string& name) const;
+
     /**
      * @brief Get the module able to handle a function by this name among the current\link Module module\endlink and the imported ones
      *
@@ -195,6 +212,14 @@ public:
         return _loaded;
     }
 
+    /**
+     * @brief Get the modules whose state is modified when parsing a file with the \link Module module\endlink :
+     * the module itself and the imported ones \link hasParsingState() having a parsing state\endlink
+     *
+     * Two files can only be parsed concurrently if they don't share any of these modules.
+     */
+    std::vector<const Module*> parsingModules() const;
+
 protected:
     /**
      * @brief [Pure Virtual] Use the \link StandardFormatDetector::Adder format adder\endlink to add format detection methods, so that the
@@ -214,6 +239,14 @@ protected:
      */
     virtual bool doLoad();
 
+    /**
+     * @brief Check if parsing a file with a \link Module module\endlink importing this one modifies
+     * the state of this one (e.g. the collector or the lazily compiled code of an \link FromFileModule HMDL module\endlink)
+     *
+     * True by default, a module only read once loaded can be shared by the parsings of several files.
+     */
+    virtual bool hasParsingState() const;
+
     /**
      * @brief Register a \link ObjectTypeTemplate type template\endlink to the \link Module module\endlink so that it can be
      * accessed by its name by the function getTemplate.
@@ -251,14 +284,52 @@ private:
         if(!_loaded)
         {
             _loaded = doLoad();
+            if (_loaded) {
+                freezeSpecializers();
+            }
         }
         return _loaded;
     }
 
+    void freezeSpecializers();
+
     ObjectType specifyLocally(const ObjectType& parent) const;
     void addParsers(Object& data, const ObjectType &type) const;
 
-    Object* handle(const ObjectType& type, File& file, Object *parent, VariableCollector& collector) const;
+    typedef std::vector<ObjectType> FatherChain;
+
+    /**
+     * @brief Resolved inheritance of a \link ObjectType type\endlink, shared between all the
+     * \link Object objects\endlink created with this type
+     *
+     * The father chains are given root first and stop before the \link ObjectTypeTemplate template\endlink
+     * they were resolved from, the specification is the one of the type once parsed by these fathers.
+     */
+    struct TypeResolution
+    {
+        std::vector<std::pair<const ObjectTypeTemplate*, std::shared_ptr<const FatherChain> > > fatherChains;
+        bool isSpecified = false;
+        ObjectType specification;
+    };
+
+    /**
+     * @brief Chain of the fathers of the type up to the template given, evaluated once per type
+     */
+    std::shared_ptr<const FatherChain> fatherChain(const ObjectType& type, const ObjectTypeTemplate& stopTemplate) const;
+
+    /**
+     * @brief Cache entry for the type, or nullptr if the type's template depends on the data
+     * (more than maxResolutionsPerTemplate distinct types seen)
+     *
+     * The cache mutex must be held while the entry is used, the types are resolved without
+     * holding it since their evaluation can resolve other types.
+     */
+    TypeResolution* resolution(const ObjectType& type) const;
+    void clearResolutions();
+
+    static const size_t maxResolutionsPerTemplate = 256;
+
+    Object* handle(const ObjectType& type, File& file, Object *parent, VariableCollector& collector, Object::ParsingMode mode = Object::fullParsing) const;
 
     std::string _name;
     bool _loaded;
@@ -266,10 +337,16 @@ private:
     std::vector<const Module*> _importedModulesChain;
     std::unordered_map<std::string, const Module*> _importedModulesMap;
 
+    /// Guards the lookup and resolution caches, which are filled while parsing from any thread
+    mutable std::mutex _cacheMutex;
+
     mutable std::unordered_map<std::string, const ObjectTypeTemplate*> _templates;
     std::vector<std::unique_ptr<ObjectTypeTemplate> > _ownedTemplates;
     std::unordered_map<ObjectTypeTemplate *, Specializer> _specializers;
 
+    mutable std::unordered_map<ObjectType, TypeResolution, std::hash<ObjectType>, IdenticalType> _resolutions;
+    mutable std::unordered_map<const ObjectTypeTemplate*, size_t> _resolutionCounts;
+
 
     mutable std::unordered_map<std::string, const ModuleMethod*> _methods;
     std::vector<std::unique_ptr<ModuleMethod> > _ownedMethods;
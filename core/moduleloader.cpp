@@ -18,9 +18,11 @@
 #include <memory>
 
 #include "core/moduleloader.h"
+#include "core/formatdetector/detectionmanifest.h"
 #include "core/objecttypetemplate.h"
 #include "core/interpreter/fromfilemodule.h"
 #include "core/interpreter/programloader.h"
+#include "core/log/metrics.h"
 #include "core/modules/default/defaultmodule.h"
 #include "core/modules/hmc/hmcmodule.h"
 #include "core/util/fileutil.h"
@@ -35,7 +37,12 @@ ModuleLoader::ModuleLoader()
 
 const Module &ModuleLoader::getModule(File &file) const
 {
-    const std::string& format = formatDetector.getFormat(file);
+    std::string format;
+    {
+        HM_METRICS_TIME(formatDetectionTime);
+        format = formatDetector.getFormat(file);
+    }
+    HM_METRICS_ADD(formatDetections, 1);
     return getModule(format);
 }
 
@@ -118,9 +125,45 @@ void ModuleLoader::refreshDirectories(const ProgramLoader &programLoader)
         }
     }
 
+    // The scripts found in the manifest are only loaded once used, the others are loaded
+    // now to read their format detections
+    DetectionManifest manifest(programLoader.cacheDir()+"detections.manifest");
+    std::vector<std::string> keys;
+    std::vector<std::string> basePaths;
+    std::vector<uint64_t> hashes;
     for(const auto& entry: selected)
     {
-        addModule(entry.first, new FromFileModule(programLoader.fromFile(entry.second)));
+        uint64_t hash;
+        if(!programLoader.scriptHash(entry.second, hash))
+            continue;
+
+        const FormatDetections* detections = manifest.find(entry.second, hash);
+        if(detections != nullptr)
+        {
+            addModule(entry.first, new FromFileModule(programLoader, entry.second, *detections));
+        }
+        else
+        {
+            keys.push_back(entry.first);
+            basePaths.push_back(entry.second);
+            hashes.push_back(hash);
+        }
+    }
+
+    std::vector<Program> programs = programLoader.fromFiles(basePaths);
+    for(size_t i = 0; i < keys.size(); ++i)
+    {
+        FromFileModule* module = new FromFileModule(programs[i]);
+        if(programs[i].isValid())
+        {
+            manifest.set(basePaths[i], hashes[i], module->formatDetections());
+        }
+        addModule(keys[i], module);
+    }
+
+    if(!manifest.save())
+    {
+        Log::warning("Format detection manifest could not be written in ", programLoader.cacheDir());
     }
 }
 
@@ -60,7 +60,9 @@ public:
      *
      * The key for the module are the name of the files (extension excluded)
      *
-     * The files are compiled again only if the compiled file is less recent than the original file
+     * The format detections of the files are kept in a \link DetectionManifest manifest\endlink in the cache
+     * directory of the \link ProgramLoader program loader\endlink, so that a file is only loaded when its
+     * module is first used, unless it is not in the manifest yet.
      */
     void setDirectories(const std::vector<std::string> &directories, const ProgramLoader &programLoader);
 
@@ -10,10 +10,30 @@ Variable ModuleMethod::call(VariableArgs &, VariableKeywordArgs &, VariableColle
     return Variable();
 }
 
+bool ModuleMethod::isPure() const
+{
+    return true;
+}
+
+const NativeMethod *ModuleMethod::native() const
+{
+    return nullptr;
+}
+
+const FromFileMethod *ModuleMethod::script() const
+{
+    return nullptr;
+}
+
+const std::vector<MethodArgument> &ModuleMethod::signature() const
+{
+    return _signature;
+}
+
 void ModuleMethod::fillNumberedArgs(VariableArgs &args, const VariableKeywordArgs &kwargs, VariableCollector &collector) const
 {
     const size_t nSignature = _signature.size();
-    size_t i = 0;
+    size_t i = args.size();
 
     for (; i < nSignature; ++i)
     {
@@ -41,3 +61,29 @@ void ModuleMethod::fillArgs(VariableArgs &args, VariableKeywordArgs &kwargs, Var
         }
     }
 }
+
+NativeMethod::NativeMethod()
+{
+}
+
+Variable NativeMethod::call(VariableArgs &args, VariableKeywordArgs &kwargs, VariableCollector &collector) const
+{
+    fillNumberedArgs(args, kwargs, collector);
+
+    std::vector<Variant> values;
+    values.reserve(args.size());
+    for (const Variable& arg : args) {
+        values.push_back(arg.value());
+    }
+
+    const Variant result = evaluate(values.data(), values.size());
+    if (result.isUndefined()) {
+        return Variable();
+    }
+    return collector.copy(result);
+}
+
+const NativeMethod *NativeMethod::native() const
+{
+    return this;
+}
@@ -41,6 +41,9 @@ private:
     Variant _defaultValue;
 };
 
+class NativeMethod;
+class FromFileMethod;
+
 class ModuleMethod
 {
 public:
@@ -53,6 +56,22 @@ public:
 
     virtual Variable call(VariableArgs& args, VariableKeywordArgs& kwargs, VariableCollector& collector) const;
 
+    /**
+     * @brief Check that the method has no side effect, so that its result only depends on its arguments
+     */
+    virtual bool isPure() const;
+
+    /**
+     * @brief Get the method as a \link NativeMethod native method\endlink, nullptr if it isn't one
+     */
+    virtual const NativeMethod* native() const;
+
+    /**
+     * @brief Get the method as a \link FromFileMethod method defined in a script\endlink, nullptr if it isn't one
+     */
+    virtual const FromFileMethod* script() const;
+
+    const std::vector<MethodArgument>& signature() const;
 
     void fillNumberedArgs(VariableArgs& args, const VariableKeywordArgs& kwargs, VariableCollector& collector) const;
 
@@ -62,4 +81,40 @@ private:
     std::vector<MethodArgument> _signature;
 };
 
+/**
+ * @brief Method computing its result from the values of its arguments only
+ *
+ * Calls naming the method with positional arguments only are bound when they are compiled:
+ * the default values of the signature are materialized once, and the values are passed
+ * directly, without building variables, argument vectors or keyword maps.
+ */
+class NativeMethod : public ModuleMethod
+{
+public:
+    /// Bound calls cannot use more values than that
+    static const size_t maxArguments = 8;
+
+    NativeMethod();
+
+    template <typename TSignature>
+    NativeMethod(TSignature&& signature) : ModuleMethod(signature)
+    {
+    }
+
+    /**
+     * @brief Call through variables, for the calls that could not be bound
+     */
+    virtual Variable call(VariableArgs& args, VariableKeywordArgs& kwargs, VariableCollector& collector) const override;
+
+    virtual const NativeMethod* native() const override;
+
+    /**
+     * @brief Compute the result from the values of the positional arguments, completed
+     * with the default values of the signature
+     *
+     * An undefined result is given back as an undefined variable by call.
+     */
+    virtual Variant evaluate(const Variant* args, size_t count) const = 0;
+};
+
 #endif // MODULEMETHOD_H
@@ -10,6 +10,9 @@ DataTypeTemplate::DataTypeTemplate()
 Parser *DataTypeTemplate::parseOrGetParser(const ObjectType &type, ParsingOption &option) const
 {
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
 
     if (type.parameterSpecified(0))
     {
@@ -11,19 +11,19 @@
 
 #include "core/log/logmanager.h"
 
-class SizeOfMethod : public ModuleMethod
+class SizeOfMethod : public NativeMethod
 {
-    virtual Variable call(VariableArgs& args, VariableKeywordArgs&, VariableCollector& collector) const override
+    virtual Variant evaluate(const Variant* args, size_t count) const override
     {
-        if (args.size() >= 1) {
-            int64_t size = args[0].value().toObjectType().fixedSize();
+        if (count >= 1) {
+            int64_t size = args[0].toObjectType().fixedSize();
             if (size != -1) {
-                return collector.copy(size);
+                return size;
             } else {
-                return collector.null();
+                return Variant::null();
             }
         } else {
-            return Variable();
+            return Variant();
         }
     }
 };
@@ -50,57 +50,60 @@ private:
         return Variable();
     }
 
+    virtual bool isPure() const override
+    {
+        return false;
+    }
+
     LogLevel _level;
 };
 
-class FormatDateMethod : public ModuleMethod
+class FormatDateMethod : public NativeMethod
 {
-    virtual Variable call(VariableArgs& args, VariableKeywordArgs&, VariableCollector& collector) const override
+    virtual Variant evaluate(const Variant* args, size_t count) const override
     {
-        if (args.size() >= 1) {
-            uint64_t secs = args[0].value().toUnsignedInteger();
-            return collector.copy(formatDate(secs));
+        if (count >= 1) {
+            uint64_t secs = args[0].toUnsignedInteger();
+            return formatDate(secs);
         } else {
-            return Variable();
+            return Variant();
         }
     }
 };
 
-class FormatDurationMethod : public ModuleMethod
+class FormatDurationMethod : public NativeMethod
 {
-    virtual Variable call(VariableArgs& args, VariableKeywordArgs&, VariableCollector& collector) const override
+    virtual Variant evaluate(const Variant* args, size_t count) const override
     {
-        if (args.size() >= 1) {
-            uint64_t secs = args[0].value().toUnsignedInteger();
-            return collector.copy(formatDuration(secs));
+        if (count >= 1) {
+            uint64_t secs = args[0].toUnsignedInteger();
+            return formatDuration(secs);
         } else {
-            return Variable();
+            return Variant();
         }
     }
 };
 
 std::vector<MethodArgument> toNumericSignature = {MethodArgument("value", true, Variant()), MethodArgument("base", true, 10)};
 
-class ToIntMethod : public ModuleMethod
+class ToIntMethod : public NativeMethod
 {
 public:
-    ToIntMethod() : ModuleMethod(toNumericSignature)
+    ToIntMethod() : NativeMethod(toNumericSignature)
     {
 
     }
 
 private:
-    virtual Variable call(VariableArgs& args, VariableKeywordArgs&kwargs, VariableCollector& collector) const override
+    virtual Variant evaluate(const Variant* args, size_t) const override
     {
-        fillNumberedArgs(args, kwargs, collector);
-
-        const Variant& value = args[0].value();
-        int base = (int) args[1].value().toInteger();
+        const Variant& value = args[0];
+        int base = (int) args[1].toInteger();
         if(value.canConvertTo(Variant::integerType))
         {
             Variant newValue = value.toInteger();
             newValue.setDisplayBase(base);
-            return collector.copy(newValue);
+            return newValue;
         }
         else if(value.canConvertTo(Variant::stringType))
         {
@@ -110,33 +113,31 @@ private:
             if(!(S>>i).fail()) {
                 Variant newValue = i;
                 newValue.setDisplayBase(base);
-                return collector.copy(newValue);
+                return newValue;
             }
         }
-        return Variable();
+        return Variant();
     }
 };
 
-class ToUIntMethod : public ModuleMethod
+class ToUIntMethod : public NativeMethod
 {
 public:
-    ToUIntMethod() : ModuleMethod(toNumericSignature)
+    ToUIntMethod() : NativeMethod(toNumericSignature)
     {
 
     }
 
 private:
-    virtual Variable call(VariableArgs& args, VariableKeywordArgs&kwargs, VariableCollector& collector) const override
+    virtual Variant evaluate(const Variant* args, size_t) const override
     {
-        fillNumberedArgs(args, kwargs, collector);
-
-        const Variant& value = args[0].value();
-        int base = (int) args[1].value().toInteger();
+        const Variant& value = args[0];
+        int base = (int) args[1].toInteger();
         if(value.canConvertTo(Variant::unsignedIntegerType))
         {
             Variant newValue = value.toUnsignedInteger();
             newValue.setDisplayBase(base);
-            return collector.copy(newValue);
+            return newValue;
         }
         else if(value.canConvertTo(Variant::stringType))
         {
@@ -146,33 +147,31 @@ private:
             if(!(S>>i).fail()) {
                 Variant newValue = i;
                 newValue.setDisplayBase(base);
-                return collector.copy(newValue);
+                return newValue;
             }
         }
-        return Variable();
+        return Variant();
     }
 };
 
-class ToFloatMethod : public ModuleMethod
+class ToFloatMethod : public NativeMethod
 {
 public:
-    ToFloatMethod() : ModuleMethod(toNumericSignature)
+    ToFloatMethod() : NativeMethod(toNumericSignature)
     {
 
     }
 
 private:
-    virtual Variable call(VariableArgs& args, VariableKeywordArgs&kwargs, VariableCollector& collector) const override
+    virtual Variant evaluate(const Variant* args, size_t) const override
     {
-        fillNumberedArgs(args, kwargs, collector);
-
-        const Variant& value = args[0].value();
-        int base = (int) args[1].value().toInteger();
+        const Variant& value = args[0];
+        int base = (int) args[1].toInteger();
         if(value.canConvertTo(Variant::unsignedIntegerType))
         {
             Variant newValue = value.toDouble();
             newValue.setDisplayBase(base);
-            return collector.copy(newValue);
+            return newValue;
         }
         else if(value.canConvertTo(Variant::stringType))
         {
@@ -182,123 +181,120 @@ private:
             if(!(S>>d).fail()) {
                 Variant newValue = d;
                 newValue.setDisplayBase(base);
-                return collector.copy(newValue);
+                return newValue;
             }
         }
-        return Variable();
+        return Variant();
     }
 };
 
-class FromAsciiMethod : public ModuleMethod
+class FromAsciiMethod : public NativeMethod
 {
-    virtual Variable call(VariableArgs& args, VariableKeywordArgs&, VariableCollector& collector) const override
+    virtual Variant evaluate(const Variant* args, size_t count) const override
     {
-        if (args.size() >= 1) {
-            const char ch = args[0].value().toInteger();
+        if (count >= 1) {
+            const char ch = args[0].toInteger();
             const std::string s(1, ch);
-            return collector.copy(s);
+            return s;
         } else {
-            return Variable();
+            return Variant();
         }
     }
 };
 
-class ToAsciiMethod : public ModuleMethod
+class ToAsciiMethod : public NativeMethod
 {
-    virtual Variable call(VariableArgs& args, VariableKeywordArgs&, VariableCollector& collector) const override
+    virtual Variant evaluate(const Variant* args, size_t count) const override
     {
-        if (args.size() >= 1) {
-            const std::string& str = args[0].value().toString();
+        if (count >= 1) {
+            const std::string& str = args[0].toString();
             if(str.empty())
-                return Variable();
+                return Variant();
             else
-                return collector.copy(str[0]);
+                return str[0];
         } else {
-            return Variable();
+            return Variant();
         }
     }
 };
 
-class ToUpperMethod : public ModuleMethod
+class ToUpperMethod : public NativeMethod
 {
-    virtual Variable call(VariableArgs& args, VariableKeywordArgs&, VariableCollector& collector) const override
+    virtual Variant evaluate(const Variant* args, size_t count) const override
     {
-        if (args.size() >= 1) {
-            std::string str = toStr(args[0].value());
+        if (count >= 1) {
+            std::string str = toStr(args[0]);
             std::transform(str.begin(), str.end(),str.begin(), ::toupper);
-            return collector.copy(str);
+            return str;
         } else {
-            return Variable();
+            return Variant();
         }
     }
 };
 
-class ToLowerMethod : public ModuleMethod
+class ToLowerMethod : public NativeMethod
 {
-    virtual Variable call(VariableArgs& args, VariableKeywordArgs&, VariableCollector& collector) const override
+    virtual Variant evaluate(const Variant* args, size_t count) const override
     {
-        if (args.size() >= 1) {
-            std::string str = toStr(args[0].value());
+        if (count >= 1) {
+            std::string str = toStr(args[0]);
             std::transform(str.begin(), str.end(),str.begin(), ::tolower);
-            return collector.copy(str);
+            return str;
         } else {
-            return Variable();
+            return Variant();
         }
     }
 };
 
-class PopCountMethod : public ModuleMethod
+class PopCountMethod : public NativeMethod
 {
-    virtual Variable call(VariableArgs& args, VariableKeywordArgs&, VariableCollector& collector) const override
+    virtual Variant evaluate(const Variant* args, size_t count) const override
     {
-        if (args.size() >= 1) {
-            uint64_t word = args[0].value().toUnsignedInteger();
-            return collector.copy(popCount(word));
+        if (count >= 1) {
+            uint64_t word = args[0].toUnsignedInteger();
+            return popCount(word);
         } else {
-            return Variable();
+            return Variant();
         }
     }
 };
 
 std::vector<MethodArgument> substringSignature = {MethodArgument("string", true, Variant()), MethodArgument("start", true, Variant()), MethodArgument("size", true, Variant())};
 
-class SubstringMethod : public ModuleMethod
+class SubstringMethod : public NativeMethod
 {
 public:
-    SubstringMethod() : ModuleMethod(substringSignature)
+    SubstringMethod() : NativeMethod(substringSignature)
     {}
 
 private:
-    virtual Variable call(VariableArgs& args, VariableKeywordArgs& kwargs, VariableCollector& collector) const override
+    virtual Variant evaluate(const Variant* args, size_t) const override
     {
-
-        fillNumberedArgs(args, kwargs, collector);
-
-        if(   args[0].value().canConvertTo(Variant::stringType)
-           && args[1].value().canConvertTo(Variant::unsignedIntegerType))
+        if(   args[0].canConvertTo(Variant::stringType)
+           && args[1].canConvertTo(Variant::unsignedIntegerType))
         {
-            const std::string str = args[0].value().toString();
+            const std::string& str = args[0].toString();
 
             uint64_t start;
             uint64_t size;
-            if(args[2].value().canConvertTo(Variant::unsignedIntegerType)) {
-                start = args[1].value().toUnsignedInteger();
-                size = args[2].value().toUnsignedInteger();
+            if(args[2].canConvertTo(Variant::unsignedIntegerType)) {
+                start = args[1].toUnsignedInteger();
+                size = args[2].toUnsignedInteger();
             } else {
                 start = 0;
-                size = args[1].value().toUnsignedInteger();
+                size = args[1].toUnsignedInteger();
             }
 
             if(start < str.size())
             {
                 if(start + size < str.size())
-                    return collector.copy(str.substr(start, size));
+                    return str.substr(start, size);
                 else
-                    return collector.copy(str.substr(start));
+                    return str.substr(start);
             }
         }
 
-        return Variable();
+        return Variant();
     }
 };
 
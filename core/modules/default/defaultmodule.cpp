@@ -72,3 +72,9 @@ bool DefaultModule::doLoad()
 
     return true;
 }
+
+bool DefaultModule::hasParsingState() const
+{
+    // The templates are shared by every module and never modified once loaded
+    return false;
+}
@@ -27,6 +27,7 @@ class DefaultModule : public Module
 {
 protected:
     bool doLoad() override;
+    bool hasParsingState() const override;
 };
 
 #endif // DEFAULTMODULE_H
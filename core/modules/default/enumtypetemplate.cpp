@@ -3,7 +3,6 @@
 #include "core/object.h"
 #include "core/parser.h"
 #include "core/objecttype.h"
-#include "core/parsingexception.h"
 #include "core/variable/objectattributes.h"
 #include "core/module.h"
 
@@ -15,10 +14,14 @@ EnumTypeTemplate::EnumTypeTemplate()
 Parser *EnumTypeTemplate::parseOrGetParser(const ObjectType &type, ParsingOption &option) const
 {
     if (!type.parameterSpecified(0)) {
-        throw ParsingException(ParsingException::Type::BadParameter, "No enum type given");
+        static_cast<Object&>(option).reportError(ParsingError::BadParameter, "No enum type given");
+        return nullptr;
     }
 
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
 
     std::unique_ptr<Object> childPtr(context.object().readVariable(type.parameterValue(0).toObjectType()));
     Object& child = *childPtr;
@@ -11,6 +11,9 @@ FileTypeTemplate::FileTypeTemplate()
 Parser *FileTypeTemplate::parseOrGetParser(const ObjectType &, ParsingOption &option) const
 {
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
     int64_t size = context.object().file().size();
     context.object().setSize(size);
     context.object().attributes(true)->addNamed("path")->setValue(context.object().file().path());
@@ -1,7 +1,6 @@
 #include "floattypetemplate.h"
 
 #include "core/object.h"
-#include "core/parsingexception.h"
 
 FloatTypeTemplate::FloatTypeTemplate()
     : ObjectTypeTemplate("float")
@@ -11,6 +10,9 @@ FloatTypeTemplate::FloatTypeTemplate()
 Parser *FloatTypeTemplate::parseOrGetParser(const ObjectType &, ParsingOption &option) const
 {
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
     context.object().setSize(32);
     union {int32_t i; float f;} val;
     context.object().file().read(reinterpret_cast<char* >(&val.i), 32);
@@ -37,6 +39,9 @@ DoubleTypeTemplate::DoubleTypeTemplate()
 Parser *DoubleTypeTemplate::parseOrGetParser(const ObjectType &, ParsingOption &option) const
 {
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
     context.object().setSize(64);
     union {int64_t i; double f;} val;
     context.object().file().read(reinterpret_cast<char* >(&val.i), 64);
@@ -66,7 +71,8 @@ Parser *FixedFloatTypeTemplate::parseOrGetParser(const ObjectType &type, Parsing
 {
     if (!type.parameterSpecified(0) && !type.parameterSpecified(1))
     {
-        throw ParsingException(ParsingException::Type::BadParameter, "Integer size must be lower than 64");
+        static_cast<Object&>(option).reportError(ParsingError::BadParameter, "Integer size must be lower than 64");
+        return nullptr;
     }
 
     auto integerCount = type.parameterValue(0).toInteger();
@@ -74,6 +80,9 @@ Parser *FixedFloatTypeTemplate::parseOrGetParser(const ObjectType &type, Parsing
 
     if (integerCount == 8 && decimalCount == 8) {
         Object::ParsingContext context(option);
+        if (!context.isAvailable()) {
+            return nullptr;
+        }
 
         context.object().setSize(16);
 
@@ -87,6 +96,9 @@ Parser *FixedFloatTypeTemplate::parseOrGetParser(const ObjectType &type, Parsing
         context.object().setValue(f);
     } else if (integerCount == 16 && decimalCount == 16) {
         Object::ParsingContext context(option);
+        if (!context.isAvailable()) {
+            return nullptr;
+        }
 
         context.object().setSize(32);
 
@@ -101,7 +113,8 @@ Parser *FixedFloatTypeTemplate::parseOrGetParser(const ObjectType &type, Parsing
         double f = integer + decimal/pow(2,16);
         context.object().setValue(f);
     } else {
-        throw ParsingException(ParsingException::Type::BadParameter, "Parameters not handled");
+        static_cast<Object&>(option).reportError(ParsingError::BadParameter, "Parameters not handled");
+        return nullptr;
     }
 
     return nullptr;
@@ -1,6 +1,5 @@
 #include "integertypetemplate.h"
 #include "core/object.h"
-#include "core/parsingexception.h"
 
 IntegerTypeTemplate::IntegerTypeTemplate()
     : ObjectTypeTemplate("int",{"size", "_base"})
@@ -10,6 +9,9 @@ IntegerTypeTemplate::IntegerTypeTemplate()
 Parser *IntegerTypeTemplate::parseOrGetParser(const ObjectType &type, ParsingOption &option) const
 {
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
 
     const int64_t size =  type.parameterValue(0).toInteger();
     Object& object = context.object();
@@ -68,7 +70,8 @@ Parser *IntegerTypeTemplate::parseOrGetParser(const ObjectType &type, ParsingOpt
     default:
         if(size>64)
         {
-            throw ParsingException(ParsingException::Type::BadParameter, "Integer size must be lower than 64");
+            static_cast<Object&>(option).reportError(ParsingError::BadParameter, "Integer size must be lower than 64");
+            return nullptr;
         }
         {
             int byteSize = (size + 7) >> 3;
@@ -119,6 +122,9 @@ UIntegerTypeTemplate::UIntegerTypeTemplate()
 Parser *UIntegerTypeTemplate::parseOrGetParser(const ObjectType &type, ParsingOption &option) const
 {
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
 
     const int64_t size =  type.parameterValue(0).toInteger();
     Object& object = context.object();
@@ -177,7 +183,8 @@ Parser *UIntegerTypeTemplate::parseOrGetParser(const ObjectType &type, ParsingOp
     default:
         if(size>64)
         {
-            throw ParsingException(ParsingException::Type::BadParameter, "Integer size must be lower than 64");
+            static_cast<Object&>(option).reportError(ParsingError::BadParameter, "Integer size must be lower than 64");
+            return nullptr;
         }
         {
             int byteSize = (size + 7) >> 3;
@@ -225,6 +232,9 @@ ByteTypeTemplate::ByteTypeTemplate()
 Parser *ByteTypeTemplate::parseOrGetParser(const ObjectType &, ParsingOption &option) const
 {
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
 
     Object& object = context.object();
 
@@ -256,6 +266,9 @@ UuidTypeTemplate::UuidTypeTemplate()
 Parser *UuidTypeTemplate::parseOrGetParser(const ObjectType &, ParsingOption &option) const
 {
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
 
     Object& object = context.object();
 
@@ -312,14 +325,19 @@ BitsetTypeTemplate::BitsetTypeTemplate()
 Parser *BitsetTypeTemplate::parseOrGetParser(const ObjectType &type, ParsingOption &option) const
 {
     if(!type.parameterSpecified(0)) {
-        throw ParsingException(ParsingException::Type::BadParameter, "Missing bitset size");
+        static_cast<Object&>(option).reportError(ParsingError::BadParameter, "Missing bitset size");
+        return nullptr;
     }
     auto size = type.parameterValue(0).toInteger();
     if (size > 64) {
-        throw ParsingException(ParsingException::Type::BadParameter, "Bitset size must be lower than 64");
+        static_cast<Object&>(option).reportError(ParsingError::BadParameter, "Bitset size must be lower than 64");
+        return nullptr;
     }
 
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
 
     context.object().setSize(size);
 
@@ -10,6 +10,9 @@ StringTypeTemplate::StringTypeTemplate()
 Parser *StringTypeTemplate::parseOrGetParser(const ObjectType &type, ParsingOption &option) const
 {
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
 
     auto numberOfChars = -1;
     if (type.parameterSpecified(0))
@@ -86,6 +89,9 @@ WStringTypeTemplate::WStringTypeTemplate()
 Parser *WStringTypeTemplate::parseOrGetParser(const ObjectType &type, ParsingOption &option) const
 {
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
 
     auto numberOfChars = -1;
     if (type.parameterSpecified(0))
@@ -2,7 +2,8 @@
 #include "core/module.h"
 
 StructParser::StructParser(ParsingOption &option)
-    : Parser(option)
+    : Parser(option),
+      _parsedInHead(false)
 {
 }
 
@@ -29,7 +30,7 @@ void StructParser::doParseHead()
         object().setSize(s);
     } else {
         s = 0;
-        for (unsigned int i = 0; i < _types.size(); ++i) {
+        for (unsigned int i = 0; i < _types.size() && object().isValid(); ++i) {
             Object* child = object().addVariable(_types[i], _names[i]);
             s += child->size();
         }
@@ -41,7 +42,7 @@ void StructParser::doParseHead()
 void StructParser::doParse()
 {
     if (!_parsedInHead) {
-        for (unsigned int i = 0; i < _types.size(); ++i) {
+        for (unsigned int i = 0; i < _types.size() && object().isValid(); ++i) {
             object().addVariable(_types[i], _names[i]);
         }
     }
@@ -36,7 +36,7 @@ void TupleParser::doParseHead()
         else
         {
             int64_t s = 0;
-            for(int64_t i = 0; i < count; ++i)
+            for(int64_t i = 0; i < count && object().isValid(); ++i)
             {
                 Object* child = addElem();
 
@@ -12,6 +12,9 @@ EbmlDateTypeTemplate::EbmlDateTypeTemplate()
 Parser *EbmlDateTypeTemplate::parseOrGetParser(const ObjectType &, ParsingOption &option) const
 {
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
 
     context.object().setSize(64);
 
@@ -14,6 +14,9 @@ EbmlElementTypeTemplate::EbmlElementTypeTemplate(const ObjectType &largeIntegerT
 Parser *EbmlElementTypeTemplate::parseOrGetParser(const ObjectType &, ParsingOption &option) const
 {
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
 
     Object* p_id = context.object().addVariable(_largeIntegerType, "id");
     Object* p_size = context.object().addVariable(_largeIntegerType, "size");
@@ -28,6 +28,9 @@ EbmlIntegerTypeTemplate::EbmlIntegerTypeTemplate(std::shared_ptr<ObjectType> ele
 Parser *EbmlIntegerTypeTemplate::parseOrGetParser(const ObjectType &, ParsingOption &option) const
 {
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
     _intType.setParameter(0, context.object().availableSize());
     Object* child = context.object().addVariable(_intType,"payload");
     if (child) {
@@ -45,6 +48,9 @@ EbmlUIntegerTypeTemplate::EbmlUIntegerTypeTemplate(std::shared_ptr<ObjectType> e
 Parser *EbmlUIntegerTypeTemplate::parseOrGetParser(const ObjectType &, ParsingOption &option) const
 {
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
     _uintType.setParameter(0, context.object().availableSize());
     Object* child = context.object().addVariable(_uintType,"payload");
     if (child) {
@@ -64,6 +70,9 @@ EbmlFloatTypeTemplate::EbmlFloatTypeTemplate(std::shared_ptr<ObjectType> element
 Parser *EbmlFloatTypeTemplate::parseOrGetParser(const ObjectType &, ParsingOption &option) const
 {
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
     Object* child = context.object().addVariable(context.object().availableSize() == 64 ? _doubleType : _floatType, "payload");
     if (child) {
         context.object().setValue(child->value());
@@ -82,6 +91,9 @@ EbmlStringTypeTemplate::EbmlStringTypeTemplate(std::shared_ptr<ObjectType> eleme
 Parser *EbmlStringTypeTemplate::parseOrGetParser(const ObjectType &, ParsingOption &option) const
 {
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
     _stringType.setParameter(0, context.object().availableSize()/8);
     Object* child = context.object().addVariable(_stringType, "payload");
     if (child) {
@@ -100,6 +112,9 @@ EbmlUtf8StringTypeTemplate::EbmlUtf8StringTypeTemplate(std::shared_ptr<ObjectTyp
 Parser *EbmlUtf8StringTypeTemplate::parseOrGetParser(const ObjectType &, ParsingOption &option) const
 {
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
     _stringType.setParameter(0, context.object().availableSize()/8);
     Object* child = context.object().addVariable(_stringType, "payload");
     if (child) {
@@ -118,6 +133,9 @@ EbmlDateElementTypeTemplate::EbmlDateElementTypeTemplate(std::shared_ptr<ObjectT
 Parser *EbmlDateElementTypeTemplate::parseOrGetParser(const ObjectType &, ParsingOption &option) const
 {
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
     Object* child = context.object().addVariable(_dateType, "payload");
     if (child) {
         context.object().setValue(child->value());
@@ -136,6 +154,9 @@ EbmlBinaryTypeTemplate::EbmlBinaryTypeTemplate(std::shared_ptr<ObjectType> eleme
 Parser *EbmlBinaryTypeTemplate::parseOrGetParser(const ObjectType &, ParsingOption &option) const
 {
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
     _dataType.setParameter(0, context.object().availableSize());
     Object* child = context.object().addVariable(_dataType, "payload");
     if (child) {
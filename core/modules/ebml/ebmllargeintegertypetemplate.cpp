@@ -9,6 +9,9 @@ EbmlLargeIntegerTypeTemplate::EbmlLargeIntegerTypeTemplate()
 Parser *EbmlLargeIntegerTypeTemplate::parseOrGetParser(const ObjectType &, ParsingOption &option) const
 {
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
 
     uint8_t byte;
     context.object().file().read(reinterpret_cast<char*>(&byte), 8);
@@ -27,13 +27,17 @@ class MkvModule : public Module
 {
 public:
     MkvModule(std::string modelPath);
+
+    /**
+     * @brief Convert an EBML id as written in the model, marker bits included, to its value
+     */
+    static int64_t parseId(char* str);
 protected:
     void addFormatDetection(StandardFormatDetector::Adder& formatAdder) override;
     void requestImportations(std::vector<std::string>& formatRequested) override;
     bool doLoad() override;
 
 private:
-    static int64_t parseId(char* str);
     std::string _modelPath;
 };
 
@@ -12,6 +12,9 @@ ParentPidTemplate::ParentPidTemplate()
 Parser *ParentPidTemplate::parseOrGetParser(const ObjectType &, ParsingOption &option) const
 {
     Object::ParsingContext context(option);
+    if (!context.isAvailable()) {
+        return nullptr;
+    }
 
     int pid = static_cast<FragmentedFile*>(&context.object().file())->parent().parent()->lookUp("PID", true)->value().toInteger();
     context.object().setSize(0);
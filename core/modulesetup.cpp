@@ -22,8 +22,6 @@ void ModuleSetup::setup()
     std::vector<std::string> logoDirs;
     std::vector<std::string> modelsDirs;
 
-    std::vector<std::string> compilerDirs;
-
 #if defined(PLATFORM_WIN32)
     char buffer[MAX_PATH];
     GetModuleFileNameA(NULL, buffer, MAX_PATH);
@@ -32,11 +30,12 @@ void ModuleSetup::setup()
     installDir = installDir.substr( 0, pos)+"\\";
 
     std::string userDir = installDir+"scripts\\";
+    std::string cacheDir = _cacheDir.empty() ? userDir+"cache\\" : _cacheDir;
+    CreateDirectoryA(cacheDir.c_str(), NULL);
 
     modelsDirs = {installDir, "..\\models\\"};
     _scriptsDirs.push_back(installDir+"scripts\\");
     _scriptsDirs.push_back("..\\scripts\\");
-    compilerDirs = {installDir, "..\\compiler\\"};
     logoDirs = {installDir, "..\\logo\\"};
 
 #elif defined(PLATFORM_LINUX) || defined(PLATFORM_APPLE)
@@ -45,12 +44,13 @@ void ModuleSetup::setup()
     std::string installDir = "/usr/share/hexamonkey/";
     std::string userDir = std::string(getenv("HOME"))+"/.hexamonkey/";
     mkdir(userDir.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+    std::string cacheDir = _cacheDir.empty() ? userDir+"cache/" : _cacheDir;
+    mkdir(cacheDir.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
 
     modelsDirs = {installDir, "../models/"};
     _scriptsDirs.push_back(installDir+"scripts/");
     _scriptsDirs.push_back(userDir);
     _scriptsDirs.push_back("../scripts/");
-    compilerDirs = {"/usr/bin/", "../compiler/"};
     logoDirs = {installDir, "../logo/"};
 
 #else
@@ -64,7 +64,7 @@ void ModuleSetup::setup()
     _moduleLoader.addModule("hmc",   new HmcModule(getFile(modelsDirs, "hmcmodel.csv")));
     _moduleLoader.addModule("stream",new StreamModule);
 
-    _programLoader.reset(createProgramLoader(static_cast<const HmcModule&>(_moduleLoader.getModule("hmc")), compilerDirs, userDir));
+    _programLoader.reset(new ProgramLoader(cacheDir));
 
     _moduleLoader.setDirectories(_scriptsDirs, programLoader());
 }
@@ -78,9 +78,9 @@ void ModuleSetup::addScriptDirectory(const std::string &dir)
     _scriptsDirs.push_back(dir);
 }
 
-ProgramLoader *ModuleSetup::createProgramLoader(const HmcModule &hmcModule, const std::vector<std::string> &compilerDir, const std::string &userDir)
+void ModuleSetup::setCacheDirectory(const std::string &dir)
 {
-    return new ProgramLoader(hmcModule, compilerDir, userDir);
+    _cacheDir = dir;
 }
 
 ModuleLoader &ModuleSetup::moduleLoader()
@@ -13,7 +13,8 @@ public:
     virtual ~ModuleSetup();
 
     void addScriptDirectory(const std::string& dir);
-    virtual ProgramLoader* createProgramLoader(const HmcModule& hmcModule, const std::vector<std::string>& compilerDir, const std::string& userDir);
+    /// Replaces the cache subdirectory of the user directory for the compiled scripts
+    void setCacheDirectory(const std::string& dir);
 
     ModuleLoader& moduleLoader();
     const ModuleLoader& moduleLoader() const;
@@ -21,6 +22,7 @@ public:
     const std::string& logoPath() const;
 private:
     std::vector<std::string> _scriptsDirs;
+    std::string _cacheDir;
     std::unique_ptr<ProgramLoader> _programLoader;
     ModuleLoader _moduleLoader;
     std::string _logoPath;
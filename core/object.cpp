@@ -20,8 +20,8 @@
 
 #include "core/object.h"
 #include "core/parser.h"
-#include "core/parsingexception.h"
 #include "core/log/logmanager.h"
+#include "core/log/metrics.h"
 #include "core/modules/stream/streammodule.h"
 #include "core/variable/objectcontext.h"
 #include "core/variable/objectattributes.h"
@@ -43,17 +43,25 @@ Object::Object(File& file, std::streampos beginningPos, Object *parent, Variable
     _rank(parent ? parent->numberOfChildren() : -1),
     _name("*"),
     _value(Variant::null()),
-    _children(0),
+    _childrenSorted(true),
     _expandOnAddition(false),
     _parsedCount(0),
     _parsingInProgress(false),
     _context(nullptr),
     _attributes(nullptr),
     _valid(true),
+    _errors(parent ? nullptr : new ParsingErrorIndex),
     _endianness(parent ? parent->_endianness : bigEndian),
+    _parsingMode(parent ? parent->_parsingMode : fullParsing),
     _collector(collector),
     _fromModule(fromModule)
 {
+    HM_METRICS_ADD(objectsCreated, 1);
+}
+
+Object::~Object()
+{
+    HM_METRICS_ADD(objectsFreed, 1);
 }
 
 
@@ -125,6 +133,35 @@ int Object::numberOfChildren() const
     return _children.size();
 }
 
+int64_t Object::childIndexAtPos(std::streamoff pos) const
+{
+    const int64_t n = _children.size();
+
+    if (_childrenSorted.load(std::memory_order_acquire)) {
+        int64_t first = 0;
+        int64_t count = n;
+        while (count > 0) {
+            int64_t step = count / 2;
+            if (_children[first + step]->beginningPos() <= pos) {
+                first += step + 1;
+                count -= step + 1;
+            } else {
+                count = step;
+            }
+        }
+        if (first > 0 && _children[first - 1]->includesPos(pos)) {
+            return first - 1;
+        }
+    } else {
+        for (int64_t i = 0; i < n; ++i) {
+            if (_children[i]->includesPos(pos)) {
+                return i;
+            }
+        }
+    }
+    return -1;
+}
+
 Object *Object::access(int64_t index, bool forceParse)
 {
     if(index >=0 && index < numberOfChildren()) {
@@ -148,10 +185,10 @@ Object *Object::access(int64_t index, bool forceParse)
 
 Object* Object::lookUp(const std::string &name, bool forceParse)
 {
-    auto it = _lookUpTable.find(name);
-    if (it != _lookUpTable.end()) {
+    Object* child = _lookUpTable.value(name, nullptr);
+    if (child != nullptr) {
 
-        return it->second;
+        return child;
 
     } else if (forceParse && !parsed()) {
 
@@ -275,6 +312,7 @@ const Variable &Object::contextVariable(bool createIfNeeded)
 
 const Variable &Object::attributesVariable(bool createIfNeeded)
 {
+    parseDescription();
     if (_attributes == nullptr && createIfNeeded) {
         _attributes = new ObjectAttributes(collector());
         _attributesVariable = Variable((VariableImplementation *) _attributes, true);
@@ -293,6 +331,26 @@ void Object::invalidate()
     _valid = false;
 }
 
+void Object::reportError(ParsingError::Reason reason, const std::string &details, const Object *child)
+{
+    // A corrupted file can have an error for most of its children, only the first ones are logged
+    static const size_t loggedErrorCount = 10;
+
+    ParsingError error(reason, *this, child, details);
+    const size_t count = root()._errors->add(error);
+    if (count <= loggedErrorCount) {
+        Log::error(error.message());
+    } else if (count == loggedErrorCount + 1) {
+        Log::warning("More parsing errors in the file, they are only recorded in its error index");
+    }
+    invalidate();
+}
+
+const ParsingErrorIndex &Object::errors() const
+{
+    return *root()._errors;
+}
+
 void Object::seekBeginning()
 {
     _file.seekg(_beginningPos,std::ios::beg);
@@ -321,7 +379,8 @@ std::streamoff Object::pos() const
 
 bool Object::includesPos(std::streamoff pos) const
 {
-    return _beginningPos <= pos && pos < _beginningPos + _size;
+    const std::streamoff size = _size.load(std::memory_order_acquire);
+    return _beginningPos <= pos && size != -1 && pos < _beginningPos + size;
 }
 
 void Object::setPos(std::streamoff pos)
@@ -347,11 +406,13 @@ void Object::setPos(std::streamoff pos)
 
 Variant &Object::value()
 {
+    parseDescription();
     return _value;
 }
 
 const Variant &Object::value() const
 {
+    parseDescription();
     return _value;
 }
 
@@ -362,11 +423,13 @@ void Object::setValue(const Variant &value)
 
 bool Object::hasLinkTo() const
 {
+    parseDescription();
     return !_linkTo.isValueless();
 }
 
 std::streamoff Object::linkTo() const
 {
+    parseDescription();
     return _linkTo.toUnsignedInteger();
 }
 
@@ -386,6 +449,7 @@ void Object::removeLinkTo()
 
 ObjectAttributes *Object::attributes(bool createIfNeeded)
 {
+    parseDescription();
     if (_attributes == nullptr && createIfNeeded) {
         _attributes = new ObjectAttributes(collector());
         _attributesVariable = Variable((VariableImplementation *) _attributes, true);
@@ -396,6 +460,7 @@ ObjectAttributes *Object::attributes(bool createIfNeeded)
 
 const ObjectAttributes *Object::attributes() const
 {
+    parseDescription();
     return _attributes;
 }
 
@@ -415,6 +480,26 @@ void Object::parseBody()
     }
 }
 
+void Object::parseDescription() const
+{
+    if (_parsingMode == skeletonParsing && _parsedCount < _parsers.size()) {
+        Object& object = const_cast<Object&>(*this);
+        const int64_t pos = object._file.tellg();
+        //A tail setting the description is run as it would have been on addition in full mode
+        if (!_parsingInProgress && std::any_of(_parsers.begin(), _parsers.end(), [](const std::unique_ptr<Parser>& parser) {
+            return parser && parser->needTailParsing();
+        })) {
+            object.parse();
+        } else {
+            for (size_t i = _parsedCount; i < _parsers.size(); ++i) {
+                object.seekObjectEnd();
+                _parsers[i]->parseDescription();
+            }
+        }
+        object._file.seekg(pos, std::ios_base::beg);
+    }
+}
+
 bool Object::parseSome(int hint)
 {
     size_t initialCount = _children.size();
@@ -468,14 +553,16 @@ void Object::setEndianness(const Object::Endianness &endianness)
     _endianness = endianness;
 }
 
-void throwChildError(const Object& object, const Object &child, ParsingException::Type type, const std::string reason)
+Object::ParsingMode Object::parsingMode() const
 {
-    throw ParsingException(type, concat("Child ", child, " cannot be added to ", object, " : ", reason));
+    return _parsingMode;
 }
 
-void Object::addChild(Object *child)
+bool Object::addChild(Object *child)
 {
-    if (child != nullptr) {
+    if (child == nullptr) {
+        return false;
+    } else {
         std::streamoff curPos = pos();
         if (child->size() == -1LL) {
             if (size() != -1LL && child->isSetToExpandOnAddition()) {
@@ -516,22 +603,30 @@ void Object::addChild(Object *child)
         }
 
         if(!child->name().empty()) {
-            _lookUpTable[child->name()] = child;
+            _lookUpTable.set(child->name(), child);
         }
 
         child->_parent = this;
+        child->_rank = _children.size();
 
-        _children.push_back(child);
+        if (!_children.empty() && child->beginningPos() < _children.back()->beginningPos()) {
+            _childrenSorted.store(false, std::memory_order_release);
+        }
         _ownedChildren.push_back(std::unique_ptr<Object>(child));
-        child->_rank = _children.size() - 1;
+        _children.push_back(child);
         _lastChild = nullptr;
 
         if (!(child->isValid())) {
-            throwChildError(*this, *child, ParsingException::InvalidChild, "child invalid");
+            reportError(ParsingError::InvalidChild, "", child);
+            return false;
         } else if (outOfFile) {
-            throwChildError(*this, *child, ParsingException::OutOfFile, "out of file");
+            reportError(ParsingError::OutOfFile, "", child);
+            return false;
         } else if (outOfParent) {
-            throwChildError(*this, *child, ParsingException::OutOfParent, concat("too big ", child->size()));
+            reportError(ParsingError::OutOfParent, concat("too big ", child->size()), child);
+            return false;
+        } else {
+            return true;
         }
     }
 }
@@ -666,13 +761,13 @@ std::streampos Object::beginningPos() const
 
 std::streamoff Object::size() const
 {
-    return _size;
+    return _size.load(std::memory_order_acquire);
 }
 
 void Object::setSize(std::streamoff size)
 {
     if (size >= 0) {
-        _size = size;
+        _size.store(size, std::memory_order_release);
     } else {
         Log::warning("Trying to set a negative value for a size");
     }
@@ -690,7 +785,9 @@ void Object::setToExpandOnAddition()
 
 std::streamoff Object::availableSize() const
 {
-    if(file().good()) {
+    if (!_valid) {
+        return 0;
+    } else if(file().good()) {
         return size() - pos();
     } else {
         return -1;
@@ -795,23 +892,19 @@ Object::ParsingContext::ParsingContext(Object &object)
     :_object(object),
       _isAvailable(!object._parsingInProgress)
 {
-    if (!_isAvailable)
-    {
-        throw LockException(_object);
+    if (_isAvailable) {
+        _object._parsingInProgress = true;
     }
-    _object._parsingInProgress = true;
 }
 
 Object::ParsingContext::ParsingContext(ParsingOption &parsingOption)
     :_object(static_cast<Object&>(parsingOption)),
       _isAvailable(!_object._parsingInProgress)
 {
-    if (!_isAvailable)
-    {
-        throw LockException(_object);
+    if (_isAvailable) {
+        _object.parseBody();
+        _object._parsingInProgress = true;
     }
-    _object.parseBody();
-    _object._parsingInProgress = true;
 }
 
 
@@ -828,17 +921,6 @@ bool Object::ParsingContext::isAvailable() const
 }
 
 
-Object::ParsingContext::LockException::LockException(const Object &object)
-    :_object(object)
-{
-}
-
-const char *Object::ParsingContext::LockException::what() const noexcept
-{
-    return "Object locked for parsing";
-}
-
-
 ParsingOption::ParsingOption()
 {
 }
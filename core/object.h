@@ -18,6 +18,7 @@
 #ifndef OBJECT_H_INCLUDED
 #define OBJECT_H_INCLUDED
 
+#include <atomic>
 #include <iostream>
 #include <list>
 #include <vector>
@@ -27,7 +28,10 @@
 
 #include "core/file/realfile.h"
 #include "core/objecttype.h"
+#include "core/parsingerror.h"
 #include "core/variant.h"
+#include "core/util/appendonlymap.h"
+#include "core/util/appendonlyvector.h"
 #include "core/util/strutil.h"
 #include "core/variable/variable.h"
 
@@ -55,6 +59,10 @@ protected:
  * It is part of a tree structure, it can threfore have a \link parent() parent\endlink and be subdivided
  * into children. The children can be access through iteration of the object or by using access functions.
  * It can also have a \link value() value\endlink.
+ *
+ * Children are only ever appended : while a single thread is parsing the object, other threads can
+ * iterate over the children, \link lookUp() look them up by name\endlink or \link childIndexAtPos()
+ * by position\endlink without locking, they see the children added so far.
  */
 class Object : public ParsingOption
 {
@@ -64,7 +72,18 @@ class Object : public ParsingOption
             littleEndian = 1
         };
 
-        typedef std::vector<Object*> container;
+        /**
+         * @brief How much of an element is parsed when it is created
+         */
+        enum ParsingMode {
+            /// Elements are parsed as the scripts require it
+            fullParsing = 0,
+            /// Only what is needed to know the size and the type of the elements is parsed,
+            /// the rest is deferred until they are explored
+            skeletonParsing = 1
+        };
+
+        typedef AppendOnlyVector<Object*> container;
         typedef container::iterator iterator;
         typedef container::const_iterator const_iterator;
         typedef container::reverse_iterator reverse_iterator;
@@ -77,20 +96,13 @@ class Object : public ParsingOption
         friend class ParsingContext;
         /**
          * @brief RAII object used to lock parsing to avoid reentrency
+         *
+         * If the \link Object object\endlink is already being parsed the context is
+         * not \link isAvailable() available\endlink and nothing should be parsed.
          */
         class ParsingContext
         {
         public:
-            class LockException : std::exception
-            {
-            public:
-                LockException(const Object& object);
-
-                const char* what() const noexcept override;
-            private:
-                const Object& _object;
-            };
-
             ParsingContext(Object& object);
             ParsingContext(ParsingOption& parsingOption);
             ~ParsingContext();
@@ -101,6 +113,8 @@ class Object : public ParsingOption
             bool _isAvailable;
         };
 
+        ~Object();
+
         /** @brief Access the file associated. */
         File& file();
 
@@ -185,6 +199,9 @@ class Object : public ParsingOption
 
         /**
          * @brief Value of the object set during parsing
+         *
+         * In \link skeletonParsing skeleton\endlink mode, accessing the value, the link or the attributes
+         * parses the part of the object that describes them if it has been left for later.
          */
         const Variant& value() const;
         Variant& value();
@@ -281,6 +298,15 @@ class Object : public ParsingOption
          */
         Object* lookUp(const std::string& name, bool forceParse = false);
 
+        /**
+         * @brief Index of the child including the absolute position given, -1 if none
+         *
+         * Children are looked for with a binary search as long as they have been added
+         * in increasing position order. It can be called while the object is parsed : the
+         * size of the last child may not be set yet, in which case it doesn't include any position.
+         */
+        int64_t childIndexAtPos(std::streamoff pos) const;
+
         /**
          * @brief Access a child by its type
          *
@@ -308,10 +334,33 @@ class Object : public ParsingOption
         bool isValid() const;
         void invalidate();
 
+        /**
+         * @brief Record an error in the \link errors() error index\endlink and invalidate the object
+         */
+        void reportError(ParsingError::Reason reason, const std::string& details = "", const Object* child = nullptr);
+
+        /**
+         * @brief Errors encountered so far while parsing the tree the object belongs to
+         *
+         * The index belongs to the root, it can be read while another thread is parsing.
+         */
+        const ParsingErrorIndex& errors() const;
+
         Endianness endianness() const;
         void setEndianness(const Endianness &endianness);
 
-        void addChild(Object* child);
+        /**
+         * @brief Parsing mode, inherited from the parent
+         */
+        ParsingMode parsingMode() const;
+
+        /**
+         * @brief Take ownership of the child and append it
+         *
+         * If the child is invalid or doesn't fit in the object or in the \link file() file\endlink,
+         * it is still appended but an error is reported and false is returned.
+         */
+        bool addChild(Object* child);
 
         /**
          * @brief Generate an \link Object object\endlink not to be subsequently added
@@ -336,6 +385,11 @@ class Object : public ParsingOption
             return _collector;
         }
 
+        /** @brief Access the \link Module module\endlink that created the object and parses it. */
+        inline const Module& module() const {
+            return _fromModule;
+        }
+
     private:
         friend class Module;
         friend class ContainerParser;
@@ -346,6 +400,7 @@ class Object : public ParsingOption
         void parseBody();
         bool parseSome(int hint);
         void parseTail();
+        void parseDescription() const;
 
         /**
          * @brief Generate an \link Object object\endlink to be subsequently added (or not)
@@ -354,7 +409,8 @@ class Object : public ParsingOption
 
         File& _file;
         std::streampos _beginningPos;
-        std::streamoff _size;
+        /// Published with release so that the readers of the children see the size once set
+        std::atomic<std::streamoff> _size;
         std::streamoff _contentSize;
         std::streamoff _pos;
 
@@ -369,7 +425,8 @@ class Object : public ParsingOption
 
         container _children;
         std::vector<std::unique_ptr<Object> > _ownedChildren;
-        std::unordered_map<std::string, Object*> _lookUpTable;
+        AppendOnlyMap<std::string, Object*> _lookUpTable;
+        std::atomic<bool> _childrenSorted;
 
         std::vector<std::unique_ptr<Parser> > _parsers;
         bool _expandOnAddition;
@@ -386,8 +443,10 @@ class Object : public ParsingOption
         Variable _attributesVariable;
 
         bool _valid;
+        std::unique_ptr<ParsingErrorIndex> _errors;
 
         Endianness _endianness;
+        ParsingMode _parsingMode;
 
         VariableCollector& _collector;
 
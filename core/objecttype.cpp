@@ -17,20 +17,157 @@
 
 #include "core/objecttype.h"
 #include "core/objecttypetemplate.h"
+#include "core/varianthash.h"
 
 #include "core/log/logmanager.h"
 
+#include <mutex>
+#include <unordered_map>
+
 Variant undefinedVariant;
 Variant nullVariant = Variant::null();
 
+namespace {
+
+/**
+ * @brief Table of the interned parameters by hash
+ *
+ * The table only keeps weak references, the entries of the parameters destroyed
+ * are swept when the table has doubled since the last sweep.
+ */
+struct InternTable
+{
+    std::mutex mutex;
+    std::unordered_multimap<size_t, std::weak_ptr<void> > entries;
+    size_t sweepSize = 1024;
+};
+
+InternTable& internTable()
+{
+    static InternTable table;
+    return table;
+}
+
+}
+
+ObjectType::Parameters::Parameters(const ObjectTypeTemplate *typeTemplate, size_t size)
+    : typeTemplate(typeTemplate),
+      values(size),
+      hash(0),
+      interned(false)
+{
+}
+
+ObjectType::Parameters::Parameters(const ObjectType::Parameters &other)
+    : typeTemplate(other.typeTemplate),
+      values(other.values),
+      hash(0),
+      interned(false)
+{
+}
+
 ObjectType::ObjectType() : _typeTemplate(&ObjectTypeTemplate::nullTypeTemplate)
 {
 }
 
+ObjectType::ObjectType(const ObjectType &other)
+    : _typeTemplate(other._typeTemplate),
+      _parameters((other._parameters == nullptr || other._parameters->interned) ? other._parameters : intern(*other._parameters))
+{
+}
+
 ObjectType::ObjectType(const ObjectTypeTemplate& _typeTemplate)
-    : _typeTemplate(&_typeTemplate),
-      _parametersValue(_typeTemplate.numberOfParameters())
+    : _typeTemplate(&_typeTemplate)
+{
+    if (_typeTemplate.numberOfParameters() > 0) {
+        _parameters = std::make_shared<Parameters>(&_typeTemplate, _typeTemplate.numberOfParameters());
+    }
+}
+
+std::shared_ptr<ObjectType::Parameters> ObjectType::intern(const Parameters &parameters)
 {
+    const size_t hash = computeHash(parameters.typeTemplate, &parameters);
+
+    InternTable& table = internTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+
+    auto range = table.entries.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        std::shared_ptr<Parameters> existing = std::static_pointer_cast<Parameters>(it->second.lock());
+        if (existing && identicalParameters(*existing, parameters)) {
+            return existing;
+        }
+    }
+
+    if (table.entries.size() >= 2 * table.sweepSize) {
+        for (auto it = table.entries.begin(); it != table.entries.end();) {
+            if (it->second.expired()) {
+                it = table.entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        table.sweepSize = std::max(table.sweepSize, table.entries.size());
+    }
+
+    std::shared_ptr<Parameters> interned = std::make_shared<Parameters>(parameters);
+    interned->hash = hash;
+    interned->interned = true;
+    table.entries.emplace(hash, interned);
+    return interned;
+}
+
+size_t ObjectType::computeHash(const ObjectTypeTemplate *typeTemplate, const Parameters *parameters)
+{
+    size_t result = std::hash<const ObjectTypeTemplate*>()(typeTemplate);
+    if (parameters != nullptr) {
+        for (const Variant& value : parameters->values) {
+            result = 31 * result + std::hash<Variant>()(value);
+        }
+    }
+    return result;
+}
+
+bool ObjectType::identicalParameters(const Parameters &a, const Parameters &b)
+{
+    if (a.typeTemplate != b.typeTemplate || a.values.size() != b.values.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < a.values.size(); ++i) {
+        const Variant& aValue = a.values[i];
+        const Variant& bValue = b.values[i];
+        if (aValue.type() != bValue.type() || aValue.displayType() != bValue.displayType()) {
+            return false;
+        }
+
+        if (aValue.type() == Variant::objectType) {
+            if (!IdenticalType()(aValue.toObjectType(), bValue.toObjectType())) {
+                return false;
+            }
+        } else if (aValue != bValue) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<Variant> &ObjectType::modifiableParameters()
+{
+    if (_parameters == nullptr) {
+        _parameters = std::make_shared<Parameters>(_typeTemplate, 0);
+    } else if (_parameters->interned) {
+        _parameters = std::make_shared<Parameters>(*_parameters);
+    }
+    return _parameters->values;
+}
+
+size_t ObjectType::hash() const
+{
+    if (_parameters != nullptr && _parameters->interned) {
+        return _parameters->hash;
+    }
+    return computeHash(_typeTemplate, _parameters.get());
 }
 
 const ObjectTypeTemplate& ObjectType::typeTemplate() const
@@ -40,8 +177,8 @@ const ObjectTypeTemplate& ObjectType::typeTemplate() const
 
 const Variant& ObjectType::parameterValue(size_t index) const
 {
-    if (index < _parametersValue.size()) {
-        return _parametersValue[index];
+    if (_parameters != nullptr && index < _parameters->values.size()) {
+        return _parameters->values[index];
     } else {
         return undefinedVariant;
     }
@@ -51,16 +188,17 @@ const Variant& ObjectType::parameterValue(size_t index) const
 
 bool ObjectType::parameterSpecified(size_t index) const
 {
-    return (index < _parametersValue.size()) && (!_parametersValue[index].isUndefined());
+    return !parameterValue(index).isUndefined();
 }
 
 void ObjectType::setParameter(size_t index, const Variant &value)
 {
-    while(index >= _parametersValue.size()) {
-        _parametersValue.push_back(undefinedVariant);
+    std::vector<Variant>& values = modifiableParameters();
+    while(index >= values.size()) {
+        values.push_back(undefinedVariant);
     }
 
-    _parametersValue[index].setValue(value);
+    values[index].setValue(value);
 }
 
 const std::string &ObjectType::name() const
@@ -99,6 +237,11 @@ bool ObjectType::extendsDirectly(const ObjectType& other) const
         return false;
     }
 
+    if(_parameters == other._parameters)
+    {
+        return true;
+    }
+
     for(int i = 0; i < typeTemplate().numberOfParameters();++i)
     {
         if(other.parameterValue(i).type() != Variant::valuelessType
@@ -119,7 +262,7 @@ void swap(ObjectType& a, ObjectType& b)
 {
     using std::swap;
     swap(a._typeTemplate,b._typeTemplate);
-    swap(a._parametersValue, b._parametersValue);
+    swap(a._parameters, b._parameters);
 }
 
 ObjectType& ObjectType::operator =(ObjectType other)
@@ -133,6 +276,9 @@ bool operator==(const ObjectType& a, const ObjectType& b)
     if(a.typeTemplate() != b.typeTemplate())
         return false;
 
+    if(a._parameters == b._parameters)
+        return true;
+
     for(int i = 0; i < a.typeTemplate().numberOfParameters();++i)
     {
         if(a.parameterValue(i) != b.parameterValue(i))
@@ -159,6 +305,28 @@ bool operator< (const ObjectType& a, const ObjectType& b)
     return false;
 }
 
+bool IdenticalType::operator()(const ObjectType &a, const ObjectType &b) const
+{
+    if (a._typeTemplate != b._typeTemplate) {
+        return false;
+    }
+
+    if (a._parameters == b._parameters) {
+        return true;
+    }
+
+    if (a._parameters == nullptr || b._parameters == nullptr) {
+        return a.numberOfParameters() == 0 && b.numberOfParameters() == 0;
+    }
+
+    //Two distinct interned instances are never identical
+    if (a._parameters->interned && b._parameters->interned) {
+        return false;
+    }
+
+    return ObjectType::identicalParameters(*a._parameters, *b._parameters);
+}
+
 std::ostream& ObjectType::display(std::ostream& out) const
 {
     const Variant elementType = attributeValue(ObjectTypeTemplate::Attribute::elementType);
@@ -223,7 +391,7 @@ int ObjectType::numberOfDisplayableParameters() const
 int ObjectType::numberOfSpecifiedParameters() const
 {
     int n = typeTemplate().numberOfParameters();
-    while (n >= 1 && _parametersValue[n-1].isUndefined())
+    while (n >= 1 && parameterValue(n-1).isUndefined())
     {
         n--;
     }
@@ -20,6 +20,7 @@
 
 #include <vector>
 #include <functional>
+#include <memory>
 
 #include "core/variant.h"
 #include "core/objecttypetemplate.h"
@@ -34,6 +35,11 @@
  * and values stored as \link Variant variants\endlink specified for some of its parameters. The easiest way to construct a
  * \link ObjectType type\endlink is to use the \link ObjectTypeTemplate type template\endlink's
  * operator().
+ *
+ * The parameters are hash-consed : when a \link ObjectType type\endlink is copied its
+ * parameters are interned, so that all the copies of equal types share the same immutable
+ * instance (with its hash precomputed) and can be compared by pointer. A type built or modified
+ * with \link setParameter() setParameter\endlink owns its parameters until it is copied.
  */
 class ObjectType
 {
@@ -43,7 +49,8 @@ public:
      * \link ObjectTypeTemplate type template\endlink
      */
     ObjectType();
-    ObjectType(const ObjectType&) = default;
+    ObjectType(const ObjectType& other);
+    ObjectType(ObjectType&& other) = default;
 
 
     /**
@@ -121,9 +128,14 @@ public:
 
     int numberOfParameters() const
     {
-        return _parametersValue.size();
+        return _parameters ? _parameters->values.size() : 0;
     }
 
+    /**
+     * @brief Hash of the template and of the parameters, precomputed for interned parameters
+     */
+    std::size_t hash() const;
+
     int numberOfDisplayableParameters() const;
     int numberOfSpecifiedParameters() const;
 
@@ -165,9 +177,35 @@ private:
     ObjectType(const ObjectTypeTemplate& typeTemplate);
 
     friend class ObjectTypeCreator;
+    friend struct IdenticalType;
+    friend bool operator==(const ObjectType& a, const ObjectType& b);
+
+    struct Parameters
+    {
+        Parameters(const ObjectTypeTemplate* typeTemplate, size_t size);
+        Parameters(const Parameters& other);
+
+        const ObjectTypeTemplate* const typeTemplate;
+        std::vector<Variant> values;
+        std::size_t hash;
+        bool interned;
+    };
+
+    /**
+     * @brief Get the shared instance equal to the parameters given, creating it if needed
+     */
+    static std::shared_ptr<Parameters> intern(const Parameters& parameters);
+    static std::size_t computeHash(const ObjectTypeTemplate* typeTemplate, const Parameters* parameters);
+    static bool identicalParameters(const Parameters& a, const Parameters& b);
+
+    /**
+     * @brief Get parameters owned by the type, copying them first if they are interned
+     */
+    std::vector<Variant>& modifiableParameters();
 
     const ObjectTypeTemplate* _typeTemplate;
-    std::vector<Variant> _parametersValue;
+    /// Null if the type has no parameter
+    std::shared_ptr<Parameters> _parameters;
 
     void _setParameters(int first);
 
@@ -201,4 +239,15 @@ bool operator< (const ObjectType& a, const ObjectType& b);
 
 std::ostream& operator<<(std::ostream& out, const ObjectType& type);
 
+/**
+ * @brief Equality of \link ObjectType types\endlink without implicit conversion of the parameters
+ *
+ * Unlike ==, an integer parameter never equals a floating one and the display bases must match,
+ * so that anything computed from one of the types is valid for the other (used for cache keys).
+ */
+struct IdenticalType
+{
+    bool operator()(const ObjectType& a, const ObjectType& b) const;
+};
+
 #endif // OBJECTTYPE_H
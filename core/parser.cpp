@@ -17,7 +17,7 @@
 
 #include "core/parser.h"
 #include "core/log/logmanager.h"
-#include "core/parsingexception.h"
+#include "core/log/metrics.h"
 
 ObjectType errorType;
 
@@ -37,14 +37,24 @@ void Parser::parseHead()
 {
     if (!_headParsed)
     {
-        try {
-            Object::ParsingContext context(object());
+        Object::ParsingContext context(object());
+        if (context.isAvailable()) {
+            HM_METRICS_ADD(headParsings, 1);
             doParseHead();
             setHeadParsed();
-        } catch (const ParsingException& exception) {
-            handleParsingException(exception);
-        } catch (const Object::ParsingContext::LockException&) {
+        }
+    }
+}
 
+void Parser::parseDescription()
+{
+    parseHead();
+
+    if (!_parsed)
+    {
+        Object::ParsingContext context(object());
+        if (context.isAvailable()) {
+            doParseDescription();
         }
     }
 }
@@ -55,14 +65,11 @@ void Parser::parse()
 
     if (!_parsed)
     {
-        try {
-            Object::ParsingContext context(object());
+        Object::ParsingContext context(object());
+        if (context.isAvailable()) {
+            HM_METRICS_ADD(bodyParsings, 1);
             doParse();
             _parsed = true;
-        } catch (const ParsingException& exception) {
-            handleParsingException(exception);
-        } catch (const Object::ParsingContext::LockException&) {
-
         }
     }
 }
@@ -72,16 +79,14 @@ bool Parser::parseSome(int hint)
     parseHead();
     if (!_parsed)
     {
-        try {
-            Object::ParsingContext context(object());
+        Object::ParsingContext context(object());
+        if (context.isAvailable())
+        {
+            HM_METRICS_ADD(partialParsings, 1);
             if (doParseSome(hint))
             {
                 _parsed = true;
             }
-        } catch (const ParsingException& exception) {
-            handleParsingException(exception);
-        } catch (const Object::ParsingContext::LockException&) {
-
         }
     }
     return _parsed;
@@ -97,14 +102,11 @@ void Parser::parseTail()
 
     if(!_tailParsed)
     {
-        try {
-            Object::ParsingContext context(object());
+        Object::ParsingContext context(object());
+        if (context.isAvailable()) {
+            HM_METRICS_ADD(tailParsings, 1);
             doParseTail();
             _tailParsed = true;
-        } catch (const ParsingException& exception) {
-            handleParsingException(exception);
-        } catch (const Object::ParsingContext::LockException&) {
-
         }
     }
 }
@@ -150,7 +152,9 @@ std::shared_ptr<std::pair<bool, ObjectType> > Parser::sharedType() const
 
 int64_t Parser::availableSize() const
 {
-    if(_object.file().good()) {
+    if (!_object.isValid()) {
+        return 0;
+    } else if(_object.file().good()) {
         return _object.size() - _object.pos();
     } else {
         return -1;
@@ -193,6 +197,10 @@ void Parser::doParseHead()
 {
 }
 
+void Parser::doParseDescription()
+{
+}
+
 void Parser::doParse()
 {
 }
@@ -221,12 +229,6 @@ void Parser::setHeadParsed()
     }
 }
 
-void Parser::handleParsingException(const ParsingException &exception)
-{
-    Log::error(exception.what());
-    object().invalidate();
-}
-
 void parseBytePattern(const std::string &pattern, std::vector<std::vector<unsigned char> >& byteList, std::vector<std::vector<unsigned char> >& maskList)
 {
     bool isCurrentMask = false;
@@ -20,8 +20,6 @@
 
 #include <string>
 
-class ParsingException;
-
 #include "core/object.h"
 
 /**
@@ -49,6 +47,11 @@ public:
      */
     void parseHead();
 
+    /**
+     * @brief Parse what describes the \link Object object\endlink (value, link and attributes) if the head left it for later
+     */
+    void parseDescription();
+
     /**
      * @brief Parse everything except the tail
      */
@@ -142,6 +145,11 @@ private:
      */
     virtual void doParseHead();
 
+    /**
+     * @brief [Virtual] Parse the description of the \link Object object\endlink if it is not part of the head (do nothing by default)
+     */
+    virtual void doParseDescription();
+
     /**
      * @brief [Virtual] Parse everything remaining except the tail, assuming that the head and only the head as been parsed (do nothing by default)
      */
@@ -177,8 +185,6 @@ private:
     bool lockObject();
     void unlockObject();
 
-    void handleParsingException(const ParsingException& exception);
-
     bool _headParsed;
     bool _parsed;
     bool _tailParsed;
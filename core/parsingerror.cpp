@@ -0,0 +1,123 @@
+//This file is part of the HexaMonkey project, a multimedia analyser
+//Copyright (C) 2013  Sevan Drapeau-Martin, Nicolas Fleury
+
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+
+#include "core/parsingerror.h"
+#include "core/object.h"
+
+ParsingError::ParsingError(Reason reason, const Object &object, const Object *child, const std::string &details)
+    : _position(child ? child->beginningPos() : object.beginningPos()),
+      _object(&object),
+      _child(child),
+      _reason(reason),
+      _details(details)
+{
+}
+
+std::streamoff ParsingError::position() const
+{
+    return _position;
+}
+
+const Object &ParsingError::object() const
+{
+    return *_object;
+}
+
+const Object *ParsingError::child() const
+{
+    return _child;
+}
+
+ParsingError::Reason ParsingError::reason() const
+{
+    return _reason;
+}
+
+const std::string &ParsingError::details() const
+{
+    return _details;
+}
+
+std::string ParsingError::message() const
+{
+    if (_child) {
+        if (_details.empty()) {
+            return concat("Child ", *_child, " cannot be added to ", *_object, " : ", reasonName(_reason));
+        } else {
+            return concat("Child ", *_child, " cannot be added to ", *_object, " : ", reasonName(_reason), " (", _details, ")");
+        }
+    } else {
+        return concat(*_object, " : ", reasonName(_reason), " (", _details, ")");
+    }
+}
+
+const char *ParsingError::reasonName(Reason reason)
+{
+    switch (reason) {
+    case OutOfFile:
+        return "out of file";
+    case OutOfParent:
+        return "out of parent";
+    case InvalidChild:
+        return "child invalid";
+    case BadParameter:
+        return "bad parameter";
+    }
+    return "unknown error";
+}
+
+size_t ParsingErrorIndex::add(const ParsingError &error)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _errors.insert(std::make_pair(error.position(), error));
+    return _errors.size();
+}
+
+bool ParsingErrorIndex::empty() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _errors.empty();
+}
+
+size_t ParsingErrorIndex::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _errors.size();
+}
+
+std::vector<const ParsingError *> ParsingErrorIndex::between(std::streamoff begin, std::streamoff end) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<const ParsingError *> result;
+    for (auto it = _errors.lower_bound(begin), last = _errors.lower_bound(end); it != last; ++it) {
+        result.push_back(&it->second);
+    }
+    return result;
+}
+
+std::vector<const ParsingError *> ParsingErrorIndex::of(const Object &object) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<const ParsingError *> result;
+    for (const auto& entry : _errors) {
+        if (&entry.second.object() == &object) {
+            result.push_back(&entry.second);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,104 @@
+//This file is part of the HexaMonkey project, a multimedia analyser
+//Copyright (C) 2013  Sevan Drapeau-Martin, Nicolas Fleury
+
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+
+#ifndef PARSINGERROR_H
+#define PARSINGERROR_H
+
+#include <ios>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class Object;
+
+/**
+ * @brief Description of an error encountered while parsing an \link Object object\endlink
+ *
+ * Errors are plain values recorded into the \link ParsingErrorIndex error index\endlink
+ * of the file instead of being thrown : the object concerned is invalidated and the parsing
+ * goes on with its siblings.
+ */
+class ParsingError
+{
+public:
+    enum Reason {
+        OutOfFile,
+        OutOfParent,
+        InvalidChild,
+        BadParameter
+    };
+
+    ParsingError(Reason reason, const Object& object, const Object* child, const std::string& details);
+
+    /** @brief Absolute position in the \link File file\endlink where the error occured */
+    std::streamoff position() const;
+
+    /** @brief \link Object Object\endlink invalidated by the error */
+    const Object& object() const;
+
+    /** @brief Child that couldn't be added, nullptr if the error isn't about a child */
+    const Object* child() const;
+
+    Reason reason() const;
+    const std::string& details() const;
+
+    /** @brief Human readable description, built on demand */
+    std::string message() const;
+
+    static const char* reasonName(Reason reason);
+
+private:
+    std::streamoff _position;
+    const Object* _object;
+    const Object* _child;
+    Reason _reason;
+    std::string _details;
+};
+
+/**
+ * @brief Errors of a file's object tree sorted by position
+ *
+ * The index is owned by the root \link Object object\endlink and filled as the
+ * parsing progresses. It can be read from another thread while the parsing goes
+ * on: the errors are never modified nor moved once recorded, so that the pointers
+ * returned stay valid as long as the tree.
+ */
+class ParsingErrorIndex
+{
+public:
+    /**
+     * @brief Record the error and return the number of errors recorded so far
+     */
+    size_t add(const ParsingError& error);
+
+    bool empty() const;
+    size_t size() const;
+
+    /** @brief Errors whose position is in [begin, end) */
+    std::vector<const ParsingError*> between(std::streamoff begin, std::streamoff end) const;
+
+    /** @brief Errors invalidating the \link Object object\endlink given */
+    std::vector<const ParsingError*> of(const Object& object) const;
+
+private:
+    mutable std::mutex _mutex;
+    std::multimap<std::streamoff, ParsingError> _errors;
+};
+
+#endif // PARSINGERROR_H
@@ -1,5 +1,7 @@
 #include "specializer.h"
 
+#include <algorithm>
+
 #include "core/log/logmanager.h"
 
 Specializer::Specializer()
@@ -17,6 +19,7 @@ Specializer::Specializer(const ObjectType& source, const ObjectType& destination
 Specializer::Specializer(const Specializer &other)
     : _directSpecialization(other._directSpecialization),
       _nextSpecializations(other._nextSpecializations),
+      _dispatch(other._dispatch),
       _writable(false)
 {
 }
@@ -45,10 +48,23 @@ void Specializer::forward(const ObjectType &source, const ObjectType &destinatio
 
 const ObjectType &Specializer::specialize(const ObjectType &source) const
 {
+    const int n = source.numberOfParameters();
+
+    //Fast path for the common case of types identified by a single value, such as EBMLElement(id)
+    if (n == 1) {
+        const Variant& value = source.parameterValue(0);
+        const Specializer* specializer = value.isValueless() ? nullptr : specializerIfExists(value);
+        if (specializer && !specializer->_directSpecialization.isNull()) {
+            return specializer->_directSpecialization;
+        } else {
+            return _directSpecialization;
+        }
+    }
+
     const Specializer* currentSpecializer = this;
     const ObjectType* currentSpecialization = &(this->_directSpecialization);
 
-    for (int i = 0,  n = source.numberOfParameters(); i < n; ++i)
+    for (int i = 0; i < n; ++i)
     {
         const Variant& value = source.parameterValue(i);
         if (value.isValueless()) {
@@ -74,6 +90,43 @@ const ObjectType &Specializer::specialize(const ObjectType &source) const
     return *currentSpecialization;
 }
 
+void Specializer::freeze()
+{
+    if (!_nextSpecializations) {
+        return;
+    }
+
+    std::shared_ptr<Dispatch> dispatch = std::make_shared<Dispatch>();
+    dispatch->pass = nullptr;
+
+    for (auto& item : *_nextSpecializations) {
+        item.second.freeze();
+
+        const Variant& key = item.first;
+        switch (key.type()) {
+            case Variant::integerType:
+            case Variant::unsignedIntegerType:
+                dispatch->keys.emplace_back(key.toInteger(), &item.second);
+                break;
+
+            case Variant::floatingType:
+                //Floating keys compare loosely with integers, the hash table handles them
+                _dispatch.reset();
+                return;
+
+            case Variant::nullType:
+                dispatch->pass = &item.second;
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    std::sort(dispatch->keys.begin(), dispatch->keys.end());
+    _dispatch = dispatch;
+}
+
 std::ostream &Specializer::display(std::ostream &out) const
 {
     out << _directSpecialization;
@@ -97,6 +150,8 @@ std::ostream &Specializer::display(std::ostream &out) const
 
 Specializer &Specializer::specializer(const Variant &value)
 {
+    _dispatch.reset();
+
     if (!_nextSpecializations) {
         _nextSpecializations.reset(new std::unordered_map<Variant, Specializer>());
     }
@@ -113,6 +168,8 @@ Specializer &Specializer::specializer(const Variant &value)
 
 Specializer &Specializer::specializer()
 {
+    _dispatch.reset();
+
     if (!_nextSpecializations) {
         _nextSpecializations.reset(new std::unordered_map<Variant, Specializer>());
     }
@@ -129,6 +186,25 @@ Specializer &Specializer::specializer()
 
 const Specializer *Specializer::specializerIfExists(const Variant &value) const
 {
+    if (_dispatch) {
+        const Variant::Type type = value.type();
+        if (type == Variant::integerType || type == Variant::unsignedIntegerType) {
+            const std::vector<std::pair<long long, const Specializer*> >& keys = _dispatch->keys;
+            const long long key = value.toInteger();
+
+            auto it = std::lower_bound(keys.begin(), keys.end(), key,
+                                       [](const std::pair<long long, const Specializer*>& item, long long key) {
+                return item.first < key;
+            });
+
+            if (it != keys.end() && it->first == key) {
+                return it->second;
+            } else {
+                return nullptr;
+            }
+        }
+    }
+
     if(!_nextSpecializations) {
         return nullptr;
     }
@@ -145,6 +221,10 @@ const Specializer *Specializer::specializerIfExists(const Variant &value) const
 
 const Specializer *Specializer::specializerIfExists() const
 {
+    if (_dispatch) {
+        return _dispatch->pass;
+    }
+
     if(!_nextSpecializations) {
         return nullptr;
     }
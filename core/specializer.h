@@ -2,6 +2,7 @@
 #define SPECIALIZER_H
 
 #include <unordered_map>
+#include <vector>
 
 #include <memory>
 #include "core/varianthash.h"
@@ -19,6 +20,13 @@ public:
     void forward(const ObjectType& source, const ObjectType& destination);
     const ObjectType& specialize(const ObjectType& source) const;
 
+    /**
+     * @brief Compile the specializer and its children into sorted dispatch tables
+     *
+     * Integer parameters are then looked up by binary search instead of being hashed.
+     * Forwarding afterwards stays valid, it simply drops the tables along the modified path.
+     */
+    void freeze();
 
     std::ostream& display(std::ostream& out) const;
 private:
@@ -34,12 +42,20 @@ private:
             if (_nextSpecializations) {
                 _nextSpecializations.reset(new std::unordered_map<Variant, Specializer>(*_nextSpecializations));
             }
+            _dispatch.reset();
             _writable = true;
         }
     }
 
+    struct Dispatch
+    {
+        std::vector<std::pair<long long, const Specializer*> > keys;
+        const Specializer* pass;
+    };
+
     ObjectType _directSpecialization;
     std::shared_ptr<std::unordered_map<Variant, Specializer> > _nextSpecializations;
+    std::shared_ptr<const Dispatch> _dispatch;
     bool _writable;
 };
 
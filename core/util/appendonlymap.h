@@ -0,0 +1,175 @@
+//This file is part of the HexaMonkey project, a multimedia analyser
+//Copyright (C) 2013  Sevan Drapeau-Martin, Nicolas Fleury
+
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+
+#ifndef APPENDONLYMAP_H
+#define APPENDONLYMAP_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "core/util/appendonlyvector.h"
+
+/**
+ * @brief Hash map whose keys can only be added, readable from other threads
+ * while a single writer inserts
+ *
+ * Entries are stored in an \link AppendOnlyVector append-only vector\endlink and
+ * chained into a bucket table. When the table gets full a larger one is built and
+ * published, the previous ones are kept until destruction so that a reader still
+ * walking them is never left with a dangling pointer. Values are stored atomically
+ * and must therefore be trivially copyable.
+ *
+ * Only one thread may call \link set() set\endlink at a time.
+ */
+template<class Key, class T, class Hash = std::hash<Key> >
+class AppendOnlyMap
+{
+    struct Entry
+    {
+        Entry(const Key& key, size_t hash, T value) : key(key), hash(hash), value(value) {}
+
+        const Key key;
+        const size_t hash;
+        std::atomic<T> value;
+    };
+
+    struct Table
+    {
+        Table(size_t bucketCount)
+            : mask(bucketCount - 1),
+              heads(new std::atomic<size_t>[bucketCount]),
+              next(new std::atomic<size_t>[bucketCount])
+        {
+            for (size_t i = 0; i < bucketCount; ++i) {
+                heads[i].store(0, std::memory_order_relaxed);
+                next[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        /// Chain the entry with the given index, heads and next hold index + 1
+        void link(size_t index, size_t hash)
+        {
+            std::atomic<size_t>& head = heads[hash & mask];
+            next[index].store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            head.store(index + 1, std::memory_order_release);
+        }
+
+        const size_t mask;
+        std::unique_ptr<std::atomic<size_t>[]> heads;
+        std::unique_ptr<std::atomic<size_t>[]> next;
+    };
+
+public:
+    AppendOnlyMap() : _table(nullptr) {}
+
+    ~AppendOnlyMap()
+    {
+        delete _table.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Number of keys published, safe to call from any thread
+     */
+    size_t size() const
+    {
+        return _entries.size();
+    }
+
+    /**
+     * @brief Value associated to the key or defaultValue if the key is absent,
+     * safe to call from any thread
+     */
+    T value(const Key& key, T defaultValue = T()) const
+    {
+        const Entry* entry = find(key);
+        return entry ? entry->value.load(std::memory_order_acquire) : defaultValue;
+    }
+
+    /**
+     * @brief Associate a value to the key, replacing the previous one, writer thread only
+     */
+    void set(const Key& key, T value)
+    {
+        Entry* entry = find(key);
+        if (entry != nullptr) {
+            entry->value.store(value, std::memory_order_release);
+            return;
+        }
+
+        const size_t hash = Hash()(key);
+        const size_t index = _entries.size();
+        _entries.emplace_back(key, hash, value);
+
+        Table* table = _table.load(std::memory_order_relaxed);
+        if (table == nullptr || index > table->mask) {
+            rebuild(table == nullptr ? 8 : 2 * (table->mask + 1));
+        } else {
+            table->link(index, hash);
+        }
+    }
+
+private:
+    const Entry* find(const Key& key) const
+    {
+        return const_cast<AppendOnlyMap*>(this)->find(key);
+    }
+
+    Entry* find(const Key& key)
+    {
+        const Table* table = _table.load(std::memory_order_acquire);
+        if (table == nullptr) {
+            return nullptr;
+        }
+
+        const size_t hash = Hash()(key);
+        for (size_t i = table->heads[hash & table->mask].load(std::memory_order_acquire);
+             i != 0;
+             i = table->next[i - 1].load(std::memory_order_relaxed)) {
+            Entry& entry = _entries[i - 1];
+            if (entry.hash == hash && entry.key == key) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    void rebuild(size_t bucketCount)
+    {
+        Table* table = new Table(bucketCount);
+        for (size_t i = 0, n = _entries.size(); i < n; ++i) {
+            table->link(i, _entries[i].hash);
+        }
+
+        Table* previous = _table.exchange(table, std::memory_order_acq_rel);
+        if (previous != nullptr) {
+            _retiredTables.emplace_back(previous);
+        }
+    }
+
+    AppendOnlyVector<Entry> _entries;
+    std::atomic<Table*> _table;
+    std::vector<std::unique_ptr<Table> > _retiredTables;
+
+    //Non copyable
+    AppendOnlyMap(const AppendOnlyMap&) = delete;
+    AppendOnlyMap& operator=(const AppendOnlyMap&) = delete;
+};
+
+#endif // APPENDONLYMAP_H
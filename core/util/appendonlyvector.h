@@ -0,0 +1,232 @@
+//This file is part of the HexaMonkey project, a multimedia analyser
+//Copyright (C) 2013  Sevan Drapeau-Martin, Nicolas Fleury
+
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+
+#ifndef APPENDONLYVECTOR_H
+#define APPENDONLYVECTOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <utility>
+
+/**
+ * @brief Sequence that can only grow, readable from other threads while a single
+ * writer appends
+ *
+ * Elements are stored in chunks of increasing size (each chunk is twice as large as the
+ * previous one) that are never moved nor freed until destruction, so references and
+ * iterators stay valid as the sequence grows. The \link size() size\endlink is published
+ * once the element is constructed : a reader can access any index below the size it
+ * has read without any lock.
+ *
+ * Only one thread may call \link push_back() push_back\endlink or \link emplace_back()
+ * emplace_back\endlink at a time.
+ */
+template<class T>
+class AppendOnlyVector
+{
+    static const unsigned int firstChunkBits = 3;
+    static const unsigned int maxChunks = 40;
+
+    struct Directory
+    {
+        std::atomic<T*> chunks[maxChunks];
+
+        Directory()
+        {
+            for (auto& chunk : chunks) {
+                chunk.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    template<class Vector, class Value>
+    class _iterator : public std::iterator<std::random_access_iterator_tag, Value>
+    {
+    public:
+        _iterator() : _vector(nullptr), _index(0) {}
+        _iterator(Vector* vector, size_t index) : _vector(vector), _index(index) {}
+        template<class OtherVector, class OtherValue>
+        _iterator(const _iterator<OtherVector, OtherValue>& other) : _vector(other._vector), _index(other._index) {}
+
+        Value& operator*() const {return (*_vector)[_index];}
+        Value* operator->() const {return &(*_vector)[_index];}
+        Value& operator[](ptrdiff_t n) const {return (*_vector)[_index + n];}
+
+        _iterator& operator++() {++_index; return *this;}
+        _iterator operator++(int) {_iterator dup(*this); ++_index; return dup;}
+        _iterator& operator--() {--_index; return *this;}
+        _iterator operator--(int) {_iterator dup(*this); --_index; return dup;}
+        _iterator& operator+=(ptrdiff_t n) {_index += n; return *this;}
+        _iterator& operator-=(ptrdiff_t n) {_index -= n; return *this;}
+        _iterator operator+(ptrdiff_t n) const {return _iterator(_vector, _index + n);}
+        _iterator operator-(ptrdiff_t n) const {return _iterator(_vector, _index - n);}
+        ptrdiff_t operator-(const _iterator& other) const {return _index - other._index;}
+
+        bool operator==(const _iterator& other) const {return _index == other._index;}
+        bool operator!=(const _iterator& other) const {return _index != other._index;}
+        bool operator<(const _iterator& other) const {return _index < other._index;}
+        bool operator>(const _iterator& other) const {return _index > other._index;}
+        bool operator<=(const _iterator& other) const {return _index <= other._index;}
+        bool operator>=(const _iterator& other) const {return _index >= other._index;}
+
+    private:
+        template<class, class> friend class _iterator;
+
+        Vector* _vector;
+        size_t _index;
+    };
+
+public:
+    typedef T value_type;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef _iterator<AppendOnlyVector<T>, T> iterator;
+    typedef _iterator<const AppendOnlyVector<T>, const T> const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    AppendOnlyVector() : _directory(nullptr), _size(0) {}
+
+    ~AppendOnlyVector()
+    {
+        Directory* directory = _directory.load(std::memory_order_relaxed);
+        if (directory == nullptr) {
+            return;
+        }
+
+        const size_t n = _size.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < n; ++i) {
+            at(*directory, i).~T();
+        }
+        for (unsigned int k = 0; k < maxChunks; ++k) {
+            ::operator delete(directory->chunks[k].load(std::memory_order_relaxed));
+        }
+        delete directory;
+    }
+
+    /**
+     * @brief Number of elements published, safe to call from any thread
+     */
+    size_t size() const
+    {
+        return _size.load(std::memory_order_acquire);
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /**
+     * @brief Access an element, the index must be lower than a \link size() size\endlink
+     * previously read
+     */
+    T& operator[](size_t index)
+    {
+        return at(*_directory.load(std::memory_order_acquire), index);
+    }
+
+    const T& operator[](size_t index) const
+    {
+        return at(*_directory.load(std::memory_order_acquire), index);
+    }
+
+    T& back()
+    {
+        return (*this)[size() - 1];
+    }
+
+    const T& back() const
+    {
+        return (*this)[size() - 1];
+    }
+
+    void push_back(const T& value)
+    {
+        emplace_back(value);
+    }
+
+    /**
+     * @brief Construct an element at the end and publish the new size, writer thread only
+     */
+    template<class... Args>
+    void emplace_back(Args&&... args)
+    {
+        const size_t index = _size.load(std::memory_order_relaxed);
+
+        Directory* directory = _directory.load(std::memory_order_relaxed);
+        if (directory == nullptr) {
+            directory = new Directory;
+            _directory.store(directory, std::memory_order_release);
+        }
+
+        size_t offset;
+        const unsigned int k = chunkIndex(index, offset);
+        T* chunk = directory->chunks[k].load(std::memory_order_relaxed);
+        if (chunk == nullptr) {
+            chunk = static_cast<T*>(::operator new(chunkSize(k) * sizeof(T)));
+            directory->chunks[k].store(chunk, std::memory_order_release);
+        }
+
+        new (chunk + offset) T(std::forward<Args>(args)...);
+        _size.store(index + 1, std::memory_order_release);
+    }
+
+    iterator begin() {return iterator(this, 0);}
+    iterator end() {return iterator(this, size());}
+    const_iterator begin() const {return const_iterator(this, 0);}
+    const_iterator end() const {return const_iterator(this, size());}
+
+    reverse_iterator rbegin() {return reverse_iterator(end());}
+    reverse_iterator rend() {return reverse_iterator(begin());}
+    const_reverse_iterator rbegin() const {return const_reverse_iterator(end());}
+    const_reverse_iterator rend() const {return const_reverse_iterator(begin());}
+
+private:
+    static size_t chunkSize(unsigned int k)
+    {
+        return size_t(1) << (firstChunkBits + k);
+    }
+
+    static unsigned int chunkIndex(size_t index, size_t& offset)
+    {
+        const size_t j = (index >> firstChunkBits) + 1;
+        const unsigned int k = 8 * sizeof(unsigned long long) - 1 - __builtin_clzll(j);
+        offset = index - (((size_t(1) << k) - 1) << firstChunkBits);
+        return k;
+    }
+
+    static T& at(Directory& directory, size_t index)
+    {
+        size_t offset;
+        const unsigned int k = chunkIndex(index, offset);
+        return directory.chunks[k].load(std::memory_order_acquire)[offset];
+    }
+
+    std::atomic<Directory*> _directory;
+    std::atomic<size_t> _size;
+
+    //Non copyable
+    AppendOnlyVector(const AppendOnlyVector&) = delete;
+    AppendOnlyVector& operator=(const AppendOnlyVector&) = delete;
+};
+
+#endif // APPENDONLYVECTOR_H
@@ -17,9 +17,17 @@
 
 #include "core/util/fileutil.h"
 #include "core/util/iterutil.h"
+#include "core/util/osutil.h"
+#include "core/util/strutil.h"
 
+#include <atomic>
+#include <cstdio>
 #include <fstream>
+#include <iterator>
 #include <dirent.h>
+#ifndef PLATFORM_WIN32
+#include <unistd.h>
+#endif
 
 #include <iostream>
 
@@ -85,3 +93,55 @@ bool fileCompare(const std::string &path1, const std::string &path2)
 
     return file1.eof() == file2.eof();
 }
+
+bool fileHash(const std::string &path, uint64_t &hash)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    char buffer[4096];
+    while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {
+        dataHash(buffer, file.gcount(), hash);
+    }
+    return true;
+}
+
+void dataHash(const char *data, size_t size, uint64_t &hash)
+{
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ static_cast<uint8_t>(data[i])) * 1099511628211ULL;
+    }
+}
+
+bool readFile(const std::string &path, std::string &content)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad();
+}
+
+std::string uniqueTempPath(const std::string &path)
+{
+    static std::atomic<unsigned int> counter(0);
+#ifdef PLATFORM_WIN32
+    const unsigned long pid = GetCurrentProcessId();
+#else
+    const unsigned long pid = getpid();
+#endif
+    return concat(path, ".", pid, ".", counter++, ".tmp");
+}
+
+bool replaceFile(const std::string &tempPath, const std::string &path)
+{
+#ifdef PLATFORM_WIN32
+    return MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(tempPath.c_str(), path.c_str()) == 0;
+#endif
+}
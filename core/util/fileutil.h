@@ -20,6 +20,7 @@
 
 #include <string>
 #include <vector>
+#include <stdint.h>
 
 /**
  * @brief Check if a file can be read at the location specified
@@ -39,4 +40,38 @@ void getDirContent(const std::string& path, std::vector<std::string>& content);
 
 bool fileCompare(const std::string& path1, const std::string& path2);
 
+/// Initial value of the hash computed by fileHash
+const uint64_t fileHashBasis = 14695981039346656037ULL;
+
+/**
+ * @brief Mix the content of a file into a 64 bits FNV-1a hash
+ *
+ * The hash should start from fileHashBasis, or from the hash of some previous content
+ * to get a hash of the concatenation. Returns false if the file cannot be read.
+ */
+bool fileHash(const std::string& path, uint64_t& hash);
+
+/**
+ * @brief Mix data into a hash in the same way as fileHash
+ */
+void dataHash(const char* data, size_t size, uint64_t& hash);
+
+/**
+ * @brief Read the whole content of a file, returns false if the file cannot be read
+ */
+bool readFile(const std::string& path, std::string& content);
+
+/**
+ * @brief Get a path next to the one given that no other thread or process uses, to write
+ * a file there before \link replaceFile moving it\endlink into place
+ */
+std::string uniqueTempPath(const std::string& path);
+
+/**
+ * @brief Move a file written completely into place, atomically replacing the one at path if any
+ *
+ * Returns false if the file could not be moved, in which case it is left where it was.
+ */
+bool replaceFile(const std::string& tempPath, const std::string& path);
+
 #endif // FILEUTIL_H
@@ -3,42 +3,121 @@
 #include "core/log/logmanager.h"
 #include "core/module.h"
 
-LocalScope::LocalScope(const Variable &context, const Module &module)
+int LocalScope::Slots::add(const std::string &name)
+{
+    auto it = _indices.find(name);
+    if (it != _indices.end()) {
+        return it->second;
+    }
+
+    const int slot = _names.size();
+    _indices[name] = slot;
+    _names.push_back(name);
+    return slot;
+}
+
+int LocalScope::Slots::find(const std::string &name) const
+{
+    auto it = _indices.find(name);
+    if (it != _indices.end()) {
+        return it->second;
+    }
+    return -1;
+}
+
+const std::string &LocalScope::Slots::name(int slot) const
+{
+    return _names[slot];
+}
+
+size_t LocalScope::Slots::size() const
+{
+    return _names.size();
+}
+
+LocalScope::LocalScope(const Variable &context, const Module &module, std::shared_ptr<const Slots> localSlots)
     : VariableImplementation(context.collector()),
+      _slotNames(localSlots),
+      _slots(localSlots ? localSlots->size() : 0, Slot{false, VariableMemory()}),
+      _hasUnboundFields(false),
       _context(context),
       _module(module)
 {
 }
 
+LocalScope::LocalScope(const Variable &context, const Module &module, std::shared_ptr<const Slots> localSlots, std::vector<Slot> &&storage)
+    : VariableImplementation(context.collector()),
+      _slotNames(localSlots),
+      _slots(std::move(storage)),
+      _hasUnboundFields(false),
+      _context(context),
+      _module(module)
+{
+    _slots.resize(localSlots ? localSlots->size() : 0, Slot{false, VariableMemory()});
+}
+
+std::vector<LocalScope::Slot> LocalScope::releaseSlots()
+{
+    std::vector<Slot> storage = std::move(_slots);
+    storage.clear();
+    _slots.clear();
+    return storage;
+}
+
 void LocalScope::collect(const VariableAdder &addAccessible)
 {
     addAccessible(_context);
     for (auto& entry : _fields) {
         addAccessible(entry.second);
     }
+    for (Slot& slot : _slots) {
+        if (slot.isSet) {
+            addAccessible(slot.variable);
+        }
+    }
+}
+
+Variable LocalScope::slotField(int slot, bool modifiable, bool createIfNeeded)
+{
+    if (_slots[slot].isSet) {
+        return _slots[slot].variable;
+    }
+    return contextField(_slotNames->name(slot), modifiable, createIfNeeded, slot);
+}
+
+void LocalScope::setSlot(int slot, const Variable &variable)
+{
+    _slots[slot].isSet = true;
+    _slots[slot].variable = variable;
+}
+
+void LocalScope::removeSlot(int slot)
+{
+    _slots[slot].isSet = false;
+    _slots[slot].variable = VariableMemory();
+}
+
+bool LocalScope::hasUnboundFields() const
+{
+    return _hasUnboundFields;
 }
 
 Variable LocalScope::doGetField(const Variant &key, bool modifiable, bool createIfNeeded)
 {
+    int slot = -1;
     if (key.type() == Variant::stringType) {
+        slot = slotIndex(key.toString());
+        if (slot != -1) {
+            return slotField(slot, modifiable, createIfNeeded);
+        }
+
         auto it = _fields.find(key.toString());
         if (it != _fields.end()) {
             return it->second;
         }
     }
 
-    const Variable variable = Variable(_context).field(key, modifiable, createIfNeeded);
-    if (key.type() != Variant::Type::stringType || variable.isDefined()) {
-        return variable;
-    } else {
-        const std::string& name = key.toString();
-        const Variable moduleVariable = _module.getVariable(name, collector());
-        if (moduleVariable.isDefined()) {
-            _fields[name] = moduleVariable;
-        }
-        return moduleVariable;
-    }
-
+    return contextField(key, modifiable, createIfNeeded, slot);
 }
 
 void LocalScope::doSetField(const Variant &key, const Variable &variable)
@@ -48,7 +127,13 @@ void LocalScope::doSetField(const Variant &key, const Variable &variable)
         return;
     }
 
-    _fields[key.toString()] = variable;
+    const int slot = slotIndex(key.toString());
+    if (slot != -1) {
+        setSlot(slot, variable);
+    } else {
+        _fields[key.toString()] = variable;
+        _hasUnboundFields = true;
+    }
 }
 
 void LocalScope::doRemoveField(const Variant &key)
@@ -58,5 +143,37 @@ void LocalScope::doRemoveField(const Variant &key)
         return;
     }
 
-    _fields.erase(key.toString());
+    const int slot = slotIndex(key.toString());
+    if (slot != -1) {
+        removeSlot(slot);
+    } else {
+        _fields.erase(key.toString());
+    }
+}
+
+int LocalScope::slotIndex(const std::string &name) const
+{
+    if (_slotNames) {
+        return _slotNames->find(name);
+    }
+    return -1;
+}
+
+Variable LocalScope::contextField(const Variant &key, bool modifiable, bool createIfNeeded, int slot)
+{
+    const Variable variable = Variable(_context).field(key, modifiable, createIfNeeded);
+    if (key.type() != Variant::Type::stringType || variable.isDefined()) {
+        return variable;
+    } else {
+        const std::string& name = key.toString();
+        const Variable moduleVariable = _module.getVariable(name, collector());
+        if (moduleVariable.isDefined()) {
+            if (slot != -1) {
+                setSlot(slot, moduleVariable);
+            } else {
+                _fields[name] = moduleVariable;
+            }
+        }
+        return moduleVariable;
+    }
 }
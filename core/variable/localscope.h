@@ -1,8 +1,10 @@
 #ifndef LOCALSCOPE_H
 #define LOCALSCOPE_H
 
+#include <memory>
 #include <unordered_map>
 #include <string>
+#include <vector>
 
 #include "core/variable/variable.h"
 
@@ -11,16 +13,81 @@ class Module;
 class LocalScope : public VariableImplementation
 {
 public:
-    LocalScope(const Variable& context, const Module& module);
+    /**
+     * @brief Local variable names bound at load time to slot indices
+     *
+     * Shared by all the scopes running the same blocks, so that the
+     * \link VirtualMachine virtual machine\endlink accesses the local variables
+     * by index instead of hashing their names.
+     */
+    class Slots
+    {
+    public:
+        /**
+         * @brief Bind a name to a slot if not already bound
+         * @return index of the slot
+         */
+        int add(const std::string& name);
+
+        /**
+         * @brief Get the slot bound to a name, -1 if there is none
+         */
+        int find(const std::string& name) const;
+
+        const std::string& name(int slot) const;
+        size_t size() const;
+
+    private:
+        std::unordered_map<std::string, int> _indices;
+        std::vector<std::string> _names;
+    };
+
+    struct Slot
+    {
+        bool isSet;
+        VariableMemory variable;
+    };
+
+    LocalScope(const Variable& context, const Module& module, std::shared_ptr<const Slots> localSlots = nullptr);
+
+    /**
+     * @brief Construct the scope on the storage released by a previous one, to reuse its memory
+     */
+    LocalScope(const Variable& context, const Module& module, std::shared_ptr<const Slots> localSlots, std::vector<Slot>&& storage);
+
+    /**
+     * @brief Give back the storage of the slots, emptied, once the scope isn't used anymore
+     */
+    std::vector<Slot> releaseSlots();
 
     virtual void collect(const VariableAdder &addAccessible) override;
+
+    /**
+     * @brief Get a local variable by its slot, same as a field access with its name
+     */
+    Variable slotField(int slot, bool modifiable, bool createIfNeeded);
+    void setSlot(int slot, const Variable& variable);
+    void removeSlot(int slot);
+
+    /**
+     * @brief Check if fields not bound to a slot have been set, in which case they
+     * may hide the fields of the context
+     */
+    bool hasUnboundFields() const;
+
 protected:
     virtual Variable doGetField(const Variant &key, bool modifiable, bool createIfNeeded) override;
     virtual void doSetField(const Variant &key, const Variable &variable) override;
     virtual void doRemoveField(const Variant &key) override;
 
 private:
+    int slotIndex(const std::string& name) const;
+    Variable contextField(const Variant &key, bool modifiable, bool createIfNeeded, int slot);
+
     std::unordered_map<std::string, VariableMemory> _fields;
+    std::shared_ptr<const Slots> _slotNames;
+    std::vector<Slot> _slots;
+    bool _hasUnboundFields;
     VariableMemory _context;
     const Module& _module;
 };
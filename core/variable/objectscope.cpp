@@ -49,6 +49,21 @@ const std::unordered_map<std::string, int> reserved = {
     {"@parser",           A_PARSER}
 };
 
+static Variant objectSize(const Object& object)
+{
+    return Variant((long long) object.size());
+}
+
+static Variant objectPos(const Object& object)
+{
+    return Variant((long long) object.pos());
+}
+
+static Variant objectAbsPos(const Object& object)
+{
+    return Variant(static_cast<long long>(static_cast<std::streamoff>(object.beginningPos()) + object.pos()));
+}
+
 class ObjectPosVariableImplementation : public VariableImplementation
 {
 public:
@@ -66,7 +81,7 @@ protected:
     }
 
     virtual Variant doGetValue() override {
-        return Variant((long long) _object.pos());
+        return objectPos(_object);
     }
 private:
     Object& _object;
@@ -85,14 +100,14 @@ public:
 protected:
     virtual void doSetValue(const Variant& value) override {
         if (value.hasNumericalType()) {
-            _object.setPos(value.toInteger() - _object.beginningPos());
+            _object.setPos(value.toInteger() - static_cast<std::streamoff>(_object.beginningPos()));
         } else {
             Log::warning("Trying to set a non numerical value for a pos");
         }
     }
 
     virtual Variant doGetValue() override {
-        return Variant(_object.beginningPos() + (long long) _object.pos());
+        return objectAbsPos(_object);
     }
 private:
     Object& _object;
@@ -118,7 +133,7 @@ protected:
     }
 
     virtual Variant doGetValue() override {
-        return Variant((long long) _object.size());
+        return objectSize(_object);
     }
 private:
     Object& _object;
@@ -218,103 +233,159 @@ void ObjectScope::collect(const VariableAdder &addAccessible)
     addAccessible(_parserScope);
 }
 
-Variable ObjectScope::doGetField(const Variant &key, bool /*modifiable*/, bool createIfNeeded)
+int ObjectScope::reservedIndex(const std::string &name)
 {
-    if (key.isValueless()) {
+    auto it = reserved.find(name);
+    if (it == reserved.end()) {
+        return -1;
+    }
+    return it->second;
+}
 
-        int numberOfChildren = _object.numberOfChildren();
-        if (numberOfChildren > 0) {
-            Object* elem = _object.access(numberOfChildren - 1, true);
-            if(elem != nullptr) {
-                return elem->variable();
+Variable ObjectScope::reservedField(int index, bool createIfNeeded)
+{
+    switch (index) {
+        case A_SIZE:
+            return Variable(new ObjectSizeVariableImplementation(_object), true);
+
+        case A_VALUE:
+            return collector().ref(_object.value());
+
+        case A_PARENT:
+        {
+            Object* parent = _object.parent();
+
+            if (parent != nullptr) {
+                return parent->variable();
             } else {
                 return Variable();
             }
-        } else {
-            return Variable();
         }
 
-    } else if (key.type() == Variant::stringType) {
+        case A_ROOT:
+            return _object.root().variable();
 
-        const std::string& name = key.toString();
-        if (name[0] == '@')
-        {
-            auto it = reserved.find(name);
-            if (it == reserved.end()) {
-                return Variable();
-            } else {
+        case A_RANK:
+        case A_REM:
+        case A_NUMBER_OF_CHILDREN:
+        case A_BEGINNING_POS:
+            return collector().copy(reservedValue(index));
 
-                switch (it->second) {
-                    case A_SIZE:
-                        return Variable(new ObjectSizeVariableImplementation(_object), true);
+        case A_POS:
+            return Variable(new ObjectPosVariableImplementation(_object), true);
 
-                    case A_VALUE:
-                        return collector().ref(_object.value());
+        case A_ABS_POS:
+            return Variable(new ObjectAbsPosVariableImplementation(_object), true);
 
-                    case A_PARENT:
-                    {
-                        Object* parent = _object.parent();
+        case A_LINK_TO:
+            return Variable(new ObjectLinkToVariableImplementation(_object), true);
 
-                        if (parent != nullptr) {
-                            return parent->variable();
-                        } else {
-                            return Variable();
-                        }
-                    }
+        case A_ATTR:
+            return _object.attributesVariable(createIfNeeded);
+
+        case A_CONTEXT:
+            return _object.contextVariable(createIfNeeded);
+
+        case A_GLOBAL:
+            return _object.root().contextVariable(createIfNeeded);
+
+        case A_ENDIANNESS:
+            return Variable(new ObjectEndiannessVariableImplementation(_object), true);
+
+        case A_TYPE:
+            return Variable(new TypeScope(collector(), _object.type()), false);
+
+        case A_ARGS:
+            return _parserScope;
 
-                    case A_ROOT:
-                        return _object.root().variable();
+        case A_PARSER:
+            if (_sharedParserAccess) {
+                return Variable(new ParserScope(collector(), _sharedParserAccess), false);
+            } else {
+                return Variable();
+            }
 
-                    case A_RANK:
-                        return collector().copy(_object.rank());
+        default:
+            return Variable();
+    }
+}
 
-                    case A_POS:
-                        return Variable(new ObjectPosVariableImplementation(_object), true);
+Variant ObjectScope::reservedValue(int index)
+{
+    switch (index) {
+        case A_SIZE:
+            return objectSize(_object);
 
-                    case A_ABS_POS:
-                        return Variable(new ObjectAbsPosVariableImplementation(_object), true);
+        case A_VALUE:
+            return _object.value();
 
-                    case A_REM:
-                        return collector().copy(_object.size() - _object.pos());
+        case A_RANK:
+            return Variant(_object.rank());
 
-                    case A_NUMBER_OF_CHILDREN:
-                        _object.explore(1);
-                        return collector().copy(_object.numberOfChildren());
+        case A_POS:
+            return objectPos(_object);
 
-                    case A_BEGINNING_POS:
-                        return collector().copy((long long) _object.beginningPos());
+        case A_ABS_POS:
+            return objectAbsPos(_object);
 
-                    case A_LINK_TO:
-                        return Variable(new ObjectLinkToVariableImplementation(_object), true);
+        case A_REM:
+            return Variant(_object.size() - _object.pos());
 
-                    case A_ATTR:
-                        return _object.attributesVariable(createIfNeeded);
+        case A_NUMBER_OF_CHILDREN:
+            _object.explore(1);
+            return Variant(_object.numberOfChildren());
 
-                    case A_CONTEXT:
-                        return _object.contextVariable(createIfNeeded);
+        case A_BEGINNING_POS:
+            return Variant((long long) _object.beginningPos());
 
-                    case A_GLOBAL:
-                        return _object.root().contextVariable(createIfNeeded);
+        default:
+            return reservedField(index, false).value();
+    }
+}
 
-                    case A_ENDIANNESS:
-                        return Variable(new ObjectEndiannessVariableImplementation(_object), true);
+bool ObjectScope::parameterValue(const ObjectTypeTemplate &typeTemplate, int index, const std::string &name, Variant &value)
+{
+    if (!_sharedType) {
+        return false;
+    }
 
-                    case A_TYPE:
-                        return Variable(new TypeScope(collector(), _object.type()), false);
+    const ObjectType& type = _sharedType->first ?
+                                 _sharedType->second
+                               : _object.type();
+    if (&type.typeTemplate() != &typeTemplate || _object.lookUp(name, false) != nullptr) {
+        return false;
+    }
 
-                    case A_ARGS:
-                        return _parserScope;
+    value = type.parameterValue(index);
+    return true;
+}
 
-                    case A_PARSER:
-                        if (_sharedParserAccess) {
-                            return Variable(new ParserScope(collector(), _sharedParserAccess), false);
-                        } else {
-                            return Variable();
-                        }
+Variable ObjectScope::doGetField(const Variant &key, bool /*modifiable*/, bool createIfNeeded)
+{
+    if (key.isValueless()) {
 
-                    default:
-                        return Variable();
-                }
+        int numberOfChildren = _object.numberOfChildren();
+        if (numberOfChildren > 0) {
+            Object* elem = _object.access(numberOfChildren - 1, true);
+            if(elem != nullptr) {
+                return elem->variable();
+            } else {
+                return Variable();
+            }
+        } else {
+            return Variable();
+        }
+
+    } else if (key.type() == Variant::stringType) {
+
+        const std::string& name = key.toString();
+        if (name[0] == '@')
+        {
+            const int index = reservedIndex(name);
+            if (index == -1) {
+                return Variable();
+            } else {
+                return reservedField(index, createIfNeeded);
             }
         } else {
             if (_sharedType) {
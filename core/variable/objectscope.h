@@ -2,11 +2,13 @@
 #define OBJECTSCOPEIMPLEMENTATION_H
 
 #include <memory>
+#include <string>
 
 #include "core/variable/variable.h"
 #include "core/parser.h"
 
 class Object;
+class ObjectTypeTemplate;
 
 class ObjectScope : public VariableImplementation
 {
@@ -15,6 +17,30 @@ public:
     ObjectScope(std::shared_ptr<Parser*> sharedParserAccess);
 
     virtual void collect(const VariableAdder &addAccessible) override;
+
+    /**
+     * @brief Get the index of a reserved field ("@size", "@pos"...), -1 if the name isn't reserved
+     */
+    static int reservedIndex(const std::string& name);
+
+    /**
+     * @brief Get a reserved field by its index, same as a field access with its name
+     */
+    Variable reservedField(int index, bool createIfNeeded);
+
+    /**
+     * @brief Get the value of a reserved field by its index without building an accessor
+     * for the numerical fields
+     */
+    Variant reservedValue(int index);
+
+    /**
+     * @brief Get the value of a type parameter by its index in the template, if the type
+     * parsed is built from this template and no child of the object hides it
+     * @return false if the value must be looked up by name
+     */
+    bool parameterValue(const ObjectTypeTemplate& typeTemplate, int index, const std::string& name, Variant& value);
+
 protected:
     virtual Variable doGetField(const Variant &key, bool modifiable, bool createIfNeeded) override;
     virtual void doSetValue(const Variant &value) override;
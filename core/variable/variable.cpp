@@ -20,6 +20,7 @@
 #include "core/variable/commonvariable.h"
 #include "core/variable/variablecollector.h"
 #include "core/log/logmanager.h"
+#include "core/log/metrics.h"
 
 const Variant undefinedVariant;
 const Variant nullVariant = Variant::null();
@@ -44,7 +45,11 @@ Variable::Variable(VariableImplementation *implementation, bool modifiable)
       _tag(modifiable)
 
 {
-    implementation->collector().registerVariable(implementation);
+    if (implementation->_external) {
+        implementation->collector().addDirectlyAccessible(implementation);
+    } else {
+        implementation->collector().registerVariable(implementation);
+    }
 }
 
 Variable::Variable(const Variable &variable)
@@ -169,15 +174,19 @@ void Variable::setField(const VariablePath &path, const Variable &variable) cons
     try {
         auto implementation = &_implementation;
         if (!_tag.flags.modifiable) {
+            HM_METRICS_ADD(exceptions, 1);
             throw Error::constModification;
         }
 
+        //The intermediate field must stay alive until the end of the access
+        Variable field;
         auto it = path.cbegin();
         for (auto end = --path.cend();it != end; ++it) {
 
-            Variable field = (*implementation)->doGetField(*it, true, true);
+            field = (*implementation)->doGetField(*it, true, true);
             implementation = &(field._implementation);
             if (!_tag.flags.modifiable) {
+                HM_METRICS_ADD(exceptions, 1);
                 throw Error::constModification;
             }
         }
@@ -203,15 +212,19 @@ void Variable::removeField(const VariablePath &path) const
     try {
         auto implementation = &_implementation;
         if (!_tag.flags.modifiable) {
+            HM_METRICS_ADD(exceptions, 1);
             throw Error::constModification;
         }
 
+        //The intermediate field must stay alive until the end of the access
+        Variable field;
         auto it = path.cbegin();
         for (auto end = --path.cend();it != end; ++it) {
 
-            Variable field = (*implementation)->doGetField(*it, true, true);
+            field = (*implementation)->doGetField(*it, true, true);
             implementation = &(field._implementation);
             if (!_tag.flags.modifiable) {
+                HM_METRICS_ADD(exceptions, 1);
                 throw Error::constModification;
             }
         }
@@ -256,6 +269,9 @@ VariableMemory::VariableMemory(const Variable &variable)
     : _implementation(variable._implementation),
       _tag(variable._tag.data)
 {
+    if (_tag.flags.defined) {
+        _implementation->_escaped = true;
+    }
 }
 
 VariableTag defaultDefinedTag(true);
@@ -264,11 +280,17 @@ VariableMemory::VariableMemory(VariableImplementation *implementation)
     : _implementation(implementation),
       _tag(implementation == &undefinedVariableImplementation ? 0 : defaultDefinedTag.data)
 {
+    if (_tag.flags.defined) {
+        _implementation->_escaped = true;
+    }
 }
 
 
 VariableImplementation::VariableImplementation(VariableCollector &variableCollector)
-    : _collector(&variableCollector)
+    : _collector(&variableCollector),
+      _young(false),
+      _escaped(false),
+      _external(false)
 {
 }
 
@@ -308,7 +330,10 @@ Variable VariableImplementation::doCall(VariableArgs &/*args*/, VariableKeywordA
 }
 
 VariableImplementation::VariableImplementation()
-    : _collector(nullptr)
+    : _collector(nullptr),
+      _young(false),
+      _escaped(false),
+      _external(false)
 {
 }
 
@@ -316,6 +341,11 @@ void VariableImplementation::collect(const std::function<void(VariableMemory &)>
 {
 }
 
+void VariableImplementation::setExternal()
+{
+    _external = true;
+}
+
 VariableMemory VariableImplementation::memory()
 {
     return VariableMemory(this);
@@ -200,6 +200,16 @@ public:
     virtual ~VariableImplementation();
     virtual void collect(const std::function<void(VariableMemory&)>& addAccessible);
 
+    /**
+     * @brief Mark the implementation as owned outside of the collector, for instance by the
+     * frame of a method call
+     *
+     * The collections still go through the variables it holds but never free it. Must be
+     * called before any \link Variable variable\endlink is built on it, and the implementation
+     * must outlive those variables.
+     */
+    void setExternal();
+
 
 protected:    
     inline VariableCollector& collector() const {
@@ -218,9 +228,19 @@ protected:
 
     virtual Variable doCall(VariableArgs &args, VariableKeywordArgs &kwargs);
 private:
+    friend class VariableMemory;
+    friend class VariableCollector;
+
     VariableImplementation(); /* <--- */ friend class UndefinedVariableImplementation;
 
     mutable VariableCollector* _collector;
+
+    /// Registered since the last collection
+    bool _young;
+    /// Held by a variable memory, i.e. possibly referenced by another implementation
+    bool _escaped;
+    /// Owned outside of the collector
+    bool _external;
 };
 
 #endif // VARIABLE_H
@@ -1,13 +1,23 @@
 #include "variablecollector.h"
 #include "core/variable/variable.h"
 #include "core/log/logmanager.h"
+#include "core/log/metrics.h"
 
 #include <algorithm>
 
 Variant VariableCollector::nullVariant = Variant::null();
 
+namespace {
+const size_t defaultFullCollectionThreshold = 10000;
+}
+
 VariableCollector::VariableCollector()
-    : _destroying(false)
+    : _destroying(false),
+      _allocationCount(0),
+      _youngAccessibleBegin(0),
+      _promotedSinceFull(0),
+      _oldSizeAfterFull(0),
+      _fullCollectionThreshold(defaultFullCollectionThreshold)
 {
 }
 
@@ -21,17 +31,26 @@ VariableCollector::~VariableCollector()
     {
         delete it->first;
     }
+    for (VariableImplementation* variable : _young) {
+        delete variable;
+    }
 }
 
 void VariableCollector::collect()
 {
+    const auto start = std::chrono::steady_clock::now();
+    const size_t freed = _statistics.freed;
+
+    promoteYoung();
     compact();
 
     size_t i = 0;
     size_t originalSize = _directlyAccessible.size();
 
     std::for_each(_directlyAccessible.begin(), _directlyAccessible.end(), [this] (VariableImplementation* variable) {
-        _accessibility[variable] = true;
+        if (!variable->_external) {
+            _accessibility[variable] = true;
+        }
     });
 
     while (true) {
@@ -44,6 +63,11 @@ void VariableCollector::collect()
             _directlyAccessible[i]->collect([this] (VariableMemory& variable) {
                 if (variable._tag.flags.defined) {
                     VariableImplementation* implementation = variable._implementation;
+                    if (implementation->_external) {
+                        // Not recorded, an external implementation is traversed each time it is reached
+                        _directlyAccessible.push_back(implementation);
+                        return;
+                    }
                     auto& isAccessible = _accessibility[implementation];
                     if (!isAccessible) {
                         isAccessible = true;
@@ -66,8 +90,77 @@ void VariableCollector::collect()
         } else {
             delete it->first;
             _accessibility.erase(it++);
+            ++_statistics.freed;
+        }
+    }
+
+    _youngAccessibleBegin = _directlyAccessible.size();
+    _promotedSinceFull = 0;
+    _oldSizeAfterFull = _accessibility.size();
+    ++_statistics.fullCollections;
+    recordPause(start, freed);
+}
+
+void VariableCollector::collectYoung()
+{
+    if (_promotedSinceFull > std::max(_fullCollectionThreshold, _oldSizeAfterFull)) {
+        collect();
+        return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const size_t freed = _statistics.freed;
+
+    // A young implementation can only be directly accessible through an entry added
+    // since the last collection, and can only be referenced by another implementation
+    // through a variable memory, in which case it is marked as escaped.
+    // The entries added are compacted on the way.
+    const size_t accessibleBegin = std::min(_youngAccessibleBegin, _directlyAccessible.size());
+    size_t accessibleEnd = accessibleBegin;
+    for (size_t i = accessibleBegin; i < _directlyAccessible.size(); ++i) {
+        VariableImplementation* variable = _directlyAccessible[i];
+        if (variable != nullptr) {
+            if (variable->_young) {
+                variable->_escaped = true;
+            }
+            _directlyAccessible[accessibleEnd] = variable;
+            ++accessibleEnd;
+        }
+    }
+    _directlyAccessible.resize(accessibleEnd);
+
+    std::vector<VariableImplementation*> young;
+    young.swap(_young);
+    for (VariableImplementation* variable : young) {
+        if (variable->_escaped) {
+            variable->_young = false;
+            _accessibility.insert(std::make_pair(variable, false));
+            ++_promotedSinceFull;
+            ++_statistics.promoted;
+        } else {
+            delete variable;
+            ++_statistics.freed;
         }
     }
+
+    _youngAccessibleBegin = _directlyAccessible.size();
+    ++_statistics.youngCollections;
+    recordPause(start, freed);
+}
+
+void VariableCollector::setFullCollectionThreshold(size_t threshold)
+{
+    _fullCollectionThreshold = threshold;
+}
+
+const VariableCollector::Statistics &VariableCollector::statistics() const
+{
+    return _statistics;
+}
+
+size_t VariableCollector::allocationCount() const
+{
+    return _allocationCount;
 }
 
 void VariableCollector::removeDirectlyAccessible(VariableImplementation *variable)
@@ -82,6 +175,7 @@ void VariableCollector::removeDirectlyAccessible(VariableImplementation *variabl
                 ++rit;
             }
             _directlyAccessible.resize(std::distance(rit, rend));
+            _youngAccessibleBegin = std::min(_youngAccessibleBegin, _directlyAccessible.size());
         } else {
             ++rit;
             while (rit != rend) {
@@ -116,6 +210,28 @@ void VariableCollector::compact()
 }
 
 
+void VariableCollector::promoteYoung()
+{
+    for (VariableImplementation* variable : _young) {
+        variable->_young = false;
+        _accessibility.insert(std::make_pair(variable, false));
+    }
+    _statistics.promoted += _young.size();
+    _young.clear();
+}
+
+void VariableCollector::recordPause(std::chrono::steady_clock::time_point start, size_t freed)
+{
+    const std::chrono::nanoseconds pause = std::chrono::steady_clock::now() - start;
+    _statistics.lastPause = pause;
+    _statistics.maxPause = std::max(_statistics.maxPause, pause);
+    _statistics.totalPause += pause;
+
+    HM_METRICS_ADD(collections, 1);
+    HM_METRICS_ADD(collectedVariables, _statistics.freed - freed);
+    HM_METRICS_RECORD(collectionPause, std::chrono::duration_cast<std::chrono::microseconds>(pause).count());
+}
+
 VariableCollectionGuard::VariableCollectionGuard(VariableCollector &collector)
     : _collector(collector)
 {
@@ -123,5 +239,5 @@ VariableCollectionGuard::VariableCollectionGuard(VariableCollector &collector)
 
 VariableCollectionGuard::~VariableCollectionGuard()
 {
-    _collector.collect();
+    _collector.collectYoung();
 }
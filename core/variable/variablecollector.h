@@ -1,6 +1,7 @@
 #ifndef VARIABLECOLLECTOR_H
 #define VARIABLECOLLECTOR_H
 
+#include <chrono>
 #include <vector>
 #include <unordered_map>
 
@@ -8,16 +9,60 @@
 
 class VariableImplementation;
 
+/**
+ * @brief Garbage collector for \link VariableImplementation variable implementations\endlink
+ *
+ * The implementations are split in two generations. The young generation holds
+ * the implementations registered since the last collection, most of them being
+ * temporaries of the evaluation. A young collection frees the young
+ * implementations that are neither directly accessible nor held by a
+ * \link VariableMemory variable memory\endlink in time proportional to the young
+ * generation, the others are promoted to the old generation. The old generation
+ * is only marked and swept by a full collection, run when enough implementations
+ * have been promoted since the last one.
+ *
+ * \link VariableImplementation::setExternal External\endlink implementations, such as
+ * the scopes of the frames of method calls, are gone through but never registered nor freed.
+ */
 class VariableCollector
 {
 public:
+    /**
+     * @brief Counters of the collections and their pause times
+     */
+    struct Statistics
+    {
+        size_t youngCollections = 0;
+        size_t fullCollections = 0;
+        size_t freed = 0;
+        size_t promoted = 0;
+        std::chrono::nanoseconds lastPause = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds maxPause = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds totalPause = std::chrono::nanoseconds::zero();
+    };
+
     VariableCollector();
     ~VariableCollector();
 
+    /**
+     * @brief Full collection : mark and sweep of every implementation registered
+     */
     void collect();
 
+    /**
+     * @brief Young collection, escalated to a full collection when the number of
+     * implementations promoted since the last full collection exceeds the threshold
+     * or the size of the old generation
+     */
+    void collectYoung();
+
+    void setFullCollectionThreshold(size_t threshold);
+    const Statistics& statistics() const;
+
     inline void registerVariable(VariableImplementation* variable) {
-        _accessibility.insert(std::make_pair(variable, false));
+        ++_allocationCount;
+        variable->_young = true;
+        _young.push_back(variable);
         addDirectlyAccessible(variable);
     }
     inline void addDirectlyAccessible(VariableImplementation* variable) {
@@ -26,6 +71,15 @@ public:
     void removeDirectlyAccessible(VariableImplementation* variable);
 
 
+    /**
+     * @brief Get the number of \link VariableImplementation variable implementations\endlink
+     * registered since the construction of the collector
+     *
+     * Each of them is a heap allocation and an entry in the accessibility table, which
+     * makes the count a measure of the memory churn of the scripts.
+     */
+    size_t allocationCount() const;
+
     /**
      * @brief Construct a \link Variable variable\endlink copying and then owning a value
      */
@@ -84,11 +138,23 @@ public:
 
 private:
     void compact();
+    void promoteYoung();
+    /// Freed is the count of implementations freed before the collection
+    void recordPause(std::chrono::steady_clock::time_point start, size_t freed);
 
     bool _destroying;
+    size_t _allocationCount;
     std::vector<VariableImplementation*> _directlyAccessible;
     std::unordered_map<VariableImplementation*, bool> _accessibility;
 
+    std::vector<VariableImplementation*> _young;
+    /// Directly accessible entries before this index were added before the last collection
+    size_t _youngAccessibleBegin;
+    size_t _promotedSinceFull;
+    size_t _oldSizeAfterFull;
+    size_t _fullCollectionThreshold;
+    Statistics _statistics;
+
 
     static Variant nullVariant;
 };
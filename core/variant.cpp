@@ -518,6 +518,11 @@ void Variant::setDisplayType(Variant::Display display)
     _type = (_type & ~displayMask) | display;
 }
 
+Variant::Display Variant::displayType() const
+{
+    return static_cast<Display>(_type & displayMask);
+}
+
 void Variant::setDisplayBase(int base)
 {
     Variant::Display display;
@@ -171,6 +171,7 @@ public:
     bool operator!() const;
 
     void setDisplayType(Display display);
+    Display displayType() const;
     void setDisplayBase(int base);
 
     std::ostream& display(std::ostream& out, bool setFlags = true) const;
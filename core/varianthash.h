@@ -66,6 +66,15 @@ namespace std
             return result;
         }
     };
+
+    template<>
+    struct hash<ObjectType>
+    {
+        std::size_t operator()(ObjectType const& type) const
+        {
+            return type.hash();
+        }
+    };
 }
 /** @endcond */
 
@@ -41,6 +41,7 @@ SOURCES += \
     tree/treeview.cpp \
     tree/treeobjectitem.cpp \
     tree/treemodel.cpp \
+    tree/treeprefetcher.cpp \
     tree/treefileitem.cpp \
     tree/treeitem.cpp \
     tree/htmldelegate.cpp \
@@ -52,10 +53,7 @@ SOURCES += \
     hex/hexfileheader.cpp \
     hex/hexfiledelegate.cpp \
     log/logwidget.cpp \
-    qtprogramloader.cpp \
-    thread/threadqueue.cpp \
-    thread/functionthread.cpp \
-    qtmodulesetup.cpp
+    thread/threadqueue.cpp
 
 
 HEADERS  += \ 
@@ -64,6 +62,7 @@ HEADERS  += \
     tree/treeview.h \
     tree/treeobjectitem.h \
     tree/treemodel.h \
+    tree/treeprefetcher.h \
     tree/treefileitem.h \
     tree/treeitem.h \
     tree/htmldelegate.h \
@@ -75,10 +74,12 @@ HEADERS  += \
     hex/hexfileheader.h \
     hex/hexfiledelegate.h \
     log/logwidget.h \
-    qtprogramloader.h \
-    thread/threadqueue.h \
-    thread/functionthread.h \
-    qtmodulesetup.h
+    thread/threadqueue.h
+
+contains(DEFINES, HM_METRICS) {
+    SOURCES += log/metricswidget.cpp
+    HEADERS += log/metricswidget.h
+}
 
 RESOURCES += \
     ressources.qrc
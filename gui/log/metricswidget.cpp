@@ -0,0 +1,56 @@
+#include "metricswidget.h"
+
+#include <QHeaderView>
+
+#include "core/log/metrics.h"
+
+MetricsWidget::MetricsWidget(QWidget *parent)
+    : QTableWidget(Metrics::counterCount + Metrics::histogramCount, 2, parent)
+{
+    setWindowTitle("Stats");
+    setHorizontalHeaderLabels(QStringList() << "Metric" << "Value");
+    horizontalHeader()->setStretchLastSection(true);
+    verticalHeader()->hide();
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    for (int counter = 0; counter < Metrics::counterCount; ++counter) {
+        setItem(counter, 0, new QTableWidgetItem(Metrics::name(static_cast<Metrics::Counter>(counter))));
+        setItem(counter, 1, new QTableWidgetItem());
+    }
+    for (int histogram = 0; histogram < Metrics::histogramCount; ++histogram) {
+        setItem(Metrics::counterCount + histogram, 0, new QTableWidgetItem(Metrics::name(static_cast<Metrics::Histogram>(histogram))));
+        setItem(Metrics::counterCount + histogram, 1, new QTableWidgetItem());
+    }
+    resizeColumnToContents(0);
+
+    connect(&timer, SIGNAL(timeout()), this, SLOT(refresh()));
+}
+
+void MetricsWidget::showEvent(QShowEvent *event)
+{
+    QTableWidget::showEvent(event);
+    refresh();
+    timer.start(refreshInterval);
+}
+
+void MetricsWidget::hideEvent(QHideEvent *event)
+{
+    QTableWidget::hideEvent(event);
+    timer.stop();
+}
+
+void MetricsWidget::refresh()
+{
+    for (int counter = 0; counter < Metrics::counterCount; ++counter) {
+        item(counter, 1)->setText(QString::number(Metrics::value(static_cast<Metrics::Counter>(counter))));
+    }
+    for (int histogram = 0; histogram < Metrics::histogramCount; ++histogram) {
+        const Metrics::Summary summary = Metrics::summary(static_cast<Metrics::Histogram>(histogram));
+        item(Metrics::counterCount + histogram, 1)->setText(QString("count %1, p50 %2, p90 %3, p99 %4, max %5")
+                                                             .arg(summary.count)
+                                                             .arg(summary.percentile(0.5))
+                                                             .arg(summary.percentile(0.9))
+                                                             .arg(summary.percentile(0.99))
+                                                             .arg(summary.max));
+    }
+}
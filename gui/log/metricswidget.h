@@ -0,0 +1,31 @@
+#ifndef METRICSWIDGET_H
+#define METRICSWIDGET_H
+
+#include <QtWidgets/QTableWidget>
+#include <QTimer>
+
+/**
+ * @brief Status panel showing the \link Metrics metrics\endlink of the parsing
+ *
+ * The values are refreshed periodically while the panel is visible.
+ */
+class MetricsWidget : public QTableWidget
+{
+    Q_OBJECT
+public:
+    MetricsWidget(QWidget* parent = 0);
+
+protected:
+    virtual void showEvent(QShowEvent* event) override;
+    virtual void hideEvent(QHideEvent* event) override;
+
+private slots:
+    void refresh();
+
+private:
+    static const int refreshInterval = 500;
+
+    QTimer timer;
+};
+
+#endif // METRICSWIDGET_H
@@ -19,7 +19,7 @@
 #include <QApplication>
 #include <QIcon>
 
-#include "qtmodulesetup.h"
+#include "core/modulesetup.h"
 
 #include "mainwindow.h"
 
@@ -27,7 +27,7 @@ int main(int argc, char *argv[])
 {
     std::cout<<std::endl;
 
-    QtModuleSetup moduleSetup;
+    ModuleSetup moduleSetup;
     moduleSetup.setup();
 
     QApplication a(argc, argv);
@@ -49,6 +49,9 @@ MainWindow::MainWindow(ModuleLoader &moduleLoader, const ProgramLoader &programL
     QTabWidget* tab = new QTabWidget(centralWidget());
     tab->addTab(hexFileWidget, "hex");
     tab->addTab(logWidget, "log");
+#ifdef HM_METRICS
+    tab->addTab(new MetricsWidget(), "stats");
+#endif
 
     layout->addWidget(treeWidget, 1);
     layout->addWidget(tab);
@@ -26,13 +26,16 @@
 #include "core/formatdetector/formatdetector.h"
 
 #include "gui/log/logwidget.h"
+#ifdef HM_METRICS
+#include "gui/log/metricswidget.h"
+#endif
 #include "gui/tree/treewidget.h"
 #include "gui/tree/htmldelegate.h"
 #include "gui/hex/hexfilewidget.h"
 
 #include <QAction>
 
-#include "qtprogramloader.h"
+#include "core/interpreter/programloader.h"
 #include "core/log/logmanager.h"
 #include "core/moduleloader.h"
 #include "core/util/fileutil.h"
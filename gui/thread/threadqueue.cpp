@@ -1,47 +1,223 @@
 #include "gui/thread/threadqueue.h"
-#include "gui/thread/functionthread.h"
 
 #include <QThread>
+#include <QMutexLocker>
 
 
-ThreadQueue::ThreadQueue(QObject *parent)
+class ThreadQueue::Worker : public QThread
+{
+public:
+    explicit Worker(ThreadQueue& queue) : QThread(&queue), _queue(queue) {}
+
+    virtual void run() final
+    {
+        _queue.work();
+    }
+
+private:
+    ThreadQueue& _queue;
+};
+
+ThreadQueue::ThreadQueue(QObject *parent, int workerCount)
     :QObject(parent),
-     _currentThread(nullptr),
-     _currentId(0),
-     _freeId(1)
+     _freeId(1),
+     _sequence(0),
+     _stopping(false)
 {
+    if (workerCount <= 0) {
+        workerCount = qMax(2, QThread::idealThreadCount());
+    }
+
+    for (int i = 0; i < workerCount; ++i) {
+        QThread* worker = new Worker(*this);
+        _workers.append(worker);
+        worker->start();
+    }
+}
+
+ThreadQueue::~ThreadQueue()
+{
+    {
+        QMutexLocker lock(&_mutex);
+        _stopping = true;
+        for (Task* task : _running) {
+            task->isCancelled = true;
+        }
+        _taskAvailable.wakeAll();
+    }
+
+    for (QThread* worker : _workers) {
+        worker->wait();
+    }
+
+    qDeleteAll(_pending);
+}
+
+int ThreadQueue::add(Priority priority, const Groups &groups, const Key &key, Step step, const std::function<void (int)> &registerId)
+{
+    int id;
+    {
+        QMutexLocker lock(&_mutex);
+
+        Task* existing = nullptr;
+        if (key.first != nullptr) {
+            for (Task* task : _pending + _running) {
+                if (task->key == key && !task->isCancelled) {
+                    existing = task;
+                    break;
+                }
+            }
+        }
+
+        if (existing != nullptr) {
+            if (priority < existing->priority) {
+                existing->priority = priority;
+            }
+            id = existing->id;
+        } else {
+            id = _freeId++;
+            _pending.append(new Task{id, priority, ++_sequence, groups, key, step, false, false});
+        }
+        registerId(id);
+    }
+    _taskAvailable.wakeOne();
+    return id;
 }
 
-void ThreadQueue::onThreadFinished()
+void ThreadQueue::cancel(int id)
 {
-    emit finished(_currentId);
-    delete _currentThread;
-    _currentThread = nullptr;
-    _currentId = 0;
-    onQueueUpdated();
+    bool removed = false;
+    {
+        QMutexLocker lock(&_mutex);
+        for (int i = 0; i < _pending.size(); ++i) {
+            if (_pending[i]->id == id) {
+                delete _pending.takeAt(i);
+                removed = true;
+                break;
+            }
+        }
+
+        if (!removed) {
+            for (Task* task : _running) {
+                if (task->id == id) {
+                    task->isCancelled = true;
+                }
+            }
+        }
+    }
+
+    if (removed) {
+        emit cancelled(id);
+    }
 }
 
-void ThreadQueue::onQueueUpdated()
+void ThreadQueue::cancelGroup(const void *group)
 {
-    if (!_currentThread && !_threadQueue.empty()) {
-        std::pair<int, QThread*> item = _threadQueue.dequeue();
-        _currentId = item.first;
-        _currentThread = item.second;
-        connect(_currentThread, SIGNAL(finished()), this, SLOT(onThreadFinished()));
-        _currentThread->start();
-        emit started(_currentId);
+    QList<int> removedIds;
+    {
+        QMutexLocker lock(&_mutex);
+        for (int i = _pending.size() - 1; i >= 0; --i) {
+            if (_pending[i]->groups.contains(group)) {
+                removedIds.prepend(_pending[i]->id);
+                delete _pending.takeAt(i);
+            }
+        }
+
+        bool running = true;
+        while (running) {
+            running = false;
+            for (Task* task : _running) {
+                if (task->groups.contains(group)) {
+                    task->isCancelled = true;
+                    running = true;
+                }
+            }
+            if (running) {
+                _taskDone.wait(&_mutex);
+            }
+        }
+    }
+
+    for (int id : removedIds) {
+        emit cancelled(id);
     }
 }
 
+ThreadQueue::Task *ThreadQueue::nextTask()
+{
+    Task* next = nullptr;
+    for (Task* task : _pending) {
+        bool groupBusy = false;
+        for (Task* runningTask : _running) {
+            if (shareGroup(runningTask, task)) {
+                groupBusy = true;
+                break;
+            }
+        }
 
-void ThreadQueue::add(QThread *thread, const std::function<void(int)> &registerId)
+        if (!groupBusy
+                && (next == nullptr
+                    || task->priority < next->priority
+                    || (task->priority == next->priority && task->sequence < next->sequence))) {
+            next = task;
+        }
+    }
+    return next;
+}
+
+bool ThreadQueue::shareGroup(const Task *task, const Task *other)
 {
-    _threadQueue.enqueue(std::make_pair(_freeId, thread));
-    registerId(_freeId++);
-    onQueueUpdated();
+    for (const void* group : task->groups) {
+        if (other->groups.contains(group)) {
+            return true;
+        }
+    }
+    return false;
 }
 
-void ThreadQueue::add(std::function<void ()> functionToRun, const std::function<void (int)> &registerId)
+void ThreadQueue::work()
 {
-    add(new FunctionThread(this, functionToRun), registerId);
+    QMutexLocker lock(&_mutex);
+    while (!_stopping) {
+        Task* task = nextTask();
+        if (task == nullptr) {
+            _taskAvailable.wait(&_mutex);
+            continue;
+        }
+
+        _pending.removeOne(task);
+        _running.append(task);
+        const bool firstStep = !task->hasStarted;
+        task->hasStarted = true;
+
+        lock.unlock();
+        if (firstStep) {
+            emit started(task->id);
+        }
+        const bool done = task->step();
+        lock.relock();
+
+        _running.removeOne(task);
+        const int id = task->id;
+        if (done || task->isCancelled) {
+            delete task;
+            lock.unlock();
+            if (done) {
+                emit finished(id);
+            } else {
+                emit cancelled(id);
+            }
+            lock.relock();
+        } else {
+            // Round robin between the tasks of same priority
+            task->sequence = ++_sequence;
+            _pending.append(task);
+            lock.unlock();
+            emit progressed(id);
+            lock.relock();
+        }
+
+        _taskDone.wakeAll();
+        _taskAvailable.wakeAll();
+    }
 }
@@ -2,38 +2,107 @@
 #define PARSINGQUEUE_H
 
 #include <QObject>
-#include <QQueue>
-#include <QModelIndex>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QVector>
+#include <QWaitCondition>
 
 #include <functional>
 
 class QThread;
 class Object;
 
+/**
+ * @brief Pool of persistent worker threads running tasks by priority
+ *
+ * A task is a step function called repeatedly until it returns true, which
+ * lets a long task yield between steps : a task of higher priority is always
+ * run first, and a cancelled task stops at the end of its current step.
+ *
+ * A task belongs to a set of groups, tasks sharing a group are never run
+ * concurrently and tasks without common groups run in parallel. The groups of
+ * a parsing task are the root \link Object object\endlink of the file, whose
+ * stream and collector cannot be shared between threads, and the
+ * \link Module::parsingModules() modules modified by the parsing\endlink.
+ *
+ * Adding a task with the same key as a task not finished yet doesn't add a new
+ * one : the id of the existing task is given back and its priority is raised
+ * if needed.
+ */
 class ThreadQueue : public QObject
 {
     Q_OBJECT
 public:
-    explicit ThreadQueue(QObject* parent);
+    enum Priority {
+        /// Requested by the user and waited for (e.g. node expansion)
+        Interactive = 0,
+        /// Exploration done ahead of the user
+        Background = 1,
+        /// Search and indexing of a whole file
+        Search = 2
+    };
 
-    void add(QThread* thread, const std::function<void (int)> &registerId);
-    void add(std::function<void ()> functionToRun, const std::function<void (int)> &registerId);
+    typedef QPair<const void*, qint64> Key;
+    typedef QVector<const void*> Groups;
+    typedef std::function<bool ()> Step;
 
-public slots:
-    void onThreadFinished();
+    explicit ThreadQueue(QObject* parent, int workerCount = 0);
+    ~ThreadQueue();
+
+    /**
+     * @brief Add a task run by steps until the step function returns true
+     * @return id of the task, emitted by \link started() started\endlink and \link finished() finished\endlink
+     */
+    int add(Priority priority, const Groups& groups, const Key& key, Step step, const std::function<void (int)> &registerId);
+
+    /**
+     * @brief Cancel a task, the task stops after its current step if running
+     */
+    void cancel(int id);
+
+    /**
+     * @brief Cancel all the tasks of a group and wait for the running ones to stop
+     */
+    void cancelGroup(const void* group);
 
 signals:
     void started(int);
+    /// Emitted after each step of a task that is neither finished nor cancelled
+    void progressed(int);
     void finished(int);
+    void cancelled(int);
 
 private:
+    class Worker;
+
+    struct Task
+    {
+        int id;
+        Priority priority;
+        quint64 sequence;
+        Groups groups;
+        Key key;
+        Step step;
+        bool hasStarted;
+        bool isCancelled;
+    };
+
+    void work();
+    Task* nextTask();
+    static bool shareGroup(const Task* task, const Task* other);
+
+    QList<Task*> _pending;
+    QList<Task*> _running;
+    QList<QThread*> _workers;
 
-    void onQueueUpdated();
+    QMutex _mutex;
+    QWaitCondition _taskAvailable;
+    QWaitCondition _taskDone;
 
-    QQueue<std::pair<int, QThread*> > _threadQueue;
-    QThread* _currentThread;
-    int _currentId;
     int _freeId;
+    quint64 _sequence;
+    bool _stopping;
 };
 
 #endif // PARSINGQUEUE_H
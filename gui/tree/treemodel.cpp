@@ -16,25 +16,50 @@
 //Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include <QMessageBox>
+#include <QMutex>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
 
 #include "core/modules/default/defaultmodule.h"
 #include "gui/tree/treemodel.h"
 #include "gui/tree/treeitem.h"
 #include "gui/tree/treeobjectitem.h"
+#include "gui/tree/treeprefetcher.h"
 #include "gui/thread/threadqueue.h"
 
+/// Children of an item filtered by a worker, the matches are taken by the model as they come
+struct TreeModel::Filtering
+{
+    Filtering(const Filter& filter, int64_t begin, int64_t end)
+        : filter(filter), next(begin), end(end), filtered(begin) {}
+
+    /// Copied so that the expression of the item can be edited while the worker runs
+    Filter filter;
+    int64_t next;
+    const int64_t end;
+
+    QMutex mutex;
+    std::vector<Object*> matches;
+    int64_t filtered;
+};
+
 TreeModel::TreeModel(const QString &/*data*/, const ProgramLoader &programLoader, TreeView* view, QObject *parent) :
     QAbstractItemModel(parent),
     view(view),
     programLoader(programLoader),
-    threadQueue(new ThreadQueue(this))
+    threadQueue(new ThreadQueue(this)),
+    prefetcher(new TreePrefetcher(*this, *view, *threadQueue))
 {
     QList<QVariant> rootData;
     rootData << "Struct" << "Beginning position" << "Size";
     rootItem = TreeItem::RootItem(rootData, this);
 
     connect(threadQueue, SIGNAL(started(int)), this, SLOT(onThreadStarted(int)));
+    connect(threadQueue, SIGNAL(progressed(int)), this, SLOT(onThreadProgressed(int)));
     connect(threadQueue, SIGNAL(finished(int)), this, SLOT(onThreadFinished(int)));
+    connect(threadQueue, SIGNAL(cancelled(int)), this, SLOT(onThreadCancelled(int)));
 }
 
 TreeItem &TreeModel::item(const QModelIndex &index) const
@@ -84,6 +109,10 @@ bool TreeModel::removeRows(int position, int rows, const QModelIndex &parent)
 
     bool success = true;
 
+    for (int row = position; row < position + rows; ++row) {
+        cancelFiltering(index(row, 0, parent));
+    }
+
     beginRemoveRows(parent, position, position + rows - 1);
     success = parentItem.removeChildren(position, rows);
     endRemoveRows();
@@ -94,6 +123,12 @@ bool TreeModel::removeRows(int position, int rows, const QModelIndex &parent)
 
 void TreeModel::removeItem(QModelIndex index)
 {
+    if (index.isValid()) {
+        const Object* root = &static_cast<TreeObjectItem*>(index.internalPointer())->object().root();
+        threadQueue->cancelGroup(root);
+        prefetcher->forgetFile(*root);
+    }
+
     QModelIndex parent = index.parent();
     int row = index.row();
     removeRow(row, parent);
@@ -179,6 +214,16 @@ int TreeModel::rowCount(const QModelIndex &parent) const
     return count;
 }
 
+QVector<const void *> TreeModel::parsingGroups(const Object &object)
+{
+    const Object& root = object.root();
+    QVector<const void*> groups{&root};
+    for (const Module* module : root.module().parsingModules()) {
+        groups.append(module);
+    }
+    return groups;
+}
+
 QModelIndex TreeModel::addObject(Object& object, const QModelIndex &parent)
 {
     new TreeObjectItem(object, programLoader, &item(parent));
@@ -193,17 +238,21 @@ QModelIndex TreeModel::addObject(Object& object, const QModelIndex &parent)
 void TreeModel::updateChildren(const QModelIndex& index)
 {
     TreeObjectItem& item = *static_cast<TreeObjectItem*>(index.internalPointer());
+    if (!item.filterExpression().empty()) {
+        filterChildren(index);
+        return;
+    }
+
     int count = 0;
     int first = realRowCount(index);
+    const int64_t firstChild = item.lastChildIndex();
 
     for (Object::iterator it = item.nextChild(); it != item.end(); ++it) {
 
         Object* object = *it;
         if (object != nullptr) {
-            if (item.filterObject(*object)) {
-                addObject(*object, index);
-                count++;
-            }
+            addObject(*object, index);
+            count++;
         }
         item.advanceLastChild();
     }
@@ -211,11 +260,91 @@ void TreeModel::updateChildren(const QModelIndex& index)
     beginInsertRows(index, first, first+count);
     endInsertRows();
 
+    prefetcher->onChildrenDisplayed(item.object(), firstChild, item.lastChildIndex());
+
     if (count) {
         emit dataChanged(index.child(0,0), index.child(count-1,columnCount(index)-1));
     }
 }
 
+void TreeModel::filterChildren(const QModelIndex &index)
+{
+    TreeObjectItem& item = *static_cast<TreeObjectItem*>(index.internalPointer());
+    Object& object = item.object();
+
+    const int64_t begin = item.lastChildIndex();
+    const int64_t end = object.numberOfChildren();
+    if (begin >= end) {
+        return;
+    }
+
+    std::shared_ptr<Filtering> filtering = std::make_shared<Filtering>(item.filter(), begin, end);
+    ThreadQueue::Step step = [&object, filtering] {
+        const int64_t batchEnd = std::min(filtering->next + filterBatchSize, filtering->end);
+        std::vector<Object*> matches;
+        filtering->filter.select(object, filtering->next, batchEnd, matches);
+        filtering->next = batchEnd;
+
+        QMutexLocker lock(&filtering->mutex);
+        filtering->matches.insert(filtering->matches.end(), matches.begin(), matches.end());
+        filtering->filtered = batchEnd;
+        return batchEnd == filtering->end;
+    };
+
+    // While the children are filtered, a new request is merged into the running one
+    threadQueue->add(ThreadQueue::Interactive, parsingGroups(object), ThreadQueue::Key(&object, -3), step, [this, &index, &filtering] (int id) {
+        if (!filteringIds.contains(id)) {
+            filteringIds.insert(id, std::make_pair(QPersistentModelIndex(index), filtering));
+        }
+    });
+}
+
+void TreeModel::addFilteredChildren(const QModelIndex &index, Filtering &filtering)
+{
+    std::vector<Object*> matches;
+    int64_t filtered;
+    {
+        QMutexLocker lock(&filtering.mutex);
+        matches.swap(filtering.matches);
+        filtered = filtering.filtered;
+    }
+
+    if (!index.isValid()) {
+        return;
+    }
+
+    TreeObjectItem& item = *static_cast<TreeObjectItem*>(index.internalPointer());
+    const int64_t firstChild = item.lastChildIndex();
+
+    if (!matches.empty()) {
+        const int first = realRowCount(index);
+        beginInsertRows(index, first, first + int(matches.size()) - 1);
+        for (Object* object : matches) {
+            addObject(*object, index);
+        }
+        endInsertRows();
+    }
+    item.setLastChildIndex(filtered);
+
+    prefetcher->onChildrenDisplayed(item.object(), firstChild, filtered);
+}
+
+void TreeModel::cancelFiltering(const QModelIndex &index)
+{
+    for (int id : filteringIds.keys()) {
+        // The items of the descendants are deleted along with the children of the index
+        QModelIndex filtered = filteringIds.value(id).first;
+        while (filtered.isValid() && filtered != index) {
+            filtered = filtered.parent();
+        }
+
+        if (filtered == index) {
+            filteringIds.remove(id);
+            threadQueue->cancel(id);
+        }
+    }
+}
+
 void TreeModel::onThreadStarted(int i)
 {
     auto parsingIt = parsingIds.find(i);
@@ -235,6 +364,19 @@ void TreeModel::onThreadStarted(int i)
     }
 }
 
+void TreeModel::onThreadProgressed(int i)
+{
+    auto filteringIt = filteringIds.find(i);
+    if (filteringIt != filteringIds.end()) {
+        if (filteringIt->first.isValid()) {
+            addFilteredChildren(filteringIt->first, *filteringIt->second);
+        } else {
+            filteringIds.erase(filteringIt);
+            threadQueue->cancel(i);
+        }
+    }
+}
+
 void TreeModel::onThreadFinished(int i)
 {
     auto parsingIt = parsingIds.find(i);
@@ -259,10 +401,49 @@ void TreeModel::onThreadFinished(int i)
 
         emit exploringFinished(std::get<0>(item), std::get<1>(item));
     }
+
+    auto filteringIt = filteringIds.find(i);
+    if (filteringIt != filteringIds.end()) {
+        auto filtering = filteringIds.take(i);
+        const QModelIndex index = filtering.first;
+        addFilteredChildren(index, *filtering.second);
+
+        // Children parsed while the others were filtered
+        if (index.isValid()) {
+            TreeObjectItem& item = *static_cast<TreeObjectItem*>(index.internalPointer());
+            if (item.object().numberOfChildren() > item.lastChildIndex()) {
+                filterChildren(index);
+            }
+        }
+    }
+}
+
+void TreeModel::onThreadCancelled(int i)
+{
+    auto parsingIt = parsingIds.find(i);
+    if (parsingIt != parsingIds.end()) {
+        QModelIndex index = parsingIds.take(i);
+
+        if (index.isValid()) {
+            static_cast<TreeObjectItem*>(index.internalPointer())->setSynchronising(false);
+            emit parsingFinished(index);
+        }
+    }
+
+    auto exploringIt = exploringIds.find(i);
+    if (exploringIt != exploringIds.end()) {
+        auto item = exploringIds.take(i);
+
+        emit exploringFinished(std::get<0>(item), std::get<1>(item));
+    }
+
+    filteringIds.remove(i);
 }
 
 void TreeModel::deleteChildren(const QModelIndex &index)
 {
+    cancelFiltering(index);
+
     const int count = realRowCount(index);
     beginRemoveRows(index,0, count);
     endRemoveRows();
@@ -302,24 +483,30 @@ void TreeModel::populate(const QModelIndex &index, unsigned int nominalCount, un
     TreeObjectItem& item = *static_cast<TreeObjectItem*>(index.internalPointer());
     Object& object = item.object();
 
-    if (item.object().parsed()) {
+    if (item.object().parsed() || object.numberOfChildren() >= item.lastChildIndex() + minCount) {
+        // Either everything or enough has already been parsed, by a previous population or the prefetcher
         if (!item.synchronised()) {
             updateChildren(index);
         }
     } else {
         if (!item.synchronising()) {
             item.setSynchronising(true);
-            threadQueue->add([&object, nominalCount, minCount, maxTries] {
-                VariableCollectionGuard guard(object.collector());
 
-                int minNumberOfChildren = object.numberOfChildren() + minCount;
+            // One exploration per step so that the worker can be given to a more urgent task in between
+            const int minNumberOfChildren = object.numberOfChildren() + minCount;
+            auto tries = std::make_shared<unsigned int>(0);
+            ThreadQueue::Step step = [&object, nominalCount, minNumberOfChildren, maxTries, tries] {
+                VariableCollectionGuard guard(object.collector());
 
-                for (unsigned int tries = 0;
-                     object.numberOfChildren() < minNumberOfChildren && !object.parsed() && tries < maxTries;
-                     ++tries) {
-                     object.exploreSome(nominalCount);
+                if (object.numberOfChildren() < minNumberOfChildren && !object.parsed() && *tries < maxTries) {
+                    object.exploreSome(nominalCount);
+                    ++*tries;
                 }
-            }, [this, &index] (int id) {
+
+                return !(object.numberOfChildren() < minNumberOfChildren && !object.parsed() && *tries < maxTries);
+            };
+
+            threadQueue->add(ThreadQueue::Interactive, parsingGroups(object), ThreadQueue::Key(&object, -1), step, [this, &index] (int id) {
                 parsingIds.insert(id, index);
             });
         }
@@ -380,20 +567,11 @@ int TreeModel::findItemChildByFilePosition(const QModelIndex &index, qint64 byte
                 success = true;
                 break;
             } else {
-                bool found = false;
-                for (int i = 0; true; ++i) {
-                    Object* child = currentObject->access(i);
-                    if (child == nullptr) {
-                        break;
-                    } else if (child->includesPos(bitPos)) {
-                        currentObject = child;
-                        found = true;
-                        result.append(i);
-                        break;
-                    }
-                }
-
-                if (!found) {
+                int64_t i = currentObject->childIndexAtPos(bitPos);
+                if (i != -1) {
+                    currentObject = currentObject->access(i);
+                    result.append(i);
+                } else {
                     if (currentObject->parsed()) {
                         success = true;
                     }
@@ -405,32 +583,32 @@ int TreeModel::findItemChildByFilePosition(const QModelIndex &index, qint64 byte
         if (success) {
             resultCallback(result);
         } else {
-            threadQueue->add([object, bitPos] {
+            // A new search replaces the previous ones
+            for (int id : exploringIds.keys()) {
+                if (std::get<1>(exploringIds.value(id)) != bytePos) {
+                    threadQueue->cancel(id);
+                }
+            }
+
+            // Each step either goes down one level or explores a bit more of the current object
+            auto current = std::make_shared<Object*>(object);
+            ThreadQueue::Step step = [object, bitPos, current] {
                 VariableCollectionGuard guard(object->collector());
 
-                Object* currentObject = object;
-                while (true) {
-                    if (currentObject->parsed() && currentObject->numberOfChildren() == 0) {
-                        break;
-                    } else {
-                        bool found = false;
-                        for (int i = 0; true; ++i) {
-                            Object* child = currentObject->access(i, true);
-                            if (child == nullptr) {
-                                break;
-                            } else if (child->includesPos(bitPos)) {
-                                currentObject = child;
-                                found = true;
-                                break;
-                            }
-                        }
-
-                        if (!found) {
-                            break;
-                        }
-                    }
+                Object* currentObject = *current;
+                int64_t i = currentObject->childIndexAtPos(bitPos);
+                if (i != -1) {
+                    *current = currentObject->access(i);
+                    return false;
+                } else if (currentObject->parsed()) {
+                    return true;
+                } else {
+                    currentObject->exploreSome(128);
+                    return false;
                 }
-            }, [this, &index, &bytePos, &resultCallback] (int id) {
+            };
+
+            threadQueue->add(ThreadQueue::Search, parsingGroups(*object), ThreadQueue::Key(object, bitPos), step, [this, &index, &bytePos, &resultCallback] (int id) {
                 exploringIds.insert(id, std::make_tuple(index, bytePos, resultCallback));
             });
 
@@ -22,8 +22,10 @@
 #include <QModelIndex>
 #include <QVariant>
 #include <QMap>
+#include <QVector>
 
 #include <functional>
+#include <memory>
 #include <utility>
 
 #include "core/object.h"
@@ -34,6 +36,7 @@
 class TreeItem;
 class ProgramLoader;
 class ThreadQueue;
+class TreePrefetcher;
 
 /**
  * @brief Model managing the data structure of the tree
@@ -46,6 +49,12 @@ class ThreadQueue;
  * that a node get expanded to populate its children. This also
  * means that when there is a large number of children only a limited
  * number are added, and the rest is then added progressively.
+ *
+ * While the user is idle, a \link TreePrefetcher prefetcher\endlink explores
+ * ahead the children likely to be displayed next.
+ *
+ * When an item has a \link Filter filter\endlink, its children are filtered by
+ * batches on a worker and the ones matching are added as each batch completes.
  */
 
 class TreeModel : public QAbstractItemModel
@@ -91,7 +100,9 @@ public slots:
     void updateFilter(QString expression);
     void updateChildren(const QModelIndex &index); 
     void onThreadStarted(int i);
+    void onThreadProgressed(int i);
     void onThreadFinished(int i);
+    void onThreadCancelled(int i);
 
 signals:
     void parsingStarted(QModelIndex);
@@ -104,17 +115,33 @@ signals:
 
 
 private:
+    friend class TreePrefetcher;
+
     static const int defaultPopulation   = 64;
     static const int minPopulationRatio  = 2;
     static const int populationTries     = 32;
+    static const int filterBatchSize     = 4096;
+
+    struct Filtering;
+
+    /// Groups of the tasks parsing the object in the thread queue
+    static QVector<const void*> parsingGroups(const Object& object);
+
     QModelIndex addObject(Object &object, const QModelIndex &parent);
+    void filterChildren(const QModelIndex &index);
+    void addFilteredChildren(const QModelIndex& index, Filtering& filtering);
+    /// Cancels the filtering of the index and of its descendants, whose items are about to be deleted
+    void cancelFiltering(const QModelIndex &index);
 
     TreeItem *rootItem;
     QModelIndex current;
     const ProgramLoader& programLoader;
     ThreadQueue* threadQueue;
+    TreePrefetcher* prefetcher;
 
     QMap<int, QModelIndex> parsingIds;
+    /// The persistent indexes stay on the model side, the workers only share the filterings
+    QMap<int, std::pair<QPersistentModelIndex, std::shared_ptr<Filtering> > > filteringIds;
     QMap<int, std::tuple<QModelIndex, qint64, std::function<void (const QList<size_t>&)> > > exploringIds;
 };
 
@@ -29,7 +29,7 @@ std::ostream& displayVariant(std::ostream& out, const Variant& variant);
 TreeObjectItem::TreeObjectItem(const ProgramLoader &programLoader, TreeItem *parent) :
     TreeItem(QList<QVariant>({"", "", ""}), parent),
     _index(0),
-    filter(programLoader),
+    _filter(programLoader),
     _synchronised(false)
 {
 }
@@ -83,24 +83,29 @@ void TreeObjectItem::advanceLastChild()
     ++_index;
 }
 
+int64_t TreeObjectItem::lastChildIndex() const
+{
+    return _index;
+}
+
 void TreeObjectItem::setLastChildIndex(int64_t l)
 {
     _index = l;
 }
 
-bool TreeObjectItem::filterObject(Object& object)
+const Filter &TreeObjectItem::filter() const
 {
-    return filter(object);
+    return _filter;
 }
 
 bool TreeObjectItem::updateFilter(const std::string &expression)
 {
-    return filter.setExpression(expression);
+    return _filter.setExpression(expression);
 }
 
 const std::string &TreeObjectItem::filterExpression()
 {
-    return filter.expression();
+    return _filter.expression();
 }
 
 bool TreeObjectItem::hasStream() const
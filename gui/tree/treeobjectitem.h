@@ -37,8 +37,8 @@
  * The children of the item are mapped to the children of the object.
  * The item is responsible for parsing the object if necessary.
  *
- * The item also holds a \link Filter filter\endlink that it can use to filter its children
- * when requested.
+ * The item also holds the \link Filter filter\endlink of its children, which the
+ * \link TreeModel model\endlink evaluates by batches on a worker.
  */
 class TreeObjectItem : public TreeItem
 {
@@ -51,8 +51,9 @@ public:
     virtual bool synchronised();
 
     void advanceLastChild();
+    int64_t lastChildIndex() const;
     void setLastChildIndex(int64_t l);
-    bool filterObject(Object &object);
+    const Filter& filter() const;
     bool updateFilter(const std::string& expression);
     const std::string& filterExpression();
     virtual bool hasStream() const override;
@@ -70,7 +71,7 @@ private:
    bool isBitsetDisplay() const;
    Object* _object;
    int64_t _index;
-   Filter filter;
+   Filter _filter;
    bool _synchronised;
 };
 
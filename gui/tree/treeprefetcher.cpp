@@ -0,0 +1,270 @@
+//This file is part of the HexaMonkey project, a multimedia analyser
+//Copyright (C) 2013  Sevan Drapeau-Martin, Nicolas Fleury
+
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+
+#include <QEvent>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QScrollBar>
+
+#include "core/object.h"
+#include "core/variable/variablecollector.h"
+#include "gui/thread/threadqueue.h"
+#include "gui/tree/treeprefetcher.h"
+#include "gui/tree/treemodel.h"
+#include "gui/tree/treeobjectitem.h"
+#include "gui/tree/treeview.h"
+
+/**
+ * @brief Ranges of children parsed ahead and not displayed yet, shared with the tasks
+ *
+ * Only the children parsed by the prefetcher are counted, so that the children parsed
+ * on demand don't consume the budget when they are displayed.
+ */
+class TreePrefetcher::Speculation
+{
+public:
+    /**
+     * @brief Record the children of the object from begin to end (excluded) as parsed ahead
+     * @return number of objects parsed ahead and not displayed yet
+     */
+    qint64 add(const Object& object, qint64 begin, qint64 end)
+    {
+        QMutexLocker lock(&_mutex);
+        if (begin < end) {
+            Prefetched& prefetched = _prefetched[&object];
+            prefetched.root = &object.root();
+            // Children are only parsed once, so the ranges never overlap
+            prefetched.ranges.insert(begin, end);
+            _count += end - begin;
+        }
+        return _count;
+    }
+
+    void remove(const Object& object, qint64 begin, qint64 end)
+    {
+        QMutexLocker lock(&_mutex);
+        auto it = _prefetched.find(&object);
+        if (it == _prefetched.end()) {
+            return;
+        }
+
+        QMap<qint64, qint64> remaining;
+        for (auto range = it->ranges.constBegin(); range != it->ranges.constEnd(); ++range) {
+            const qint64 overlapBegin = qMax(range.key(), begin);
+            const qint64 overlapEnd = qMin(range.value(), end);
+            if (overlapBegin < overlapEnd) {
+                _count -= overlapEnd - overlapBegin;
+                if (range.key() < overlapBegin) {
+                    remaining.insert(range.key(), overlapBegin);
+                }
+                if (overlapEnd < range.value()) {
+                    remaining.insert(overlapEnd, range.value());
+                }
+            } else {
+                remaining.insert(range.key(), range.value());
+            }
+        }
+
+        if (remaining.isEmpty()) {
+            _prefetched.erase(it);
+        } else {
+            it->ranges = remaining;
+        }
+    }
+
+    void forget(const Object& root)
+    {
+        QMutexLocker lock(&_mutex);
+        for (auto it = _prefetched.begin(); it != _prefetched.end();) {
+            if (it->root == &root) {
+                for (auto range = it->ranges.constBegin(); range != it->ranges.constEnd(); ++range) {
+                    _count -= range.value() - range.key();
+                }
+                it = _prefetched.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    qint64 count()
+    {
+        QMutexLocker lock(&_mutex);
+        return _count;
+    }
+
+private:
+    struct Prefetched
+    {
+        const Object* root;
+        /// Beginning and end of the ranges of children parsed ahead
+        QMap<qint64, qint64> ranges;
+    };
+
+    QMutex _mutex;
+    QHash<const Object*, Prefetched> _prefetched;
+    qint64 _count = 0;
+};
+
+TreePrefetcher::TreePrefetcher(TreeModel &model, TreeView &view, ThreadQueue &threadQueue)
+    : QObject(&model),
+      _model(model),
+      _view(view),
+      _threadQueue(threadQueue),
+      _speculation(std::make_shared<Speculation>())
+{
+    _idleTimer.setSingleShot(true);
+    _idleTimer.setInterval(idleDelay);
+
+    connect(&_idleTimer, SIGNAL(timeout()), this, SLOT(prefetch()));
+    connect(&_threadQueue, SIGNAL(finished(int)), this, SLOT(onTaskDone(int)));
+    connect(&_threadQueue, SIGNAL(cancelled(int)), this, SLOT(onTaskDone(int)));
+    connect(_view.verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(onScrolled()));
+
+    _view.installEventFilter(this);
+    _view.viewport()->installEventFilter(this);
+}
+
+void TreePrefetcher::onChildrenDisplayed(const Object &object, qint64 begin, qint64 end)
+{
+    _speculation->remove(object, begin, end);
+}
+
+void TreePrefetcher::forgetFile(const Object &root)
+{
+    _speculation->forget(root);
+}
+
+void TreePrefetcher::restart()
+{
+    cancel();
+    _idleTimer.start();
+}
+
+void TreePrefetcher::prefetch()
+{
+    const int page = TreeModel::defaultPopulation;
+
+    QModelIndex current = _view.currentIndex();
+    if (current.isValid()) {
+        current = current.sibling(current.row(), 0);
+
+        if (_view.isExpanded(current)) {
+            prefetchChildren(current, page);
+        }
+
+        if (current.parent().isValid()) {
+            prefetchChildren(current.parent(), page);
+        }
+    }
+
+    const int bottom = _view.viewport()->height();
+    for (QModelIndex index = _view.indexAt(QPoint(0, 0));
+         index.isValid() && _view.visualRect(index).top() < bottom;
+         index = _view.indexBelow(index)) {
+
+        if (index.parent() == current.parent() && index != current && !_view.isExpanded(index)) {
+            prefetchChildren(index, page);
+        }
+    }
+}
+
+void TreePrefetcher::onScrolled()
+{
+    restart();
+
+    // Load the next page as soon as the end of the children displayed gets visible
+    QModelIndex last = _view.indexAt(QPoint(0, _view.viewport()->height() - 1));
+    if (last.isValid() && last.parent().isValid()) {
+        TreeItem& parentItem = _model.item(last.parent());
+        const int threshold = _model.realRowCount(last.parent()) - TreeModel::defaultPopulation / TreeModel::minPopulationRatio;
+        if (!parentItem.synchronised() && last.row() >= threshold) {
+            _model.populate(last.parent(),
+                            TreeModel::defaultPopulation,
+                            TreeModel::defaultPopulation / TreeModel::minPopulationRatio,
+                            TreeModel::populationTries);
+        }
+    }
+}
+
+void TreePrefetcher::onTaskDone(int id)
+{
+    _taskIds.remove(id);
+}
+
+bool TreePrefetcher::eventFilter(QObject */*watched*/, QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::KeyPress:
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::Wheel:
+        restart();
+        break;
+
+    default:
+        break;
+    }
+    return false;
+}
+
+void TreePrefetcher::cancel()
+{
+    _idleTimer.stop();
+    for (int id : _taskIds.values()) {
+        _threadQueue.cancel(id);
+    }
+}
+
+void TreePrefetcher::prefetchChildren(const QModelIndex &index, int count)
+{
+    if (budgetExhausted()) {
+        return;
+    }
+
+    TreeObjectItem& item = static_cast<TreeObjectItem&>(_model.item(index));
+    Object& object = item.object();
+
+    const int target = item.lastChildIndex() + count;
+    if (item.synchronising() || object.parsed() || object.numberOfChildren() >= target) {
+        return;
+    }
+
+    auto speculation = _speculation;
+    const qint64 maxCount = memoryBudget / objectFootprint;
+
+    ThreadQueue::Step step = [&object, target, count, speculation, maxCount] {
+        VariableCollectionGuard guard(object.collector());
+
+        const int before = object.numberOfChildren();
+        object.exploreSome(count);
+        const qint64 speculativeCount = speculation->add(object, before, object.numberOfChildren());
+
+        return object.parsed() || object.numberOfChildren() >= target || speculativeCount >= maxCount;
+    };
+
+    _threadQueue.add(ThreadQueue::Background, TreeModel::parsingGroups(object), ThreadQueue::Key(&object, -2), step, [this] (int id) {
+        _taskIds.insert(id);
+    });
+}
+
+bool TreePrefetcher::budgetExhausted() const
+{
+    return _speculation->count() >= memoryBudget / objectFootprint;
+}
@@ -0,0 +1,97 @@
+//This file is part of the HexaMonkey project, a multimedia analyser
+//Copyright (C) 2013  Sevan Drapeau-Martin, Nicolas Fleury
+
+//This program is free software; you can redistribute it and/or
+//modify it under the terms of the GNU General Public License
+//as published by the Free Software Foundation; either version 2
+//of the License, or (at your option) any later version.
+
+//This program is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with this program; if not, write to the Free Software
+//Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+
+#ifndef TREEPREFETCHER_H
+#define TREEPREFETCHER_H
+
+#include <QObject>
+#include <QModelIndex>
+#include <QSet>
+#include <QTimer>
+
+#include <memory>
+
+class Object;
+class ThreadQueue;
+class TreeModel;
+class TreeView;
+
+/**
+ * @brief Speculative exploration of the tree while the user is idle
+ *
+ * Once the user has stopped interacting with the \link TreeView view\endlink for a
+ * while, the prefetcher explores on low priority tasks the next page of children of
+ * the current node and of its parent, as well as the first page of children of the
+ * visible siblings of the current node, so that scrolling or expanding them doesn't
+ * wait for the parsing.
+ *
+ * Any interaction cancels the tasks not done yet. The number of \link Object objects\endlink
+ * parsed ahead and not displayed yet is bounded by a memory budget.
+ */
+class TreePrefetcher : public QObject
+{
+    Q_OBJECT
+public:
+    TreePrefetcher(TreeModel& model, TreeView& view, ThreadQueue& threadQueue);
+
+    /**
+     * @brief Notify that the children of the object from begin to end (excluded) have been added
+     * to the model, the ones parsed ahead are no longer speculative
+     */
+    void onChildrenDisplayed(const Object& object, qint64 begin, qint64 end);
+
+    /**
+     * @brief Forget the children parsed ahead in a file about to be closed
+     */
+    void forgetFile(const Object& root);
+
+public slots:
+    /**
+     * @brief Cancel the running prefetch and wait again for the user to be idle
+     */
+    void restart();
+
+private slots:
+    void prefetch();
+    void onScrolled();
+    void onTaskDone(int id);
+
+private:
+    class Speculation;
+
+    virtual bool eventFilter(QObject* watched, QEvent* event) override;
+
+    void cancel();
+    void prefetchChildren(const QModelIndex& index, int count);
+    bool budgetExhausted() const;
+
+    static const int idleDelay = 300;
+    static const qint64 memoryBudget = 64 * 1024 * 1024;
+    /// Rough memory footprint of a parsed object with its value and name
+    static const qint64 objectFootprint = 512;
+
+    TreeModel& _model;
+    TreeView& _view;
+    ThreadQueue& _threadQueue;
+
+    QTimer _idleTimer;
+    QSet<int> _taskIds;
+    std::shared_ptr<Speculation> _speculation;
+};
+
+#endif // TREEPREFETCHER_H
@@ -96,6 +96,11 @@ void TreeWidget::displayMenu(const QPoint &pos)
 
         QAction *dumpToFileAction = menu.addAction("Dump to File");
 
+        QAction *showErrorsAction = nullptr;
+        if (hasParsingErrors()) {
+            showErrorsAction = menu.addAction("Show Parsing Errors");
+        }
+
         QAction *closeFileAction = menu.addAction("Close File");
 
         QAction *trigeredAction = menu.exec(view->viewport()->mapToGlobal(pos));
@@ -117,6 +122,8 @@ void TreeWidget::displayMenu(const QPoint &pos)
             closeFile();
         } else if (trigeredAction == dumpToFileAction) {
             dumpToFile();
+        } else if (trigeredAction == showErrorsAction) {
+            showParsingErrors();
         }
     }
 }
@@ -254,6 +261,32 @@ void TreeWidget::dumpToFile()
     static_cast<TreeObjectItem&>(model->item(current)).object().dumpToFile(QFileDialog::getSaveFileName(this, "Dump to file").toStdString());
 }
 
+bool TreeWidget::hasParsingErrors() const
+{
+    QModelIndex current = view->currentIndex();
+    if(!current.isValid())
+        return false;
+
+    return !static_cast<TreeObjectItem&>(model->item(current)).object().errors().empty();
+}
+
+void TreeWidget::showParsingErrors()
+{
+    QModelIndex current = view->currentIndex();
+    if(!current.isValid())
+        return;
+
+    Object& object = static_cast<TreeObjectItem&>(model->item(current)).object();
+    std::streamoff begin = object.beginningPos();
+    std::streamoff end = object.size() != -1 ? begin + object.size() : object.file().size();
+
+    const auto errors = object.errors().between(begin, end);
+    Log::info(errors.size(), " parsing error(s) in ", object);
+    for (const ParsingError* error : errors) {
+        Log::info("    at ", error->position(), " : ", error->message());
+    }
+}
+
 TreeModel* TreeWidget::getModel()
 {
     return model;
@@ -57,6 +57,8 @@ public:
     void dumpStreamToFile();
     void closeFile();
     void dumpToFile();
+    bool hasParsingErrors() const;
+    void showParsingErrors();
     TreeModel* getModel();
 
 signals:
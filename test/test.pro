@@ -22,8 +22,6 @@ HEADERS += \
 	test_formatdetector.h \
 	test_util.h \
         test_parser.h \
-        ../gui/qtmodulesetup.h \
-        ../gui/qtprogramloader.h \
     test_variable.h
 
 SOURCES += \
@@ -32,6 +30,4 @@ SOURCES += \
 	test_formatdetector.cpp \
 	test_util.cpp \
         test_parser.cpp \
-        ../gui/qtmodulesetup.cpp \
-        ../gui/qtprogramloader.cpp \
     test_variable.cpp
@@ -1,9 +1,33 @@
 #include "test_parser.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <streambuf>
+
+#include "compiler/model.h"
 #include "core/modules/default/defaultmodule.h"
+#include "core/modules/mkv/mkvmodule.h"
+#include "core/util/rapidxml/rapidxml.hpp"
+#include "core/interpreter/bytecode.h"
+#include "core/interpreter/evaluator.h"
+#include "core/interpreter/filter.h"
+#include "core/interpreter/query.h"
+#include "core/interpreter/program.h"
+#include "core/interpreter/programloader.h"
+#include "core/interpreter/scriptprofiler.h"
+#include "core/log/metrics.h"
+#include "core/log/streamlogger.h"
+#include "core/variable/mapscope.h"
+#include "core/variable/objectattributes.h"
 #include "core/variable/variablecollector.h"
 
 #include "core/util/fileutil.h"
+#include "core/util/strutil.h"
+#include "core/util/unused.h"
 #include "core/log/logmanager.h"
 
 TestParser::TestParser() : path("resources/parser/")
@@ -116,25 +140,685 @@ void TestParser::test_zip()
     QVERIFY(checkFile("test_zip.zip"));
 }
 
-bool TestParser::checkFile(const std::string &fileName, int depth, int width, const std::string &moduleKey)
+void TestParser::test_bytecode()
+{
+    QVERIFY(checkInterpreters("test_default.bin", -1, -1, "test_default"));
+    QVERIFY(checkInterpreters("test_find.bin", -1, -1, "test_find"));
+    QVERIFY(checkInterpreters("test_asf.asf", 3, 22));
+    QVERIFY(checkInterpreters("test_bmp_24.bmp"));
+    QVERIFY(checkInterpreters("test_jpg.jpg", -1, 20));
+    QVERIFY(checkInterpreters("test_mp3.mp3", -1, 15));
+    QVERIFY(checkInterpreters("test_mp4.mp4", -1, 20));
+    QVERIFY(checkInterpreters("test_pe.exe", -1, 15));
+    QVERIFY(checkInterpreters("test_zip.zip"));
+}
+
+void TestParser::test_methods()
 {
+    const Module& module = moduleSetup.moduleLoader().getModule("test_methods");
     VariableCollector collector;
 
-    Log::info("Checking ", fileName);
+    for (bool bytecode : {true, false}) {
+        Bytecode::setEnabled(bytecode);
+
+        //Each call to the recursive method takes a frame from the pool while the caller holds its own
+        QCOMPARE(callMethod(module, "factorial", {10}, collector).toInteger(), 3628800ll);
+
+        //The inner call is made while the outer one still has to add its result
+        QCOMPARE(callMethod(module, "nestedTriangles", {5}, collector).toInteger(), 83ll);
+    }
+    Bytecode::setEnabled(true);
+
+    //The small methods are inlined, and give the same result as the AST interpreter
+    const Program program = moduleSetup.programLoader().fromFile(path+"scripts/test_methods");
+    QVERIFY(program.isValid());
+    for (const Program& declaration : program.node(2)) {
+        if (declaration.tag() == HMC_FUNCTION_DECLARATION && declaration.node(0).payload().toString() == "clampedSum") {
+            const std::shared_ptr<const Bytecode> code = Bytecode::compile(declaration.node(2), false, &module);
+            QVERIFY(code != nullptr);
+            QVERIFY(std::none_of(code->instructions().begin(), code->instructions().end(), [](const Bytecode::Instruction& instruction) {
+                return instruction.op == Bytecode::OpCode::Call;
+            }));
+        }
+    }
+    for (int64_t a : {-5, 3, 12}) {
+        const Variant result = callMethod(module, "clampedSum", {a, 7}, collector);
+        Bytecode::setEnabled(false);
+        const Variant expected = callMethod(module, "clampedSum", {a, 7}, collector);
+        Bytecode::setEnabled(true);
+        QCOMPARE(result.toInteger(), expected.toInteger());
+    }
+
+    //Once the pool holds a frame, a call only allocates the local variables it declares
+    const int calls = 100;
+    const ModuleMethod* clamp = module.getMethod("clamp");
+    QVERIFY(clamp != nullptr);
+    VariableArgs clampArgs = {collector.copy(15), collector.copy(0), collector.copy(10)};
+    VariableKeywordArgs kwargs;
+    QCOMPARE(clamp->call(clampArgs, kwargs, collector).value().toInteger(), 10ll);
+    size_t allocations = collector.allocationCount();
+    for (int i = 0; i < calls; ++i) {
+        clamp->call(clampArgs, kwargs, collector);
+    }
+    QCOMPARE(collector.allocationCount(), allocations);
+
+    const ModuleMethod* triangle = module.getMethod("triangle");
+    QVERIFY(triangle != nullptr);
+    VariableArgs triangleArgs = {collector.copy(10)};
+    QCOMPARE(triangle->call(triangleArgs, kwargs, collector).value().toInteger(), 55ll);
+    allocations = collector.allocationCount();
+    for (int i = 0; i < calls; ++i) {
+        triangle->call(triangleArgs, kwargs, collector);
+    }
+    //total and i
+    QCOMPARE(collector.allocationCount() - allocations, size_t(2 * calls));
+}
+
+void TestParser::test_optimization()
+{
+    UNUSED(hmcElemNames);
+    const std::string scriptsDir = "../scripts/";
+    std::vector<std::string> files;
+    getDirContent(scriptsDir, files);
+    std::sort(files.begin(), files.end());
+
+    //Instructions of the blocks compiled without then with the optimisations
+    size_t total[2] = {0, 0};
+    for (const std::string& file : files) {
+        if (extension(file) != "hm") {
+            continue;
+        }
+        const std::string key = file.substr(0, file.size() - 3);
+        const Module& module = moduleSetup.moduleLoader().getModule(key);
+        const Program program = moduleSetup.programLoader().fromFile(scriptsDir+key);
+        QVERIFY(program.isValid());
+
+        std::vector<std::pair<Program, bool> > blocks;
+        for (const Program& declaration : program.node(2)) {
+            if (declaration.tag() == HMC_CLASS_DECLARATION) {
+                blocks.push_back(std::make_pair(declaration.node(1).node(0), true));
+                blocks.push_back(std::make_pair(declaration.node(1).node(1), true));
+            } else if (declaration.tag() == HMC_FUNCTION_DECLARATION) {
+                blocks.push_back(std::make_pair(declaration.node(2), false));
+            }
+        }
+
+        size_t count[2] = {0, 0};
+        size_t hoisted = 0;
+        for (const auto& block : blocks) {
+            std::shared_ptr<const Bytecode> code[2];
+            for (int optimized = 0; optimized < 2; ++optimized) {
+                Bytecode::setOptimized(optimized);
+                code[optimized] = Bytecode::compile(block.first, block.second, &module);
+            }
+            if (code[0] && code[1]) {
+                count[0] += code[0]->size();
+                count[1] += code[1]->size();
+                hoisted += std::count_if(code[1]->instructions().begin(), code[1]->instructions().end(), [](const Bytecode::Instruction& instruction) {
+                    return instruction.op == Bytecode::OpCode::SubField;
+                });
+            }
+        }
+        Bytecode::setOptimized(true);
+
+        //Hoisting a path adds the flag set on entering the loop, so a script can grow
+        Log::info(key, " : ", count[0], " instructions, ", count[1], " once optimised, ", hoisted, " reads through a hoisted path");
+        if (key == "ts") {
+            //The PAT and PMT lookups of the transport packets go through @parent[index].psi_table and @root.@attr
+            QVERIFY(hoisted > 0);
+        }
+        total[0] += count[0];
+        total[1] += count[1];
+    }
+
+    Log::info("All scripts : ", total[0], " instructions, ", total[1], " once optimised");
+
+    QVERIFY(total[0] > 0);
+    QVERIFY(total[1] < total[0]);
+
+#ifdef HM_METRICS
+    //Instructions run and path elements resolved to parse the samples entirely
+    const std::vector<std::string> samples = {
+        "test_avi.avi", "test_flv.flv", "test_mp3.mp3", "test_mp4.mp4", "test_png.png", "test_ts.ts", "test_wav.wav", "test_zip.zip"
+    };
+    for (const std::string& sample : samples) {
+        uint64_t instructions[2];
+        uint64_t pathElements[2];
+        for (int optimized = 0; optimized < 2; ++optimized) {
+            countExecution(sample, optimized, instructions[optimized], pathElements[optimized]);
+        }
+        Log::info(sample, " : ", instructions[0], " instructions executed, ", instructions[1], " once optimised, ",
+                  pathElements[0], " path elements resolved, ", pathElements[1], " once optimised");
+        QVERIFY(instructions[1] > 0);
+
+        //A read through a hoisted path takes one more instruction but only resolves the end of the path
+        QVERIFY(pathElements[1] <= pathElements[0]);
+        if (sample == "test_ts.ts") {
+            QVERIFY(pathElements[1] < pathElements[0]);
+        }
+    }
+#endif
+}
+
+void TestParser::test_allocations()
+{
+    const size_t astAllocations = countAllocations("test_mp4.mp4", false);
+    const size_t bytecodeAllocations = countAllocations("test_mp4.mp4", true);
+
+    Log::info("Variables allocated for test_mp4.mp4 : ", astAllocations, " with the AST interpreter, ",
+              bytecodeAllocations, " with the bytecode");
+
+    QVERIFY(astAllocations > 0);
+    QVERIFY(bytecodeAllocations <= astAllocations);
+    //The AST interpreter no longer boxes its intermediate results, which made it allocate 2.5 times more
+    QVERIFY(astAllocations < 2 * bytecodeAllocations);
+
+    //The operators and the constants of a right value are evaluated without any variable
+    VariableCollector collector;
+    MapScope* scope = new MapScope(collector);
+    Variable scopeVariable(scope, true);
+    scope->setField("a", collector.copy(2));
+    scope->setField("b", collector.copy(3));
+    const Program program = moduleSetup.programLoader().fromString("a + b * 4 + 1");
+    QVERIFY(program.isValid());
+
+    const Evaluator evaluator(scopeVariable);
+    const size_t allocations = collector.allocationCount();
+    bool correct = true;
+    for (int i = 0; i < 100; ++i) {
+        correct = correct && evaluator.value(program.node(0)).toInteger() == 15;
+    }
+    QVERIFY(correct);
+    QCOMPARE(collector.allocationCount(), allocations);
+}
+
+void TestParser::test_specify()
+{
+    std::ifstream modelFile("../models/mkvmodel.xml");
+    QVERIFY(modelFile.good());
+    std::string modelText((std::istreambuf_iterator<char>(modelFile)), std::istreambuf_iterator<char>());
+    rapidxml::xml_document<> modelParser;
+    modelParser.parse<0>(&modelText[0]);
+
+    const Module& module = moduleSetup.moduleLoader().getModule("mkv");
+
+    std::vector<ObjectType> modelTypes;
+    for (rapidxml::xml_node<>* node = modelParser.first_node()->first_node(); node; node = node->next_sibling()) {
+        modelTypes.push_back(module.getType("EBMLElement", MkvModule::parseId(node->first_attribute("id")->value())));
+    }
+
+    //Ids absent from the model, as met in damaged files, go past the resolution cache
+    std::vector<ObjectType> unknownTypes;
+    for (int64_t id = 0x7F000000; id < 0x7F000000 + 4096; ++id) {
+        unknownTypes.push_back(module.getType("EBMLElement", id));
+    }
+
+    const int rounds = 100;
+    size_t specified = 0;
+
+    logDuration("Specified "+toStr(rounds * (modelTypes.size() + unknownTypes.size()))+" EBML elements ("
+                +toStr(modelTypes.size())+" ids from mkvmodel.xml)", [&] {
+        for (int round = 0; round < rounds; ++round) {
+            for (const ObjectType& type : modelTypes) {
+                specified += !module.specify(type).isNull();
+            }
+            for (const ObjectType& type : unknownTypes) {
+                specified += !module.specify(type).isNull();
+            }
+        }
+    });
+
+    QCOMPARE(specified, rounds * modelTypes.size());
+}
+
+void TestParser::test_skeleton()
+{
+    //The values and attributes are read before the children are explored
+    QVERIFY(checkSkeleton("test_default.bin", "test_default"));
+    QVERIFY(checkSkeleton("test_find.bin", "test_find"));
+    QVERIFY(checkSkeleton("test_asf.asf"));
+    QVERIFY(checkSkeleton("test_avi.avi"));
+    QVERIFY(checkSkeleton("test_bmp_4.bmp"));
+    QVERIFY(checkSkeleton("test_bmp_16b565.bmp"));
+    QVERIFY(checkSkeleton("test_bmp_24.bmp"));
+    QVERIFY(checkSkeleton("test_bmp_32b8888.bmp"));
+    QVERIFY(checkSkeleton("test_gif.gif"));
+    QVERIFY(checkSkeleton("test_flv.flv"));
+    QVERIFY(checkSkeleton("test_jpg.jpg"));
+    QVERIFY(checkSkeleton("test_pe.exe"));
+    QVERIFY(checkSkeleton("test_png.png"));
+    QVERIFY(checkSkeleton("test_msgpack.msgpack"));
+    QVERIFY(checkSkeleton("test_midi.midi"));
+    QVERIFY(checkSkeleton("test_mp3.mp3"));
+    QVERIFY(checkSkeleton("test_mp4.mp4"));
+    QVERIFY(checkSkeleton("test_mkv.mkv"));
+    QVERIFY(checkSkeleton("test_ogg.ogg"));
+    QVERIFY(checkSkeleton("test_sqlite.sqlite"));
+    //The tail of the interoperability fields sets their link
+    QVERIFY(checkSkeleton("test_tiff.tif"));
+    QVERIFY(checkSkeleton("test_ts.ts"));
+    QVERIFY(checkSkeleton("test_wav.wav"));
+    QVERIFY(checkSkeleton("test_zip.zip"));
+    QVERIFY(checkSkeleton("../format_detector/magic_ts.ts"));
+}
+
+void TestParser::test_errors()
+{
+    //The sample is cut in the middle of its media data box, which starts at byte 160
+    std::string content;
+    QVERIFY(readFile(path+"test_mp4.mp4", content));
+    {
+        std::ofstream truncated(path+"new/test_mp4_truncated.mp4", std::ios::binary);
+        truncated.write(content.data(), content.size() / 2);
+    }
+
+    VariableCollector truncatedCollector;
+    RealFile truncatedFile;
+    Object* truncated = parseFile("new/test_mp4_truncated.mp4", "mp4", truncatedFile, truncatedCollector);
+    QVERIFY(truncated != nullptr);
+    truncated->explore(-1);
+
+    const std::vector<const ParsingError*> fileErrors = truncated->errors().of(*truncated);
+    QCOMPARE(int(fileErrors.size()), 1);
+    const ParsingError& error = *fileErrors[0];
+    QCOMPARE(error.reason(), ParsingError::OutOfFile);
+    QCOMPARE(&error.object(), static_cast<const Object*>(truncated));
+    QVERIFY(error.child() != nullptr);
+    QCOMPARE(error.position(), std::streamoff(160*8));
+    QCOMPARE(error.child()->beginningPos(), error.position());
+
+    const std::vector<const ParsingError*> found = truncated->errors().between(160*8, 160*8 + 1);
+    QVERIFY(std::find(found.begin(), found.end(), &error) != found.end());
+    QVERIFY(truncated->errors().between(0, 160*8).empty());
+
+    //The parsing stops at the box out of the file
+    QVERIFY(!truncated->isValid());
+    QCOMPARE(truncated->availableSize(), std::streamoff(0));
+    QCOMPARE(static_cast<const Object*>(truncated->access(truncated->numberOfChildren() - 1)), error.child());
+
+    //Every movie box holds a box too big for it, only the first errors are logged
+    //The inner boxes stay in the file, the last one ending in the free box that follows
+    const int boxCount = 20;
+    {
+        std::ofstream corrupted(path+"new/test_mp4_corrupted.mp4", std::ios::binary);
+        corrupted.write(content.data(), 28);
+        for (int i = 0; i < boxCount; ++i) {
+            corrupted.write("\x00\x00\x00\x10" "moov" "\x00\x00\x00\x10" "free", 16);
+        }
+        corrupted.write("\x00\x00\x00\x10" "free" "\x00\x00\x00\x00\x00\x00\x00\x00", 16);
+    }
+
+    std::ostringstream log;
+    VariableCollector corruptedCollector;
+    RealFile corruptedFile;
+    Object* corrupted = nullptr;
+    {
+        StreamLogger logger(log);
+        corrupted = parseFile("new/test_mp4_corrupted.mp4", "mp4", corruptedFile, corruptedCollector);
+        QVERIFY(corrupted != nullptr);
+        corrupted->explore(-1);
+    }
+
+    QVERIFY(corrupted->isValid());
+    QVERIFY(int(corrupted->errors().size()) >= boxCount);
+    for (int i = 0; i < boxCount; ++i) {
+        const Object* box = corrupted->access(i + 1);
+        QVERIFY(box != nullptr);
+        QVERIFY(!box->isValid());
+        const std::vector<const ParsingError*> boxErrors = corrupted->errors().of(*box);
+        QCOMPARE(int(boxErrors.size()), 1);
+        QCOMPARE(boxErrors[0]->reason(), ParsingError::OutOfParent);
+        QCOMPARE(boxErrors[0]->position(), std::streamoff((28 + 16*i + 8)*8));
+    }
+
+    int loggedErrors = 0;
+    int warnings = 0;
+    std::istringstream lines(log.str());
+    for (std::string line; std::getline(lines, line);) {
+        if (line.compare(0, 7, "[ERROR]") == 0 && line.find("cannot be added to") != std::string::npos) {
+            ++loggedErrors;
+        } else if (line.compare(0, 9, "[WARNING]") == 0 && line.find("More parsing errors") != std::string::npos) {
+            ++warnings;
+        }
+    }
+    QCOMPARE(loggedErrors, 10);
+    QCOMPARE(warnings, 1);
+}
+
+void TestParser::test_startup()
+{
+    const std::string cacheDir = path+"new/cache/";
+
+    std::vector<std::string> cached;
+    getDirContent(cacheDir, cached);
+    for (const std::string& entry : cached) {
+        std::remove((cacheDir+entry).c_str());
+    }
+
+    //The first setup compiles every script, the second one finds them in the cache
+    size_t cacheSize[2];
+    for (int run = 0; run < 2; ++run) {
+        logDuration(run == 0 ? "Started up with an empty compile cache" : "Started up with the compile cache filled", [&] {
+            ModuleSetup setup;
+            setup.addScriptDirectory(path+"scripts/");
+            setup.setCacheDirectory(cacheDir);
+            setup.setup();
+        });
+
+        cached.clear();
+        getDirContent(cacheDir, cached);
+        cacheSize[run] = std::count_if(cached.begin(), cached.end(), [](const std::string& entry) {
+            return extension(entry) == "hmc";
+        });
+    }
+
+    QVERIFY(cacheSize[0] > 0);
+    QCOMPARE(cacheSize[1], cacheSize[0]);
+    QVERIFY(fileExists(cacheDir+"detections.manifest"));
+
+    //The scripts in the manifest are only loaded when their module is first used
+    ModuleSetup setup;
+    setup.addScriptDirectory(path+"scripts/");
+    setup.setCacheDirectory(cacheDir);
+    setup.setup();
 
     RealFile file;
-    file.setPath(path+fileName);
+    file.setPath(path+"test_png.png");
+    const Module* module = nullptr;
+    logDuration("Loaded the module of a PNG file on first use", [&] {
+        module = &setup.moduleLoader().getModule(file);
+    });
 
-    if (!file.good())
+    QVERIFY(module->isLoaded());
+    QVERIFY(!module->getTemplate("PngFile").isNull());
+
+    //Scripts sharing a name in different directories keep an entry each in the cache
+    std::string source;
+    QVERIFY(readFile(path+"scripts/test_find.hm", source));
     {
-        Log::error("File not found ", fileName);
-        return false;
+        std::ofstream copy(path+"new/test_find.hm", std::ios::binary);
+        copy << source;
     }
 
-    ModuleLoader& moduleLoader = moduleSetup.moduleLoader();
-    const Module& module = moduleKey.empty() ? moduleLoader.getModule(file) : moduleLoader.getModule(moduleKey);
+    ProgramLoader loader(cacheDir);
+    for (const std::string& script : {path+"scripts/test_find.hm", path+"new/test_find.hm", path+"scripts/test_find.hm"}) {
+        QVERIFY(loader.fromHM(script).isValid());
+    }
+
+    cached.clear();
+    getDirContent(cacheDir, cached);
+    QCOMPARE(int(std::count_if(cached.begin(), cached.end(), [](const std::string& entry) {
+        return entry.compare(0, 10, "test_find-") == 0 && extension(entry) == "hmc";
+    })), 2);
+}
+
+void TestParser::test_expression()
+{
+    //As compiled by filters each time their expression is edited
+    const std::vector<std::string> expressions = {
+        "@size > 1000",
+        "name == \"moov\" || name == \"trak\"",
+        "(@value & 0xff) != 0 && @pos < 2 * @size",
+        "!(@args.size >= 3) || @info != \"none\""
+    };
+
+    const int rounds = 100;
+    size_t compiled = 0;
+
+    logDuration("Compiled "+toStr(rounds * expressions.size())+" filter expressions", [&] {
+        for (int round = 0; round < rounds; ++round) {
+            for (const std::string& expression : expressions) {
+                compiled += moduleSetup.programLoader().fromString(expression).isValid();
+            }
+        }
+    });
+
+    QCOMPARE(compiled, rounds * expressions.size());
+    QVERIFY(!moduleSetup.programLoader().fromString("@size >").isValid());
+}
+
+void TestParser::test_filter()
+{
+    VariableCollector collector;
+    RealFile file;
+    Object* object = parseFile("test_flv.flv", "", file, collector);
+    QVERIFY(object != nullptr);
+
+    Object* body = object->lookUp("_body", true);
+    QVERIFY(body != nullptr);
+    body->explore(2);
+    const int64_t count = body->numberOfChildren();
+
+    //The first expression is pushed down, the second one needs the scope of the objects
+    const std::vector<std::string> expressions = {
+        "tagFlag.type == 9 && dataSize > 1000",
+        "@parent.@size > 0 && tagFlag.type == 9 && dataSize > 1000"
+    };
+    const int64_t batchSize = 256;
+
+    for (const std::string& expression : expressions) {
+        Filter filter(moduleSetup.programLoader());
+        QVERIFY(filter.setExpression(expression));
+
+        const std::string description = "Filtered "+toStr(count)+" children by \""+expression+"\""
+                                        +(filter.pushedDown() ? " (pushed down)" : "");
+
+        std::vector<Object*> expected;
+        logDuration(description+" one by one", [&] {
+            for (int64_t i = 0; i < count; ++i) {
+                Object* child = body->access(i);
+                if (child != nullptr && filter(*child)) {
+                    expected.push_back(child);
+                }
+            }
+        });
+
+        std::vector<Object*> matches;
+        logDuration(description+" by batches", [&] {
+            for (int64_t begin = 0; begin < count; begin += batchSize) {
+                filter.select(*body, begin, std::min(begin + batchSize, count), matches);
+            }
+        });
+
+        QVERIFY(!expected.empty());
+        QVERIFY(matches == expected);
+    }
+
+    //The operand not deciding of the result is not read, its fields are not parsed
+    VariableCollector lazyCollector;
+    RealFile lazyFile;
+    Object* lazyObject = parseFile("test_flv.flv", "", lazyFile, lazyCollector);
+    QVERIFY(lazyObject != nullptr);
+    Object* tag = lazyObject->lookUp("_body", true)->access(1, true);
+    QVERIFY(tag != nullptr);
+    const int64_t parsedCount = tag->numberOfChildren();
+
+    Filter shortCircuit(moduleSetup.programLoader());
+    QVERIFY(shortCircuit.setExpression("@size > 0 || missing == 1"));
+    QVERIFY(shortCircuit.pushedDown());
+    QVERIFY(shortCircuit(*tag));
+    QCOMPARE(int64_t(tag->numberOfChildren()), parsedCount);
+
+    QVERIFY(shortCircuit.setExpression("@size > 0 && missing == 1"));
+    QVERIFY(!shortCircuit(*tag));
+    QVERIFY(tag->numberOfChildren() > parsedCount);
+}
 
-    Object* object = module.handleFile(module.getType("File"), file, collector);
+void TestParser::test_query()
+{
+    VariableCollector collector;
+    RealFile file;
+    Object* object = parseFile("test_mp4.mp4", "", file, collector);
+    QVERIFY(object != nullptr);
+
+    Query query(moduleSetup.programLoader());
+    QVERIFY(query.setExpression("**:TrackBox/:MediaBox/:MediaHeaderBox/timescale"));
+    std::vector<Object*> timescales = query.select(*object);
+    QCOMPARE(timescales.size(), size_t(2));
+    QCOMPARE(timescales[0]->value().toInteger(), 90000ll);
+    QCOMPARE(timescales[1]->value().toInteger(), 48000ll);
+
+    //A type test also keeps the objects whose type extends the template
+    QVERIFY(query.setExpression("**:TrackBox/:MediaBox/:FullBox/timescale"));
+    QCOMPARE(query.select(*object).size(), size_t(2));
+    QVERIFY(query.setExpression(":Box"));
+    std::vector<Object*> boxes = query.select(*object);
+    QCOMPARE(boxes.size(), size_t(object->numberOfChildren()));
+    QVERIFY(std::any_of(boxes.begin(), boxes.end(), [](Object* box) {
+        return box->type().typeTemplate().name() == "MovieBox";
+    }));
+
+    QVERIFY(query.setExpression("**[type == \"stsz\" && sample_count > 200]/sample_count"));
+    std::vector<Object*> counts = query.select(*object);
+    QCOMPARE(counts.size(), size_t(1));
+    QCOMPARE(counts[0]->value().toInteger(), 261ll);
+
+    //The query stops as soon as the callback asks for it
+    QVERIFY(query.setExpression("#1/*"));
+    int found = 0;
+    QVERIFY(!query.run(*object, [&found](Object&) {
+        return ++found < 2;
+    }));
+    QCOMPARE(found, 2);
+
+    QVERIFY(!query.setExpression("**:TrackBox[sample_count > 1"));
+    QVERIFY(!query.setExpression("#first"));
+    QVERIFY(!query.setExpression("**//type"));
+}
+
+void TestParser::test_profiler()
+{
+    //The lines are only read for the scripts loaded once the profiler is enabled
+    ScriptProfiler::clear();
+    ScriptProfiler::setEnabled(true);
+    Bytecode::setEnabled(false);
+    bool parsed;
+    size_t boxes = 0;
+    Program program;
+    {
+        ModuleSetup setup;
+        setup.addScriptDirectory(path+"scripts/");
+        setup.setup();
+        program = setup.programLoader().fromFile("../scripts/mp4");
+
+        VariableCollector collector;
+        RealFile file;
+        file.setPath(path+"test_mp4.mp4");
+        const Module& module = setup.moduleLoader().getModule(file);
+        Object* object = module.handleFile(module.getType("File"), file, collector);
+        parsed = object != nullptr;
+        if (parsed) {
+            object->explore(-1);
+        }
+        ScriptProfiler::setEnabled(false);
+
+        Query query(setup.programLoader());
+        if (parsed && query.setExpression("**:Box")) {
+            boxes = query.select(*object).size();
+        }
+    }
+    Bytecode::setEnabled(true);
+    QVERIFY(parsed);
+    QVERIFY(boxes > 0);
+
+    //The lines expected are read from the script, loaded with its lines as well
+    int boxLine = -1, fileLoopLine = -1;
+    for (const Program& declaration : program.node(2)) {
+        if (declaration.tag() != HMC_CLASS_DECLARATION) {
+            continue;
+        }
+        const std::string& name = declaration.node(0).node(0).node(0).payload().toString();
+        const Program body = declaration.node(1).node(0);
+        if (name == "Box") {
+            boxLine = body.node(0).line();
+        } else if (name == "Mp4File") {
+            fileLoopLine = body.node(body.size() - 1).line();
+        }
+    }
+    QVERIFY(boxLine > 0 && fileLoopLine > 0);
+
+    std::stringstream report;
+    ScriptProfiler::writeReport(report);
+    Log::info(report.str());
+
+    // Every box begins with its size, on the first line of Box
+    std::map<std::string, long long> lineCounts;
+    std::map<std::string, long long> typeObjects;
+    double previousTime = std::numeric_limits<double>::max();
+    bool sorted = true;
+    std::string line;
+    while (std::getline(report, line)) {
+        std::stringstream S(line);
+        double selfTime, totalTime;
+        long long count, objects, bytes;
+        std::string name;
+        if (line.find("mp4.hm:") != std::string::npos && S >> selfTime >> totalTime >> count >> name) {
+            // The calls are given after the location, the statements after two spaces
+            std::string rest;
+            std::getline(S, rest);
+            if (rest.compare(0, 2, "  ") == 0) {
+                lineCounts[name] = count;
+            }
+        } else if (S >> selfTime >> totalTime >> count >> objects >> bytes >> name) {
+            typeObjects[name] = objects;
+        } else {
+            previousTime = std::numeric_limits<double>::max();
+            continue;
+        }
+        sorted = sorted && selfTime <= previousTime;
+        previousTime = selfTime;
+    }
+    QVERIFY(sorted);
+    QCOMPARE(lineCounts["mp4.hm:" + toStr(boxLine)], static_cast<long long>(boxes));
+    QCOMPARE(typeObjects["Mp4File"], 1ll);
+
+    std::stringstream folded;
+    ScriptProfiler::writeFoldedStacks(folded);
+    // The boxes are parsed by the loop ending Mp4File
+    QVERIFY(folded.str().find("Mp4File;mp4.hm:" + toStr(fileLoopLine) + ";") != std::string::npos);
+
+    ScriptProfiler::clear();
+}
+
+void TestParser::test_metrics()
+{
+#ifdef HM_METRICS
+    Metrics::reset();
+    {
+        VariableCollector collector;
+        RealFile file;
+        Object* object = parseFile("test_mp4.mp4", "", file, collector);
+        QVERIFY(object != nullptr);
+        object->explore(-1);
+    }
+
+    std::stringstream report;
+    Metrics::writeText(report);
+    Log::info(report.str());
+
+    QCOMPARE(Metrics::value(Metrics::formatDetections), uint64_t(1));
+    QCOMPARE(Metrics::summary(Metrics::formatDetectionTime).count, uint64_t(1));
+    QVERIFY(Metrics::value(Metrics::objectsCreated) > 0);
+    QVERIFY(Metrics::value(Metrics::headParsings) > 0);
+    QVERIFY(Metrics::value(Metrics::collections) > 0);
+
+    const Metrics::Summary readSize = Metrics::summary(Metrics::readSize);
+    QVERIFY(Metrics::value(Metrics::fileReads) > 0);
+    QCOMPARE(readSize.count, Metrics::value(Metrics::fileReads));
+    QCOMPARE(readSize.sum, Metrics::value(Metrics::fileBytesRead));
+    QVERIFY(readSize.percentile(0.5) <= readSize.percentile(0.99));
+    QVERIFY(readSize.percentile(0.99) <= readSize.max);
+#else
+    QSKIP("The metrics are not compiled in");
+#endif
+}
+
+bool TestParser::checkFile(const std::string &fileName, int depth, int width, const std::string &moduleKey)
+{
+    VariableCollector collector;
+    RealFile file;
+
+    Object* object = parseFile(fileName, moduleKey, file, collector);
 
     if (!object) {
         return false;
@@ -152,6 +836,193 @@ bool TestParser::checkFile(const std::string &fileName, int depth, int width, co
 
 }
 
+bool TestParser::checkInterpreters(const std::string &fileName, int depth, int width, const std::string &moduleKey)
+{
+    const std::string astPath = path+"new/"+fileName+".ast.txt";
+    const std::string bytecodePath = path+"new/"+fileName+".bytecode.txt";
+
+    {
+        VariableCollector collector;
+        RealFile file;
+        Bytecode::setEnabled(false);
+        Object* object = parseFile(fileName, moduleKey, file, collector);
+        Bytecode::setEnabled(true);
+
+        if (!object) {
+            return false;
+        }
+        writeObject(*object, astPath, depth, width);
+    }
+
+    {
+        VariableCollector collector;
+        RealFile file;
+        Object* object = parseFile(fileName, moduleKey, file, collector);
+
+        if (!object) {
+            return false;
+        }
+        writeObject(*object, bytecodePath, depth, width);
+    }
+
+    return fileCompare(astPath, bytecodePath);
+}
+
+bool TestParser::checkSkeleton(const std::string &fileName, const std::string &moduleKey)
+{
+    VariableCollector fullCollector;
+    RealFile fullFile;
+    Object* full = parseFile(fileName, moduleKey, fullFile, fullCollector);
+
+    VariableCollector skeletonCollector;
+    RealFile skeletonFile;
+    Object* skeleton = parseFile(fileName, moduleKey, skeletonFile, skeletonCollector, Object::skeletonParsing);
+
+    if (!full || !skeleton) {
+        return false;
+    }
+    return compareDescriptions(*full, *skeleton);
+}
+
+bool TestParser::compareDescriptions(Object &expected, Object &actual)
+{
+    if (!(expected.value() == actual.value())) {
+        Log::error("Value of ", actual.name(), " at ", actual.beginningPos(), " differs in skeleton mode : ", actual.value(), " instead of ", expected.value());
+        return false;
+    }
+
+    if (expected.hasLinkTo() != actual.hasLinkTo() || (expected.hasLinkTo() && expected.linkTo() != actual.linkTo())) {
+        Log::error("Link of ", actual.name(), " at ", actual.beginningPos(), " differs in skeleton mode");
+        return false;
+    }
+
+    const ObjectAttributes* expectedAttributes = expected.attributes();
+    const ObjectAttributes* actualAttributes = actual.attributes();
+    if ((expectedAttributes == nullptr) != (actualAttributes == nullptr)) {
+        Log::error("Attributes of ", actual.name(), " at ", actual.beginningPos(), " differ in skeleton mode");
+        return false;
+    }
+    if (expectedAttributes != nullptr) {
+        bool same = expectedAttributes->fieldNames() == actualAttributes->fieldNames()
+                 && expectedAttributes->numberedCount() == actualAttributes->numberedCount();
+        for (size_t i = 0; same && i < expectedAttributes->fieldNames().size(); ++i) {
+            const std::string& name = expectedAttributes->fieldNames()[i];
+            same = *expectedAttributes->getNamed(name) == *actualAttributes->getNamed(name);
+        }
+        for (size_t i = 0; same && i < expectedAttributes->numberedCount(); ++i) {
+            same = expectedAttributes->getNumbered(i) == actualAttributes->getNumbered(i);
+        }
+        if (!same) {
+            Log::error("Attributes of ", actual.name(), " at ", actual.beginningPos(), " differ in skeleton mode");
+            return false;
+        }
+    }
+
+    expected.explore();
+    actual.explore();
+    if (expected.numberOfChildren() != actual.numberOfChildren()) {
+        Log::error("Children of ", actual.name(), " at ", actual.beginningPos(), " differ in skeleton mode");
+        return false;
+    }
+
+    for (int i = 0; i < expected.numberOfChildren(); ++i) {
+        if (!compareDescriptions(*expected.access(i), *actual.access(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t TestParser::countAllocations(const std::string &fileName, bool bytecode)
+{
+    VariableCollector collector;
+    RealFile file;
+
+    Bytecode::setEnabled(bytecode);
+    Object* object = parseFile(fileName, "", file, collector);
+    if (object) {
+        //Writing the whole tree parses it entirely
+        writeObject(*object, path+"new/"+fileName+".allocations.txt", -1, -1);
+    }
+    Bytecode::setEnabled(true);
+
+    return collector.allocationCount();
+}
+
+void TestParser::countExecution(const std::string &fileName, bool optimized, uint64_t &instructions, uint64_t &pathElements)
+{
+#ifdef HM_METRICS
+    //The blocks are compiled once per module, which is loaded again for each setting
+    Bytecode::setOptimized(optimized);
+    instructions = Metrics::value(Metrics::instructionsExecuted);
+    pathElements = Metrics::value(Metrics::pathElementsResolved);
+    {
+        ModuleSetup setup;
+        setup.addScriptDirectory(path+"scripts/");
+        setup.setup();
+
+        VariableCollector collector;
+        RealFile file;
+        file.setPath(path+fileName);
+        const Module& module = setup.moduleLoader().getModule(file);
+        Object* object = module.handleFile(module.getType("File"), file, collector);
+        if (object) {
+            object->explore(-1);
+        }
+    }
+    Bytecode::setOptimized(true);
+    instructions = Metrics::value(Metrics::instructionsExecuted) - instructions;
+    pathElements = Metrics::value(Metrics::pathElementsResolved) - pathElements;
+#else
+    UNUSED(fileName);
+    UNUSED(optimized);
+    instructions = 0;
+    pathElements = 0;
+#endif
+}
+
+void TestParser::logDuration(const std::string &description, const std::function<void ()> &task)
+{
+    const auto start = std::chrono::steady_clock::now();
+    task();
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    Log::info(description, " in ", elapsed.count(), " us");
+}
+
+Variant TestParser::callMethod(const Module &module, const std::string &name, const std::vector<int64_t> &values, VariableCollector &collector)
+{
+    const ModuleMethod* method = module.getMethod(name);
+    if (method == nullptr) {
+        return Variant();
+    }
+
+    VariableArgs args;
+    for (int64_t value : values) {
+        args.push_back(collector.copy(value));
+    }
+    VariableKeywordArgs kwargs;
+    return method->call(args, kwargs, collector).value();
+}
+
+Object *TestParser::parseFile(const std::string &fileName, const std::string &moduleKey, RealFile &file, VariableCollector &collector, Object::ParsingMode mode)
+{
+    Log::info("Checking ", fileName);
+
+    file.setPath(path+fileName);
+
+    if (!file.good())
+    {
+        Log::error("File not found ", fileName);
+        return nullptr;
+    }
+
+    ModuleLoader& moduleLoader = moduleSetup.moduleLoader();
+    const Module& module = moduleKey.empty() ? moduleLoader.getModule(file) : moduleLoader.getModule(moduleKey);
+
+    return module.handleFile(module.getType("File"), file, collector, mode);
+}
+
 void TestParser::writeObject(Object &object, const std::string &outputPath, int depth, int width)
 {
     std::ofstream file;
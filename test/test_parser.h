@@ -5,8 +5,10 @@
 
 #include <QObject>
 #include <fstream>
+#include <functional>
 
-#include "gui/qtmodulesetup.h"
+#include "core/modulesetup.h"
+#include "core/file/realfile.h"
 
 class TestParser : public QObject
 {
@@ -37,14 +39,36 @@ private slots:
     void test_wave();
     void test_zip();
 
+    void test_bytecode();
+    void test_methods();
+    void test_optimization();
+    void test_allocations();
+    void test_specify();
+    void test_skeleton();
+    void test_errors();
+    void test_startup();
+    void test_expression();
+    void test_filter();
+    void test_query();
+    void test_profiler();
+    void test_metrics();
+
 private:
 
     bool checkFile(const std::string& fileName, int depth = -1, int width = -1, const std::string &moduleKey = "");
+    bool checkInterpreters(const std::string& fileName, int depth = -1, int width = -1, const std::string &moduleKey = "");
+    bool checkSkeleton(const std::string& fileName, const std::string &moduleKey = "");
+    bool compareDescriptions(Object& expected, Object& actual);
+    size_t countAllocations(const std::string& fileName, bool bytecode);
+    Variant callMethod(const Module& module, const std::string& name, const std::vector<int64_t>& values, VariableCollector& collector);
+    void countExecution(const std::string& fileName, bool optimized, uint64_t& instructions, uint64_t& pathElements);
+    void logDuration(const std::string& description, const std::function<void()>& task);
+    Object* parseFile(const std::string& fileName, const std::string &moduleKey, RealFile& file, VariableCollector& collector, Object::ParsingMode mode = Object::fullParsing);
 
     void writeObject(Object& object, const std::string& outputPath, int depth, int width);
     void writeObjectRecursive(Object& object, std::ofstream& file, int currentDepth, int remainingDepth, int width);
 
-    QtModuleSetup moduleSetup;
+    ModuleSetup moduleSetup;
     const std::string path;
 };
 
@@ -1,7 +1,10 @@
 
 #include <sstream>
+#include <thread>
 
 #include "test_util.h"
+#include "core/util/appendonlymap.h"
+#include "core/util/appendonlyvector.h"
 #include "core/util/bitutil.h"
 #include "core/util/csvreader.h"
 #include "core/util/fileutil.h"
@@ -137,6 +140,41 @@ void TestUtil::testFileUtil_fileCompare()
     QVERIFY(!fileCompare("resources/util/file_compare.orig.txt", "resources/util/file_compare.shorter.txt"));
 }
 
+void TestUtil::testFileUtil_fileHash()
+{
+    uint64_t orig = fileHashBasis;
+    uint64_t same = fileHashBasis;
+    uint64_t different = fileHashBasis;
+    QVERIFY( fileHash("resources/util/file_compare.orig.txt", orig));
+    QVERIFY( fileHash("resources/util/file_compare.same.txt", same));
+    QVERIFY( fileHash("resources/util/file_compare.different.txt", different));
+    QCOMPARE(orig, same);
+    QVERIFY(orig != different);
+
+    uint64_t empty = fileHashBasis;
+    QVERIFY(!fileHash("resources/util/file_exists_false.txt", empty));
+    QCOMPARE(empty, fileHashBasis);
+
+    uint64_t twice = orig;
+    QVERIFY( fileHash("resources/util/file_compare.orig.txt", twice));
+    QVERIFY(twice != orig);
+}
+
+void TestUtil::testFileUtil_readFile()
+{
+    std::string content;
+    QVERIFY( readFile("resources/util/file_compare.orig.txt", content));
+    QVERIFY(!content.empty());
+
+    uint64_t fromFile = fileHashBasis;
+    uint64_t fromContent = fileHashBasis;
+    QVERIFY( fileHash("resources/util/file_compare.orig.txt", fromFile));
+    dataHash(content.data(), content.size(), fromContent);
+    QCOMPARE(fromContent, fromFile);
+
+    QVERIFY(!readFile("resources/util/file_exists_false.txt", content));
+}
+
 void TestUtil::testStrUtil_strTo()
 {
     QCOMPARE(strTo<int>(std::string("10.0")), int(10));
@@ -278,6 +316,83 @@ void TestUtil::testIterationWrapper()
     QCOMPARE(++str_it, reverse(strings).end());
 }
 
+void TestUtil::testAppendOnlyVector()
+{
+    AppendOnlyVector<std::string> strings;
+    QCOMPARE(strings.empty(), true);
+    QCOMPARE(strings.begin() == strings.end(), true);
+
+    for (int i = 0; i < 1000; ++i) {
+        strings.push_back(toStr(i));
+    }
+    QCOMPARE(strings.size(), size_t(1000));
+    QCOMPARE(strings[0], std::string("0"));
+    QCOMPARE(strings[7], std::string("7"));
+    QCOMPARE(strings[8], std::string("8"));
+    QCOMPARE(strings[999], std::string("999"));
+    QCOMPARE(strings.back(), std::string("999"));
+
+    // references are not invalidated by growth
+    const std::string* first = &strings[0];
+    for (int i = 0; i < 10000; ++i) {
+        strings.emplace_back("x");
+    }
+    QCOMPARE(first, &strings[0]);
+
+    QCOMPARE(int(strings.end() - strings.begin()), 11000);
+    QCOMPARE(*(strings.begin() + 500), std::string("500"));
+    QCOMPARE(*strings.rbegin(), std::string("x"));
+    QCOMPARE(*(strings.rend() - 1), std::string("0"));
+}
+
+void TestUtil::testAppendOnlyVector_concurrentRead()
+{
+    const size_t n = 200000;
+    AppendOnlyVector<size_t> values;
+
+    std::thread writer([&values, n] {
+        for (size_t i = 0; i < n; ++i) {
+            values.push_back(i);
+        }
+    });
+
+    bool consistent = true;
+    size_t read = 0;
+    while (read < n) {
+        const size_t size = values.size();
+        for (; read < size; ++read) {
+            consistent = consistent && values[read] == read;
+        }
+    }
+    writer.join();
+
+    QCOMPARE(consistent, true);
+}
+
+void TestUtil::testAppendOnlyMap()
+{
+    AppendOnlyMap<std::string, int> map;
+    QCOMPARE(map.value("a", -1), -1);
+
+    map.set("a", 1);
+    map.set("b", 2);
+    QCOMPARE(map.value("a", -1), 1);
+    QCOMPARE(map.value("b", -1), 2);
+    QCOMPARE(map.value("c", -1), -1);
+
+    // the last value set is kept
+    map.set("a", 3);
+    QCOMPARE(map.value("a", -1), 3);
+    QCOMPARE(map.size(), size_t(2));
+
+    for (int i = 0; i < 1000; ++i) {
+        map.set(toStr(i), i);
+    }
+    QCOMPARE(map.size(), size_t(1002));
+    QCOMPARE(map.value("0", -1), 0);
+    QCOMPARE(map.value("999", -1), 999);
+    QCOMPARE(map.value("b", -1), 2);
+}
 
 void TestUtil::testFormat()
 {
@@ -15,6 +15,8 @@ private slots:
     void testFileUtil_getFile();
     void testFileUtil_getDirContent();
     void testFileUtil_fileCompare();
+    void testFileUtil_fileHash();
+    void testFileUtil_readFile();
     void testStrUtil_strTo();
     void testStrUtil_toStr();
     void testStrUtil_toHex();
@@ -29,6 +31,9 @@ private slots:
     void testStrUtil_join();
     void testOptOwnPtr();
     void testIterationWrapper();
+    void testAppendOnlyVector();
+    void testAppendOnlyVector_concurrentRead();
+    void testAppendOnlyMap();
     void testFormat();
 };
 
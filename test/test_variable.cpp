@@ -86,3 +86,63 @@ void TestVariable::testCollector()
     collector.collect();
     QCOMPARE(collected, shouldBeCollected);
 }
+
+void TestVariable::testYoungCollector()
+{
+    VariableCollector collector;
+
+    std::vector<CollectorTestVariableImplementation*> implementations;
+    std::vector<Variable> variables;
+    std::vector<int> collected = {0,0,0,0,0,0,0,0,0,0};
+
+    for (int i = 0; i < 6; ++i) {
+        auto implementation = new CollectorTestVariableImplementation(collector, collected[i], i);
+        implementations.push_back(implementation);
+        variables.emplace_back(implementation, true);
+    }
+
+    // 1 is held by 0, 4 and 5 reference each other
+    implementations[0]->addReference(variables[1]);
+    implementations[4]->addReference(variables[5]);
+    implementations[5]->addReference(variables[4]);
+
+    variables[1] = Variable();
+    variables[2] = Variable();
+    variables[4] = Variable();
+
+    // The garbage that never escaped is freed, the others are promoted
+    collector.collectYoung();
+    QCOMPARE(collected, std::vector<int>({0,0,1,0,0,0,0,0,0,0}));
+    QCOMPARE(collector.statistics().youngCollections, (size_t) 1);
+    QCOMPARE(collector.statistics().freed, (size_t) 1);
+    QCOMPARE(collector.statistics().promoted, (size_t) 5);
+
+    // The old generation is only swept by a full collection
+    variables[5] = Variable();
+    collector.collectYoung();
+    QCOMPARE(collected, std::vector<int>({0,0,1,0,0,0,0,0,0,0}));
+
+    collector.collect();
+    QCOMPARE(collected, std::vector<int>({0,0,1,0,1,1,0,0,0,0}));
+    QCOMPARE(collector.statistics().fullCollections, (size_t) 1);
+    QCOMPARE(collector.statistics().freed, (size_t) 3);
+
+    // Once more implementations than the old generation have been promoted,
+    // a young collection runs a full collection
+    collector.setFullCollectionThreshold(0);
+    for (int i = 6; i < 10; ++i) {
+        variables.emplace_back(new CollectorTestVariableImplementation(collector, collected[i], i), true);
+    }
+    collector.collectYoung();
+    QCOMPARE(collector.statistics().fullCollections, (size_t) 1);
+
+    variables[3] = Variable();
+    collector.collectYoung();
+    QCOMPARE(collected, std::vector<int>({0,0,1,1,1,1,0,0,0,0}));
+    QCOMPARE(collector.statistics().fullCollections, (size_t) 2);
+    QVERIFY(collector.statistics().maxPause >= collector.statistics().lastPause);
+
+    variables.clear();
+    collector.collect();
+    QCOMPARE(collected, std::vector<int>({1,1,1,1,1,1,1,1,1,1}));
+}
@@ -8,7 +8,8 @@ class TestVariable : public QObject
     Q_OBJECT
 private slots:
     void testCollector();
-    
+    void testYoungCollector();
+
 };
 
 #endif // TEST_VARIABLE_H
@@ -278,6 +278,37 @@ void TestVariant::objectType()
     // ObjectType ot3 = var.toObjectType();
 }
 
+void TestVariant::objectTypeInterning()
+{
+    ObjectTypeTemplate typeTemplate("InterningTest", {"a", "b"});
+
+    ObjectType built = ObjectTypeCreator::Create(typeTemplate);
+    built.setParameters(1, "x");
+    ObjectType a = built;
+    ObjectType b = built;
+    QCOMPARE(a.hash(), b.hash());
+    QCOMPARE(IdenticalType()(a, b), true);
+    QCOMPARE(a == b, true);
+
+    // an integer and a floating parameter are equal but not identical
+    ObjectType floating = ObjectTypeCreator::Create(typeTemplate);
+    floating.setParameters(1.0, "x");
+    ObjectType c = floating;
+    QCOMPARE(c == a, true);
+    QCOMPARE(IdenticalType()(c, a), false);
+
+    // modifying a copy leaves the shared parameters untouched
+    ObjectType d = a;
+    d.setParameter(0, 2);
+    QCOMPARE(a.parameterValue(0).toInteger(), 1LL);
+    QCOMPARE(d.parameterValue(0).toInteger(), 2LL);
+    QCOMPARE(d == a, false);
+
+    d.setParameter(0, 1);
+    QCOMPARE(IdenticalType()(d, a), true);
+    QCOMPARE(ObjectType(d).hash(), a.hash());
+}
+
 void TestVariant::conversion()
 {
     // setValue resets the Variant (including the type)
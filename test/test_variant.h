@@ -14,6 +14,7 @@ private slots:
     void floating();
     void string();
     void objectType();
+    void objectTypeInterning();
     void conversion();
 };
 